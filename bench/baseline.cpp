@@ -0,0 +1,308 @@
+#include "baseline.h"
+
+#include "vk_core.h"
+#include "util/json.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+
+// reads the two levels of string keyed objects of the baseline file, no arrays, booleans or nulls
+class BaselineReader {
+
+    public:
+
+        BaselineReader( std::string_view text) : mText{ text}, mPos{ 0} {}
+
+        void Expect( char c) {
+
+            SkipSpace();
+            if (mPos >= mText.size() || mText[mPos] != c)
+            {
+                throw std::runtime_error( "Malformed baseline file, expected '" + std::string( 1, c) + "' at offset " + std::to_string( mPos));
+            }
+            mPos++;
+        }
+
+        // consumes c if it is the next character
+        bool Accept( char c) {
+
+            SkipSpace();
+            if (mPos < mText.size() && mText[mPos] == c)
+            {
+                mPos++;
+                return true;
+            }
+
+            return false;
+        }
+
+        // decodes the escapes written by vktg::AppendJsonString, unicode escapes of the basic multilingual plane become UTF-8
+        std::string ReadString() {
+
+            Expect( '"');
+            std::string str;
+            while (mPos < mText.size() && mText[mPos] != '"')
+            {
+                if (mText[mPos] != '\\')
+                {
+                    str += mText[mPos++];
+                    continue;
+                }
+                if (++mPos >= mText.size())
+                {
+                    break;
+                }
+                char c = mText[mPos++];
+                switch (c)
+                {
+                    case 'b': str += '\b'; break;
+                    case 'f': str += '\f'; break;
+                    case 'n': str += '\n'; break;
+                    case 'r': str += '\r'; break;
+                    case 't': str += '\t'; break;
+                    case 'u': AppendCodePoint( str, ReadHex4()); break;
+                    default: str += c; break;
+                }
+            }
+            Expect( '"');
+
+            return str;
+        }
+
+        double ReadNumber() {
+
+            SkipSpace();
+            std::string number{ mText.substr( mPos, std::min<size_t>( 64, mText.size() - mPos))};
+            char *end = nullptr;
+            double value = std::strtod( number.c_str(), &end);
+            if (end == number.c_str())
+            {
+                throw std::runtime_error( "Malformed baseline file, expected number at offset " + std::to_string( mPos));
+            }
+            mPos += end - number.c_str();
+
+            return value;
+        }
+
+        bool AtEnd() {
+
+            SkipSpace();
+            return mPos == mText.size();
+        }
+
+    private:
+
+        uint32_t ReadHex4() {
+
+            std::string digits{ mText.substr( mPos, std::min<size_t>( 4, mText.size() - mPos))};
+            char *end = nullptr;
+            uint32_t value = (uint32_t)std::strtoul( digits.c_str(), &end, 16);
+            if (digits.size() != 4 || end != digits.c_str() + 4)
+            {
+                throw std::runtime_error( "Malformed baseline file, expected four hex digits at offset " + std::to_string( mPos));
+            }
+            mPos += 4;
+
+            return value;
+        }
+
+        static void AppendCodePoint( std::string &str, uint32_t codePoint) {
+
+            if (codePoint < 0x80)
+            {
+                str += (char)codePoint;
+            }
+            else if (codePoint < 0x800)
+            {
+                str += (char)(0xC0 | (codePoint >> 6));
+                str += (char)(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                str += (char)(0xE0 | (codePoint >> 12));
+                str += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+                str += (char)(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        void SkipSpace() {
+
+            while (mPos < mText.size() && std::isspace( (unsigned char)mText[mPos]))
+            {
+                mPos++;
+            }
+        }
+
+        std::string_view mText;
+        size_t mPos;
+};
+
+
+std::string Baselines::MachineKey() {
+
+    auto properties = vktg::Gpu().getProperties();
+
+    std::ostringstream key;
+    key << properties.deviceName.data() << " / driver " << properties.driverVersion
+#ifdef NDEBUG
+        << " / release";
+#else
+        << " / debug";
+#endif
+
+    return key.str();
+}
+
+
+bool Baselines::Load( std::string_view path) {
+
+    std::ifstream file( std::string{ path});
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string text = content.str();
+
+    mMachines.clear();
+    BaselineReader reader( text);
+    reader.Expect( '{');
+    if (!reader.Accept( '}'))
+    {
+        do {
+            auto &benchmarks = mMachines[reader.ReadString()];
+            reader.Expect( ':');
+            reader.Expect( '{');
+            if (!reader.Accept( '}'))
+            {
+                do {
+                    auto name = reader.ReadString();
+                    reader.Expect( ':');
+                    benchmarks[name] = reader.ReadNumber();
+                } while (reader.Accept( ','));
+                reader.Expect( '}');
+            }
+        } while (reader.Accept( ','));
+        reader.Expect( '}');
+    }
+    if (!reader.AtEnd())
+    {
+        throw std::runtime_error( "Malformed baseline file " + std::string{ path} + ", unexpected content after end of object");
+    }
+
+    return true;
+}
+
+
+bool Baselines::Save( std::string_view path) const {
+
+    std::ostringstream out;
+    out << "{";
+    bool firstMachine = true;
+    for (auto &[machine, benchmarks] : mMachines)
+    {
+        out << (firstMachine ? "\n  " : ",\n  ");
+        vktg::AppendJsonString( out, machine);
+        out << ": {";
+        bool firstBenchmark = true;
+        for (auto &[name, medianNs] : benchmarks)
+        {
+            out << (firstBenchmark ? "\n    " : ",\n    ");
+            vktg::AppendJsonString( out, name);
+            out << ": " << std::fixed << std::setprecision( 1) << medianNs;
+            firstBenchmark = false;
+        }
+        out << "\n  }";
+        firstMachine = false;
+    }
+    out << "\n}\n";
+
+    std::ofstream file( std::string{ path});
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << out.str();
+
+    return true;
+}
+
+
+bool Baselines::HasMachine( std::string_view machine) const {
+
+    auto it = mMachines.find( machine);
+
+    return it != mMachines.end() && !it->second.empty();
+}
+
+
+void Baselines::Update( std::string_view machine, const std::vector<BenchmarkResult> &results) {
+
+    auto it = mMachines.find( machine);
+    if (it == mMachines.end())
+    {
+        it = mMachines.emplace( std::string{ machine}, std::map<std::string, double>{}).first;
+    }
+    for (auto &result : results)
+    {
+        it->second[result.name] = result.medianNs;
+    }
+}
+
+
+std::vector<BaselineComparison> Baselines::Compare( std::string_view machine, const std::vector<BenchmarkResult> &results, double threshold) const {
+
+    std::vector<BaselineComparison> comparisons;
+    comparisons.reserve( results.size());
+
+    auto it = mMachines.find( machine);
+    for (auto &result : results)
+    {
+        BaselineComparison comparison{ result.name, 0.0, result.medianNs, 0.0, false};
+        if (it != mMachines.end())
+        {
+            auto baseline = it->second.find( result.name);
+            if (baseline != it->second.end() && baseline->second > 0.0)
+            {
+                comparison.baselineNs = baseline->second;
+                comparison.change = result.medianNs / baseline->second - 1.0;
+                // compared on the times, so a change of exactly the threshold is not lost to rounding of the ratio
+                comparison.regressed = result.medianNs > baseline->second * (1.0 + threshold);
+            }
+        }
+        comparisons.push_back( comparison);
+    }
+
+    return comparisons;
+}
+
+
+uint32_t PrintComparisons( const std::vector<BaselineComparison> &comparisons) {
+
+    uint32_t regressions = 0;
+    std::printf( "%-48s %12s %12s %10s\n", "benchmark", "baseline us", "median us", "change");
+    for (auto &comparison : comparisons)
+    {
+        if (comparison.baselineNs == 0.0)
+        {
+            std::printf( "%-48s %12s %12.2f %10s\n", comparison.name.c_str(), "-", comparison.currentNs * 1e-3, "new");
+            continue;
+        }
+        std::printf(
+            "%-48s %12.2f %12.2f %+9.1f%%%s\n",
+            comparison.name.c_str(), comparison.baselineNs * 1e-3, comparison.currentNs * 1e-3, comparison.change * 1e2,
+            comparison.regressed ? "  REGRESSED" : ""
+        );
+        regressions += comparison.regressed;
+    }
+
+    return regressions;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+
+#include "benchmark.h"
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// @brief Median time of a benchmark compared against its stored baseline.
+struct BaselineComparison {
+
+    std::string name;
+    /// @brief Baseline median time in nanoseconds, 0 if the benchmark has no baseline yet.
+    double baselineNs;
+    double currentNs;
+    /// @brief Relative change of the median time, positive if slower.
+    double change;
+    bool regressed;
+};
+
+
+/// @brief Per machine baseline timings stored in a JSON file of the form { "<machine>": { "<benchmark>": median_ns, ... }, ... }.
+class Baselines {
+
+    public:
+
+        /// @brief Key identifying the machine the benchmarks run on, made from device name, driver version and build type.
+        /// @return Machine key.
+        static std::string MachineKey();
+
+        /// @brief Loads baselines from file, replacing the current ones.
+        /// @param path Path to baseline file.
+        /// @return False if the file does not exist, throws if it is malformed.
+        bool Load( std::string_view path);
+        /// @brief Writes baselines of all machines to file.
+        /// @param path Path to baseline file.
+        /// @return True if the file was written.
+        bool Save( std::string_view path) const;
+
+        /// @brief Checks if baselines are stored for a machine.
+        /// @param machine Machine key.
+        /// @return True if the machine has at least one baseline.
+        bool HasMachine( std::string_view machine) const;
+
+        /// @brief Sets the baselines of a machine to the median times of the given results, other benchmarks of the machine are kept.
+        /// @param machine Machine key.
+        /// @param results Benchmark results.
+        void Update( std::string_view machine, const std::vector<BenchmarkResult> &results);
+        /// @brief Compares median times of the given results against the baselines of a machine.
+        /// @param machine Machine key.
+        /// @param results Benchmark results.
+        /// @param threshold Allowed relative slow down before a benchmark counts as regressed, e.g. 0.1 for 10%. A median of exactly baseline * (1 + threshold) still passes.
+        /// @return Comparison for each result.
+        std::vector<BaselineComparison> Compare( std::string_view machine, const std::vector<BenchmarkResult> &results, double threshold) const;
+
+    private:
+
+        std::map<std::string, std::map<std::string, double>, std::less<>> mMachines;
+};
+
+
+/// @brief Prints comparisons as a table to stdout.
+/// @param comparisons Comparisons to print.
+/// @return Number of regressed benchmarks.
+uint32_t PrintComparisons( const std::vector<BaselineComparison> &comparisons);
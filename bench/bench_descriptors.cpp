@@ -0,0 +1,46 @@
+#include "benchmark.h"
+
+#include "descriptors.h"
+
+#include <vector>
+
+
+void RunDescriptorBenchmarks( BenchmarkRunner &runner) {
+
+    const uint32_t iterations = 10000;
+
+    std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+        vk::DescriptorSetLayoutBinding{}
+            .setBinding( 0 )
+            .setDescriptorType( vk::DescriptorType::eUniformBuffer )
+            .setDescriptorCount( 1 )
+            .setStageFlags( vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment ),
+        vk::DescriptorSetLayoutBinding{}
+            .setBinding( 1 )
+            .setDescriptorType( vk::DescriptorType::eCombinedImageSampler )
+            .setDescriptorCount( 4 )
+            .setStageFlags( vk::ShaderStageFlagBits::eFragment )
+    };
+
+    vktg::DescriptorLayoutCache layoutCache;
+    vk::DescriptorSetLayout layout = layoutCache.CreateLayout( bindings);
+
+    runner.Run( "DescriptorLayoutCache::CreateLayout/hit", iterations, [&]( int32_t){
+        layoutCache.CreateLayout( bindings);
+    });
+
+    // a different descriptor count per iteration creates a new layout each time
+    runner.Run( "DescriptorLayoutCache::CreateLayout/miss", 1000, [&]( int32_t i){
+        auto missBindings = bindings;
+        missBindings[1].setDescriptorCount( 8 + warmupIterations + i );
+        layoutCache.CreateLayout( missBindings);
+    });
+
+    vktg::DescriptorSetAllocator allocator;
+    runner.Run( "DescriptorSetAllocator::Allocate", iterations, [&]( int32_t){
+        allocator.Allocate( layout);
+    });
+
+    allocator.DestroyPools();
+    layoutCache.DestroyLayouts();
+}
@@ -0,0 +1,176 @@
+#include "benchmark.h"
+#include "baseline.h"
+
+#include "vk_core.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+// enables only the features the device supports, CPU implementations like lavapipe lack some of the defaults
+template<typename Features>
+static void MaskFeatures( Features &enabled, const Features &supported, size_t offset) {
+
+    auto enabledBools = reinterpret_cast<VkBool32*>( reinterpret_cast<uint8_t*>( &enabled) + offset);
+    auto supportedBools = reinterpret_cast<const VkBool32*>( reinterpret_cast<const uint8_t*>( &supported) + offset);
+    for (size_t i = 0; i < (sizeof(Features) - offset) / sizeof(VkBool32); i++)
+    {
+        enabledBools[i] = enabledBools[i] && supportedBools[i];
+    }
+}
+
+
+static void ConfigureHeadless() {
+
+    vktg::Config()->headless = true;
+
+    // the feature structs start with sType and pNext
+    const size_t chainOffset = offsetof( VkPhysicalDeviceVulkan12Features, samplerMirrorClampToEdge);
+    vktg::Config()->setVulkan10DeviceFeatures = []( vk::PhysicalDeviceFeatures2 &features){
+        MaskFeatures( features.features, vktg::Gpu().getFeatures(), 0);
+    };
+    vktg::Config()->setVulkan11DeviceFeatures = [chainOffset]( vk::PhysicalDeviceVulkan11Features &features){
+        auto supported = vktg::Gpu().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features>();
+        MaskFeatures( features, supported.get<vk::PhysicalDeviceVulkan11Features>(), chainOffset);
+    };
+    vktg::Config()->setVulkan12DeviceFeatures = [chainOffset]( vk::PhysicalDeviceVulkan12Features &features){
+        auto supported = vktg::Gpu().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        MaskFeatures( features, supported.get<vk::PhysicalDeviceVulkan12Features>(), chainOffset);
+    };
+    vktg::Config()->setVulkan13DeviceFeatures = [chainOffset]( vk::PhysicalDeviceVulkan13Features &features){
+        auto supported = vktg::Gpu().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan13Features>();
+        MaskFeatures( features, supported.get<vk::PhysicalDeviceVulkan13Features>(), chainOffset);
+    };
+}
+
+
+// usage: bench_all [--filter <name part>] [--out <results.json>] [--baseline <baselines.json> [--update-baseline] [--threshold <fraction>]]
+// with --baseline the median times are compared against the baselines of this machine and the exit code is 1 on regression,
+// or if the baseline file or the baselines of this machine are missing, seed them with --update-baseline
+int main( int argc, char **argv) {
+
+    std::string filter;
+    std::string outPath;
+    std::string baselinePath;
+    bool updateBaseline = false;
+    double threshold = 0.1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp( argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (std::strcmp( argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else if (std::strcmp( argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (std::strcmp( argv[i], "--update-baseline") == 0)
+        {
+            updateBaseline = true;
+        }
+        else if (std::strcmp( argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = std::atof( argv[++i]);
+        }
+        else
+        {
+            std::cerr << "usage: bench_all [--filter <name part>] [--out <results.json>] [--baseline <baselines.json> [--update-baseline] [--threshold <fraction>]]\n";
+            return 1;
+        }
+    }
+
+    ConfigureHeadless();
+    vktg::StartUp();
+
+    // checked before running, a missing baseline must not pass as a successful check
+    Baselines baselines;
+    auto machine = Baselines::MachineKey();
+    if (!baselinePath.empty())
+    {
+        bool loaded = false;
+        try
+        {
+            loaded = baselines.Load( baselinePath);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            vktg::ShutDown();
+            return 1;
+        }
+
+        if (!updateBaseline && !loaded)
+        {
+            std::cerr << "Baseline file " << baselinePath << " not found, create it with --update-baseline\n";
+            vktg::ShutDown();
+            return 1;
+        }
+        if (!updateBaseline && !baselines.HasMachine( machine))
+        {
+            std::cerr << "No baselines for " << machine << " in " << baselinePath << ", add them with --update-baseline\n";
+            vktg::ShutDown();
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner( filter);
+    RunStorageBenchmarks( runner);
+    RunDescriptorBenchmarks( runner);
+    RunSamplerBenchmarks( runner);
+    RunPipelineBenchmarks( runner);
+    RunSubmitContextBenchmarks( runner);
+    RunScenarioBenchmarks( runner);
+    vktg::WaitIdle();
+
+    runner.Print();
+    int exitCode = 0;
+    if (!outPath.empty())
+    {
+        std::ofstream file( outPath);
+        if (file.is_open())
+        {
+            file << runner.Json();
+        }
+        else
+        {
+            std::cerr << "Failed to open file " << outPath << " for writing!\n";
+            exitCode = 1;
+        }
+    }
+
+    if (!baselinePath.empty())
+    {
+        if (updateBaseline)
+        {
+            baselines.Update( machine, runner.Results());
+            if (!baselines.Save( baselinePath))
+            {
+                std::cerr << "Failed to open file " << baselinePath << " for writing!\n";
+                exitCode = 1;
+            }
+        }
+        else
+        {
+            std::cout << "\nbaselines of " << machine << ", threshold " << threshold * 100 << "%\n";
+            auto regressions = PrintComparisons( baselines.Compare( machine, runner.Results(), threshold));
+            if (regressions > 0)
+            {
+                std::cerr << regressions << " benchmark(s) regressed!\n";
+                exitCode = 1;
+            }
+        }
+    }
+
+    vktg::ShutDown();
+
+    return exitCode;
+}
@@ -0,0 +1,53 @@
+#include "benchmark.h"
+
+#include "descriptors.h"
+#include "pipelines.h"
+
+#include <vector>
+
+
+void RunPipelineBenchmarks( BenchmarkRunner &runner) {
+
+    const uint32_t iterations = 50;
+
+    std::vector<vktg::Pipeline> pipelines;
+
+    vk::ShaderModule compShader = vktg::LoadShader( VKTG_SHADER_DIR "test_comp.spv");
+    auto setBinding = vk::DescriptorSetLayoutBinding{}
+        .setBinding( 0 )
+        .setDescriptorType( vk::DescriptorType::eStorageImage )
+        .setDescriptorCount( 1 )
+        .setStageFlags( vk::ShaderStageFlagBits::eCompute );
+    vk::DescriptorSetLayout setLayout = vktg::CreateDescriptorSetLayout( std::span( &setBinding, 1));
+
+    runner.Run( "ComputePipelineBuilder::Build", iterations, [&]( int32_t){
+        vktg::ComputePipelineBuilder builder;
+        builder
+            .SetShader( compShader, nullptr, "main")
+            .AddDescriptorLayout( setLayout);
+        pipelines.push_back( builder.Build());
+    });
+
+    vk::ShaderModule vertShader = vktg::LoadShader( VKTG_SHADER_DIR "test_vert.spv");
+    vk::ShaderModule fragShader = vktg::LoadShader( VKTG_SHADER_DIR "test_frag.spv");
+    std::vector<vk::DynamicState> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+
+    runner.Run( "GraphicsPipelineBuilder::Build", iterations, [&]( int32_t){
+        vktg::GraphicsPipelineBuilder builder;
+        builder
+            .AddShader( vertShader, vk::ShaderStageFlagBits::eVertex, nullptr, "main")
+            .AddShader( fragShader, vk::ShaderStageFlagBits::eFragment, nullptr, "main")
+            .SetDynamicStates( dynamicStates);
+        pipelines.push_back( builder.Build());
+    });
+
+    for (auto &pipeline : pipelines)
+    {
+        vktg::DestroyPipeline( pipeline.pipeline);
+        vktg::DestroyPipelineLayout( pipeline.pipelineLayout);
+    }
+    vktg::DestroyDescriptorSetLayout( setLayout);
+    vktg::DestroyShaderModule( compShader);
+    vktg::DestroyShaderModule( vertShader);
+    vktg::DestroyShaderModule( fragShader);
+}
@@ -0,0 +1,27 @@
+#include "benchmark.h"
+
+#include "samplers.h"
+
+#include <vector>
+
+
+void RunSamplerBenchmarks( BenchmarkRunner &runner) {
+
+    // stays well below the maxSamplerAllocationCount limit of 4000
+    const uint32_t iterations = 1000;
+
+    std::vector<vk::Sampler> samplers;
+    runner.Run( "SamplerBuilder::Build", iterations, [&]( int32_t){
+        vktg::SamplerBuilder builder;
+        builder
+            .SetFilter( vk::Filter::eLinear)
+            .SetMipMapMode( vk::SamplerMipmapMode::eLinear)
+            .SetAddressMode( vk::SamplerAddressMode::eRepeat);
+        samplers.push_back( builder.Build());
+    });
+
+    for (auto sampler : samplers)
+    {
+        vktg::DestroySampler( sampler);
+    }
+}
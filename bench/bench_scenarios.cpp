@@ -0,0 +1,394 @@
+#include "benchmark.h"
+
+#include "commands.h"
+#include "descriptors.h"
+#include "pipelines.h"
+#include "rendering.h"
+#include "samplers.h"
+#include "storage.h"
+#include "synchronization.h"
+#include "transfer.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+
+// end-to-end scenarios, each iteration is one frame or one batch of uploads including the wait for the GPU,
+// frames are recorded into frameOverlap command buffers like in the examples, so CPU and GPU work overlap
+
+
+struct FrameResources {
+    vk::CommandPool commandPool;
+    vk::CommandBuffer cmd;
+    vk::Fence fence;
+};
+
+
+static std::vector<FrameResources> CreateFrames( uint32_t frameOverlap, uint32_t queueIndex) {
+
+    std::vector<FrameResources> frames( frameOverlap);
+    for (auto &frame : frames)
+    {
+        frame.commandPool = vktg::CreateCommandPool( queueIndex);
+        frame.cmd = vktg::AllocateCommandBuffer( frame.commandPool);
+        frame.fence = vktg::CreateFence();
+    }
+
+    return frames;
+}
+
+
+static void DestroyFrames( std::vector<FrameResources> &frames) {
+
+    for (auto &frame : frames)
+    {
+        vktg::DestroyCommandPool( frame.commandPool);
+        vktg::DestroyFence( frame.fence);
+    }
+    frames.clear();
+}
+
+
+static vk::CommandBuffer BeginFrame( FrameResources &frame) {
+
+    vktg::WaitForFence( frame.fence);
+    vktg::ResetFence( frame.fence);
+
+    frame.cmd.reset( vk::CommandBufferResetFlagBits::eReleaseResources);
+    auto cmdBeginInfo = vk::CommandBufferBeginInfo{}
+        .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+    frame.cmd.begin( cmdBeginInfo);
+
+    return frame.cmd;
+}
+
+
+static void SubmitFrame( FrameResources &frame, vk::Queue queue) {
+
+    frame.cmd.end();
+
+    vk::CommandBufferSubmitInfo cmdInfos[] = {
+        vk::CommandBufferSubmitInfo{}
+            .setCommandBuffer( frame.cmd )
+    };
+    vktg::SubmitCommands( queue, cmdInfos, {}, {}, frame.fence);
+}
+
+
+// offscreen version of the textured_mesh example with a generated grid mesh and texture
+static void TexturedMeshScenario( BenchmarkRunner &runner) {
+
+    const uint32_t width = 1280, height = 720;
+    const uint32_t gridSize = 256;
+    const uint32_t textureSize = 1024;
+    const uint8_t frameOverlap = 2;
+
+    // vertex layout and uniform buffers of mesh.vert
+    struct MeshVertex {
+        float position[3];
+        float color[4];
+        float texCoord[2];
+        float normal[3];
+        float tangent[3];
+    };
+    struct CameraData {
+        float view[16];
+        float proj[16];
+        float viewProj[16];
+        float position[4];
+    } camera = {
+        .view = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1},
+        .proj = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1},
+        .viewProj = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1},
+        .position = {0,0,0,1}
+    };
+    float model[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+
+    std::vector<MeshVertex> vertices;
+    vertices.reserve( (gridSize + 1) * (gridSize + 1));
+    for (uint32_t y = 0; y <= gridSize; y++)
+    {
+        for (uint32_t x = 0; x <= gridSize; x++)
+        {
+            float u = (float)x / gridSize, v = (float)y / gridSize;
+            vertices.push_back( MeshVertex{
+                { 1.8f * u - 0.9f, 1.8f * v - 0.9f, 0.5f},
+                { 1.f, 1.f, 1.f, 1.f},
+                { u, v},
+                { 0.f, 0.f, -1.f},
+                { 1.f, 0.f, 0.f}
+            });
+        }
+    }
+    std::vector<uint32_t> indices;
+    indices.reserve( 6 * gridSize * gridSize);
+    for (uint32_t y = 0; y < gridSize; y++)
+    {
+        for (uint32_t x = 0; x < gridSize; x++)
+        {
+            uint32_t i0 = y * (gridSize + 1) + x, i1 = i0 + 1, i2 = i0 + gridSize + 1, i3 = i2 + 1;
+            indices.insert( indices.end(), { i0, i2, i1, i1, i2, i3});
+        }
+    }
+
+    std::vector<uint32_t> texels( textureSize * textureSize);
+    for (uint32_t y = 0; y < textureSize; y++)
+    {
+        for (uint32_t x = 0; x < textureSize; x++)
+        {
+            texels[y * textureSize + x] = ((x / 32 + y / 32) % 2) ? 0xffffffff : 0xff404040;
+        }
+    }
+
+    // resources
+    vktg::Buffer vertexBuffer, indexBuffer, cameraBuffer, objectBuffer;
+    vktg::CreateBuffer( vertexBuffer, vertices.size() * sizeof(MeshVertex), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( indexBuffer, indices.size() * sizeof(uint32_t), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( cameraBuffer, sizeof(CameraData), vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( objectBuffer, sizeof(model), vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::UploadBufferData( vertices.data(), vertexBuffer.buffer, vertexBuffer.Size(), 0);
+    vktg::UploadBufferData( indices.data(), indexBuffer.buffer, indexBuffer.Size(), 0);
+    vktg::UploadBufferData( &camera, cameraBuffer.buffer, sizeof(CameraData), 0);
+    vktg::UploadBufferData( model, objectBuffer.buffer, sizeof(model), 0);
+
+    vktg::Image texture;
+    vktg::CreateImage( texture, textureSize, textureSize, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+    vktg::UploadImageData( texels.data(), texture);
+    auto sampler = vktg::SamplerBuilder()
+        .SetFilter( vk::Filter::eLinear )
+        .SetAddressMode( vk::SamplerAddressMode::eRepeat )
+        .Build();
+
+    vktg::Image renderImage, depthImage;
+    vktg::CreateImage( renderImage, width, height, vk::Format::eR16G16B16A16Sfloat, vk::ImageUsageFlagBits::eColorAttachment);
+    vktg::CreateImage( depthImage, width, height, vk::Format::eD32Sfloat, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::ImageAspectFlagBits::eDepth);
+
+    // descriptors
+    std::vector<vk::DescriptorPoolSize> poolSizes = {
+        vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, 4},
+        vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, 4}
+    };
+    vktg::DescriptorSetAllocator descriptorAllocator( poolSizes, 4);
+    vktg::DescriptorLayoutCache layoutCache;
+    vk::DescriptorSetLayout layouts[3];
+    auto cameraInfo = vktg::GetDescriptorBufferInfo( cameraBuffer.buffer);
+    auto objectInfo = vktg::GetDescriptorBufferInfo( objectBuffer.buffer);
+    auto textureInfo = vktg::GetDescriptorImageInfo( texture.imageView, sampler);
+    vk::DescriptorSet descriptors[] = {
+        vktg::DescriptorSetBuilder( &descriptorAllocator, &layoutCache)
+            .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex, &cameraInfo )
+            .Build( &layouts[0] ),
+        vktg::DescriptorSetBuilder( &descriptorAllocator, &layoutCache)
+            .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex, &objectInfo )
+            .Build( &layouts[1] ),
+        vktg::DescriptorSetBuilder( &descriptorAllocator, &layoutCache)
+            .BindImage( 0, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment, &textureInfo )
+            .Build( &layouts[2] )
+    };
+
+    // pipeline
+    auto vertexShader = vktg::LoadShader( VKTG_SHADER_DIR "mesh_vert.spv");
+    auto fragmentShader = vktg::LoadShader( VKTG_SHADER_DIR "texture_frag.spv");
+    auto vertexBinding = vk::VertexInputBindingDescription{ 0, sizeof(MeshVertex), vk::VertexInputRate::eVertex};
+    vk::VertexInputAttributeDescription vertexAttributes[] = {
+        { 0, 0, vk::Format::eR32G32B32Sfloat, offsetof( MeshVertex, position)},
+        { 1, 0, vk::Format::eR32G32B32A32Sfloat, offsetof( MeshVertex, color)},
+        { 2, 0, vk::Format::eR32G32Sfloat, offsetof( MeshVertex, texCoord)},
+        { 3, 0, vk::Format::eR32G32B32Sfloat, offsetof( MeshVertex, normal)},
+        { 4, 0, vk::Format::eR32G32B32Sfloat, offsetof( MeshVertex, tangent)}
+    };
+    std::vector<vk::DynamicState> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+    std::vector<vk::Format> colorFormats = { renderImage.Format()};
+    auto pipeline = vktg::GraphicsPipelineBuilder()
+        .AddShader( vertexShader, vk::ShaderStageFlagBits::eVertex )
+        .AddShader( fragmentShader, vk::ShaderStageFlagBits::eFragment )
+        .AddDescriptorLayouts( layouts )
+        .SetDynamicStates( dynamicStates )
+        .SetVertexInputBindng( vertexBinding )
+        .SetVertexAttributes( vertexAttributes )
+        .SetInputAssembly( vk::PrimitiveTopology::eTriangleList )
+        .SetPolygonMode( vk::PolygonMode::eFill )
+        .SetCulling( vk::CullModeFlagBits::eNone, vk::FrontFace::eCounterClockwise )
+        .EnableDepth()
+        .SetDepthFormat( depthImage.Format() )
+        .SetColorFormats( colorFormats )
+        .Build();
+    vktg::DestroyShaderModule( vertexShader);
+    vktg::DestroyShaderModule( fragmentShader);
+
+    auto clearColor = vktg::CreateClearColorValue( 0.2f, 0.2f, 0.2f, 1.0f);
+    auto clearDepth = vktg::CreateClearDepthStencilValue( 1.f, 0.f);
+    auto frames = CreateFrames( frameOverlap, vktg::GraphicsQueueIndex());
+
+    runner.Run( "scenario/textured_mesh_offscreen", 300, [&]( int32_t i){
+        auto &frame = frames[(i + warmupIterations) % frameOverlap];
+        auto cmd = BeginFrame( frame);
+
+            vktg::TransitionImageLayout(
+                cmd, renderImage.image,
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal,
+                vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eNone,
+                vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite
+            );
+            vktg::TransitionImageLayout(
+                cmd, depthImage.image,
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthAttachmentOptimal,
+                vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests, vk::AccessFlagBits2::eNone,
+                vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests, vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
+                vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1}
+            );
+
+            std::vector<vk::RenderingAttachmentInfo> colorAttachments = { vktg::CreateColorAttachment( renderImage.imageView, &clearColor)};
+            vk::RenderingAttachmentInfo depthAttachment = vktg::CreateDepthStencilAttachment( depthImage.imageView, &clearDepth);
+            cmd.beginRendering( vktg::CreateRenderingInfo( vk::Extent2D{ width, height}, colorAttachments, &depthAttachment));
+
+                vk::DeviceSize offset = 0;
+                cmd.bindVertexBuffers( 0, 1, &vertexBuffer.buffer, &offset);
+                cmd.bindIndexBuffer( indexBuffer.buffer, 0, vk::IndexType::eUint32);
+                cmd.bindPipeline( vk::PipelineBindPoint::eGraphics, pipeline.pipeline);
+                cmd.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, pipeline.pipelineLayout, 0, 3, descriptors, 0, nullptr);
+                vk::Viewport viewport = vktg::CreateViewport( 0.f, 0.f, width, height, 0.f, 1.f);
+                vk::Rect2D scissor = vktg::CreateScissor( 0, 0, width, height);
+                cmd.setViewport( 0, 1, &viewport);
+                cmd.setScissor( 0, 1, &scissor);
+                cmd.drawIndexed( (uint32_t)indices.size(), 1, 0, 0, 0);
+
+            cmd.endRendering();
+
+        SubmitFrame( frame, vktg::GraphicsQueue());
+    });
+
+    vktg::WaitIdle();
+    DestroyFrames( frames);
+    vktg::DestroyPipeline( pipeline.pipeline);
+    vktg::DestroyPipelineLayout( pipeline.pipelineLayout);
+    descriptorAllocator.DestroyPools();
+    layoutCache.DestroyLayouts();
+    vktg::DestroySampler( sampler);
+    vktg::DestroyImage( texture);
+    vktg::DestroyImage( renderImage);
+    vktg::DestroyImage( depthImage);
+    vktg::DestroyBuffer( vertexBuffer);
+    vktg::DestroyBuffer( indexBuffer);
+    vktg::DestroyBuffer( cameraBuffer);
+    vktg::DestroyBuffer( objectBuffer);
+}
+
+
+// dispatch loop of the compute_image example without the copy to the swapchain
+static void ComputeImageScenario( BenchmarkRunner &runner) {
+
+    const uint32_t width = 1920, height = 1080;
+    const uint8_t frameOverlap = 2;
+
+    vktg::Image image;
+    vktg::CreateImage( image, width, height, vk::Format::eR16G16B16A16Sfloat, vk::ImageUsageFlagBits::eStorage);
+
+    auto binding = vk::DescriptorSetLayoutBinding{}
+        .setBinding( 0 )
+        .setDescriptorType( vk::DescriptorType::eStorageImage )
+        .setDescriptorCount( 1 )
+        .setStageFlags( vk::ShaderStageFlagBits::eCompute );
+    vktg::DescriptorSetAllocator descriptorAllocator;
+    vktg::DescriptorLayoutCache layoutCache;
+    vk::DescriptorSetLayout layout;
+    auto imageInfo = vktg::GetDescriptorImageInfo( image.imageView, VK_NULL_HANDLE, vk::ImageLayout::eGeneral);
+    auto descriptorSet = vktg::DescriptorSetBuilder( &descriptorAllocator, &layoutCache)
+        .BindImage( 0, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute, &imageInfo )
+        .Build( &layout );
+
+    struct CornerColors {
+        float tl[4];
+        float tr[4];
+        float bl[4];
+        float br[4];
+    } cornerColors = {
+        .tl = {1.f, 0.f, 0.f, 1.f},
+        .tr = {0.f, 1.f, 0.f, 1.f},
+        .bl = {0.f, 0.f, 1.f, 1.f},
+        .br = {0.5f, 0.5f, 0.5f, 1.f}
+    };
+    auto pushConstant = vk::PushConstantRange{}
+        .setStageFlags( vk::ShaderStageFlagBits::eCompute )
+        .setOffset( 0 )
+        .setSize( sizeof(CornerColors) );
+    auto computeShader = vktg::LoadShader( VKTG_SHADER_DIR "gradient_comp.spv");
+    auto pipeline = vktg::ComputePipelineBuilder()
+        .SetShader( computeShader )
+        .AddDescriptorLayout( layout )
+        .AddPushConstant( pushConstant )
+        .Build();
+    vktg::DestroyShaderModule( computeShader);
+
+    auto frames = CreateFrames( frameOverlap, vktg::ComputeQueueIndex());
+
+    runner.Run( "scenario/compute_image", 300, [&]( int32_t i){
+        auto &frame = frames[(i + warmupIterations) % frameOverlap];
+        auto cmd = BeginFrame( frame);
+
+            vktg::TransitionImageLayout(
+                cmd, image.image,
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral,
+                vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eNone,
+                vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite
+            );
+            cornerColors.br[0] = cornerColors.br[1] = cornerColors.br[2] = std::cos( i / 491.f) * std::cos( i / 491.f);
+            cmd.bindPipeline( vk::PipelineBindPoint::eCompute, pipeline.pipeline);
+            cmd.bindDescriptorSets( vk::PipelineBindPoint::eCompute, pipeline.pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            cmd.pushConstants( pipeline.pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(CornerColors), &cornerColors);
+            cmd.dispatch( (width + 15) / 16, (height + 15) / 16, 1);
+
+        SubmitFrame( frame, vktg::ComputeQueue());
+    });
+
+    vktg::WaitIdle();
+    DestroyFrames( frames);
+    vktg::DestroyPipeline( pipeline.pipeline);
+    vktg::DestroyPipelineLayout( pipeline.pipelineLayout);
+    descriptorAllocator.DestroyPools();
+    layoutCache.DestroyLayouts();
+    vktg::DestroyImage( image);
+}
+
+
+// level loading style uploads, many mesh sized buffers and a large texture with synchronous uploads
+static void BulkUploadScenario( BenchmarkRunner &runner) {
+
+    const uint32_t bufferCount = 32;
+    const size_t bufferSize = 512 << 10;
+    const uint32_t textureSize = 2048;
+
+    std::vector<vktg::Buffer> buffers( bufferCount);
+    for (auto &buffer : buffers)
+    {
+        vktg::CreateBuffer( buffer, bufferSize, vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    }
+    vktg::Image texture;
+    vktg::CreateImage( texture, textureSize, textureSize, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+
+    std::vector<uint8_t> bufferData( bufferSize, 1);
+    std::vector<uint8_t> textureData( textureSize * textureSize * 4, 2);
+
+    runner.Run( "scenario/bulk_upload", 10, [&]( int32_t){
+        for (auto &buffer : buffers)
+        {
+            vktg::UploadBufferData( bufferData.data(), buffer.buffer, bufferSize, 0);
+        }
+        vktg::UploadImageData( textureData.data(), texture);
+    }, bufferCount * bufferSize + textureData.size());
+
+    for (auto &buffer : buffers)
+    {
+        vktg::DestroyBuffer( buffer);
+    }
+    vktg::DestroyImage( texture);
+}
+
+
+void RunScenarioBenchmarks( BenchmarkRunner &runner) {
+
+    TexturedMeshScenario( runner);
+    ComputeImageScenario( runner);
+    BulkUploadScenario( runner);
+}
@@ -0,0 +1,62 @@
+#include "benchmark.h"
+
+#include "storage.h"
+#include "transfer.h"
+
+#include <vector>
+
+
+void RunStorageBenchmarks( BenchmarkRunner &runner) {
+
+    const uint32_t iterations = 1000;
+    const size_t bufferSize = 64 << 10;
+
+    // created buffers are destroyed afterwards, so only creation is timed
+    std::vector<vktg::Buffer> buffers( iterations + warmupIterations);
+    bool created = runner.Run( "CreateBuffer/64KB", iterations, [&]( int32_t i){
+        vktg::CreateBuffer( buffers[i + warmupIterations], bufferSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    });
+    if (created)
+    {
+        runner.Run( "DestroyBuffer/64KB", iterations, [&]( int32_t i){
+            vktg::DestroyBuffer( buffers[i + warmupIterations]);
+        });
+    }
+
+    std::vector<uint8_t> data( bufferSize, 1);
+    std::vector<vktg::Buffer> stagingBuffers;
+    runner.Run( "CreateStagingBuffer/64KB", iterations, [&]( int32_t){
+        vktg::Buffer stagingBuffer;
+        vktg::CreateStagingBuffer( stagingBuffer, bufferSize, data.data());
+        stagingBuffers.push_back( stagingBuffer);
+    }, bufferSize);
+    for (auto &stagingBuffer : stagingBuffers)
+    {
+        vktg::DestroyBuffer( stagingBuffer);
+    }
+
+    // upload throughput vs size, each upload waits for its copy to complete
+    struct UploadSize {
+        const char *name;
+        size_t size;
+        uint32_t iterations;
+    };
+    UploadSize uploadSizes[] = {
+        { "UploadBufferData/4KB", 4 << 10, 200},
+        { "UploadBufferData/64KB", 64 << 10, 200},
+        { "UploadBufferData/1MB", 1 << 20, 50},
+        { "UploadBufferData/16MB", 16 << 20, 10}
+    };
+    for (auto &upload : uploadSizes)
+    {
+        vktg::Buffer dstBuffer;
+        vktg::CreateBuffer( dstBuffer, upload.size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst);
+        data.resize( upload.size, 1);
+
+        runner.Run( upload.name, upload.iterations, [&]( int32_t){
+            vktg::UploadBufferData( data.data(), dstBuffer.buffer, upload.size, 0);
+        }, upload.size);
+
+        vktg::DestroyBuffer( dstBuffer);
+    }
+}
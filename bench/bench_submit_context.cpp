@@ -0,0 +1,28 @@
+#include "benchmark.h"
+
+#include "submit_context.h"
+#include "synchronization.h"
+
+#include <utility>
+
+
+void RunSubmitContextBenchmarks( BenchmarkRunner &runner) {
+
+    const uint32_t iterations = 1000;
+
+    // empty command buffers, so the time is the submit and fence wait round trip
+    for (auto [name, queueType] : {
+        std::pair{ "SubmitContext/graphics", vktg::QueueType::eGraphics},
+        std::pair{ "SubmitContext/transfer", vktg::QueueType::eTransfer}
+    })
+    {
+        auto submitContext = vktg::CreateSubmitContext( queueType);
+        runner.Run( name, iterations, [&]( int32_t){
+            submitContext.Begin();
+            submitContext.End();
+            submitContext.Submit();
+            vktg::WaitForFence( submitContext.fence);
+        });
+        vktg::DestroySubmitContext( submitContext);
+    }
+}
@@ -0,0 +1,122 @@
+#include "benchmark.h"
+
+#include "vk_core.h"
+#include "util/json.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <sstream>
+
+
+BenchmarkRunner::BenchmarkRunner( std::string_view filter) : mFilter{ filter} {
+
+}
+
+
+bool BenchmarkRunner::Run( std::string_view name, uint32_t iterations, const std::function<void( int32_t iteration)> &func, uint64_t bytes) {
+
+    if (!mFilter.empty() && name.find( mFilter) == std::string_view::npos)
+    {
+        return false;
+    }
+
+    for (int32_t i = -warmupIterations; i < 0; i++)
+    {
+        func( i);
+    }
+
+    mTimes.resize( iterations);
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func( (int32_t)i);
+        auto end = std::chrono::steady_clock::now();
+        mTimes[i] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>( end - start).count();
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.bytes = bytes;
+    result.meanNs = std::accumulate( mTimes.begin(), mTimes.end(), 0.0) / iterations;
+    double variance = 0.0;
+    for (double time : mTimes)
+    {
+        variance += (time - result.meanNs) * (time - result.meanNs);
+    }
+    result.stddevNs = std::sqrt( variance / iterations);
+
+    std::sort( mTimes.begin(), mTimes.end());
+    result.minNs = mTimes.front();
+    result.maxNs = mTimes.back();
+    result.medianNs = iterations % 2 == 1 ? mTimes[iterations / 2] : 0.5 * (mTimes[iterations / 2 - 1] + mTimes[iterations / 2]);
+    mResults.push_back( result);
+
+    return true;
+}
+
+
+std::string BenchmarkRunner::Json() const {
+
+    auto properties = vktg::Gpu().getProperties();
+
+    std::ostringstream out;
+    out << "{\n  \"context\": {\"date\": ";
+    vktg::AppendJsonString( out, vktg::Timer::GetDateTimeStr());
+    out << ", \"device\": ";
+    vktg::AppendJsonString( out, properties.deviceName.data());
+    out << ", \"deviceType\": ";
+    vktg::AppendJsonString( out, vk::to_string( properties.deviceType));
+    out << ", \"driverVersion\": " << properties.driverVersion
+        << ", \"apiVersion\": \"" << VK_VERSION_MAJOR( properties.apiVersion) << '.' << VK_VERSION_MINOR( properties.apiVersion) << '.' << VK_VERSION_PATCH( properties.apiVersion) << "\""
+#ifdef NDEBUG
+        << ", \"buildType\": \"release\"},\n";
+#else
+        << ", \"buildType\": \"debug\"},\n";
+#endif
+
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < mResults.size(); i++)
+    {
+        auto &result = mResults[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        vktg::AppendJsonString( out, result.name);
+        out << ", \"iterations\": " << result.iterations
+            << ", \"bytes\": " << result.bytes
+            << ", \"mean_ns\": " << result.meanNs
+            << ", \"median_ns\": " << result.medianNs
+            << ", \"min_ns\": " << result.minNs
+            << ", \"max_ns\": " << result.maxNs
+            << ", \"stddev_ns\": " << result.stddevNs;
+        if (result.bytes > 0)
+        {
+            out << ", \"throughput_mb_s\": " << result.bytes / result.medianNs * 1e3;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+
+    return out.str();
+}
+
+
+void BenchmarkRunner::Print() const {
+
+    std::printf( "%-48s %10s %12s %12s %12s %12s\n", "benchmark", "iterations", "median us", "mean us", "min us", "MB/s");
+    for (auto &result : mResults)
+    {
+        std::printf(
+            "%-48s %10u %12.2f %12.2f %12.2f",
+            result.name.c_str(), result.iterations, result.medianNs * 1e-3, result.meanNs * 1e-3, result.minNs * 1e-3
+        );
+        if (result.bytes > 0)
+        {
+            std::printf( " %12.1f", result.bytes / result.medianNs * 1e3);
+        }
+        std::printf( "\n");
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// @brief Timing statistics of a benchmark, times are per iteration in nanoseconds.
+struct BenchmarkResult {
+
+    std::string name;
+    uint32_t iterations;
+    /// @brief Bytes processed per iteration, 0 if not a throughput benchmark.
+    uint64_t bytes;
+    double meanNs;
+    double medianNs;
+    double minNs;
+    double maxNs;
+    double stddevNs;
+};
+
+
+/// @brief Runs benchmarks matching a name filter and collects their results.
+class BenchmarkRunner {
+
+    public:
+
+        /// @brief Initialize runner.
+        /// @param filter Only benchmarks whose name contains this string are run, empty to run all.
+        BenchmarkRunner( std::string_view filter = "");
+
+        /// @brief Times each iteration of a benchmark separately after a few untimed warm up iterations.
+        ///        Work that must not be timed, like destroying created objects, belongs after the call.
+        /// @param name Benchmark name, e.g. "CreateBuffer/64KB".
+        /// @param iterations Number of timed iterations.
+        /// @param func Benchmark body, called with the iteration index, negative for warm up iterations.
+        /// @param bytes Bytes processed per iteration, to report throughput.
+        /// @return True if the benchmark was run.
+        bool Run( std::string_view name, uint32_t iterations, const std::function<void( int32_t iteration)> &func, uint64_t bytes = 0);
+
+        /// @brief Results of all benchmarks run so far.
+        /// @return List of benchmark results.
+        const std::vector<BenchmarkResult>& Results() const { return mResults; }
+        /// @brief Formats results as JSON, including device and driver information.
+        /// @return JSON string.
+        std::string Json() const;
+        /// @brief Prints results as a table to stdout.
+        void Print() const;
+
+    private:
+
+        std::string mFilter;
+        std::vector<BenchmarkResult> mResults;
+        std::vector<double> mTimes;
+};
+
+
+/// @brief Number of warm up iterations of each benchmark.
+constexpr int32_t warmupIterations = 3;
+
+
+void RunStorageBenchmarks( BenchmarkRunner &runner);
+void RunDescriptorBenchmarks( BenchmarkRunner &runner);
+void RunSamplerBenchmarks( BenchmarkRunner &runner);
+void RunPipelineBenchmarks( BenchmarkRunner &runner);
+void RunSubmitContextBenchmarks( BenchmarkRunner &runner);
+void RunScenarioBenchmarks( BenchmarkRunner &runner);
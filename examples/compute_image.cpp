@@ -2,6 +2,7 @@
 #include "vulkantogo.h"
 
 #include <cmath>
+#include <memory>
 
 
 int main() {
@@ -11,6 +12,8 @@ int main() {
 
     // deletion stack
     auto deletionStack = vktg::DeletionStack{};
+    // swapchains and render graphs replaced on resize, destroyed once the frames using them are done
+    vktg::DeferredDeletionQueue retired;
 
 
      // swapchain
@@ -18,13 +21,9 @@ int main() {
     vktg::CreateSwapchain( swapchain);
 
 
-    // render image
-    vktg::Image renderImage;
-    vktg::CreateImage(
-        renderImage,
-        swapchain.Width(), swapchain.Height(), vk::Format::eR16G16B16A16Sfloat, 
-        vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst
-    );
+    // frames in flight
+    uint64_t frameCount = 0;
+    const uint8_t frameOverlap = 2;
 
 
     // descriptors
@@ -32,18 +31,27 @@ int main() {
     std::vector<vk::DescriptorPoolSize> poolSizes = {
         vk::DescriptorPoolSize{ vk::DescriptorType::eStorageImage, maxSetsPerPool}
     };
-    vktg::DescriptorSetAllocator descriptorsetAllocator( poolSizes, maxSetsPerPool);
     vktg::DescriptorLayoutCache descriptorSetLayoutCache;
 
     deletionStack.Push( [&](){
         descriptorSetLayoutCache.DestroyLayouts();
-        descriptorsetAllocator.DestroyPools();
     });
 
 
+    // render graph and the descriptors of its transient images, a resize builds a new graph while frames in flight still use the old one
+    struct RenderTargets {
+        vktg::RenderGraph renderGraph;
+        vktg::DescriptorSetAllocator descriptorsetAllocator;
+        vk::DescriptorSet computeDescriptors;
+    };
+    std::shared_ptr<RenderTargets> targets;
+    uint32_t renderImage;
+    uint32_t swapchainImage;
+
+
     // compute pipeline
     // load shader
-    auto computeShader = vktg::LoadShader( "../res/shaders/gradient_comp.spv");
+    auto computeShader = vktg::LoadShader( VKTG_SHADER_DIR "gradient_comp.spv");
     // push constants
     struct ShaderPushConstants {
         float tl[4];
@@ -62,10 +70,13 @@ int main() {
         .setSize( sizeof(ShaderPushConstants) );
     // descriptor set
     vk::DescriptorSetLayout computeLayout;
-    auto computeImageInfo = vktg::GetDescriptorImageInfo( renderImage.imageView, VK_NULL_HANDLE, vk::ImageLayout::eGeneral);
-    auto computeDescriptors = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
-        .BindImage( 0, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute, &computeImageInfo )
-        .Build( &computeLayout );
+    vk::DescriptorImageInfo computeImageInfo;
+    auto computeBinding = vk::DescriptorSetLayoutBinding{}
+        .setBinding( 0 )
+        .setDescriptorType( vk::DescriptorType::eStorageImage )
+        .setDescriptorCount( 1 )
+        .setStageFlags( vk::ShaderStageFlagBits::eCompute );
+    computeLayout = descriptorSetLayoutCache.CreateLayout( std::span{&computeBinding, 1});
     // build pipeline
     auto computePipeline = vktg::ComputePipelineBuilder()
         .SetShader( computeShader )
@@ -82,15 +93,74 @@ int main() {
     });
 
 
+    // build render graph, the gradient is drawn on the compute queue and copied to the swapchain on the graphics queue
+    auto buildRenderGraph = [&](){
+
+        if (targets)
+        {
+            retired.Push( frameCount, [oldTargets = targets](){
+                oldTargets->renderGraph.Destroy();
+                oldTargets->descriptorsetAllocator.DestroyPools();
+            });
+        }
+        targets = std::shared_ptr<RenderTargets>( new RenderTargets{ vktg::RenderGraph( frameOverlap), vktg::DescriptorSetAllocator( poolSizes, maxSetsPerPool)});
+        auto &renderGraph = targets->renderGraph;
+        auto pTargets = targets.get();
+
+        renderImage = renderGraph.CreateImage(
+            "render image",
+            swapchain.Width(), swapchain.Height(), vk::Format::eR16G16B16A16Sfloat, 
+            vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc
+        );
+        swapchainImage = renderGraph.ImportImage(
+            swapchain.images[0], swapchain.imageViews[0], swapchain.imageFormat, swapchain.extent,
+            vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eNone, vk::ImageLayout::eUndefined},
+            vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone, swapchain.presentLayout}
+        );
+
+        renderGraph.AddPass( "background", vktg::QueueType::eCompute)
+            .Write( renderImage, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite, vk::ImageLayout::eGeneral})
+            .SetExecute( [&, pTargets, renderImage = renderImage]( vk::CommandBuffer cmd){
+                auto &image = pTargets->renderGraph.GetImage( renderImage);
+                cmd.bindPipeline( vk::PipelineBindPoint::eCompute, computePipeline.pipeline);
+                cmd.bindDescriptorSets( vk::PipelineBindPoint::eCompute, computePipeline.pipelineLayout, 0, 1, &pTargets->computeDescriptors, 0, nullptr);
+                cmd.pushConstants( computePipeline.pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ShaderPushConstants), &cornerColors);
+                cmd.dispatch( std::ceil(image.Width() / 16.f), std::ceil(image.Height() / 16.f), 1);
+            });
+
+        renderGraph.AddPass( "copy to swapchain")
+            .Read( renderImage, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal})
+            .Write( swapchainImage, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal})
+            .SetExecute( [&, pTargets, renderImage = renderImage, swapchainImage = swapchainImage]( vk::CommandBuffer cmd){
+                auto &image = pTargets->renderGraph.GetImage( renderImage);
+                vktg::CopyImage( 
+                    cmd, image.image, pTargets->renderGraph.GetImage( swapchainImage).image,
+                    vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{image.Width(), image.Height()}},
+                    vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{swapchain.Width(), swapchain.Height()}}
+                );
+            });
+
+        renderGraph.Compile();
+
+        // update descriptors
+        computeImageInfo = vktg::GetDescriptorImageInfo( renderGraph.GetImage( renderImage).imageView, VK_NULL_HANDLE, vk::ImageLayout::eGeneral);
+        targets->computeDescriptors = vktg::DescriptorSetBuilder( &targets->descriptorsetAllocator, &descriptorSetLayoutCache)
+            .BindImage( 0, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute, &computeImageInfo)
+            .Build();
+    };
+    buildRenderGraph();
+
+    deletionStack.Push( [&](){
+        targets->renderGraph.Destroy();
+        targets->descriptorsetAllocator.DestroyPools();
+    });
+
+
     // frame resources
-    uint64_t frameCount = 0;
-    const uint8_t frameOverlap = 2;
     struct FrameResources {
         vk::Fence renderFence;
         vk::Semaphore renderSemaphore;
         vk::Semaphore presentSemaphore;
-        vk::CommandPool commandPool;
-        vk::CommandBuffer commandbuffer;
     } frameResources[frameOverlap];
 
     for (auto &frame : frameResources)
@@ -104,13 +174,6 @@ int main() {
             vktg::DestroySemaphore( frame.renderSemaphore);
             vktg::DestroySemaphore( frame.presentSemaphore);
         });
-        
-        // command pools and command buffers
-        frame.commandPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
-        deletionStack.Push( [=](){
-            vktg::DestroyCommandPool( frame.commandPool);
-        });
-        frame.commandbuffer = vktg::AllocateCommandBuffer( frame.commandPool);
     }
 
 
@@ -119,20 +182,11 @@ int main() {
     {
         glfwPollEvents();
 
-        // recreate swapchain and render image if outdated
+        // recreate swapchain and render graph if outdated
         if (!swapchain.isValid)
         {
-        	vktg::WaitIdle();
-
-            vktg::CreateSwapchain( swapchain);
-            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height());
-
-            // update descriptors
-            descriptorsetAllocator.ResetPools();
-            computeImageInfo = vktg::GetDescriptorImageInfo( renderImage.imageView, VK_NULL_HANDLE, vk::ImageLayout::eGeneral);
-            computeDescriptors = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
-                .BindImage( 0, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute, &computeImageInfo)
-                .Build();
+            vktg::CreateSwapchain( swapchain, &retired, frameCount);
+            buildRenderGraph();
         }
 
         // get current frame
@@ -140,89 +194,45 @@ int main() {
             
         // wait for render fence to record render commands
         vktg::WaitForFence( frame.renderFence);
-        vktg::ResetFence( frame.renderFence);
+
+        // destroy what was retired before the frames in flight started
+        if (frameCount >= frameOverlap)
+        {
+            retired.Flush( frameCount - frameOverlap);
+        }
             
-        // get next swapchain image
+        // get next swapchain image, the fence is only reset once this frame is sure to signal it
         uint32_t imageIndex;
         if (!vktg::NextSwapchainImage( swapchain, frame.renderSemaphore, &imageIndex))
         {
             continue;
         }
+        vktg::ResetFence( frame.renderFence);
+
+        // update background colors
+        float tlr = std::cos( frameCount / 1013.f), tlg = std::sin( frameCount / 1013.f);
+        float trg = std::cos( frameCount / 907.f), trb = std::sin( frameCount / 907.f);
+        float blb = std::cos( frameCount / 1129.f), blr = std::sin( frameCount / 1129.f);
+        float brw = std::cos( frameCount / 491.f);
+        cornerColors.tl[0] = tlr*tlr; cornerColors.tl[1] = tlg*tlg;
+        cornerColors.tr[1] = trg*trg; cornerColors.tl[2] = trb*trb;
+        cornerColors.bl[2] = blb*blb; cornerColors.bl[0] = blr*blr;
+        cornerColors.br[0] = cornerColors.br[1] = cornerColors.br[2] = brw*brw;;
+
+        // record and submit render graph, barriers are placed by the graph
+        auto &renderGraph = targets->renderGraph;
+        renderGraph.UpdateImportedImage( swapchainImage, swapchain.images[imageIndex], swapchain.imageViews[imageIndex]);
 
-        // record render commands
-        auto cmd = frame.commandbuffer;
-        cmd.reset( vk::CommandBufferResetFlagBits::eReleaseResources);
-        auto commandBeginInfo = vk::CommandBufferBeginInfo{}
-            .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-        VK_CHECK( cmd.begin( &commandBeginInfo) );
-
-            // update background colors
-            float tlr = std::cos( frameCount / 1013.f), tlg = std::sin( frameCount / 1013.f);
-            float trg = std::cos( frameCount / 907.f), trb = std::sin( frameCount / 907.f);
-            float blb = std::cos( frameCount / 1129.f), blr = std::sin( frameCount / 1129.f);
-            float brw = std::cos( frameCount / 491.f);
-            cornerColors.tl[0] = tlr*tlr; cornerColors.tl[1] = tlg*tlg;
-            cornerColors.tr[1] = trg*trg; cornerColors.tl[2] = trb*trb;
-            cornerColors.bl[2] = blb*blb; cornerColors.bl[0] = blr*blr;
-            cornerColors.br[0] = cornerColors.br[1] = cornerColors.br[2] = brw*brw;;
-
-            //background compute draw
-            vktg::TransitionImageLayout( 
-                cmd, renderImage.image, 
-                vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral,
-                vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
-                vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite
-            );
-
-            cmd.bindPipeline( vk::PipelineBindPoint::eCompute, computePipeline.pipeline);
-            cmd.bindDescriptorSets( vk::PipelineBindPoint::eCompute, computePipeline.pipelineLayout, 0, 1, &computeDescriptors, 0, nullptr);
-            cmd.pushConstants( computePipeline.pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ShaderPushConstants), &cornerColors);
-            cmd.dispatch( std::ceil(renderImage.Width() / 16.f), std::ceil(renderImage.Height() / 16.f), 1);
-
-            // copy render image to swapchain
-            vktg::TransitionImageLayout( 
-                cmd, renderImage.image, 
-                vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferSrcOptimal,
-                vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderWrite,
-                vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead
-            );
-            vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], 
-                vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-                vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
-                vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
-            );
-            vktg::CopyImage( 
-                cmd, renderImage.image, swapchain.images[imageIndex],
-                vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{renderImage.Width(), renderImage.Height()}},
-                vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{swapchain.Width(), swapchain.Height()}}
-            );
-
-            // transition swapchain image to present optimal layout
-            vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], 
-                vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR,
-                vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
-                vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
-            );
-
-        cmd.end();
-
-        // submit
-        vk::CommandBufferSubmitInfo cmdInfos[] = {
-            vk::CommandBufferSubmitInfo{}
-                .setCommandBuffer( cmd )
-        };
         vk::SemaphoreSubmitInfo waitInfos[] = {
             vk::SemaphoreSubmitInfo{}
                 .setSemaphore( frame.renderSemaphore )
-                .setStageMask( vk::PipelineStageFlagBits2::eColorAttachmentOutput )
+                .setStageMask( vk::PipelineStageFlagBits2::eTransfer )
         };
         vk::SemaphoreSubmitInfo signalInfos[] = {
             vk::SemaphoreSubmitInfo{}
                 .setSemaphore( frame.presentSemaphore )
         };
-        vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, waitInfos, signalInfos, frame.renderFence);
+        renderGraph.Execute( waitInfos, signalInfos, frame.renderFence);
 
         // present
         vktg::PresentImage( swapchain, &frame.presentSemaphore, &imageIndex);
@@ -233,9 +243,9 @@ int main() {
 
     // cleanup
 	vktg::WaitIdle();
+    retired.FlushAll();
 
     deletionStack.Flush();
-    vktg::DestroyImage( renderImage);
     vktg::DestroySwapchain( swapchain);
 
     vktg::ShutDown();
@@ -0,0 +1,465 @@
+#include "vulkantogo.h"
+#include "shared/utility.h"
+#include "shared/mesh_cache.h"
+
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <iostream>
+
+
+// draws a grid of mesh instances with vktg::IndirectDrawer, instances outside the view frustum are culled by cull.comp
+// before the single indirect draw, prints the average GPU time of cull pass and draw on exit
+int main() {
+
+    vktg::StartUp();
+
+
+    // deletion stack
+    vktg::DeletionStack deletionStack = vktg::DeletionStack{};
+    // swapchains and render targets replaced on resize, destroyed once the frames using them are done
+    vktg::DeferredDeletionQueue retired;
+
+
+    // swapchain
+    auto swapchain = vktg::PrepareSwapchain();
+    vktg::CreateSwapchain( swapchain);
+
+
+    // render image
+    vktg::Image renderImage;
+    vktg::CreateImage(
+        renderImage,
+        swapchain.Width(), swapchain.Height(), vk::Format::eR16G16B16A16Sfloat,
+        vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst
+    );
+    // depth image
+    vktg::Image depthImage;
+    vktg::CreateImage(
+        depthImage,
+        swapchain.Width(), swapchain.Height(), vk::Format::eD24UnormS8Uint,
+        vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::ImageAspectFlagBits::eDepth
+    );
+
+    // clearn values
+    auto clearColor = vktg::CreateClearColorValue( 0.2f, 0.2f, 0.2f, 1.0f);
+    auto clearDepth = vktg::CreateClearDepthStencilValue( 1.f, 0.f);
+
+
+    // frames in flight
+    uint64_t frameCount = 0;
+    const uint8_t frameOverlap = 2;
+
+
+    // descriptors
+    uint32_t maxSetsPerPool = 10;
+    std::vector<vk::DescriptorPoolSize> poolSizes = {
+        vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, maxSetsPerPool},
+        vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, maxSetsPerPool},
+        vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, maxSetsPerPool}
+    };
+    vktg::DescriptorSetAllocator descriptorsetAllocator( poolSizes, maxSetsPerPool);
+    vktg::DescriptorLayoutCache descriptorSetLayoutCache;
+
+    deletionStack.Push( [&](){
+        descriptorSetLayoutCache.DestroyLayouts();
+        descriptorsetAllocator.DestroyPools();
+    });
+
+
+    // uniform buffers
+    // camera
+    struct CameraData {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::mat4 viewProj;
+        glm::vec3 pos;
+    } camera;
+    vktg::Buffer cameraBuffer;
+    vktg::CreateBuffer( cameraBuffer, sizeof( CameraData), vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::Buffer cameraStaging;
+    vktg::CreateStagingBuffer( cameraStaging, sizeof(CameraData));
+
+    deletionStack.Push( [&](){
+        vktg::DestroyBuffer( cameraBuffer);
+        vktg::DestroyBuffer( cameraStaging);
+    });
+
+    // model
+    MappedMesh mesh;
+    LoadCookedMesh( "../res/models/viking_room.obj", mesh);
+    auto vertexData = std::as_bytes( mesh.Vertices());
+    auto indexData = mesh.IndexData();
+    vktg::Buffer vertexBuffer, indexBuffer;
+    vktg::CreateBuffer( vertexBuffer, vertexData.size_bytes(), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( indexBuffer, indexData.size_bytes(), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+
+    deletionStack.Push( [&](){
+        vktg::DestroyBuffer( vertexBuffer);
+        vktg::DestroyBuffer( indexBuffer);
+    });
+
+    // instances, a grid around the origin of which only a part is inside the view frustum
+    const int gridSize = 32;
+    const float gridSpacing = 3.f;
+    vktg::IndirectDrawer indirectDrawer( gridSize * gridSize, 1, frameOverlap);
+    deletionStack.Push( [&](){
+        indirectDrawer.Destroy();
+    });
+
+    uint32_t meshHandle = indirectDrawer.AddMesh( mesh.IndexCount(), 0, 0);
+    glm::vec3 boundsCenter = 0.5f * (mesh.BoundsMin() + mesh.BoundsMax());
+    float boundsRadius = 0.5f * glm::length( mesh.BoundsMax() - mesh.BoundsMin());
+
+    std::vector<vktg::DrawInstance> instances;
+    for (int y = 0; y < gridSize; y++)
+    {
+        for (int x = 0; x < gridSize; x++)
+        {
+            glm::vec3 position = gridSpacing * glm::vec3( x - gridSize / 2, y - gridSize / 2, 0.f);
+            glm::mat4 model = glm::translate( glm::mat4(1.f), position);
+
+            vktg::DrawInstance instance{};
+            memcpy( instance.model, &model[0][0], sizeof(instance.model));
+            memcpy( instance.boundsCenter, &boundsCenter[0], sizeof(instance.boundsCenter));
+            instance.boundsRadius = boundsRadius;
+            instance.mesh = meshHandle;
+            instances.push_back( instance);
+        }
+    }
+    std::cout << "instances = " << instances.size() << '\n';
+
+    // texture
+    uint32_t textureWidth, textureHeight;
+    auto textureData = LoadImage( "../res/images/viking_room.png", textureWidth, textureHeight);
+    vktg::Image texture;
+    vktg::CreateImage(
+        texture, textureWidth, textureHeight, vk::Format::eR8G8B8A8Unorm,
+        vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst
+    );
+    vktg::UploadImageData( textureData.data(), texture);
+    textureData.clear();
+
+    deletionStack.Push( [&](){
+        vktg::DestroyImage( texture);
+    });
+
+    // sampler
+    auto sampler = vktg::SamplerBuilder()
+        .SetFilter( vk::Filter::eLinear )
+        .SetAddressMode( vk::SamplerAddressMode::eClampToBorder )
+        .SetBorderColor( vk::BorderColor::eIntOpaqueBlack )
+        .Build();
+
+    deletionStack.Push( [=](){
+        vktg::DestroySampler( sampler);
+    });
+
+
+    // graphics pipeline
+    // shaders
+    auto vertexShader = vktg::LoadShader( VKTG_SHADER_DIR "mesh_indirect_vert.spv");
+    auto fragmentShader = vktg::LoadShader( VKTG_SHADER_DIR "texture_frag.spv");
+    // descriptor sets
+    vk::DescriptorSetLayout cameraDescriptorLayout;
+    auto cameraBufferInfo = vktg::GetDescriptorBufferInfo( cameraBuffer.buffer);
+    auto cameraDescriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
+        .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex, &cameraBufferInfo )
+        .Build( &cameraDescriptorLayout );
+    // one instance buffer per frame in flight, the drawer and the frame index both advance once per frame,
+    // so descriptor i holds the instance buffer the drawer switches to in frame i
+    vk::DescriptorSetLayout instanceDescriptorLayout;
+    std::vector<vk::DescriptorSet> instanceDescriptors( frameOverlap);
+    for (auto &descriptor : instanceDescriptors)
+    {
+        indirectDrawer.NextFrame();
+        auto instanceBufferInfo = vktg::GetDescriptorBufferInfo( indirectDrawer.InstanceBuffer().buffer);
+        descriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
+            .BindBuffer( 0, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex, &instanceBufferInfo )
+            .Build( &instanceDescriptorLayout );
+    }
+    vk::DescriptorSetLayout textureDescriptorLayout;
+    auto textureInfo = vktg::GetDescriptorImageInfo( texture.imageView, sampler);
+    auto textureDescriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
+        .BindImage( 0, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment, &textureInfo )
+        .Build( &textureDescriptorLayout );
+    // build pipeline
+    auto vertexBinding = Vertex::getBindingDescription();
+    auto vertexAttributes = Vertex::getAttributeDescriptions();
+    std::vector<vk::DynamicState> dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+    std::vector<vk::Format> colorattachmentFormats = {renderImage.Format()};
+    std::vector<vk::DescriptorSetLayout> descriptorLayouts = {cameraDescriptorLayout, instanceDescriptorLayout, textureDescriptorLayout};
+    auto instancedMeshPipeline = vktg::GraphicsPipelineBuilder()
+        .AddShader( vertexShader, vk::ShaderStageFlagBits::eVertex )
+        .AddShader( fragmentShader, vk::ShaderStageFlagBits::eFragment )
+        .AddDescriptorLayouts( descriptorLayouts )
+        .SetDynamicStates( dynamicStates )
+        .SetVertexInputBindng( vertexBinding )
+        .SetVertexAttributes( vertexAttributes )
+        .SetInputAssembly( vk::PrimitiveTopology::eTriangleList )
+        .SetPolygonMode( vk::PolygonMode::eFill )
+        .SetCulling( vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise )
+        .EnableDepth()
+        .SetDepthFormat( depthImage.Format() )
+        .SetColorFormats( colorattachmentFormats )
+        .Build();
+
+    deletionStack.Push( [=](){
+        vktg::DestroyPipelineLayout( instancedMeshPipeline.pipelineLayout);
+        vktg::DestroyPipeline( instancedMeshPipeline.pipeline);
+    });
+
+    // cleanup shader modules immediately, no longer needed
+    vktg::DestroyShaderModule( vertexShader);
+    vktg::DestroyShaderModule( fragmentShader);
+
+    // upload mesh data to gpu
+    vktg::Buffer vertexStaging;
+    vktg::CreateStagingBuffer( vertexStaging, vertexData.size_bytes(), vertexData.data());
+    vktg::Buffer indexStaging;
+    vktg::CreateStagingBuffer( indexStaging, indexData.size_bytes(), indexData.data());
+    vk::IndexType indexType = mesh.IndexType();
+    mesh.Close();
+
+    vktg::SubmitContext transferSubmit = vktg::CreateSubmitContext( vktg::QueueType::eTransfer);
+    deletionStack.Push( [&](){
+        vktg::DestroySubmitContext( transferSubmit);
+    });
+
+    transferSubmit.Begin();
+        vktg::CopyBuffer( transferSubmit.cmd, vertexStaging.buffer, vertexBuffer.buffer, vertexStaging.Size());
+        vktg::CopyBuffer( transferSubmit.cmd, indexStaging.buffer, indexBuffer.buffer, indexStaging.Size());
+    transferSubmit.End();
+    transferSubmit.Submit();
+    vktg::WaitForFence( transferSubmit.fence);
+
+    vktg::DestroyBuffer( vertexStaging);
+    vktg::DestroyBuffer( indexStaging);
+
+
+    // frame resources
+    struct FrameResources {
+        vk::Fence renderFence;
+        vk::Semaphore renderSemaphore;
+        vk::Semaphore presentSemaphore;
+        vk::CommandPool commandPool;
+        vk::CommandBuffer commandbuffer;
+    } frameResources[frameOverlap];
+
+    for (auto &frame : frameResources)
+    {
+        // synchronization objects
+        frame.renderFence = vktg::CreateFence();
+        frame.renderSemaphore = vktg::CreateSemaphore();
+        frame.presentSemaphore = vktg::CreateSemaphore();
+        deletionStack.Push( [=](){
+            vktg::DestroyFence( frame.renderFence);
+            vktg::DestroySemaphore( frame.renderSemaphore);
+            vktg::DestroySemaphore( frame.presentSemaphore);
+        });
+
+        // command pools and command buffers
+        frame.commandPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
+        deletionStack.Push( [=](){
+            vktg::DestroyCommandPool( frame.commandPool);
+        });
+        frame.commandbuffer = vktg::AllocateCommandBuffer( frame.commandPool);
+    }
+
+    // gpu time of cull pass and draw
+    vktg::GpuProfiler gpuProfiler( frameOverlap);
+    deletionStack.Push( [&](){
+        gpuProfiler.Destroy();
+    });
+    double cullTimeSum = 0.0, drawTimeSum = 0.0;
+    uint64_t timeCount = 0;
+
+
+    // render loop
+    while (!glfwWindowShouldClose( vktg::Window()))
+    {
+        glfwPollEvents();
+
+
+        // recreate swapchain and render image if outdated
+        if (!swapchain.isValid)
+        {
+            vktg::CreateSwapchain( swapchain, &retired, frameCount);
+            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height(), &retired, frameCount);
+            vktg::ResizeImage( depthImage, swapchain.Width(), swapchain.Height(), &retired, frameCount);
+        }
+
+
+        // camera orbiting inside the grid
+        float angle = glm::radians( 30.f * frameCount / 600);
+        camera.pos = glm::vec3( 20.f * std::cos( angle), 20.f * std::sin( angle), 6.f);
+        camera.view = glm::lookAt( camera.pos, glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f));
+        camera.proj = glm::perspective( glm::radians( 60.f), (float)renderImage.Width() / renderImage.Height(), 0.1f, 100.f);
+        camera.proj[1][1] *= -1;
+        camera.viewProj = camera.proj * camera.view;
+        memcpy( cameraStaging.allocationInfo.pMappedData, &camera, sizeof(camera));
+
+        transferSubmit.Begin();
+            vktg::CopyBuffer( transferSubmit.cmd, cameraStaging.buffer, cameraBuffer.buffer, cameraStaging.Size());
+        transferSubmit.End();
+        transferSubmit.Submit();
+
+
+        // get current frame
+        auto &frame = frameResources[frameCount % frameOverlap];
+
+        // wait for render fence to record render commands
+        vktg::WaitForFence( frame.renderFence);
+
+        // destroy what was retired before the frames in flight started
+        if (frameCount >= frameOverlap)
+        {
+            retired.Flush( frameCount - frameOverlap);
+        }
+
+        // get next swapchain image, the fence is only reset once this frame is sure to signal it
+        uint32_t imageIndex;
+        if (!vktg::NextSwapchainImage( swapchain, frame.renderSemaphore, &imageIndex))
+        {
+            continue;
+        }
+        vktg::ResetFence( frame.renderFence);
+
+        // instance buffer of this frame is no longer read by the gpu
+        indirectDrawer.NextFrame();
+        indirectDrawer.SetInstances( instances);
+
+        // record render commands
+        auto cmd = frame.commandbuffer;
+        cmd.reset( vk::CommandBufferResetFlagBits::eReleaseResources);
+        auto commandBeginInfo = vk::CommandBufferBeginInfo{}
+            .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+        VK_CHECK( cmd.begin( &commandBeginInfo) );
+
+            // read times of the last submit of this frame, complete since its fence is signaled
+            gpuProfiler.BeginFrame( cmd);
+            auto results = gpuProfiler.Results();
+            if (results.size() == 2)
+            {
+                cullTimeSum += results[0].milliseconds;
+                drawTimeSum += results[1].milliseconds;
+                timeCount++;
+            }
+
+            // frustum culling writes the indirect draw commands
+            gpuProfiler.BeginZone( cmd, "cull");
+            indirectDrawer.Cull( cmd, &camera.viewProj[0][0]);
+            gpuProfiler.EndZone( cmd, vk::PipelineStageFlagBits2::eComputeShader);
+
+            // geometry draw
+            vktg::TransitionImageLayout(
+                cmd, renderImage.image,
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal,
+                vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
+                vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite
+            );
+
+            std::vector<vk::RenderingAttachmentInfo> colorAttachments = {vktg::CreateColorAttachment( renderImage.imageView, &clearColor)};
+            vk::RenderingAttachmentInfo depthAttachment = vktg::CreateDepthStencilAttachment( depthImage.imageView, &clearDepth);
+            auto renderingInfo = vktg::CreateRenderingInfo( swapchain.extent, colorAttachments, &depthAttachment);
+            cmd.beginRendering( renderingInfo);
+
+                size_t offset = 0;
+                cmd.bindVertexBuffers2( 0, 1, &vertexBuffer.buffer, &offset, nullptr, nullptr);
+                cmd.bindIndexBuffer( indexBuffer.buffer, 0, indexType);
+
+                cmd.bindPipeline( vk::PipelineBindPoint::eGraphics, instancedMeshPipeline.pipeline);
+                vk::DescriptorSet descriptors[] = {cameraDescriptor, instanceDescriptors[frameCount % frameOverlap], textureDescriptor};
+                cmd.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, instancedMeshPipeline.pipelineLayout, 0, 3, descriptors, 0, nullptr);
+
+                //set dynamic viewport and scissor
+                vk::Viewport viewport = vktg::CreateViewport( 0.f, 0.f, renderImage.Width(), renderImage.Height(), 0.f, 1.f);
+                vk::Rect2D scissor = vktg::CreateScissor( 0.f, 0.f, renderImage.Width(), renderImage.Height());
+                cmd.setViewport( 0, 1, &viewport);
+                cmd.setScissor( 0, 1, &scissor);
+
+                gpuProfiler.BeginZone( cmd, "indirect draw");
+                indirectDrawer.Draw( cmd);
+                gpuProfiler.EndZone( cmd, vk::PipelineStageFlagBits2::eAllGraphics);
+
+            cmd.endRendering();
+
+
+            // copy render image to swapchain
+            // both transitions are recorded with a single pipeline barrier
+            vktg::BarrierBatch copyBarriers;
+            vktg::TransitionImageLayout(
+                copyBarriers, renderImage.image,
+                vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal,
+                vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite,
+                vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead
+            );
+            vktg::TransitionImageLayout(
+                copyBarriers, swapchain.images[imageIndex],
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
+                vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
+            );
+            copyBarriers.Flush( cmd);
+            vktg::CopyImage(
+                cmd, renderImage.image, swapchain.images[imageIndex],
+                vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{renderImage.Width(), renderImage.Height()}},
+                vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{swapchain.Width(), swapchain.Height()}}
+            );
+
+            // transition swapchain image to present optimal layout
+            vktg::TransitionImageLayout(
+                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, swapchain.presentLayout,
+                vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+                vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
+            );
+
+        cmd.end();
+
+
+        // wait for data transfer to complete
+        vktg::WaitForFence( transferSubmit.fence);
+
+
+        vk::CommandBufferSubmitInfo cmdInfos[] = {
+            vk::CommandBufferSubmitInfo{}
+                .setCommandBuffer( cmd )
+        };
+        vk::SemaphoreSubmitInfo waitInfos[] = {
+            vk::SemaphoreSubmitInfo{}
+                .setSemaphore( frame.renderSemaphore )
+                .setStageMask( vk::PipelineStageFlagBits2::eColorAttachmentOutput )
+        };
+        vk::SemaphoreSubmitInfo signalInfos[] = {
+            vk::SemaphoreSubmitInfo{}
+                .setSemaphore( frame.presentSemaphore )
+        };
+        vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, waitInfos, signalInfos, frame.renderFence);
+
+        vktg::PresentImage( swapchain, &frame.presentSemaphore, &imageIndex);
+
+        ++frameCount;
+    }
+
+
+    // cleanup
+	vktg::WaitIdle();
+    retired.FlushAll();
+
+    if (timeCount > 0)
+    {
+        std::cout << "Cull pass: " << cullTimeSum / timeCount << " ms, indirect draw: " << drawTimeSum / timeCount << " ms average over " << timeCount << " frames\n";
+    }
+
+    deletionStack.Flush();
+    vktg::DestroyImage( renderImage);
+    vktg::DestroyImage( depthImage);
+    vktg::DestroySwapchain( swapchain);
+
+    vktg::ShutDown();
+
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 
 
 #include "vulkantogo.h"
+#include "shared/mesh_cache.h"
 #include "shared/utility.h"
 
 #include <glm/gtx/euler_angles.hpp>
@@ -13,15 +14,19 @@
 
 int main() {
 
+    // present id and wait to pace presents for low latency, if the driver supports them
+    vktg::Config()->presentWait = true;
     vktg::StartUp();
 
 
     // deletion stack
     vktg::DeletionStack deletionStack = vktg::DeletionStack{};
+    // swapchains and render targets replaced on resize, destroyed once the frames using them are done
+    vktg::DeferredDeletionQueue retired;
 
 
-    // swapchain
-    auto swapchain = vktg::PrepareSwapchain();
+    // swapchain, low latency since input is handled every frame
+    auto swapchain = vktg::PrepareSwapchain( vktg::PresentPolicy::eLowLatency);
     vktg::CreateSwapchain( swapchain);
 
 
@@ -113,12 +118,15 @@ int main() {
     });
 
     // model
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    LoadMesh( "../res/models/viking_room.obj", vertices, indices);
+    MappedMesh mesh;
+    LoadCookedMesh( "../res/models/viking_room.obj", mesh);
+    auto vertices = mesh.Vertices();
+    auto indexData = mesh.IndexData();
+    uint32_t indexCount = mesh.IndexCount();
+    vk::IndexType indexType = mesh.IndexType();
     vktg::Buffer vertexBuffer, indexBuffer;
-    vktg::CreateBuffer( vertexBuffer, vertices.size() * sizeof(Vertex), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
-    vktg::CreateBuffer( indexBuffer, indices.size() * sizeof(uint32_t), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( vertexBuffer, vertices.size_bytes(), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( indexBuffer, indexData.size_bytes(), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
     
     deletionStack.Push( [&](){
         vktg::DestroyBuffer( vertexBuffer);
@@ -149,8 +157,8 @@ int main() {
 
     // graphics pipeline
     // shaders
-    auto vertexShader = vktg::LoadShader( "../res/shaders/mesh_vert.spv");
-    auto fragmentShader = vktg::LoadShader( "../res/shaders/texture_frag.spv");
+    auto vertexShader = vktg::LoadShader( VKTG_SHADER_DIR "mesh_vert.spv");
+    auto fragmentShader = vktg::LoadShader( VKTG_SHADER_DIR "texture_frag.spv");
     // descriptor sets
     vk::DescriptorSetLayout cameraDescriptorLayout;
     auto cameraBufferInfo = vktg::GetDescriptorBufferInfo( cameraBuffer.buffer);
@@ -199,9 +207,11 @@ int main() {
 
     // upload data to gpu
     vktg::Buffer vertexStaging;
-    vktg::CreateStagingBuffer( vertexStaging, vertices.size() * sizeof(Vertex), vertices.data());
+    vktg::CreateStagingBuffer( vertexStaging, vertices.size_bytes(), vertices.data());
     vktg::Buffer indexStaging;
-    vktg::CreateStagingBuffer( indexStaging, indices.size() * sizeof(uint32_t), indices.data());
+    vktg::CreateStagingBuffer( indexStaging, indexData.size_bytes(), indexData.data());
+    // mesh data lives in staging memory now
+    mesh.Close();
     vktg::Buffer cameraStaging;
     vktg::CreateStagingBuffer( cameraStaging, sizeof(CameraData), &cameraData);
     vktg::Buffer objectStaging;
@@ -224,18 +234,15 @@ int main() {
         vktg::CopyBuffer( transferSubmit.cmd, indexStaging.buffer, indexBuffer.buffer, indexStaging.Size());
         vktg::CopyBuffer( transferSubmit.cmd, cameraStaging.buffer, cameraBuffer.buffer, cameraStaging.Size());
         vktg::CopyBuffer( transferSubmit.cmd, objectStaging.buffer, objectBuffer.buffer, objectStaging.Size());
-        vktg::TransitionImageLayout( 
-            transferSubmit.cmd, texture.image, 
-            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-            vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
-            vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
+        // old layouts and source stages are taken from the tracked texture state
+        vktg::Transition( 
+            transferSubmit.cmd, texture, 
+            vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal}
         );
         vktg::CopyBufferToImage( transferSubmit.cmd, textureStaging.buffer, texture.image, 0, texture.Width(), texture.Height());
-        vktg::TransitionImageLayout( 
-            transferSubmit.cmd, texture.image, 
-            vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
-            vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
-            vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
+        vktg::Transition( 
+            transferSubmit.cmd, texture, 
+            vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone, vk::ImageLayout::eShaderReadOnlyOptimal}
         );
     transferSubmit.End();
     transferSubmit.Submit();
@@ -249,8 +256,8 @@ int main() {
     vktg::DestroyBuffer( textureStaging);
 
 
-    // frame handler
-    const uint8_t frameOverlap = 2;
+    // frame handler, with as many frames in flight as the present policy of the swapchain asks for
+    const uint8_t frameOverlap = (uint8_t)swapchain.framesInFlight;
     vktg::FrameHandler frameHandler( frameOverlap);
     frameHandler.RegisterLateCallback( "fps", [&](){
 
@@ -261,7 +268,12 @@ int main() {
 
         if (totalTime >= 1.0)
         {
-            std::cout << "fps = " << frameHandler.FrameCount() - lastFrameCount << '\n';
+            std::cout << "fps = " << frameHandler.FrameCount() - lastFrameCount;
+            if (auto latency = frameHandler.Stat( "input latency"))
+            {
+                std::cout << ", input latency = " << latency->Average() << " ms";
+            }
+            std::cout << '\n';
             lastFrameCount = frameHandler.FrameCount();
             totalTime = 0.0;
         }
@@ -274,7 +286,8 @@ int main() {
         vk::Semaphore presentSemaphore;
         vk::CommandPool commandPool;
         vk::CommandBuffer commandbuffer;
-    } frameResources[frameHandler.FrameOverlap()];
+    };
+    std::vector<FrameResources> frameResources( frameHandler.FrameOverlap());
 
     for (auto &frame : frameResources)
     {
@@ -331,6 +344,10 @@ int main() {
     input.PushLayer( &inputLayer); 
 
 
+    // input latency measurements already added to the frame stats
+    uint64_t inputLatencyCount = 0;
+
+
     // render loop
     while (!glfwWindowShouldClose( vktg::Window())) 
     {
@@ -338,18 +355,17 @@ int main() {
         frameHandler.EarlyUpdate();
 
 
-        // handle input
+        // wait for older presents to be shown first, so the input is fresh when this frame is, then handle input
+        vktg::WaitForPresentPacing( swapchain);
         input.Update();
 
 
         // recreate swapchain and render image if outdated
         if (!swapchain.isValid)
         {
-        	vktg::WaitIdle();
-
-            vktg::CreateSwapchain( swapchain);
-            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height());
-            vktg::ResizeImage( depthImage, swapchain.Width(), swapchain.Height());
+            vktg::CreateSwapchain( swapchain, &retired, frameHandler.FrameCount());
+            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height(), &retired, frameHandler.FrameCount());
+            vktg::ResizeImage( depthImage, swapchain.Width(), swapchain.Height(), &retired, frameHandler.FrameCount());
         }
 
 
@@ -378,14 +394,20 @@ int main() {
             
         // wait for render fence to record render commands
         vktg::WaitForFence( frame.renderFence);
-        vktg::ResetFence( frame.renderFence);
+
+        // destroy what was retired before the frames in flight started
+        if (frameHandler.FrameCount() >= frameOverlap)
+        {
+            retired.Flush( frameHandler.FrameCount() - frameOverlap);
+        }
             
-        // get next swapchain image
+        // get next swapchain image, the fence is only reset once this frame is sure to signal it
         uint32_t imageIndex;
         if (!vktg::NextSwapchainImage( swapchain, frame.renderSemaphore, &imageIndex))
         {
             continue;
         }
+        vktg::ResetFence( frame.renderFence);
 
         // record render commands
         auto cmd = frame.commandbuffer;
@@ -410,7 +432,7 @@ int main() {
 
                 size_t offset = 0;
                 cmd.bindVertexBuffers2( 0, 1, &vertexBuffer.buffer, &offset, nullptr, nullptr);
-                cmd.bindIndexBuffer( indexBuffer.buffer, 0, vk::IndexType::eUint32);
+                cmd.bindIndexBuffer( indexBuffer.buffer, 0, indexType);
 
                 cmd.bindPipeline( vk::PipelineBindPoint::eGraphics, texturedMeshPipeline.pipeline);
                 vk::DescriptorSet descriptors[] = {cameraDescriptor, objectDescriptor, textureDescriptor};
@@ -422,25 +444,28 @@ int main() {
                 cmd.setViewport( 0, 1, &viewport);
                 cmd.setScissor( 0, 1, &scissor);
 
-                cmd.drawIndexed( (uint32_t)indices.size(), 1, 0, 0, 0);
+                cmd.drawIndexed( indexCount, 1, 0, 0, 0);
 
 
             cmd.endRendering();
 
 
             // copy render image to swapchain
+            // both transitions are recorded with a single pipeline barrier
+            vktg::BarrierBatch copyBarriers;
             vktg::TransitionImageLayout( 
-                cmd, renderImage.image, 
+                copyBarriers, renderImage.image, 
                 vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal,
                 vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead
             );
             vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], 
+                copyBarriers, swapchain.images[imageIndex], 
                 vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
                 vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
             );
+            copyBarriers.Flush( cmd);
             vktg::CopyImage( 
                 cmd, renderImage.image, swapchain.images[imageIndex],
                 vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{renderImage.Width(), renderImage.Height()}},
@@ -449,7 +474,7 @@ int main() {
 
             // transition swapchain image to present optimal layout
             vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR,
+                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, swapchain.presentLayout,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
                 vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
             );
@@ -476,7 +501,13 @@ int main() {
         };
         vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, waitInfos, signalInfos, frame.renderFence);
 
-        vktg::PresentImage( swapchain, &frame.presentSemaphore, &imageIndex);
+        vktg::PresentImage( swapchain, &frame.presentSemaphore, &imageIndex, input.InputTime());
+        // measured here without present wait, otherwise by WaitForPresentPacing once the present is done
+        if (swapchain.inputLatencyCount != inputLatencyCount)
+        {
+            frameHandler.AddStat( "input latency", swapchain.inputLatency);
+            inputLatencyCount = swapchain.inputLatencyCount;
+        }
 
         
         // late frame updates
@@ -486,6 +517,7 @@ int main() {
 
     // cleanup
 	vktg::WaitIdle();
+    retired.FlushAll();
 
     deletionStack.Flush();
     vktg::DestroyImage( renderImage);
@@ -0,0 +1,107 @@
+#include "vulkantogo.h"
+#include "shared/utility.h"
+#include "shared/mesh_import.h"
+#include "shared/mesh_cache.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+// writes a grid of gridSize x gridSize quads with positions, uvs and normals as .obj file
+static void WriteGridMesh( const std::string &path, uint32_t gridSize) {
+
+    std::ofstream file( path);
+    uint32_t rowSize = gridSize + 1;
+    for (uint32_t y = 0; y < rowSize; y++)
+    {
+        for (uint32_t x = 0; x < rowSize; x++)
+        {
+            float u = (float)x / gridSize;
+            float v = (float)y / gridSize;
+            float h = 0.1f * std::sin( 20.f * u) * std::cos( 20.f * v);
+            file << "v " << u << ' ' << h << ' ' << v << '\n';
+            file << "vt " << u << ' ' << v << '\n';
+        }
+    }
+    file << "vn 0 1 0\n";
+    for (uint32_t y = 0; y < gridSize; y++)
+    {
+        for (uint32_t x = 0; x < gridSize; x++)
+        {
+            uint32_t i0 = y * rowSize + x + 1;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + rowSize;
+            uint32_t i3 = i2 + 1;
+            file << "f " << i0 << '/' << i0 << "/1 " << i2 << '/' << i2 << "/1 " << i1 << '/' << i1 << "/1\n";
+            file << "f " << i1 << '/' << i1 << "/1 " << i2 << '/' << i2 << "/1 " << i3 << '/' << i3 << "/1\n";
+        }
+    }
+}
+
+
+template<typename Func>
+static double Measure( Func func) {
+
+    vktg::Timer timer;
+    timer.Start();
+    func();
+    timer.Update();
+
+    return timer.ElapsedUnscaledTime();
+}
+
+
+// usage: mesh_import_bench [mesh.obj]
+// without a mesh a grid of about three million triangles is generated
+int main( int argc, char **argv) {
+
+    std::string meshPath;
+    if (argc > 1)
+    {
+        meshPath = argv[1];
+    }
+    else
+    {
+        meshPath = (std::filesystem::temp_directory_path() / "vktg_bench_grid.obj").string();
+        WriteGridMesh( meshPath, 1200);
+    }
+
+    std::vector<Vertex> referenceVertices, vertices;
+    std::vector<uint32_t> referenceIndices, indices;
+    vktg::ThreadPool threadPool;
+
+    double unorderedMapTime = Measure( [&](){ LoadMesh( meshPath, referenceVertices, referenceIndices); });
+    double serialTime = Measure( [&](){ ImportMesh( meshPath, vertices, indices); });
+    double parallelTime = Measure( [&](){ ImportMesh( meshPath, vertices, indices, &threadPool); });
+
+    bool match = vertices.size() == referenceVertices.size() && indices == referenceIndices;
+
+    // vertex cache efficiency before and after mesh optimization
+    auto fileOrderStats = vktg::AnalyzeVertexCache( indices, (uint32_t)vertices.size());
+    double optimizeTime = Measure( [&](){ OptimizeMesh( vertices, indices); });
+    auto optimizedStats = vktg::AnalyzeVertexCache( indices, (uint32_t)vertices.size());
+
+    std::cout << "mesh:                  " << meshPath << '\n';
+    std::cout << "triangles:             " << indices.size() / 3 << '\n';
+    std::cout << "unique vertices:       " << vertices.size() << '\n';
+    std::cout << "LoadMesh:              " << unorderedMapTime << " s\n";
+    std::cout << "ImportMesh:            " << serialTime << " s\n";
+    std::cout << "ImportMesh (" << threadPool.ThreadCount() << " threads): " << parallelTime << " s\n";
+    std::cout << "results match:         " << (match ? "yes" : "no") << '\n';
+    std::cout << "OptimizeMesh:          " << optimizeTime << " s\n";
+    std::cout << "ACMR file order:       " << fileOrderStats.acmr << '\n';
+    std::cout << "ACMR optimized:        " << optimizedStats.acmr << '\n';
+
+    if (argc <= 1)
+    {
+        std::filesystem::remove( meshPath);
+    }
+
+    return match ? EXIT_SUCCESS : EXIT_FAILURE;
+}
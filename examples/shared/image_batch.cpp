@@ -0,0 +1,203 @@
+#include "image_batch.h"
+#include "synchronization.h"
+#include "transfer.h"
+#include "utility.h"
+
+#include "stb/stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+
+ImageBatchLoader::ImageBatchLoader( vktg::ThreadPool &threadPool, vk::DeviceSize chunkSize) : pThreadPool{ &threadPool}, mChunkSize{ chunkSize} {
+
+    for (auto &stage : mStages)
+    {
+        stage.context = vktg::CreateSubmitContext( vktg::QueueType::eGraphics);
+    }
+}
+
+
+std::vector<vktg::Image> ImageBatchLoader::Load( std::span<const std::string> imagePaths, bool srgb, bool keepChannels, vk::ImageUsageFlags usage, const vktg::ResourceUsage &finalUsage) {
+
+    // read files and image headers in parallel
+    std::vector<Entry> entries( imagePaths.size());
+    std::vector<std::future<void>> jobs;
+    jobs.reserve( entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        jobs.push_back( pThreadPool->Submit( [&, i](){
+            auto &entry = entries[i];
+            entry.file = ReadFile( imagePaths[i]);
+
+            int w, h, c;
+            if (!stbi_info_from_memory( entry.file.data(), (int)entry.file.size(), &w, &h, &c))
+            {
+                throw std::runtime_error( "Failed to read image " + imagePaths[i] + "!");
+            }
+            entry.width = w;
+            entry.height = h;
+
+            // three channel formats are rarely supported for sampling
+            entry.channels = (keepChannels && c <= 2) ? c : 4;
+            switch (entry.channels)
+            {
+                case 1: entry.format = vk::Format::eR8Unorm; break;
+                case 2: entry.format = vk::Format::eR8G8Unorm; break;
+                default: entry.format = srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm; break;
+            }
+            entry.size = (vk::DeviceSize)w * h * entry.channels;
+        }));
+    }
+    for (auto &job : jobs)
+    {
+        job.wait();
+    }
+    for (auto &job : jobs)
+    {
+        job.get();
+    }
+
+    // a failed decode leaves no images behind, chunks already submitted finish before their images are destroyed
+    std::vector<vktg::Image> images( entries.size());
+    try
+    {
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            vktg::CreateImage( images[i], entries[i].width, entries[i].height, entries[i].format, usage | vk::ImageUsageFlagBits::eTransferDst);
+        }
+
+        // decode chunks alternating between two staging buffers, one chunk uploads while the next is decoded
+        size_t next = 0;
+        uint32_t stageIndex = 0;
+        while (next < entries.size())
+        {
+            auto &stage = mStages[stageIndex];
+            stageIndex = (stageIndex + 1) % 2;
+            if (stage.submitted)
+            {
+                vktg::WaitForFence( stage.context.fence);
+                stage.submitted = false;
+            }
+
+            // images of this chunk, an image larger than a chunk gets a chunk of its own
+            size_t first = next;
+            vk::DeviceSize chunkSize = 0;
+            while (next < entries.size())
+            {
+                vk::DeviceSize offset = (chunkSize + 15) / 16 * 16;
+                if (next > first && offset + entries[next].size > mChunkSize)
+                {
+                    break;
+                }
+                entries[next].offset = offset;
+                chunkSize = offset + entries[next].size;
+                next++;
+            }
+
+            if (stage.staging.Size() < chunkSize)
+            {
+                if (stage.staging.buffer)
+                {
+                    vktg::DestroyBuffer( stage.staging);
+                }
+                vktg::CreateStagingBuffer( stage.staging, std::max( chunkSize, mChunkSize));
+            }
+
+            // stb_image allocates its own output, decoded pixels are copied once into staging memory
+            auto stagingData = static_cast<uint8_t*>( stage.staging.Data());
+            jobs.clear();
+            for (size_t i = first; i < next; i++)
+            {
+                jobs.push_back( pThreadPool->Submit( [&, i, stagingData](){
+                    auto &entry = entries[i];
+                    int w, h, c;
+                    stbi_uc *pixels = stbi_load_from_memory( entry.file.data(), (int)entry.file.size(), &w, &h, &c, entry.channels);
+                    if (!pixels)
+                    {
+                        throw std::runtime_error( "Failed to decode image " + imagePaths[i] + "!");
+                    }
+                    memcpy( stagingData + entry.offset, pixels, entry.size);
+                    stbi_image_free( pixels);
+
+                    entry.file = std::vector<uint8_t>{};
+                }));
+            }
+            for (auto &job : jobs)
+            {
+                job.wait();
+            }
+            for (auto &job : jobs)
+            {
+                job.get();
+            }
+
+            stage.context.Begin();
+                vktg::BarrierBatch barriers;
+                for (size_t i = first; i < next; i++)
+                {
+                    vktg::Transition( barriers, images[i], vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal});
+                }
+                barriers.Flush( stage.context.cmd);
+
+                for (size_t i = first; i < next; i++)
+                {
+                    vktg::CopyBufferToImage( stage.context.cmd, stage.staging.buffer, images[i].image, entries[i].offset, entries[i].width, entries[i].height);
+                    vktg::Transition( barriers, images[i], finalUsage);
+                }
+                barriers.Flush( stage.context.cmd);
+            stage.context.End();
+            stage.context.Submit();
+            stage.submitted = true;
+        }
+    }
+    catch (...)
+    {
+        for (auto &stage : mStages)
+        {
+            if (stage.submitted)
+            {
+                vktg::WaitForFence( stage.context.fence);
+                stage.submitted = false;
+            }
+        }
+        for (auto &image : images)
+        {
+            if (image.image)
+            {
+                vktg::DestroyImage( image);
+            }
+        }
+        throw;
+    }
+
+    for (auto &stage : mStages)
+    {
+        if (stage.submitted)
+        {
+            vktg::WaitForFence( stage.context.fence);
+            stage.submitted = false;
+        }
+    }
+
+    return images;
+}
+
+
+void ImageBatchLoader::Destroy() {
+
+    for (auto &stage : mStages)
+    {
+        if (stage.submitted)
+        {
+            vktg::WaitForFence( stage.context.fence);
+        }
+        if (stage.staging.buffer)
+        {
+            vktg::DestroyBuffer( stage.staging);
+        }
+        vktg::DestroySubmitContext( stage.context);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "vk_core.h"
+#include "storage.h"
+#include "submit_context.h"
+#include "util/thread_pool.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+
+// decodes batches of image files on a thread pool straight into persistently mapped staging memory,
+// uploading each chunk of decoded images while the next chunk is decoded
+class ImageBatchLoader {
+
+    public:
+
+        ImageBatchLoader( vktg::ThreadPool &threadPool, vk::DeviceSize chunkSize = 64 << 20);
+
+        // decode and upload images, single and dual channel images keep their channel count if requested, all others become RGBA8
+        std::vector<vktg::Image> Load(
+            std::span<const std::string> imagePaths, bool srgb = true, bool keepChannels = false,
+            vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+            const vktg::ResourceUsage &finalUsage = vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal}
+        );
+
+        // destroy staging buffers and submit contexts
+        void Destroy();
+
+    private:
+
+        struct Entry {
+            std::vector<uint8_t> file;
+            uint32_t width;
+            uint32_t height;
+            int channels;
+            vk::Format format;
+            vk::DeviceSize offset;
+            vk::DeviceSize size;
+        };
+
+        // staging buffer and submit context of one chunk in flight
+        struct Stage {
+            vktg::Buffer staging;
+            vktg::SubmitContext context;
+            bool submitted = false;
+        };
+
+        vktg::ThreadPool *pThreadPool;
+        const vk::DeviceSize mChunkSize;
+        Stage mStages[2];
+};
@@ -0,0 +1,258 @@
+#include "mesh_cache.h"
+#include "mesh_import.h"
+#include "mesh_optimizer.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+static constexpr uint32_t cookedMeshMagic = 0x4D544B56;   // "VKTM"
+static constexpr uint32_t cookedMeshVersion = 2;
+
+
+static uint64_t AlignOffset( uint64_t offset) {
+
+    return (offset + 15) / 16 * 16;
+}
+
+
+MappedMesh::~MappedMesh() {
+
+    Close();
+}
+
+
+bool MappedMesh::Open( std::string_view cookedPath) {
+
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA( std::string( cookedPath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx( file, &size);
+    HANDLE mapping = size.QuadPart > 0 ? CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void *data = mapping ? MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data)
+    {
+        if (mapping)
+        {
+            CloseHandle( mapping);
+        }
+        CloseHandle( file);
+        return false;
+    }
+    pFile = file;
+    pMapping = mapping;
+    mSize = (size_t)size.QuadPart;
+#else
+    int file = open( std::string( cookedPath).c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat fileStat;
+    void *data = (fstat( file, &fileStat) == 0 && fileStat.st_size > 0) ? mmap( nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+    if (data == MAP_FAILED)
+    {
+        close( file);
+        return false;
+    }
+    // vertex and index streams are read front to back
+    madvise( data, fileStat.st_size, MADV_SEQUENTIAL);
+    mFile = file;
+    mSize = (size_t)fileStat.st_size;
+#endif
+    pData = static_cast<const uint8_t*>( data);
+
+    // validate header and stream ranges
+    const auto &header = Header();
+    bool valid = mSize >= sizeof(CookedMeshHeader)
+        && header.magic == cookedMeshMagic
+        && header.version == cookedMeshVersion
+        && header.vertexStride == sizeof(Vertex)
+        && (header.indexSize == sizeof(uint16_t) || header.indexSize == sizeof(uint32_t))
+        && header.vertexOffset + (uint64_t)header.vertexCount * header.vertexStride <= mSize
+        && header.indexOffset + (uint64_t)header.indexCount * header.indexSize <= mSize;
+    if (!valid)
+    {
+        Close();
+    }
+
+    return valid;
+}
+
+
+void MappedMesh::Close() {
+
+    if (!pData)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile( pData);
+    CloseHandle( pMapping);
+    CloseHandle( pFile);
+    pMapping = nullptr;
+    pFile = nullptr;
+#else
+    munmap( const_cast<uint8_t*>( pData), mSize);
+    close( mFile);
+    mFile = -1;
+#endif
+    pData = nullptr;
+    mSize = 0;
+}
+
+
+const CookedMeshHeader& MappedMesh::Header() const {
+
+    return *reinterpret_cast<const CookedMeshHeader*>( pData);
+}
+
+
+std::span<const Vertex> MappedMesh::Vertices() const {
+
+    return std::span<const Vertex>( reinterpret_cast<const Vertex*>( pData + Header().vertexOffset), Header().vertexCount);
+}
+
+
+std::span<const uint8_t> MappedMesh::IndexData() const {
+
+    return std::span<const uint8_t>( pData + Header().indexOffset, (size_t)Header().indexCount * Header().indexSize);
+}
+
+
+uint32_t MappedMesh::IndexCount() const {
+
+    return Header().indexCount;
+}
+
+
+vk::IndexType MappedMesh::IndexType() const {
+
+    return Header().indexSize == sizeof(uint16_t) ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+}
+
+
+glm::vec3 MappedMesh::BoundsMin() const {
+
+    return glm::vec3( Header().boundsMin[0], Header().boundsMin[1], Header().boundsMin[2]);
+}
+
+
+glm::vec3 MappedMesh::BoundsMax() const {
+
+    return glm::vec3( Header().boundsMax[0], Header().boundsMax[1], Header().boundsMax[2]);
+}
+
+
+// write cooked mesh
+void WriteCookedMesh( std::string_view cookedPath, std::span<const Vertex> vertices, std::span<const uint32_t> indices, uint64_t sourceSize, int64_t sourceTime, bool compactIndices) {
+
+    std::vector<uint8_t> indexData;
+    auto indexType = vktg::CompactIndices( indices, compactIndices ? (uint32_t)vertices.size() : ~0u, indexData);
+
+    CookedMeshHeader header{};
+    header.magic = cookedMeshMagic;
+    header.version = cookedMeshVersion;
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+    header.vertexStride = sizeof(Vertex);
+    header.vertexCount = (uint32_t)vertices.size();
+    header.indexCount = (uint32_t)indices.size();
+    header.indexSize = indexType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    header.vertexOffset = AlignOffset( sizeof(CookedMeshHeader));
+    header.indexOffset = AlignOffset( header.vertexOffset + vertices.size_bytes());
+
+    glm::vec3 boundsMin( vertices.empty() ? 0.f : std::numeric_limits<float>::max());
+    glm::vec3 boundsMax( vertices.empty() ? 0.f : std::numeric_limits<float>::lowest());
+    for (auto &vertex : vertices)
+    {
+        boundsMin = glm::min( boundsMin, vertex.position);
+        boundsMax = glm::max( boundsMax, vertex.position);
+    }
+    memcpy( header.boundsMin, &boundsMin, sizeof(header.boundsMin));
+    memcpy( header.boundsMax, &boundsMax, sizeof(header.boundsMax));
+
+    // write to temporary file first, so an interrupted write never leaves a broken cooked mesh behind
+    std::string tempPath = std::string( cookedPath) + ".tmp";
+    {
+        std::ofstream file( tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error( "Failed to write cooked mesh " + std::string( cookedPath) + "!");
+        }
+
+        const char padding[16] = {};
+        file.write( reinterpret_cast<const char*>( &header), sizeof(header));
+        file.write( padding, header.vertexOffset - sizeof(header));
+        file.write( reinterpret_cast<const char*>( vertices.data()), vertices.size_bytes());
+        file.write( padding, header.indexOffset - header.vertexOffset - vertices.size_bytes());
+        file.write( reinterpret_cast<const char*>( indexData.data()), indexData.size());
+        if (!file.good())
+        {
+            throw std::runtime_error( "Failed to write cooked mesh " + std::string( cookedPath) + "!");
+        }
+    }
+    std::filesystem::rename( tempPath, std::string( cookedPath));
+}
+
+
+// optimize mesh
+void OptimizeMesh( std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) {
+
+    uint32_t vertexCount = (uint32_t)vertices.size();
+    vktg::OptimizeVertexCache( indices, vertexCount);
+    vktg::OptimizeOverdraw( indices, &vertices[0].position.x, sizeof(Vertex), vertexCount);
+    vertices.resize( vktg::OptimizeVertexFetch( indices, vertices.data(), vertexCount, sizeof(Vertex)));
+}
+
+
+// load cooked mesh
+void LoadCookedMesh( std::string_view meshPath, MappedMesh &mesh, vktg::ThreadPool *threadPool, bool optimize) {
+
+    std::filesystem::path sourcePath( meshPath);
+    uint64_t sourceSize = std::filesystem::file_size( sourcePath);
+    int64_t sourceTime = std::filesystem::last_write_time( sourcePath).time_since_epoch().count();
+    std::string cookedPath = sourcePath.string() + (optimize ? ".cooked" : ".unoptimized.cooked");
+
+    if (mesh.Open( cookedPath) && mesh.Header().sourceSize == sourceSize && mesh.Header().sourceTime == sourceTime)
+    {
+        return;
+    }
+    mesh.Close();
+
+    // first import or outdated cooked mesh
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    ImportMesh( meshPath, vertices, indices, threadPool);
+    if (optimize && !vertices.empty())
+    {
+        OptimizeMesh( vertices, indices);
+    }
+    WriteCookedMesh( cookedPath, vertices, indices, sourceSize, sourceTime, optimize);
+
+    if (!mesh.Open( cookedPath))
+    {
+        throw std::runtime_error( "Failed to map cooked mesh " + cookedPath + "!");
+    }
+}
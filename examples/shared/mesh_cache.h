@@ -0,0 +1,76 @@
+#pragma once
+
+#include "utility.h"
+#include "util/thread_pool.h"
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+// header of a cooked mesh file, followed by the vertex and index streams at 16 byte aligned offsets
+struct CookedMeshHeader {
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+static_assert( sizeof(CookedMeshHeader) == 80, "cooked mesh header must not contain padding");
+
+
+// read-only memory mapping of a cooked mesh file
+class MappedMesh {
+
+    public:
+
+        MappedMesh() = default;
+        ~MappedMesh();
+
+        MappedMesh( const MappedMesh&) = delete;
+        MappedMesh& operator=( const MappedMesh&) = delete;
+
+        // map cooked mesh file, returns false if the file does not exist or is not a valid cooked mesh
+        bool Open( std::string_view cookedPath);
+        void Close();
+
+        const CookedMeshHeader& Header() const;
+        // vertex and index data can be copied straight into staging memory
+        std::span<const Vertex> Vertices() const;
+        // 16 bit indices if the mesh has fewer than 65536 vertices, 32 bit otherwise
+        std::span<const uint8_t> IndexData() const;
+        uint32_t IndexCount() const;
+        vk::IndexType IndexType() const;
+        glm::vec3 BoundsMin() const;
+        glm::vec3 BoundsMax() const;
+
+    private:
+
+        const uint8_t *pData = nullptr;
+        size_t mSize = 0;
+    #ifdef _WIN32
+        void *pFile = nullptr;
+        void *pMapping = nullptr;
+    #else
+        int mFile = -1;
+    #endif
+};
+
+
+// write cooked mesh file with bounds computed from the vertex positions, indices are stored with 16 bit if possible and requested
+void WriteCookedMesh( std::string_view cookedPath, std::span<const Vertex> vertices, std::span<const uint32_t> indices, uint64_t sourceSize = 0, int64_t sourceTime = 0, bool compactIndices = true);
+
+// reorder triangles for vertex cache locality and overdraw, then vertices for fetch locality
+void OptimizeMesh( std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+// map the cooked version of an .obj mesh next to the source file, importing, optimizing and cooking it first if it is missing or outdated
+// unoptimized meshes keep file order and 32 bit indices
+void LoadCookedMesh( std::string_view meshPath, MappedMesh &mesh, vktg::ThreadPool *threadPool = nullptr, bool optimize = true);
@@ -0,0 +1,317 @@
+#include "mesh_import.h"
+
+#include "tinyobjloader/tiny_obj_loader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <stdexcept>
+
+
+// vertices are hashed and compared as raw bytes, so the struct must not contain padding
+static_assert( sizeof(Vertex) == 15 * sizeof(float), "Vertex must not contain padding");
+
+static constexpr uint32_t emptySlot = std::numeric_limits<uint32_t>::max();
+// triangle corners per import chunk
+static constexpr size_t chunkCorners = 3 * (1 << 16);
+
+
+static uint64_t Mix( uint64_t h) {
+
+    // murmur3 finalizer
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+
+    return h;
+}
+
+
+VertexTable::VertexTable( size_t expectedCount) : mCount{ 0} {
+
+    // keep load factor at or below one half
+    size_t capacity = 64;
+    while (capacity < 2 * expectedCount)
+    {
+        capacity *= 2;
+    }
+    mSlots.resize( capacity, Slot{ 0, emptySlot});
+}
+
+
+uint64_t VertexTable::Hash( const Vertex &vertex) {
+
+    uint64_t words[8] = {};
+    memcpy( words, &vertex, sizeof(Vertex));
+
+    uint64_t h = sizeof(Vertex);
+    for (auto word : words)
+    {
+        h = (h ^ Mix( word)) * 0x9E3779B97F4A7C15ull;
+        h = (h << 31) | (h >> 33);
+    }
+
+    return Mix( h);
+}
+
+
+uint32_t VertexTable::Insert( const Vertex &vertex, std::vector<Vertex> &vertices) {
+
+    return Insert( vertex, Hash( vertex), vertices);
+}
+
+
+uint32_t VertexTable::Insert( const Vertex &vertex, uint64_t hash, std::vector<Vertex> &vertices) {
+
+    if (2 * (mCount + 1) > mSlots.size())
+    {
+        Grow();
+    }
+
+    // linear probing, stored hash bits reject most mismatches without touching the vertex array
+    uint32_t hash32 = (uint32_t)(hash ^ (hash >> 32));
+    size_t mask = mSlots.size() - 1;
+    size_t pos = hash32 & mask;
+    while (mSlots[pos].index != emptySlot)
+    {
+        auto &slot = mSlots[pos];
+        if (slot.hash == hash32 && memcmp( &vertices[slot.index], &vertex, sizeof(Vertex)) == 0)
+        {
+            return slot.index;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    uint32_t index = (uint32_t)vertices.size();
+    vertices.push_back( vertex);
+    mSlots[pos] = Slot{ hash32, index};
+    mCount++;
+
+    return index;
+}
+
+
+size_t VertexTable::Size() const {
+
+    return mCount;
+}
+
+
+void VertexTable::Grow() {
+
+    std::vector<Slot> oldSlots( mSlots.size() * 2, Slot{ 0, emptySlot});
+    std::swap( oldSlots, mSlots);
+
+    size_t mask = mSlots.size() - 1;
+    for (auto &slot : oldSlots)
+    {
+        if (slot.index == emptySlot)
+        {
+            continue;
+        }
+        size_t pos = slot.hash & mask;
+        while (mSlots[pos].index != emptySlot)
+        {
+            pos = (pos + 1) & mask;
+        }
+        mSlots[pos] = slot;
+    }
+}
+
+
+// triangles of one shape processed by one job
+struct ImportChunk {
+
+    const tinyobj::shape_t *shape;
+    size_t first;
+    size_t count;
+    size_t indexOffset;
+
+    // chunk local unique vertices with zero tangents, their hashes and accumulated tangents
+    std::vector<Vertex> vertices;
+    std::vector<uint64_t> hashes;
+    std::vector<glm::vec3> tangents;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> remap;
+};
+
+
+static void ProcessChunk( const tinyobj::attrib_t &attrib, ImportChunk &chunk) {
+
+    VertexTable table( chunk.count / 2);
+    chunk.vertices.reserve( chunk.count / 2);
+    chunk.indices.resize( chunk.count);
+
+    for (size_t i = 0; i < chunk.count; i++)
+    {
+        const auto &index = chunk.shape->mesh.indices[chunk.first + i];
+
+        Vertex vertex{};
+        vertex.position = {
+            attrib.vertices[3*index.vertex_index + 0],
+            attrib.vertices[3*index.vertex_index + 1],
+            attrib.vertices[3*index.vertex_index + 2]
+        };
+        if (index.texcoord_index >= 0)
+        {
+            vertex.texCoord = {
+                attrib.texcoords[2*index.texcoord_index + 0],
+                1.0f - attrib.texcoords[2*index.texcoord_index + 1]
+            };
+        }
+        if (index.normal_index >= 0)
+        {
+            vertex.normal = {
+                attrib.normals[3*index.normal_index + 0],
+                attrib.normals[3*index.normal_index + 1],
+                attrib.normals[3*index.normal_index + 2]
+            };
+        }
+        vertex.color = {1.0f, 1.0f, 1.0f, 1.0f};
+
+        uint64_t hash = VertexTable::Hash( vertex);
+        size_t vertexCount = chunk.vertices.size();
+        chunk.indices[i] = table.Insert( vertex, hash, chunk.vertices);
+        if (chunk.vertices.size() > vertexCount)
+        {
+            chunk.hashes.push_back( hash);
+        }
+    }
+
+    // accumulate tangents of the chunk's triangles on its local vertices
+    chunk.tangents.resize( chunk.vertices.size(), glm::vec3( 0.f));
+    for (size_t i = 0; i + 2 < chunk.count; i += 3)
+    {
+        const Vertex &v0 = chunk.vertices[ chunk.indices[i]];
+        const Vertex &v1 = chunk.vertices[ chunk.indices[i+1]];
+        const Vertex &v2 = chunk.vertices[ chunk.indices[i+2]];
+
+        glm::vec3 edge1 = v1.position - v0.position;
+        glm::vec3 edge2 = v2.position - v0.position;
+
+        float deltaU1 = v1.texCoord.x - v0.texCoord.x;
+        float deltaV1 = v1.texCoord.y - v0.texCoord.y;
+        float deltaU2 = v2.texCoord.x - v0.texCoord.x;
+        float deltaV2 = v2.texCoord.y - v0.texCoord.y;
+
+        float f = 1.0f / (deltaU1 * deltaV2 - deltaU2 * deltaV1);
+        glm::vec3 tangent = f * (deltaV2 * edge1 - deltaV1 * edge2);
+
+        chunk.tangents[ chunk.indices[i]] += tangent;
+        chunk.tangents[ chunk.indices[i+1]] += tangent;
+        chunk.tangents[ chunk.indices[i+2]] += tangent;
+    }
+}
+
+
+template<typename Func>
+static void ForEachChunk( std::vector<ImportChunk> &chunks, vktg::ThreadPool *threadPool, Func func) {
+
+    if (!threadPool || chunks.size() == 1)
+    {
+        for (auto &chunk : chunks)
+        {
+            func( chunk);
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> jobs;
+    jobs.reserve( chunks.size());
+    for (auto &chunk : chunks)
+    {
+        jobs.push_back( threadPool->Submit( [&func, &chunk](){ func( chunk); }));
+    }
+    for (auto &job : jobs)
+    {
+        job.wait();
+    }
+    for (auto &job : jobs)
+    {
+        job.get();
+    }
+}
+
+
+// import mesh
+void ImportMesh( std::string_view meshPath, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, vktg::ThreadPool *threadPool) {
+
+    // load mesh data from file
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warning, error;
+
+    if (!tinyobj::LoadObj( &attrib, &shapes, &materials, &warning, &error, std::string( meshPath).c_str()))
+    {
+        throw std::runtime_error( warning + error);
+    }
+
+    // split shapes into chunks of whole triangles
+    std::vector<ImportChunk> chunks;
+    size_t indexCount = 0;
+    for (const auto &shape : shapes)
+    {
+        size_t shapeCount = shape.mesh.indices.size();
+        for (size_t first = 0; first < shapeCount; first += chunkCorners)
+        {
+            auto &chunk = chunks.emplace_back();
+            chunk.shape = &shape;
+            chunk.first = first;
+            chunk.count = std::min( chunkCorners, shapeCount - first);
+            chunk.indexOffset = indexCount;
+            indexCount += chunk.count;
+        }
+    }
+
+    // deduplicate vertices and accumulate tangents per chunk
+    ForEachChunk( chunks, threadPool, [&attrib]( ImportChunk &chunk){
+        ProcessChunk( attrib, chunk);
+    });
+
+    // merge chunk vertices in chunk order, which keeps the vertex order of a serial import
+    size_t localCount = 0;
+    for (auto &chunk : chunks)
+    {
+        localCount += chunk.vertices.size();
+    }
+    vertices.clear();
+    vertices.reserve( localCount);
+    std::vector<glm::vec3> tangents;
+    tangents.reserve( localCount);
+    VertexTable table( localCount);
+    for (auto &chunk : chunks)
+    {
+        chunk.remap.resize( chunk.vertices.size());
+        for (size_t i = 0; i < chunk.vertices.size(); i++)
+        {
+            uint32_t index = table.Insert( chunk.vertices[i], chunk.hashes[i], vertices);
+            if (index == tangents.size())
+            {
+                tangents.push_back( glm::vec3( 0.f));
+            }
+            tangents[index] += chunk.tangents[i];
+            chunk.remap[i] = index;
+        }
+        chunk.vertices = std::vector<Vertex>{};
+        chunk.hashes = std::vector<uint64_t>{};
+        chunk.tangents = std::vector<glm::vec3>{};
+    }
+
+    // remap chunk indices to merged vertices
+    indices.resize( indexCount);
+    ForEachChunk( chunks, threadPool, [&indices]( ImportChunk &chunk){
+        for (size_t i = 0; i < chunk.count; i++)
+        {
+            indices[chunk.indexOffset + i] = chunk.remap[ chunk.indices[i]];
+        }
+    });
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        vertices[i].tangent = tangents[i];
+    }
+}
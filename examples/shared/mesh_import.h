@@ -0,0 +1,43 @@
+#pragma once
+
+#include "utility.h"
+#include "util/thread_pool.h"
+
+#include <string_view>
+#include <vector>
+
+
+// open addressing hash table mapping vertices to their index in a vertex array,
+// vertices are hashed and compared by their raw bytes
+class VertexTable {
+
+    public:
+
+        VertexTable( size_t expectedCount = 0);
+
+        static uint64_t Hash( const Vertex &vertex);
+
+        // index of vertex in vertices, vertex is appended if it is not in the table yet
+        uint32_t Insert( const Vertex &vertex, std::vector<Vertex> &vertices);
+        // same as above with precomputed hash
+        uint32_t Insert( const Vertex &vertex, uint64_t hash, std::vector<Vertex> &vertices);
+
+        size_t Size() const;
+
+    private:
+
+        void Grow();
+
+        struct Slot {
+            uint32_t hash;
+            uint32_t index;
+        };
+
+        std::vector<Slot> mSlots;
+        size_t mCount;
+};
+
+
+// load .obj file, deduplicating vertices and accumulating tangents in parallel chunks of triangles if a thread pool is given
+// vertex order and indices match LoadMesh, tangents may differ by rounding since they are summed per chunk
+void ImportMesh( std::string_view meshPath, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, vktg::ThreadPool *threadPool = nullptr);
@@ -0,0 +1,403 @@
+#include "texture_loader.h"
+#include "formats.h"
+#include "utility.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+
+// read little endian value at given file offset
+template<typename T>
+static T Read( const std::vector<uint8_t> &file, size_t offset) {
+
+    if (offset + sizeof(T) > file.size())
+    {
+        throw std::runtime_error( "Unexpected end of texture file!");
+    }
+
+    T value;
+    memcpy( &value, file.data() + offset, sizeof(T));
+
+    return value;
+}
+
+
+static constexpr uint32_t FourCC( char a, char b, char c, char d) {
+
+    return uint32_t(a) | (uint32_t(b) << 8) | (uint32_t(c) << 16) | (uint32_t(d) << 24);
+}
+
+
+vk::Format SelectTranscodeFormat( bool srgb) {
+
+    auto features = vktg::Gpu().getFeatures();
+    auto supported = [&]( vk::Format format) {
+        return bool( vktg::Gpu().getFormatProperties( format).optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage);
+    };
+
+    if (features.textureCompressionBC)
+    {
+        auto format = srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+        if (supported( format))
+        {
+            return format;
+        }
+    }
+    if (features.textureCompressionASTC_LDR)
+    {
+        auto format = srgb ? vk::Format::eAstc4x4SrgbBlock : vk::Format::eAstc4x4UnormBlock;
+        if (supported( format))
+        {
+            return format;
+        }
+    }
+    if (features.textureCompressionETC2)
+    {
+        auto format = srgb ? vk::Format::eEtc2R8G8B8A8SrgbBlock : vk::Format::eEtc2R8G8B8A8UnormBlock;
+        if (supported( format))
+        {
+            return format;
+        }
+    }
+
+    return srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+}
+
+
+// load KTX2 texture
+TextureData LoadKtx2( std::string_view texturePath, const Ktx2Transcoder *transcoder, vktg::ThreadPool *threadPool) {
+
+    auto file = ReadFile( texturePath);
+
+    static const uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    if (file.size() < 80 || memcmp( file.data(), identifier, sizeof(identifier)) != 0)
+    {
+        throw std::runtime_error( "Invalid KTX2 file " + std::string( texturePath) + "!");
+    }
+
+    // header
+    auto vkFormat = (vk::Format)Read<uint32_t>( file, 12);
+    uint32_t pixelWidth = Read<uint32_t>( file, 20);
+    uint32_t pixelHeight = Read<uint32_t>( file, 24);
+    uint32_t pixelDepth = Read<uint32_t>( file, 28);
+    uint32_t layerCount = Read<uint32_t>( file, 32);
+    uint32_t faceCount = Read<uint32_t>( file, 36);
+    uint32_t levelCount = Read<uint32_t>( file, 40);
+    uint32_t supercompressionScheme = Read<uint32_t>( file, 44);
+    uint64_t sgdByteOffset = Read<uint64_t>( file, 64);
+    uint64_t sgdByteLength = Read<uint64_t>( file, 72);
+
+    if (pixelDepth > 1)
+    {
+        throw std::runtime_error( "3D textures are not supported!");
+    }
+    if (faceCount != 1 && faceCount != 6)
+    {
+        throw std::runtime_error( "Invalid face count " + std::to_string( faceCount) + " in KTX2 file " + std::string( texturePath) + "!");
+    }
+    if (sgdByteOffset + sgdByteLength > file.size())
+    {
+        throw std::runtime_error( "Unexpected end of texture file!");
+    }
+
+    TextureData texture;
+    texture.width = pixelWidth;
+    texture.height = std::max( pixelHeight, 1u);
+    texture.mipLevels = std::max( levelCount, 1u);
+    texture.layers = std::max( layerCount, 1u) * faceCount;
+    texture.cubemap = faceCount == 6;
+
+    // level index, level 0 first
+    struct LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+    std::vector<LevelIndex> levels( texture.mipLevels);
+    for (uint32_t level = 0; level < texture.mipLevels; level++)
+    {
+        size_t offset = 80 + 24 * level;
+        levels[level].byteOffset = Read<uint64_t>( file, offset);
+        levels[level].byteLength = Read<uint64_t>( file, offset + 8);
+        levels[level].uncompressedByteLength = Read<uint64_t>( file, offset + 16);
+        if (levels[level].byteOffset + levels[level].byteLength > file.size())
+        {
+            throw std::runtime_error( "Unexpected end of texture file!");
+        }
+    }
+
+    auto levelSize = [&]( uint32_t level) {
+        return vktg::ImageDataSize( texture.format, std::max( texture.width >> level, 1u), std::max( texture.height >> level, 1u), 1, texture.layers);
+    };
+
+    // block-compressed or uncompressed data is copied as is
+    bool transcode = vkFormat == vk::Format::eUndefined || supercompressionScheme != 0;
+    if (!transcode)
+    {
+        texture.format = vkFormat;
+        texture.data.reserve( vktg::ImageDataSize( texture.format, texture.width, texture.height, texture.mipLevels, texture.layers));
+        for (uint32_t level = 0; level < texture.mipLevels; level++)
+        {
+            if (levels[level].byteLength != levelSize( level))
+            {
+                throw std::runtime_error( "Invalid level size in KTX2 file " + std::string( texturePath) + "!");
+            }
+            auto levelData = file.data() + levels[level].byteOffset;
+            texture.data.insert( texture.data.end(), levelData, levelData + levels[level].byteLength);
+        }
+
+        return texture;
+    }
+
+    if (transcoder == nullptr || !transcoder->transcode)
+    {
+        throw std::runtime_error( "KTX2 file " + std::string( texturePath) + " is supercompressed and requires a transcoder!");
+    }
+
+    // supercompressed levels are transcoded independently, on worker threads if available
+    texture.format = vkFormat == vk::Format::eUndefined ? transcoder->targetFormat : vkFormat;
+    std::span<const uint8_t> globalData( file.data() + sgdByteOffset, sgdByteLength);
+    auto transcodeLevel = [&]( uint32_t level) {
+        Ktx2Level levelInfo{
+            std::span<const uint8_t>( file.data() + levels[level].byteOffset, levels[level].byteLength),
+            level,
+            std::max( texture.width >> level, 1u),
+            std::max( texture.height >> level, 1u),
+            texture.layers,
+            levels[level].uncompressedByteLength
+        };
+        auto levelData = transcoder->transcode( levelInfo, globalData, supercompressionScheme, texture.format);
+        if (levelData.size() != levelSize( level))
+        {
+            throw std::runtime_error( "Transcoded level has wrong size!");
+        }
+
+        return levelData;
+    };
+
+    std::vector<std::vector<uint8_t>> levelData( texture.mipLevels);
+    if (threadPool != nullptr)
+    {
+        std::vector<std::future<std::vector<uint8_t>>> results;
+        results.reserve( texture.mipLevels);
+        for (uint32_t level = 0; level < texture.mipLevels; level++)
+        {
+            results.push_back( threadPool->Submit( [&transcodeLevel, level](){ return transcodeLevel( level); }));
+        }
+        // wait for all jobs before rethrowing, they reference local data
+        for (auto &result : results)
+        {
+            result.wait();
+        }
+        for (uint32_t level = 0; level < texture.mipLevels; level++)
+        {
+            levelData[level] = results[level].get();
+        }
+    }
+    else
+    {
+        for (uint32_t level = 0; level < texture.mipLevels; level++)
+        {
+            levelData[level] = transcodeLevel( level);
+        }
+    }
+
+    texture.data.reserve( vktg::ImageDataSize( texture.format, texture.width, texture.height, texture.mipLevels, texture.layers));
+    for (auto &data : levelData)
+    {
+        texture.data.insert( texture.data.end(), data.begin(), data.end());
+    }
+
+    return texture;
+}
+
+
+static vk::Format DxgiToVkFormat( uint32_t dxgiFormat) {
+
+    switch (dxgiFormat)
+    {
+        case 2:  return vk::Format::eR32G32B32A32Sfloat;
+        case 10: return vk::Format::eR16G16B16A16Sfloat;
+        case 28: return vk::Format::eR8G8B8A8Unorm;
+        case 29: return vk::Format::eR8G8B8A8Srgb;
+        case 49: return vk::Format::eR8G8Unorm;
+        case 61: return vk::Format::eR8Unorm;
+        case 71: return vk::Format::eBc1RgbaUnormBlock;
+        case 72: return vk::Format::eBc1RgbaSrgbBlock;
+        case 74: return vk::Format::eBc2UnormBlock;
+        case 75: return vk::Format::eBc2SrgbBlock;
+        case 77: return vk::Format::eBc3UnormBlock;
+        case 78: return vk::Format::eBc3SrgbBlock;
+        case 80: return vk::Format::eBc4UnormBlock;
+        case 81: return vk::Format::eBc4SnormBlock;
+        case 83: return vk::Format::eBc5UnormBlock;
+        case 84: return vk::Format::eBc5SnormBlock;
+        case 87: return vk::Format::eB8G8R8A8Unorm;
+        case 91: return vk::Format::eB8G8R8A8Srgb;
+        case 95: return vk::Format::eBc6HUfloatBlock;
+        case 96: return vk::Format::eBc6HSfloatBlock;
+        case 98: return vk::Format::eBc7UnormBlock;
+        case 99: return vk::Format::eBc7SrgbBlock;
+        default:
+            throw std::runtime_error( "Unsupported DXGI format " + std::to_string( dxgiFormat) + "!");
+    }
+}
+
+
+// load DDS texture
+TextureData LoadDds( std::string_view texturePath, bool srgb) {
+
+    auto file = ReadFile( texturePath);
+    if (file.size() < 128 || Read<uint32_t>( file, 0) != FourCC( 'D', 'D', 'S', ' '))
+    {
+        throw std::runtime_error( "Invalid DDS file " + std::string( texturePath) + "!");
+    }
+
+    // header
+    uint32_t height = Read<uint32_t>( file, 12);
+    uint32_t width = Read<uint32_t>( file, 16);
+    uint32_t mipCount = Read<uint32_t>( file, 28);
+    uint32_t pixelFormatFlags = Read<uint32_t>( file, 80);
+    uint32_t fourCC = Read<uint32_t>( file, 84);
+    uint32_t rgbBitCount = Read<uint32_t>( file, 88);
+    uint32_t redMask = Read<uint32_t>( file, 92);
+    uint32_t caps2 = Read<uint32_t>( file, 112);
+
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDPF_RGB = 0x40;
+    const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+    const uint32_t DDSCAPS2_VOLUME = 0x200000;
+    const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    if (caps2 & DDSCAPS2_VOLUME)
+    {
+        throw std::runtime_error( "3D textures are not supported!");
+    }
+
+    TextureData texture;
+    texture.width = width;
+    texture.height = height;
+    texture.mipLevels = std::max( mipCount, 1u);
+    texture.cubemap = caps2 & DDSCAPS2_CUBEMAP;
+    texture.layers = texture.cubemap ? 6 : 1;
+
+    size_t dataOffset = 128;
+    if ((pixelFormatFlags & DDPF_FOURCC) && fourCC == FourCC( 'D', 'X', '1', '0'))
+    {
+        texture.format = DxgiToVkFormat( Read<uint32_t>( file, 128));
+        texture.cubemap = Read<uint32_t>( file, 136) & DDS_RESOURCE_MISC_TEXTURECUBE;
+        texture.layers = std::max( Read<uint32_t>( file, 140), 1u) * (texture.cubemap ? 6 : 1);
+        dataOffset = 148;
+    }
+    else if (pixelFormatFlags & DDPF_FOURCC)
+    {
+        switch (fourCC)
+        {
+            case FourCC( 'D', 'X', 'T', '1'):
+                texture.format = srgb ? vk::Format::eBc1RgbaSrgbBlock : vk::Format::eBc1RgbaUnormBlock;
+                break;
+            case FourCC( 'D', 'X', 'T', '2'):
+            case FourCC( 'D', 'X', 'T', '3'):
+                texture.format = srgb ? vk::Format::eBc2SrgbBlock : vk::Format::eBc2UnormBlock;
+                break;
+            case FourCC( 'D', 'X', 'T', '4'):
+            case FourCC( 'D', 'X', 'T', '5'):
+                texture.format = srgb ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock;
+                break;
+            case FourCC( 'A', 'T', 'I', '1'):
+            case FourCC( 'B', 'C', '4', 'U'):
+                texture.format = vk::Format::eBc4UnormBlock;
+                break;
+            case FourCC( 'B', 'C', '4', 'S'):
+                texture.format = vk::Format::eBc4SnormBlock;
+                break;
+            case FourCC( 'A', 'T', 'I', '2'):
+            case FourCC( 'B', 'C', '5', 'U'):
+                texture.format = vk::Format::eBc5UnormBlock;
+                break;
+            case FourCC( 'B', 'C', '5', 'S'):
+                texture.format = vk::Format::eBc5SnormBlock;
+                break;
+            // D3DFMT_A16B16G16R16F and D3DFMT_A32B32G32R32F
+            case 113:
+                texture.format = vk::Format::eR16G16B16A16Sfloat;
+                break;
+            case 116:
+                texture.format = vk::Format::eR32G32B32A32Sfloat;
+                break;
+            default:
+                throw std::runtime_error( "Unsupported DDS format in " + std::string( texturePath) + "!");
+        }
+    }
+    else if ((pixelFormatFlags & DDPF_RGB) && rgbBitCount == 32 && (redMask == 0x000000ff || redMask == 0x00ff0000))
+    {
+        bool rgba = redMask == 0x000000ff;
+        if (srgb)
+        {
+            texture.format = rgba ? vk::Format::eR8G8B8A8Srgb : vk::Format::eB8G8R8A8Srgb;
+        }
+        else
+        {
+            texture.format = rgba ? vk::Format::eR8G8B8A8Unorm : vk::Format::eB8G8R8A8Unorm;
+        }
+    }
+    else
+    {
+        throw std::runtime_error( "Unsupported DDS format in " + std::string( texturePath) + "!");
+    }
+
+    // DDS stores all mip levels of one layer after another, reorder to all layers of one mip level after another
+    std::vector<vk::DeviceSize> levelSizes( texture.mipLevels);
+    std::vector<vk::DeviceSize> levelOffsets( texture.mipLevels);
+    vk::DeviceSize layerSize = 0;
+    for (uint32_t mip = 0; mip < texture.mipLevels; mip++)
+    {
+        levelSizes[mip] = vktg::ImageDataSize( texture.format, std::max( texture.width >> mip, 1u), std::max( texture.height >> mip, 1u));
+        levelOffsets[mip] = layerSize * texture.layers;
+        layerSize += levelSizes[mip];
+    }
+    if (dataOffset + layerSize * texture.layers > file.size())
+    {
+        throw std::runtime_error( "Unexpected end of texture file!");
+    }
+
+    texture.data.resize( layerSize * texture.layers);
+    const uint8_t *src = file.data() + dataOffset;
+    for (uint32_t layer = 0; layer < texture.layers; layer++)
+    {
+        for (uint32_t mip = 0; mip < texture.mipLevels; mip++)
+        {
+            memcpy( texture.data.data() + levelOffsets[mip] + layer * levelSizes[mip], src, levelSizes[mip]);
+            src += levelSizes[mip];
+        }
+    }
+
+    return texture;
+}
+
+
+// load texture by file extension
+TextureData LoadTexture( std::string_view texturePath, bool srgb, const Ktx2Transcoder *transcoder, vktg::ThreadPool *threadPool) {
+
+    std::string extension( texturePath.substr( std::min( texturePath.find_last_of( '.'), texturePath.size())));
+    std::transform( extension.begin(), extension.end(), extension.begin(), []( unsigned char c){ return (char)std::tolower( c); });
+
+    if (extension == ".ktx2")
+    {
+        return LoadKtx2( texturePath, transcoder, threadPool);
+    }
+    if (extension == ".dds")
+    {
+        return LoadDds( texturePath, srgb);
+    }
+
+    TextureData texture;
+    texture.format = srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+    texture.data = LoadImage( texturePath, texture.width, texture.height);
+
+    return texture;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "vk_core.h"
+#include "util/thread_pool.h"
+
+#include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+// texture data of all mip levels and layers, packed mip level after mip level as expected by vktg::UploadImageData
+struct TextureData {
+
+    vk::Format format = vk::Format::eUndefined;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 1;
+    uint32_t layers = 1;
+    bool cubemap = false;
+    std::vector<uint8_t> data;
+};
+
+
+// single mip level of a KTX2 file, holding all layers and faces
+struct Ktx2Level {
+
+    std::span<const uint8_t> data;
+    uint32_t level;
+    uint32_t width;
+    uint32_t height;
+    uint32_t layers;
+    uint64_t uncompressedSize;
+};
+
+// decodes supercompressed (BasisLZ, Zstandard) and universal (ETC1S, UASTC) KTX2 data, e.g. with basis_universal
+struct Ktx2Transcoder {
+
+    // format used for universal data without a Vulkan format, should be supported by the device
+    vk::Format targetFormat = vk::Format::eBc7UnormBlock;
+    // returns the packed level data in the given format, called on worker threads for different levels at once
+    std::function<std::vector<uint8_t>(
+        const Ktx2Level &level, std::span<const uint8_t> globalData,
+        uint32_t supercompressionScheme, vk::Format format)> transcode;
+};
+
+// picks the best supported block-compressed format to transcode universal data to, falls back to RGBA8
+vk::Format SelectTranscodeFormat( bool srgb);
+
+
+// load KTX2 texture, supercompressed levels are transcoded in parallel if a thread pool is given
+TextureData LoadKtx2( std::string_view texturePath, const Ktx2Transcoder *transcoder = nullptr, vktg::ThreadPool *threadPool = nullptr);
+
+// load DDS texture with legacy or DX10 header, legacy formats are interpreted as sRGB if requested
+TextureData LoadDds( std::string_view texturePath, bool srgb = true);
+
+// load texture by file extension, other image files are decoded to RGBA8 with a single mip level
+TextureData LoadTexture( std::string_view texturePath, bool srgb = true, const Ktx2Transcoder *transcoder = nullptr, vktg::ThreadPool *threadPool = nullptr);
@@ -6,49 +6,38 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tinyobjloader/tiny_obj_loader.h"
 
+#include <fstream>
+
 
 vk::VertexInputBindingDescription Vertex::getBindingDescription() {
-	
-    auto bindingDescription = vk::VertexInputBindingDescription{}
-        .setBinding( 0 )
-        .setStride( sizeof(Vertex) )
-        .setInputRate( vk::VertexInputRate::eVertex );
-    
-    return bindingDescription;
+
+    return MeshVertexLayout::Binding();
 }
 
 std::vector<vk::VertexInputAttributeDescription> Vertex::getAttributeDescriptions() {
 
-    std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
-    attributeDescriptions.resize( 5);
-    
-    attributeDescriptions[0]
-        .setLocation( 0 )
-        .setBinding( 0 )
-        .setFormat( vk::Format::eR32G32B32Sfloat )
-        .setOffset( offsetof(Vertex, position) );
-    attributeDescriptions[1]
-        .setLocation( 1 )
-        .setBinding( 0 )
-        .setFormat( vk::Format::eR32G32B32A32Sfloat )
-        .setOffset( offsetof(Vertex, color) );
-    attributeDescriptions[2]
-        .setLocation( 2 )
-        .setBinding( 0 )
-        .setFormat( vk::Format::eR32G32Sfloat )
-        .setOffset( offsetof(Vertex, texCoord) );
-    attributeDescriptions[3]
-        .setLocation( 3 )
-        .setBinding( 0 )
-        .setFormat( vk::Format::eR32G32B32Sfloat )
-        .setOffset( offsetof(Vertex, normal) );
-    attributeDescriptions[4]
-        .setLocation( 4 )
-        .setBinding( 0 )
-        .setFormat( vk::Format::eR32G32B32Sfloat )
-        .setOffset( offsetof(Vertex, tangent) );
-    
-    return attributeDescriptions;
+    constexpr auto attributeDescriptions = MeshVertexLayout::Attributes();
+
+    return std::vector<vk::VertexInputAttributeDescription>( attributeDescriptions.begin(), attributeDescriptions.end());
+}
+
+
+// pack vertices
+std::vector<PackedVertex> PackVertices( std::span<const Vertex> vertices) {
+
+    std::vector<PackedVertex> packedVertices( vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const auto &vertex = vertices[i];
+        auto &packed = packedVertices[i];
+        packed.position = vktg::Float3{ vertex.position.x, vertex.position.y, vertex.position.z};
+        packed.color = vktg::PackUnorm8x4( vertex.color.r, vertex.color.g, vertex.color.b, vertex.color.a);
+        packed.texCoord = vktg::PackHalf2( vertex.texCoord.x, vertex.texCoord.y);
+        packed.normal = vktg::PackOctahedral( vktg::Float3{ vertex.normal.x, vertex.normal.y, vertex.normal.z});
+        packed.tangent = vktg::PackOctahedral( vktg::Float3{ vertex.tangent.x, vertex.tangent.y, vertex.tangent.z});
+    }
+
+    return packedVertices;
 }
 
 
@@ -145,4 +134,21 @@ std::vector<uint8_t> LoadImage( std::string_view imagePath, uint32_t &width, uin
     stbi_image_free( pixels);
 
     return imageData;
-}
\ No newline at end of file
+}
+
+
+// read whole file into memory
+std::vector<uint8_t> ReadFile( std::string_view filePath) {
+
+    std::ifstream file( filePath.data(), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        throw std::runtime_error( "Failed to open file " + std::string( filePath) + "!");
+    }
+
+    std::vector<uint8_t> data( (size_t)file.tellg());
+    file.seekg( 0);
+    file.read( reinterpret_cast<char*>( data.data()), data.size());
+
+    return data;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vk_core.h"
+#include "vertex_formats.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -9,9 +10,16 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/hash.hpp>
 
+#include <span>
 #include <vector>
 
 
+// glm vectors as vertex attributes
+template<> struct vktg::VertexAttributeFormat<glm::vec2> { static constexpr vk::Format format = vk::Format::eR32G32Sfloat; };
+template<> struct vktg::VertexAttributeFormat<glm::vec3> { static constexpr vk::Format format = vk::Format::eR32G32B32Sfloat; };
+template<> struct vktg::VertexAttributeFormat<glm::vec4> { static constexpr vk::Format format = vk::Format::eR32G32B32A32Sfloat; };
+
+
 // single mesh vertex data
 struct Vertex {
 
@@ -31,6 +39,27 @@ struct Vertex {
 	}
 };
 
+using MeshVertexLayout = vktg::VertexLayout<glm::vec3, glm::vec4, glm::vec2, glm::vec3, glm::vec3>;
+static_assert( MeshVertexLayout::stride == sizeof(Vertex));
+
+
+// compact mesh vertex, 28 instead of 60 bytes, use with mesh_packed.vert
+struct PackedVertex {
+
+	vktg::Float3 position;
+	vktg::Unorm8x4 color;
+	vktg::Half2 texCoord;
+	vktg::Snorm16x2 normal;
+	vktg::Snorm16x2 tangent;
+};
+
+using PackedVertexLayout = vktg::VertexLayout<vktg::Float3, vktg::Unorm8x4, vktg::Half2, vktg::Snorm16x2, vktg::Snorm16x2>;
+static_assert( PackedVertexLayout::stride == sizeof(PackedVertex));
+
+// pack full float vertices
+std::vector<PackedVertex> PackVertices( std::span<const Vertex> vertices);
+
+
 // custom hash for Vertex type
 namespace std {
 	template<> 
@@ -55,3 +84,6 @@ void LoadMesh(std::string_view meshPath, std::vector<Vertex> &vertices, std::vec
 // load image
 std::vector<uint8_t> LoadImage(std::string_view imagePath, uint32_t &width, uint32_t &height);
 
+
+// read whole file
+std::vector<uint8_t> ReadFile( std::string_view filePath);
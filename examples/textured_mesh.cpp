@@ -1,20 +1,71 @@
 
 #include "vulkantogo.h"
 #include "shared/utility.h"
+#include "shared/texture_loader.h"
+#include "shared/mesh_cache.h"
 
 #include <cmath>
+#include <cstring>
+#include <span>
+#include <string_view>
 #include <vector>
 
 #include <iostream>
 
 
-int main() {
+// usage: textured_mesh [--unoptimized] [--packed] [--meshlets] [texture]
+// prints the average GPU time of the mesh draw on exit, --unoptimized draws the mesh in file order with 32 bit indices for comparison,
+// --packed draws compact 28 byte vertices with mesh_packed.vert instead of full float vertices,
+// --meshlets draws culled meshlets with meshlet.task and meshlet.mesh if mesh shaders are supported,
+// texture can be a KTX2 or DDS file with block-compressed mip levels or any other image file to replace the default texture
+int main( int argc, char **argv) {
+
+    bool optimizeMesh = true;
+    bool packVertices = false;
+    bool useMeshlets = false;
+    std::string_view texturePath = "../res/images/viking_room.png";
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string_view( argv[i]) == "--unoptimized")
+        {
+            optimizeMesh = false;
+        }
+        else if (std::string_view( argv[i]) == "--packed")
+        {
+            packVertices = true;
+        }
+        else if (std::string_view( argv[i]) == "--meshlets")
+        {
+            useMeshlets = true;
+        }
+        else
+        {
+            texturePath = argv[i];
+        }
+    }
+
+    if (useMeshlets)
+    {
+        vktg::Config()->setMeshShaderFeatures = []( vk::PhysicalDeviceMeshShaderFeaturesEXT &features){
+            features.setTaskShader( VK_TRUE ).setMeshShader( VK_TRUE );
+        };
+    }
 
     vktg::StartUp();
 
+    if (useMeshlets && !vktg::MeshShaderEnabled())
+    {
+        std::cout << "mesh shaders are not supported, drawing with the vertex pipeline\n";
+        useMeshlets = false;
+    }
+    // the mesh shader reads full float vertices
+    packVertices = packVertices && !useMeshlets;
+
 
     // deletion stack
     vktg::DeletionStack deletionStack = vktg::DeletionStack{};
+    // swapchains and render targets replaced on resize, destroyed once the frames using them are done
+    vktg::DeferredDeletionQueue retired;
 
 
     // swapchain
@@ -46,7 +97,8 @@ int main() {
     uint32_t maxSetsPerPool = 10;
     std::vector<vk::DescriptorPoolSize> poolSizes = {
         vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, maxSetsPerPool},
-        vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, maxSetsPerPool}
+        vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, maxSetsPerPool},
+        vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, maxSetsPerPool}
     };
     vktg::DescriptorSetAllocator descriptorsetAllocator( poolSizes, maxSetsPerPool);
     vktg::DescriptorLayoutCache descriptorSetLayoutCache;
@@ -88,23 +140,82 @@ int main() {
     });
 
     // model
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    LoadMesh( "../res/models/viking_room.obj", vertices, indices);
+    MappedMesh mesh;
+    LoadCookedMesh( "../res/models/viking_room.obj", mesh, nullptr, optimizeMesh);
+    auto vertices = mesh.Vertices();
+    std::vector<PackedVertex> packedVertices;
+    if (packVertices)
+    {
+        packedVertices = PackVertices( vertices);
+    }
+    auto vertexData = packVertices ? std::as_bytes( std::span<const PackedVertex>{ packedVertices}) : std::as_bytes( vertices);
+    std::cout << "vertex memory = " << vertexData.size_bytes() / 1024 << " KiB\n";
+    auto indexData = mesh.IndexData();
+    uint32_t indexCount = mesh.IndexCount();
+    vk::IndexType indexType = mesh.IndexType();
     vktg::Buffer vertexBuffer, indexBuffer;
-    vktg::CreateBuffer( vertexBuffer, vertices.size() * sizeof(Vertex), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
-    vktg::CreateBuffer( indexBuffer, indices.size() * sizeof(uint32_t), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( vertexBuffer, vertexData.size_bytes(), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst);
+    vktg::CreateBuffer( indexBuffer, indexData.size_bytes(), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst);
     
     deletionStack.Push( [&](){
         vktg::DestroyBuffer( vertexBuffer);
         vktg::DestroyBuffer( indexBuffer);
     });
 
-    // texture
-    uint32_t width, height;
-    auto imgData = LoadImage( "../res/images/viking_room.png", width, height);
+    // meshlets in the optimized index order, each task shader workgroup culls 32 of them
+    vktg::MeshletData meshlets;
+    vktg::Buffer meshletBuffer, boundsBuffer, meshletVertexBuffer, meshletTriangleBuffer;
+    if (useMeshlets)
+    {
+        std::vector<uint32_t> indices( indexCount);
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            if (indexType == vk::IndexType::eUint16)
+            {
+                uint16_t index;
+                memcpy( &index, indexData.data() + i * sizeof(uint16_t), sizeof(uint16_t));
+                indices[i] = index;
+            }
+            else
+            {
+                memcpy( &indices[i], indexData.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+            }
+        }
+        meshlets = vktg::BuildMeshlets( indices, &vertices[0].position.x, sizeof(Vertex), (uint32_t)vertices.size());
+        // triangle bytes are read as uints in meshlet.mesh
+        meshlets.triangles.resize( (meshlets.triangles.size() + 3) / 4 * 4);
+        std::cout << "meshlets = " << meshlets.meshlets.size() << '\n';
+
+        auto storageUsage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+        vktg::CreateBuffer( meshletBuffer, meshlets.meshlets.size() * sizeof(vktg::Meshlet), storageUsage);
+        vktg::CreateBuffer( boundsBuffer, meshlets.bounds.size() * sizeof(vktg::MeshletBounds), storageUsage);
+        vktg::CreateBuffer( meshletVertexBuffer, meshlets.vertices.size() * sizeof(uint32_t), storageUsage);
+        vktg::CreateBuffer( meshletTriangleBuffer, meshlets.triangles.size(), storageUsage);
+
+        deletionStack.Push( [&](){
+            vktg::DestroyBuffer( meshletBuffer);
+            vktg::DestroyBuffer( boundsBuffer);
+            vktg::DestroyBuffer( meshletVertexBuffer);
+            vktg::DestroyBuffer( meshletTriangleBuffer);
+        });
+    }
+
+    // texture, KTX2 and DDS files are loaded with all their mip levels, other images get a generated mip chain
+    auto textureData = LoadTexture( texturePath);
+    bool generateMips = textureData.mipLevels == 1 && !vktg::IsCompressed( textureData.format);
     vktg::Image texture;
-    vktg::CreateImage( texture, width, height, vk::Format::eR8G8B8A8Srgb, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+    vktg::CreateImage( 
+        texture, textureData.width, textureData.height, textureData.format, 
+        vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst, 
+        vk::ImageAspectFlagBits::eColor, 
+        generateMips ? vktg::MipLevelCount( textureData.width, textureData.height) : textureData.mipLevels, textureData.layers
+    );
+
+    auto textureSize = vktg::ImageDataSize( texture.Format(), texture.Width(), texture.Height(), texture.MipLevels(), texture.Layers());
+    auto rgba8Size = vktg::ImageDataSize( vk::Format::eR8G8B8A8Unorm, texture.Width(), texture.Height(), texture.MipLevels(), texture.Layers());
+    // formats like RGBA16F take more memory than RGBA8
+    auto savedSize = (int64_t)rgba8Size - (int64_t)textureSize;
+    std::cout << "texture memory = " << textureSize / 1024 << " KiB, saved " << savedSize / 1024 << " KiB compared to RGBA8\n";
 
     deletionStack.Push( [&](){
         vktg::DestroyImage( texture);
@@ -113,6 +224,7 @@ int main() {
     // sampler
     auto sampler = vktg::SamplerBuilder()
         .SetFilter( vk::Filter::eLinear )
+        .SetMipMapMode( vk::SamplerMipmapMode::eLinear )
         .SetAddressMode( vk::SamplerAddressMode::eClampToBorder )
         .SetBorderColor( vk::BorderColor::eIntOpaqueBlack )
         .Build();
@@ -124,37 +236,79 @@ int main() {
 
     // graphics pipeline
     // shaders
-    auto vertexShader = vktg::LoadShader( "../res/shaders/mesh_vert.spv");
-    auto fragmentShader = vktg::LoadShader( "../res/shaders/texture_frag.spv");
+    auto fragmentShader = vktg::LoadShader( VKTG_SHADER_DIR "texture_frag.spv");
     // descriptor sets
+    vk::ShaderStageFlags geometryStages = useMeshlets ? vk::ShaderStageFlagBits::eTaskEXT | vk::ShaderStageFlagBits::eMeshEXT : vk::ShaderStageFlags( vk::ShaderStageFlagBits::eVertex);
     vk::DescriptorSetLayout cameraDescriptorLayout;
     auto cameraBufferInfo = vktg::GetDescriptorBufferInfo( cameraBuffer.buffer);
     auto cameraDescriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
-        .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex, &cameraBufferInfo )
+        .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, geometryStages, &cameraBufferInfo )
         .Build( &cameraDescriptorLayout );
     vk::DescriptorSetLayout objectDescriptorLayout;
     auto objectBufferInfo = vktg::GetDescriptorBufferInfo( objectBuffer.buffer);
     auto objectDescriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
-        .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex, &objectBufferInfo )
+        .BindBuffer( 0, vk::DescriptorType::eUniformBuffer, geometryStages, &objectBufferInfo )
         .Build( &objectDescriptorLayout );
     vk::DescriptorSetLayout textureDescriptorLayout;
     auto textureInfo = vktg::GetDescriptorImageInfo( texture.imageView, sampler);
     auto textureDescriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
         .BindImage( 0, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment, &textureInfo )
         .Build( &textureDescriptorLayout );
+    vk::DescriptorSetLayout meshletDescriptorLayout;
+    vk::DescriptorSet meshletDescriptor;
+    if (useMeshlets)
+    {
+        auto meshletInfo = vktg::GetDescriptorBufferInfo( meshletBuffer.buffer);
+        auto boundsInfo = vktg::GetDescriptorBufferInfo( boundsBuffer.buffer);
+        auto meshletVertexInfo = vktg::GetDescriptorBufferInfo( meshletVertexBuffer.buffer);
+        auto meshletTriangleInfo = vktg::GetDescriptorBufferInfo( meshletTriangleBuffer.buffer);
+        auto vertexInfo = vktg::GetDescriptorBufferInfo( vertexBuffer.buffer);
+        meshletDescriptor = vktg::DescriptorSetBuilder( &descriptorsetAllocator, &descriptorSetLayoutCache)
+            .BindBuffer( 0, vk::DescriptorType::eStorageBuffer, geometryStages, &meshletInfo )
+            .BindBuffer( 1, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eTaskEXT, &boundsInfo )
+            .BindBuffer( 2, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eMeshEXT, &meshletVertexInfo )
+            .BindBuffer( 3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eMeshEXT, &meshletTriangleInfo )
+            .BindBuffer( 4, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eMeshEXT, &vertexInfo )
+            .Build( &meshletDescriptorLayout );
+    }
     // build pipeline
-    auto vertexAttributes = Vertex::getAttributeDescriptions();
     std::vector<vk::DynamicState> dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
     std::vector<vk::Format> colorattachmentFormats = {renderImage.Format()};
     std::vector<vk::DescriptorSetLayout> descriptorLayouts = {cameraDescriptorLayout, objectDescriptorLayout, textureDescriptorLayout};
-    auto texturedMeshPipeline = vktg::GraphicsPipelineBuilder()
-        .AddShader( vertexShader, vk::ShaderStageFlagBits::eVertex )
+    auto pipelineBuilder = vktg::GraphicsPipelineBuilder();
+    if (useMeshlets)
+    {
+        // no vertex input, the mesh shader fetches vertices from the storage buffers
+        descriptorLayouts.push_back( meshletDescriptorLayout);
+        auto meshletCountConstant = vk::PushConstantRange{ vk::ShaderStageFlagBits::eTaskEXT, 0, sizeof(uint32_t)};
+        pipelineBuilder
+            .AddShader( vktg::LoadShader( VKTG_SHADER_DIR "meshlet_task.spv"), vk::ShaderStageFlagBits::eTaskEXT )
+            .AddShader( vktg::LoadShader( VKTG_SHADER_DIR "meshlet_mesh.spv"), vk::ShaderStageFlagBits::eMeshEXT )
+            .AddPushConstant( meshletCountConstant );
+    }
+    else
+    {
+        auto vertexBinding = packVertices ? PackedVertexLayout::Binding() : Vertex::getBindingDescription();
+        std::vector<vk::VertexInputAttributeDescription> vertexAttributes;
+        if (packVertices)
+        {
+            auto packedAttributes = PackedVertexLayout::Attributes();
+            vertexAttributes.assign( packedAttributes.begin(), packedAttributes.end());
+        }
+        else
+        {
+            vertexAttributes = Vertex::getAttributeDescriptions();
+        }
+        pipelineBuilder
+            .AddShader( vktg::LoadShader( packVertices ? VKTG_SHADER_DIR "mesh_packed_vert.spv" : VKTG_SHADER_DIR "mesh_vert.spv"), vk::ShaderStageFlagBits::eVertex )
+            .SetVertexInputBindng( vertexBinding )
+            .SetVertexAttributes( vertexAttributes )
+            .SetInputAssembly( vk::PrimitiveTopology::eTriangleList );
+    }
+    auto texturedMeshPipeline = pipelineBuilder
         .AddShader( fragmentShader, vk::ShaderStageFlagBits::eFragment )
         .AddDescriptorLayouts( descriptorLayouts )
         .SetDynamicStates( dynamicStates )
-        .SetVertexInputBindng( Vertex::getBindingDescription() )
-        .SetVertexAttributes( vertexAttributes )
-        .SetInputAssembly( vk::PrimitiveTopology::eTriangleList )
         .SetPolygonMode( vk::PolygonMode::eFill )
         .SetCulling( vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise )
         .EnableDepth()
@@ -169,20 +323,34 @@ int main() {
     });
 
     // cleanup shader modules immediately, no longer needed
-    vktg::DestroyShaderModule( vertexShader);
-    vktg::DestroyShaderModule( fragmentShader);
+    for (auto &shaderInfo : pipelineBuilder.shaderInfos)
+    {
+        vktg::DestroyShaderModule( shaderInfo.module);
+    }
 
     // upload data to gpu
     vktg::Buffer vertexStaging;
-    vktg::CreateStagingBuffer( vertexStaging, vertices.size() * sizeof(Vertex), vertices.data());
+    vktg::CreateStagingBuffer( vertexStaging, vertexData.size_bytes(), vertexData.data());
     vktg::Buffer indexStaging;
-    vktg::CreateStagingBuffer( indexStaging, indices.size() * sizeof(uint32_t), indices.data());
+    vktg::CreateStagingBuffer( indexStaging, indexData.size_bytes(), indexData.data());
+    std::vector<vktg::Buffer> meshletStaging;
+    if (useMeshlets)
+    {
+        meshletStaging.resize( 4);
+        vktg::CreateStagingBuffer( meshletStaging[0], meshletBuffer.Size(), meshlets.meshlets.data());
+        vktg::CreateStagingBuffer( meshletStaging[1], boundsBuffer.Size(), meshlets.bounds.data());
+        vktg::CreateStagingBuffer( meshletStaging[2], meshletVertexBuffer.Size(), meshlets.vertices.data());
+        vktg::CreateStagingBuffer( meshletStaging[3], meshletTriangleBuffer.Size(), meshlets.triangles.data());
+    }
+    uint32_t meshletCount = (uint32_t)meshlets.meshlets.size();
+    meshlets = vktg::MeshletData{};
+    // mesh data lives in staging memory now
+    mesh.Close();
+    packedVertices.clear();
     vktg::Buffer cameraStaging;
     vktg::CreateStagingBuffer( cameraStaging, sizeof(CameraData), &camera);
     vktg::Buffer objectStaging;
     vktg::CreateStagingBuffer( objectStaging, sizeof(ObjectData), &object);
-    vktg::Buffer textureStaging;
-    vktg::CreateStagingBuffer( textureStaging, imgData.size() * sizeof(uint8_t), imgData.data());
 
     deletionStack.Push( [=](){
         vktg::DestroyBuffer( cameraStaging);
@@ -197,31 +365,58 @@ int main() {
     transferSubmit.Begin();
         vktg::CopyBuffer( transferSubmit.cmd, vertexStaging.buffer, vertexBuffer.buffer, vertexStaging.Size());
         vktg::CopyBuffer( transferSubmit.cmd, indexStaging.buffer, indexBuffer.buffer, indexStaging.Size());
+        if (useMeshlets)
+        {
+            vktg::CopyBuffer( transferSubmit.cmd, meshletStaging[0].buffer, meshletBuffer.buffer, meshletStaging[0].Size());
+            vktg::CopyBuffer( transferSubmit.cmd, meshletStaging[1].buffer, boundsBuffer.buffer, meshletStaging[1].Size());
+            vktg::CopyBuffer( transferSubmit.cmd, meshletStaging[2].buffer, meshletVertexBuffer.buffer, meshletStaging[2].Size());
+            vktg::CopyBuffer( transferSubmit.cmd, meshletStaging[3].buffer, meshletTriangleBuffer.buffer, meshletStaging[3].Size());
+        }
         vktg::CopyBuffer( transferSubmit.cmd, cameraStaging.buffer, cameraBuffer.buffer, cameraStaging.Size());
         vktg::CopyBuffer( transferSubmit.cmd, objectStaging.buffer, objectBuffer.buffer, objectStaging.Size());
-        vktg::TransitionImageLayout( 
-            transferSubmit.cmd, texture.image, 
-            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-            vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
-            vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
-        );
-        vktg::CopyBufferToImage( transferSubmit.cmd, textureStaging.buffer, texture.image, 0, texture.Width(), texture.Height());
-        vktg::TransitionImageLayout( 
-            transferSubmit.cmd, texture.image, 
-            vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
-            vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
-            vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
-        );
     transferSubmit.End();
     transferSubmit.Submit();
 
+    if (generateMips)
+    {
+        // texture upload and mip generation on the graphics queue, blits are not supported on transfer queues
+        vktg::Buffer textureStaging;
+        vktg::CreateStagingBuffer( textureStaging, textureData.data.size(), textureData.data.data());
+
+        vktg::SubmitContext graphicsSubmit = vktg::CreateSubmitContext( vktg::QueueType::eGraphics);
+        graphicsSubmit.Begin();
+            // old layouts and source stages are taken from the tracked texture state
+            vktg::Transition( 
+                graphicsSubmit.cmd, texture, 
+                vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal},
+                vk::ImageSubresourceRange{ {}, 0, 1, 0, 1}
+            );
+            vktg::CopyBufferToImage( graphicsSubmit.cmd, textureStaging.buffer, texture.image, 0, texture.Width(), texture.Height());
+            vktg::GenerateMipmaps( graphicsSubmit.cmd, texture);
+        graphicsSubmit.End();
+        graphicsSubmit.Submit();
+        vktg::WaitForFence( graphicsSubmit.fence);
+
+        vktg::DestroySubmitContext( graphicsSubmit);
+        vktg::DestroyBuffer( textureStaging);
+    }
+    else
+    {
+        // all mip levels with a single copy
+        vktg::UploadImageData( textureData.data.data(), texture);
+    }
+    textureData.data.clear();
+
     // wait for data transfer to complete
     vktg::WaitForFence( transferSubmit.fence);
 
     // cleanup staging buffers that are no longer needed
     vktg::DestroyBuffer( vertexStaging);
     vktg::DestroyBuffer( indexStaging);
-    vktg::DestroyBuffer( textureStaging);
+    for (auto &staging : meshletStaging)
+    {
+        vktg::DestroyBuffer( staging);
+    }
 
 
     // frame resources
@@ -255,6 +450,14 @@ int main() {
         frame.commandbuffer = vktg::AllocateCommandBuffer( frame.commandPool);
     }
 
+    // gpu time of the mesh draw
+    vktg::GpuProfiler gpuProfiler( frameOverlap);
+    deletionStack.Push( [&](){
+        gpuProfiler.Destroy();
+    });
+    double drawTimeSum = 0.0;
+    uint64_t drawTimeCount = 0;
+
 
     // render loop
     while (!glfwWindowShouldClose( vktg::Window())) 
@@ -265,11 +468,9 @@ int main() {
         // recreate swapchain and render image if outdated
         if (!swapchain.isValid)
         {
-        	vktg::WaitIdle();
-
-            vktg::CreateSwapchain( swapchain);
-            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height());
-            vktg::ResizeImage( depthImage, swapchain.Width(), swapchain.Height());
+            vktg::CreateSwapchain( swapchain, &retired, frameCount);
+            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height(), &retired, frameCount);
+            vktg::ResizeImage( depthImage, swapchain.Width(), swapchain.Height(), &retired, frameCount);
         }
 
 
@@ -294,14 +495,20 @@ int main() {
             
         // wait for render fence to record render commands
         vktg::WaitForFence( frame.renderFence);
-        vktg::ResetFence( frame.renderFence);
-            
-        // get next swapchain image
+
+        // destroy what was retired before the frames in flight started
+        if (frameCount >= frameOverlap)
+        {
+            retired.Flush( frameCount - frameOverlap);
+        }
+
+        // get next swapchain image, the fence is only reset once this frame is sure to signal it
         uint32_t imageIndex;
         if (!vktg::NextSwapchainImage( swapchain, frame.renderSemaphore, &imageIndex))
         {
             continue;
         }
+        vktg::ResetFence( frame.renderFence);
 
         // record render commands
         auto cmd = frame.commandbuffer;
@@ -310,6 +517,14 @@ int main() {
             .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
         VK_CHECK( cmd.begin( &commandBeginInfo) );
 
+            // read draw time of the last submit of this frame, complete since its fence is signaled
+            gpuProfiler.BeginFrame( cmd);
+            for (auto &zone : gpuProfiler.Results())
+            {
+                drawTimeSum += zone.milliseconds;
+                drawTimeCount++;
+            }
+
             // geometry draw
             vktg::TransitionImageLayout( 
                 cmd, renderImage.image, 
@@ -323,13 +538,16 @@ int main() {
             auto renderingInfo = vktg::CreateRenderingInfo( swapchain.extent, colorAttachments, &depthAttachment);
             cmd.beginRendering( renderingInfo);
 
-                size_t offset = 0;
-                cmd.bindVertexBuffers2( 0, 1, &vertexBuffer.buffer, &offset, nullptr, nullptr);
-                cmd.bindIndexBuffer( indexBuffer.buffer, 0, vk::IndexType::eUint32);
+                if (!useMeshlets)
+                {
+                    size_t offset = 0;
+                    cmd.bindVertexBuffers2( 0, 1, &vertexBuffer.buffer, &offset, nullptr, nullptr);
+                    cmd.bindIndexBuffer( indexBuffer.buffer, 0, indexType);
+                }
 
                 cmd.bindPipeline( vk::PipelineBindPoint::eGraphics, texturedMeshPipeline.pipeline);
-                vk::DescriptorSet descriptors[] = {cameraDescriptor, objectDescriptor, textureDescriptor};
-                cmd.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, texturedMeshPipeline.pipelineLayout, 0, 3, descriptors, 0, nullptr);
+                vk::DescriptorSet descriptors[] = {cameraDescriptor, objectDescriptor, textureDescriptor, meshletDescriptor};
+                cmd.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, texturedMeshPipeline.pipelineLayout, 0, useMeshlets ? 4 : 3, descriptors, 0, nullptr);
                 
                 //set dynamic viewport and scissor
                 vk::Viewport viewport = vktg::CreateViewport( 0.f, 0.f, renderImage.Width(), renderImage.Height(), 0.f, 1.f);
@@ -337,25 +555,38 @@ int main() {
                 cmd.setViewport( 0, 1, &viewport);
                 cmd.setScissor( 0, 1, &scissor);
 
-                cmd.drawIndexed( (uint32_t)indices.size(), 1, 0, 0, 0);
+                gpuProfiler.BeginZone( cmd, "mesh draw");
+                if (useMeshlets)
+                {
+                    cmd.pushConstants( texturedMeshPipeline.pipelineLayout, vk::ShaderStageFlagBits::eTaskEXT, 0, sizeof(uint32_t), &meshletCount);
+                    cmd.drawMeshTasksEXT( (meshletCount + 31) / 32, 1, 1);
+                }
+                else
+                {
+                    cmd.drawIndexed( indexCount, 1, 0, 0, 0);
+                }
+                gpuProfiler.EndZone( cmd, vk::PipelineStageFlagBits2::eAllGraphics);
 
 
             cmd.endRendering();
 
 
             // copy render image to swapchain
+            // both transitions are recorded with a single pipeline barrier
+            vktg::BarrierBatch copyBarriers;
             vktg::TransitionImageLayout( 
-                cmd, renderImage.image, 
+                copyBarriers, renderImage.image, 
                 vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal,
                 vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead
             );
             vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], 
+                copyBarriers, swapchain.images[imageIndex], 
                 vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
                 vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
             );
+            copyBarriers.Flush( cmd);
             vktg::CopyImage( 
                 cmd, renderImage.image, swapchain.images[imageIndex],
                 vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{renderImage.Width(), renderImage.Height()}},
@@ -364,7 +595,7 @@ int main() {
 
             // transition swapchain image to present optimal layout
             vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR,
+                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, swapchain.presentLayout,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
                 vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
             );
@@ -399,6 +630,12 @@ int main() {
 
     // cleanup
 	vktg::WaitIdle();
+    retired.FlushAll();
+
+    if (drawTimeCount > 0)
+    {
+        std::cout << (optimizeMesh ? "Optimized" : "Unoptimized") << (useMeshlets ? " meshlet" : "") << " mesh draw time: " << drawTimeSum / drawTimeCount << " ms average over " << drawTimeCount << " frames\n";
+    }
 
     deletionStack.Flush();
     vktg::DestroyImage( renderImage);
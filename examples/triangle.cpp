@@ -12,6 +12,8 @@ int main() {
 
     // deletion stack
     vktg::DeletionStack deletionStack = vktg::DeletionStack{};
+    // swapchains and render targets replaced on resize, destroyed once the frames using them are done
+    vktg::DeferredDeletionQueue retired;
 
 
     // swapchain
@@ -28,8 +30,8 @@ int main() {
 
 
     // graphics pipeline
-    auto vertexShader = vktg::LoadShader( "../res/shaders/triangle_vert.spv");
-    auto fragmentShader = vktg::LoadShader( "../res/shaders/triangle_frag.spv");
+    auto vertexShader = vktg::LoadShader( VKTG_SHADER_DIR "triangle_vert.spv");
+    auto fragmentShader = vktg::LoadShader( VKTG_SHADER_DIR "triangle_frag.spv");
     std::vector<vk::DynamicState> dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
     std::vector<vk::Format> colorattachmentFormats = {renderImage.imageInfo.format};
     auto trianglePipeline = vktg::GraphicsPipelineBuilder()
@@ -92,10 +94,8 @@ int main() {
         // recreate swapchain and render image if outdated
         if (!swapchain.isValid)
         {
-        	vktg::WaitIdle();
-
-            vktg::CreateSwapchain( swapchain);
-            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height());
+            vktg::CreateSwapchain( swapchain, &retired, frameCount);
+            vktg::ResizeImage( renderImage, swapchain.Width(), swapchain.Height(), &retired, frameCount);
         }
 
         // get current frame
@@ -103,14 +103,20 @@ int main() {
             
         // wait for render fence to record render commands
         vktg::WaitForFence( frame.renderFence);
-        vktg::ResetFence( frame.renderFence);
+
+        // destroy what was retired before the frames in flight started
+        if (frameCount >= frameOverlap)
+        {
+            retired.Flush( frameCount - frameOverlap);
+        }
             
-        // get next swapchain image
+        // get next swapchain image, the fence is only reset once this frame is sure to signal it
         uint32_t imageIndex;
         if (!vktg::NextSwapchainImage( swapchain, frame.renderSemaphore, &imageIndex))
         {
             continue;
         }
+        vktg::ResetFence( frame.renderFence);
 
         // record render commands
         auto cmd = frame.commandbuffer;
@@ -146,18 +152,21 @@ int main() {
 
 
             // copy render image to swapchain
+            // both transitions are recorded with a single pipeline barrier
+            vktg::BarrierBatch copyBarriers;
             vktg::TransitionImageLayout( 
-                cmd, renderImage.image, 
+                copyBarriers, renderImage.image, 
                 vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal,
                 vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead
             );
             vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], 
+                copyBarriers, swapchain.images[imageIndex], 
                 vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
                 vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite
             );
+            copyBarriers.Flush( cmd);
             vktg::CopyImage( 
                 cmd, renderImage.image, swapchain.images[imageIndex],
                 vk::Rect2D{vk::Offset2D{0, 0}, vk::Extent2D{renderImage.Width(), renderImage.Height()}},
@@ -166,7 +175,7 @@ int main() {
 
             // transition swapchain image to present optimal layout
             vktg::TransitionImageLayout( 
-                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR,
+                cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, swapchain.presentLayout,
                 vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
                 vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone
             );
@@ -198,6 +207,7 @@ int main() {
 
     // cleanup
 	vktg::WaitIdle();
+    retired.FlushAll();
 
     deletionStack.Flush();
     vktg::DestroyImage( renderImage);
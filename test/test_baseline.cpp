@@ -0,0 +1,140 @@
+
+#include <catch2/catch.hpp>
+
+#include "../bench/baseline.h"
+#include "../vulkantogo/util/json.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+static std::string WriteBaselineFile( const std::string &content) {
+
+    auto path = (std::filesystem::temp_directory_path() / "vktg_test_baselines.json").string();
+    std::ofstream file( path);
+    file << content;
+
+    return path;
+}
+
+
+static BenchmarkResult Result( const std::string &name, double medianNs) {
+
+    return BenchmarkResult{ name, 10, 0, medianNs, medianNs, medianNs, medianNs, 0.0};
+}
+
+
+TEST_CASE( "load baselines", "[baseline]") {
+
+    Baselines baselines;
+    REQUIRE_FALSE( baselines.Load( (std::filesystem::temp_directory_path() / "vktg_test_missing_baselines.json").string()) );
+
+    auto path = WriteBaselineFile( R"({
+        "gpu a / driver 1 / release": { "scenario/mesh": 1000.0, "scenario/\"quoted\"": 2e3 },
+        "gpu b / driver 2 / debug": {}
+    })");
+    REQUIRE( baselines.Load( path) );
+    REQUIRE( baselines.HasMachine( "gpu a / driver 1 / release") );
+    REQUIRE_FALSE( baselines.HasMachine( "gpu b / driver 2 / debug") );
+    REQUIRE_FALSE( baselines.HasMachine( "gpu c") );
+
+    auto comparisons = baselines.Compare( "gpu a / driver 1 / release", { Result( "scenario/mesh", 1000.0), Result( "scenario/\"quoted\"", 2000.0)}, 0.1);
+    REQUIRE( comparisons[0].baselineNs == 1000.0 );
+    REQUIRE( comparisons[1].baselineNs == 2000.0 );
+
+    // saved and loaded again unchanged
+    REQUIRE( baselines.Save( path) );
+    Baselines reloaded;
+    REQUIRE( reloaded.Load( path) );
+    REQUIRE( reloaded.Compare( "gpu a / driver 1 / release", { Result( "scenario/\"quoted\"", 2000.0)}, 0.1)[0].baselineNs == 2000.0 );
+
+    std::filesystem::remove( path);
+}
+
+
+TEST_CASE( "escape control characters in JSON strings", "[baseline]") {
+
+    std::ostringstream out;
+    vktg::AppendJsonString( out, std::string( "a\"b\\c\nd\te\x01" "f\x1f", 12));
+    REQUIRE( out.str() == R"("a\"b\\c\nd\te\u0001f\u001f")" );
+
+    // names with control characters are saved as valid JSON and loaded back unchanged
+    std::string machine = "gpu\x02 / driver 1\n";
+    std::string name = "scenario/\ttab\x1b";
+    Baselines baselines;
+    baselines.Update( machine, { Result( name, 500.0)});
+    auto path = WriteBaselineFile( "");
+    REQUIRE( baselines.Save( path) );
+
+    std::ifstream file( path);
+    std::string content( (std::istreambuf_iterator<char>( file)), std::istreambuf_iterator<char>());
+    for (char c : content)
+    {
+        REQUIRE( ((unsigned char)c >= 0x20 || c == '\n' || c == ' ') );
+    }
+
+    Baselines reloaded;
+    REQUIRE( reloaded.Load( path) );
+    REQUIRE( reloaded.HasMachine( machine) );
+    REQUIRE( reloaded.Compare( machine, { Result( name, 500.0)}, 0.1)[0].baselineNs == 500.0 );
+
+    std::filesystem::remove( path);
+}
+
+
+TEST_CASE( "reject malformed baselines", "[baseline]") {
+
+    std::vector<std::string> malformed = {
+        "",
+        "[]",
+        R"({ "gpu a": { "scenario/mesh" 1000 } })",
+        R"({ "gpu a": { "scenario/mesh": fast } })",
+        R"({ "gpu a": { "scenario/mesh": 1000 })",
+        R"({ "gpu a": { "scenario/mesh": 1000 } } trailing)",
+        R"({ "gpu a": { "scenario/mesh)",
+        R"({ "gpu a": 1000 })",
+    };
+    for (auto &content : malformed)
+    {
+        auto path = WriteBaselineFile( content);
+        Baselines baselines;
+        INFO( content);
+        REQUIRE_THROWS( baselines.Load( path) );
+        std::filesystem::remove( path);
+    }
+}
+
+
+TEST_CASE( "compare against baselines", "[baseline]") {
+
+    Baselines baselines;
+    baselines.Update( "gpu a", { Result( "slower", 100.0), Result( "edge", 100.0), Result( "faster", 100.0), Result( "zero", 0.0)});
+
+    auto comparisons = baselines.Compare( "gpu a", {
+        Result( "slower", 110.5), Result( "edge", 110.0), Result( "faster", 50.0), Result( "zero", 10.0), Result( "new", 10.0)
+    }, 0.1);
+    REQUIRE( comparisons.size() == 5 );
+
+    // slower than the threshold allows
+    REQUIRE( comparisons[0].regressed );
+    REQUIRE( comparisons[0].change == Approx( 0.105) );
+    // exactly at the threshold still passes
+    REQUIRE_FALSE( comparisons[1].regressed );
+    REQUIRE_FALSE( comparisons[2].regressed );
+    REQUIRE( comparisons[2].change == Approx( -0.5) );
+    // no usable baseline, reported as new
+    REQUIRE_FALSE( comparisons[3].regressed );
+    REQUIRE( comparisons[3].baselineNs == 0.0 );
+    REQUIRE_FALSE( comparisons[4].regressed );
+    REQUIRE( comparisons[4].baselineNs == 0.0 );
+
+    // a zero threshold fails on any slow down
+    REQUIRE( baselines.Compare( "gpu a", { Result( "edge", 100.001)}, 0.0)[0].regressed );
+    REQUIRE_FALSE( baselines.Compare( "gpu a", { Result( "edge", 100.0)}, 0.0)[0].regressed );
+
+    // other machines have no baselines
+    REQUIRE( baselines.Compare( "gpu b", { Result( "slower", 1000.0)}, 0.1)[0].baselineNs == 0.0 );
+}
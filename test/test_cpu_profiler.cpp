@@ -0,0 +1,130 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/util/cpu_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+
+static std::vector<vktg::CpuProfileEvent> EventsNamed( const char *name) {
+
+    auto events = vktg::CpuProfiler::Events();
+    std::erase_if( events, [name]( const vktg::CpuProfileEvent &event){ return std::strcmp( event.name, name) != 0; });
+
+    return events;
+}
+
+
+TEST_CASE( "cpu zones", "[util, cpu_profiler]") {
+
+    vktg::CpuProfiler::Clear();
+    {
+        vktg::CpuProfileZone outer( "test outer");
+        {
+            vktg::CpuProfileZone inner( "test inner");
+        }
+        vktg::CpuProfiler::Marker( "test marker", 7);
+    }
+
+    auto outer = EventsNamed( "test outer");
+    auto inner = EventsNamed( "test inner");
+    auto marker = EventsNamed( "test marker");
+    REQUIRE( outer.size() == 1 );
+    REQUIRE( inner.size() == 1 );
+    REQUIRE( marker.size() == 1 );
+
+    REQUIRE( outer[0].type == vktg::CpuProfileEvent::Type::eZone );
+    REQUIRE( outer[0].depth == 0 );
+    REQUIRE( inner[0].depth == 1 );
+    REQUIRE( inner[0].thread == outer[0].thread );
+    REQUIRE( inner[0].start >= outer[0].start );
+    REQUIRE( inner[0].start + inner[0].duration <= outer[0].start + outer[0].duration );
+    REQUIRE( marker[0].type == vktg::CpuProfileEvent::Type::eMarker );
+    REQUIRE( marker[0].value == 7 );
+
+    vktg::CpuProfiler::Clear();
+    REQUIRE( EventsNamed( "test outer").empty() );
+}
+
+
+TEST_CASE( "cpu zones while disabled", "[util, cpu_profiler]") {
+
+    vktg::CpuProfiler::Clear();
+    vktg::CpuProfiler::Enable( false);
+    vktg::CpuProfiler::BeginZone( "test disabled");
+    vktg::CpuProfiler::Enable( true);
+    vktg::CpuProfiler::EndZone();
+
+    REQUIRE( EventsNamed( "test disabled").empty() );
+}
+
+
+TEST_CASE( "cpu zones on multiple threads", "[util, cpu_profiler]") {
+
+    vktg::CpuProfiler::Clear();
+    std::thread thread( [](){
+        vktg::CpuProfiler::SetThreadName( "test thread");
+        vktg::CpuProfileZone zone( "test thread zone");
+    });
+    thread.join();
+    {
+        vktg::CpuProfileZone zone( "test main zone");
+    }
+
+    auto threadZone = EventsNamed( "test thread zone");
+    auto mainZone = EventsNamed( "test main zone");
+    REQUIRE( threadZone.size() == 1 );
+    REQUIRE( mainZone.size() == 1 );
+    REQUIRE( threadZone[0].thread != mainZone[0].thread );
+    REQUIRE( vktg::CpuProfiler::ThreadNames()[threadZone[0].thread] == "test thread" );
+
+    auto trace = vktg::CpuProfiler::ChromeTrace();
+    REQUIRE( trace.find( "\"traceEvents\"") != std::string::npos );
+    REQUIRE( trace.find( "\"test thread zone\"") != std::string::npos );
+    REQUIRE( trace.find( "\"test thread\"") != std::string::npos );
+}
+
+
+TEST_CASE( "cpu profiler ring overflow", "[util, cpu_profiler]") {
+
+    vktg::CpuProfiler::Clear();
+    for (uint32_t i = 0; i < vktg::CpuProfiler::ringSize + 10; i++)
+    {
+        vktg::CpuProfileZone zone( "test overflow");
+    }
+
+    // the oldest events are overwritten
+    auto events = EventsNamed( "test overflow");
+    REQUIRE( events.size() == vktg::CpuProfiler::ringSize );
+    REQUIRE( std::is_sorted( events.begin(), events.end(), []( auto &a, auto &b){ return a.start < b.start; }) );
+}
+
+
+TEST_CASE( "collect cpu events while recording", "[util, cpu_profiler]") {
+
+    vktg::CpuProfiler::Clear();
+    std::atomic<bool> done{ false};
+    std::thread thread( [&done](){
+        // several times the ring size, so slots are overwritten while they are collected
+        for (uint64_t i = 0; i < 8 * vktg::CpuProfiler::ringSize; i++)
+        {
+            vktg::CpuProfiler::Marker( "test concurrent", i);
+        }
+        done = true;
+    });
+
+    // a torn copy would mix the value of one marker with the start time of another
+    bool ordered = true;
+    while (!done)
+    {
+        auto events = EventsNamed( "test concurrent");
+        for (size_t i = 1; i < events.size(); i++)
+        {
+            ordered = ordered && events[i].value > events[i - 1].value;
+        }
+    }
+    thread.join();
+    REQUIRE( ordered );
+}
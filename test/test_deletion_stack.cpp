@@ -0,0 +1,76 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/util/deletion_stack.h"
+
+
+TEST_CASE("deferred deletion queue", "[util, deletion_stack]") {
+
+    vktg::DeferredDeletionQueue queue;
+    std::vector<int> deleted;
+    queue.Push( 3, [&](){ deleted.push_back( 0); });
+    queue.Push( 3, [&](){ deleted.push_back( 1); });
+    queue.Push( 5, [&](){ deleted.push_back( 2); });
+
+    REQUIRE( queue.Size() == 3 );
+
+    // nothing retired yet
+    queue.Flush( 2);
+    REQUIRE( deleted.empty() );
+
+    // objects of a frame are deleted in order of submission
+    queue.Flush( 3);
+    REQUIRE( deleted == std::vector<int>{ 0, 1} );
+    REQUIRE( queue.Size() == 1 );
+
+    queue.FlushAll();
+    REQUIRE( deleted == std::vector<int>{ 0, 1, 2} );
+    REQUIRE( queue.Size() == 0 );
+}
+
+
+TEST_CASE("deferred deletion across frames in flight", "[util, deletion_stack]") {
+
+    const uint64_t frameOverlap = 2;
+    vktg::DeferredDeletionQueue queue;
+    std::vector<uint64_t> deleted;
+
+    // retire one object per frame and flush like the render loop after waiting for the frame fence
+    for (uint64_t frame = 0; frame < 8; frame++)
+    {
+        if (frame >= frameOverlap)
+        {
+            queue.Flush( frame - frameOverlap);
+        }
+
+        // only objects of frames no longer in flight are deleted
+        for (auto deletedFrame : deleted)
+        {
+            REQUIRE( deletedFrame + frameOverlap <= frame );
+        }
+        REQUIRE( deleted.size() == (frame >= frameOverlap ? frame - frameOverlap + 1 : 0) );
+        REQUIRE( queue.Size() == frame - deleted.size() );
+
+        queue.Push( frame, [&deleted, frame](){ deleted.push_back( frame); });
+    }
+
+    queue.FlushAll();
+    REQUIRE( deleted == std::vector<uint64_t>{ 0, 1, 2, 3, 4, 5, 6, 7} );
+}
+
+
+TEST_CASE("deferred deletion of an older frame is not called early", "[util, deletion_stack]") {
+
+    vktg::DeferredDeletionQueue queue;
+    std::vector<int> deleted;
+    queue.Push( 5, [&](){ deleted.push_back( 0); });
+    queue.Push( 2, [&](){ deleted.push_back( 1); });
+
+    // the older frame waits for the frame pushed before it, also when that frame is flushed first
+    queue.Flush( 2);
+    REQUIRE( deleted.empty() );
+    REQUIRE( queue.Size() == 2 );
+
+    queue.Flush( 5);
+    REQUIRE( deleted == std::vector<int>{ 0, 1} );
+    REQUIRE( queue.Size() == 0 );
+}
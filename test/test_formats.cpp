@@ -0,0 +1,38 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/formats.h"
+
+
+TEST_CASE( "format info", "[formats]") {
+
+    auto rgba = vktg::GetFormatInfo( vk::Format::eR8G8B8A8Srgb);
+    REQUIRE( rgba.blockSize == 4 );
+    REQUIRE( rgba.blockWidth == 1 );
+    REQUIRE( rgba.blockHeight == 1 );
+    REQUIRE( vktg::GetFormatInfo( vk::Format::eR32G32B32A32Sfloat).blockSize == 16 );
+    REQUIRE_FALSE( vktg::IsCompressed( vk::Format::eD32Sfloat) );
+
+    auto bc1 = vktg::GetFormatInfo( vk::Format::eBc1RgbaUnormBlock);
+    REQUIRE( bc1.blockSize == 8 );
+    REQUIRE( bc1.blockWidth == 4 );
+    REQUIRE( bc1.blockHeight == 4 );
+    REQUIRE( vktg::IsCompressed( vk::Format::eBc7SrgbBlock) );
+
+    auto astc = vktg::GetFormatInfo( vk::Format::eAstc10x6UnormBlock);
+    REQUIRE( astc.blockSize == 16 );
+    REQUIRE( astc.blockWidth == 10 );
+    REQUIRE( astc.blockHeight == 6 );
+
+    REQUIRE_THROWS( vktg::GetFormatInfo( vk::Format::eUndefined) );
+}
+
+
+TEST_CASE( "image data size", "[formats]") {
+
+    REQUIRE( vktg::ImageDataSize( vk::Format::eR8G8B8A8Unorm, 16, 16) == 16 * 16 * 4 );
+    // 8x8 + 4x4 + 2x2 + 1x1 texels, 3 layers
+    REQUIRE( vktg::ImageDataSize( vk::Format::eR16Sfloat, 8, 8, 4, 3) == (64 + 16 + 4 + 1) * 2 * 3 );
+    // partial blocks are rounded up, mip levels smaller than a block still take a whole block
+    REQUIRE( vktg::ImageDataSize( vk::Format::eBc1RgbUnormBlock, 10, 6) == 3 * 2 * 8 );
+    REQUIRE( vktg::ImageDataSize( vk::Format::eBc7UnormBlock, 8, 8, 4) == (4 + 1 + 1 + 1) * 16 );
+}
@@ -0,0 +1,148 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/util/frame_handler.h"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+
+TEST_CASE( "rolling stats", "[util, frame_handler]") {
+
+    vktg::RollingStats stats;
+    REQUIRE( stats.Count() == 0 );
+    REQUIRE( stats.Average() == 0.0 );
+
+    stats.Add( 2.0);
+    stats.Add( 4.0);
+    REQUIRE( stats.Count() == 2 );
+    REQUIRE( stats.Last() == 4.0 );
+    REQUIRE( stats.Average() == 3.0 );
+    REQUIRE( stats.Min() == 2.0 );
+    REQUIRE( stats.Max() == 4.0 );
+
+    // old values leave the window
+    for (uint32_t i = 0; i < vktg::RollingStats::windowSize; i++)
+    {
+        stats.Add( 1.0);
+    }
+    REQUIRE( stats.Count() == vktg::RollingStats::windowSize );
+    REQUIRE( stats.Average() == 1.0 );
+    REQUIRE( stats.Max() == 1.0 );
+}
+
+
+TEST_CASE( "frame handler stats", "[util, frame_handler]") {
+
+    vktg::FrameHandler frameHandler( 2);
+    REQUIRE( frameHandler.Stat( "draw") == nullptr );
+
+    frameHandler.AddStat( "draw", 1.5);
+    REQUIRE( frameHandler.Stat( "draw") != nullptr );
+    REQUIRE( frameHandler.Stat( "draw")->Last() == 1.5 );
+    REQUIRE( frameHandler.Stats().size() == 1 );
+}
+
+
+TEST_CASE( "frame time stats", "[util, frame_handler]") {
+
+    vktg::FrameTimeStats frameTimes;
+    REQUIRE( frameTimes.Count() == 0 );
+    REQUIRE( frameTimes.Percentile( 50.0) == 0.0 );
+
+    // 99 smooth frames and one stutter
+    for (uint32_t i = 0; i < 99; i++)
+    {
+        frameTimes.Add( 10.1);
+    }
+    frameTimes.Add( 40.0);
+    REQUIRE( frameTimes.Count() == 100 );
+    REQUIRE( frameTimes.Last() == 40.0 );
+    REQUIRE( frameTimes.Max() == 40.0 );
+    REQUIRE( frameTimes.Average() == Approx( 10.399) );
+    REQUIRE( frameTimes.Percentile( 50.0) >= 10.0 );
+    REQUIRE( frameTimes.Percentile( 50.0) <= 10.25 );
+    REQUIRE( frameTimes.Percentile( 99.0) <= 10.25 );
+    REQUIRE( frameTimes.Percentile( 100.0) == 40.0 );
+
+    uint32_t histogramCount = 0;
+    for (auto count : frameTimes.Histogram())
+    {
+        histogramCount += count;
+    }
+    REQUIRE( histogramCount == 100 );
+    REQUIRE( frameTimes.Histogram()[40] == 99 );
+
+    // the stutter leaves the window
+    for (uint32_t i = 0; i < vktg::FrameTimeStats::windowSize; i++)
+    {
+        frameTimes.Add( 5.0);
+    }
+    REQUIRE( frameTimes.Count() == vktg::FrameTimeStats::windowSize );
+    REQUIRE( frameTimes.Max() == 5.0 );
+    REQUIRE( frameTimes.Average() == Approx( 5.0) );
+    REQUIRE( frameTimes.Histogram()[40] == 0 );
+}
+
+
+TEST_CASE( "frame time percentiles of hitches", "[util, frame_handler]") {
+
+    // hitches longer than the histogram range all land in its last bin
+    vktg::FrameTimeStats frameTimes;
+    for (uint32_t i = 0; i < 90; i++)
+    {
+        frameTimes.Add( 16.0);
+    }
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        frameTimes.Add( 100.0 + 10.0 * i);
+    }
+    REQUIRE( frameTimes.Histogram()[vktg::FrameTimeStats::binCount - 1] == 10 );
+    REQUIRE( frameTimes.Max() == 190.0 );
+
+    // percentiles inside the last bin are the exact hitch times, not the 64 ms bin edge
+    REQUIRE( frameTimes.Percentile( 50.0) <= 16.25 );
+    REQUIRE( frameTimes.Percentile( 91.0) == 100.0 );
+    REQUIRE( frameTimes.Percentile( 95.0) == 140.0 );
+    REQUIRE( frameTimes.Percentile( 99.0) == 180.0 );
+    REQUIRE( frameTimes.Percentile( 100.0) == 190.0 );
+
+    // also once the window wrapped around
+    for (uint32_t i = 0; i < vktg::FrameTimeStats::windowSize; i++)
+    {
+        frameTimes.Add( i % 100 == 99 ? 250.0 : 8.0);
+    }
+    REQUIRE( frameTimes.Histogram()[vktg::FrameTimeStats::binCount - 1] == 5 );
+    REQUIRE( frameTimes.Percentile( 99.5) == 250.0 );
+    REQUIRE( frameTimes.Percentile( 95.0) <= 8.25 );
+}
+
+
+TEST_CASE( "frame time dump", "[util, frame_handler]") {
+
+    auto path = (std::filesystem::temp_directory_path() / "vktg_frame_times.csv").string();
+    std::filesystem::remove( path);
+
+    vktg::FrameHandler frameHandler( 2);
+    frameHandler.SetFrameTimeDump( path, 2);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        frameHandler.EarlyUpdate();
+        frameHandler.LateUpdate();
+    }
+    REQUIRE( frameHandler.FrameTimes().Count() == 4 );
+
+    std::ifstream file( path);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline( file, line))
+    {
+        lines.push_back( line);
+    }
+    REQUIRE( lines.size() == 3 );
+    REQUIRE( lines[0] == "frame,count,average_ms,p50_ms,p95_ms,p99_ms,max_ms" );
+    REQUIRE( lines[1].rfind( "2,2,", 0) == 0 );
+    REQUIRE( lines[2].rfind( "4,4,", 0) == 0 );
+
+    std::filesystem::remove( path);
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/geometry_pool.h"
+
+
+TEST_CASE( "range allocator best fit", "[geometry_pool]") {
+
+    vktg::RangeAllocator ranges( 100);
+
+    uint64_t a = ranges.Allocate( 10);
+    uint64_t b = ranges.Allocate( 20);
+    uint64_t c = ranges.Allocate( 5);
+    REQUIRE( a == 0 );
+    REQUIRE( b == 10 );
+    REQUIRE( c == 30 );
+    REQUIRE( ranges.FreeSize() == 65 );
+
+    // free [10, 30), the smaller hole is preferred over the tail
+    ranges.Free( b, 20);
+    REQUIRE( ranges.FreeRangeCount() == 2 );
+    REQUIRE( ranges.Allocate( 15) == 10 );
+    REQUIRE( ranges.Allocate( 30) == 35 );
+    REQUIRE( ranges.LargestFreeRange() == 35 );
+
+    REQUIRE( ranges.Allocate( 0) == vktg::RangeAllocator::invalidOffset );
+    REQUIRE( ranges.Allocate( 36) == vktg::RangeAllocator::invalidOffset );
+}
+
+
+TEST_CASE( "range allocator coalescing", "[geometry_pool]") {
+
+    vktg::RangeAllocator ranges( 40);
+
+    uint64_t offsets[4];
+    for (auto &offset : offsets)
+    {
+        offset = ranges.Allocate( 10);
+    }
+    REQUIRE( ranges.FreeSize() == 0 );
+    REQUIRE( ranges.FreeRangeCount() == 0 );
+
+    ranges.Free( offsets[0], 10);
+    ranges.Free( offsets[2], 10);
+    REQUIRE( ranges.FreeRangeCount() == 2 );
+    REQUIRE( ranges.Allocate( 20) == vktg::RangeAllocator::invalidOffset );
+
+    // freeing the range in between merges all three
+    ranges.Free( offsets[1], 10);
+    REQUIRE( ranges.FreeRangeCount() == 1 );
+    REQUIRE( ranges.LargestFreeRange() == 30 );
+
+    ranges.Free( offsets[3], 10);
+    REQUIRE( ranges.FreeRangeCount() == 1 );
+    REQUIRE( ranges.FreeSize() == ranges.Capacity() );
+    REQUIRE( ranges.Allocate( 40) == 0 );
+
+    ranges.Reset( 80);
+    REQUIRE( ranges.Capacity() == 80 );
+    REQUIRE( ranges.LargestFreeRange() == 80 );
+}
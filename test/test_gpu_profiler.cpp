@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/gpu_profiler.h"
+#include "../vulkantogo/commands.h"
+#include "../vulkantogo/synchronization.h"
+
+
+TEST_CASE( "gpu zones", "[gpu_profiler]") {
+
+    vk::CommandPool cmdPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
+    vk::CommandBuffer cmd = vktg::AllocateCommandBuffer( cmdPool);
+    vk::Fence fence = vktg::CreateFence( vk::FenceCreateFlags{});
+
+    vktg::FrameHandler frameHandler( 1);
+    vktg::GpuProfiler profiler( 1, 2);
+    profiler.Attach( &frameHandler);
+
+    auto record = [&]( const std::function<void()> &commands){
+        cmd.reset( vk::CommandBufferResetFlagBits::eReleaseResources);
+        auto cmdBeginInfo = vk::CommandBufferBeginInfo{}
+            .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+        cmd.begin( cmdBeginInfo);
+            commands();
+        cmd.end();
+
+        vk::CommandBufferSubmitInfo cmdInfos[] = {
+            vk::CommandBufferSubmitInfo{}
+                .setCommandBuffer( cmd )
+        };
+        vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, {}, {}, fence);
+        vktg::WaitForFence( fence);
+        vktg::ResetFence( fence);
+    };
+
+    record( [&](){
+        profiler.BeginFrame( cmd);
+        REQUIRE( profiler.Results().empty() );
+        {
+            vktg::ScopedGpuZone outer( profiler, cmd, "outer");
+            profiler.BeginZone( cmd, "inner");
+            profiler.EndZone( cmd);
+            // exceeds maxZones and is ignored
+            profiler.BeginZone( cmd, "ignored");
+            profiler.EndZone( cmd);
+        }
+    });
+
+    record( [&](){
+        profiler.BeginFrame( cmd);
+    });
+
+    auto results = profiler.Results();
+    REQUIRE( results.size() == 2 );
+    REQUIRE( results[0].name == "outer" );
+    REQUIRE( results[0].depth == 0 );
+    REQUIRE( results[1].name == "inner" );
+    REQUIRE( results[1].depth == 1 );
+    REQUIRE( results[0].milliseconds >= results[1].milliseconds );
+    REQUIRE( frameHandler.Stat( "gpu/outer") != nullptr );
+    REQUIRE( frameHandler.Stat( "gpu/outer")->Count() == 1 );
+    REQUIRE( frameHandler.Stat( "gpu/ignored") == nullptr );
+
+    profiler.Destroy();
+    vktg::DestroyCommandPool( cmdPool);
+    vktg::DestroyFence( fence);
+}
@@ -0,0 +1,163 @@
+
+#include <catch2/catch.hpp>
+
+#include "../examples/shared/image_batch.h"
+#include "../examples/shared/utility.h"
+#include "../vulkantogo/synchronization.h"
+#include "../vulkantogo/transfer.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+// binary PPM for RGB or PGM for gray images, both decoded by stb_image
+static void WritePnm( const std::string &path, uint32_t width, uint32_t height, int channels, uint8_t seed) {
+
+    std::ofstream file( path, std::ios::binary);
+    file << (channels == 1 ? "P5\n" : "P6\n") << width << ' ' << height << "\n255\n";
+    for (uint32_t i = 0; i < width * height * channels; i++)
+    {
+        file.put( (char)uint8_t(seed + 7 * i));
+    }
+}
+
+
+// copies mip level 0 of an image in transfer source layout to host memory
+static std::vector<uint8_t> ReadImage( const vktg::Image &image, uint32_t texelSize) {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, image.Width() * image.Height() * texelSize, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu, vma::AllocationCreateFlagBits::eMapped);
+
+    auto context = vktg::CreateSubmitContext( vktg::QueueType::eGraphics);
+    context.Begin();
+        vktg::CopyImageToBuffer( context.cmd, image.image, buffer.buffer, 0, image.Width(), image.Height());
+    context.End();
+    context.Submit();
+    vktg::WaitForFence( context.fence);
+
+    auto data = static_cast<uint8_t*>( buffer.Data());
+    std::vector<uint8_t> pixels( data, data + buffer.Size());
+
+    vktg::DestroySubmitContext( context);
+    vktg::DestroyBuffer( buffer);
+
+    return pixels;
+}
+
+
+TEST_CASE( "batch image upload matches serial upload", "[image_batch]") {
+
+    vktg::ResourceUsage transferRead{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal};
+
+    // an image larger than a chunk, several images per chunk and odd sizes
+    struct Extent { uint32_t width, height; };
+    std::vector<Extent> extents = { {37, 23}, {64, 64}, {8, 8}, {16, 5}, {1, 1}, {20, 20}};
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < extents.size(); i++)
+    {
+        paths.push_back( (std::filesystem::temp_directory_path() / ("vktg_test_batch_" + std::to_string( i) + ".ppm")).string());
+        WritePnm( paths.back(), extents[i].width, extents[i].height, 3, (uint8_t)i);
+    }
+
+    vktg::ThreadPool threadPool( 4);
+    ImageBatchLoader loader( threadPool, 4096);
+    auto images = loader.Load( paths, false, false, vk::ImageUsageFlagBits::eTransferSrc, transferRead);
+    REQUIRE( images.size() == paths.size() );
+
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        REQUIRE( images[i].Format() == vk::Format::eR8G8B8A8Unorm );
+        REQUIRE( images[i].Width() == extents[i].width );
+        REQUIRE( images[i].Height() == extents[i].height );
+
+        // serial path decodes to RGBA8 and uploads with its own staging buffer
+        uint32_t width, height;
+        auto pixels = LoadImage( paths[i], width, height);
+        vktg::Image reference;
+        vktg::CreateImage( reference, width, height, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+        vktg::UploadImageData( pixels.data(), reference, transferRead);
+
+        REQUIRE( ReadImage( images[i], 4) == ReadImage( reference, 4) );
+
+        vktg::DestroyImage( reference);
+        vktg::DestroyImage( images[i]);
+        std::filesystem::remove( paths[i]);
+    }
+
+    loader.Destroy();
+}
+
+
+TEST_CASE( "batch image upload keeps single channel images", "[image_batch]") {
+
+    vktg::ResourceUsage transferRead{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal};
+
+    std::vector<std::string> paths = { (std::filesystem::temp_directory_path() / "vktg_test_batch_gray.pgm").string()};
+    WritePnm( paths[0], 12, 9, 1, 3);
+
+    vktg::ThreadPool threadPool( 2);
+    ImageBatchLoader loader( threadPool);
+    auto images = loader.Load( paths, false, true, vk::ImageUsageFlagBits::eTransferSrc, transferRead);
+    REQUIRE( images[0].Format() == vk::Format::eR8Unorm );
+
+    auto pixels = ReadImage( images[0], 1);
+    for (uint32_t i = 0; i < 12 * 9; i++)
+    {
+        REQUIRE( pixels[i] == uint8_t(3 + 7 * i) );
+    }
+
+    vktg::DestroyImage( images[0]);
+    loader.Destroy();
+    std::filesystem::remove( paths[0]);
+}
+
+
+TEST_CASE( "batch image upload destroys its images if a decode fails", "[image_batch]") {
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < 4; i++)
+    {
+        paths.push_back( (std::filesystem::temp_directory_path() / ("vktg_test_batch_valid_" + std::to_string( i) + ".ppm")).string());
+        WritePnm( paths.back(), 16, 16, 3, (uint8_t)i);
+    }
+
+    // png with a valid header but an invalid zlib stream, stb_image reads its header but fails to decode it
+    paths.push_back( (std::filesystem::temp_directory_path() / "vktg_test_batch_corrupt.png").string());
+    {
+        std::ofstream file( paths.back(), std::ios::binary);
+        const uint8_t png[] = {
+            0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a,
+            0, 0, 0, 13, 'I', 'H', 'D', 'R', 0, 0, 0, 16, 0, 0, 0, 16, 8, 2, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 4, 'I', 'D', 'A', 'T', 0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0,
+            0, 0, 0, 0, 'I', 'E', 'N', 'D', 0, 0, 0, 0
+        };
+        file.write( reinterpret_cast<const char*>( png), sizeof(png));
+    }
+
+    // two images per chunk, a first batch of the valid images creates both staging buffers of the loader
+    vktg::ThreadPool threadPool( 2);
+    ImageBatchLoader loader( threadPool, 2048);
+    auto images = loader.Load( std::span( paths).first( 4), false);
+    REQUIRE( images.size() == 4 );
+    for (auto &image : images)
+    {
+        vktg::DestroyImage( image);
+    }
+
+    // the corrupt image is decoded after earlier chunks were submitted, none of the images of the batch survive
+    auto allocationCount = vktg::Allocator().calculateStats().total.allocationCount;
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        REQUIRE_THROWS( loader.Load( paths, false) );
+        REQUIRE( vktg::Allocator().calculateStats().total.allocationCount == allocationCount );
+    }
+
+    loader.Destroy();
+    for (auto &path : paths)
+    {
+        std::filesystem::remove( path);
+    }
+}
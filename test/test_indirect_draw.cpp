@@ -0,0 +1,49 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/indirect_draw.h"
+
+
+TEST_CASE( "frustum plane extraction", "[indirect_draw]") {
+
+    // column major perspective projection with 90 degree fov, near 1 and far 100, Vulkan depth range
+    float n = 1.f, f = 100.f;
+    float viewProj[16] = {
+        1.f, 0.f, 0.f, 0.f,
+        0.f, 1.f, 0.f, 0.f,
+        0.f, 0.f, f / (n - f), -1.f,
+        0.f, 0.f, n * f / (n - f), 0.f
+    };
+    float planes[6][4];
+    vktg::ExtractFrustumPlanes( viewProj, planes);
+
+    // planes are normalized
+    for (auto &plane : planes)
+    {
+        REQUIRE( plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2] == Approx( 1.f) );
+    }
+    // near plane at z = -1 facing the view direction
+    REQUIRE( planes[4][2] == Approx( -1.f) );
+    REQUIRE( planes[4][3] == Approx( -1.f) );
+
+    float inside[3] = { 0.f, 0.f, -10.f};
+    float behind[3] = { 0.f, 0.f, 5.f};
+    float right[3] = { 20.f, 0.f, -10.f};
+    float touchingRight[3] = { 10.5f, 0.f, -10.f};
+    float beyondFar[3] = { 0.f, 0.f, -150.f};
+
+    REQUIRE( vktg::IsSphereInFrustum( planes, inside, 1.f) );
+    REQUIRE( !vktg::IsSphereInFrustum( planes, behind, 1.f) );
+    REQUIRE( !vktg::IsSphereInFrustum( planes, right, 1.f) );
+    REQUIRE( vktg::IsSphereInFrustum( planes, touchingRight, 1.f) );
+    REQUIRE( !vktg::IsSphereInFrustum( planes, beyondFar, 1.f) );
+    REQUIRE( vktg::IsSphereInFrustum( planes, beyondFar, 60.f) );
+}
+
+
+TEST_CASE( "indirect draw data layout", "[indirect_draw]") {
+
+    // must match the std430 structs in cull.comp and mesh_indirect.vert
+    REQUIRE( sizeof(vktg::DrawInstance) == 96 );
+    REQUIRE( sizeof(vktg::IndirectMesh) == 16 );
+    REQUIRE( sizeof(vk::DrawIndexedIndirectCommand) == 20 );
+}
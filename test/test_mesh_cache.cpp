@@ -0,0 +1,212 @@
+#include <catch2/catch.hpp>
+
+#include "../examples/shared/mesh_cache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+// single quad with positions, uvs and a normal
+static void WriteQuadMesh( const std::string &path) {
+
+    std::ofstream file( path);
+    file << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n";
+    file << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n";
+    file << "vn 0 0 1\n";
+    file << "f 1/1/1 2/2/1 3/3/1\nf 1/1/1 3/3/1 4/4/1\n";
+}
+
+
+// vertices that can not come from importing the quad, so a mapped cooked mesh holding them was not re-cooked
+static std::vector<Vertex> MarkerVertices() {
+
+    std::vector<Vertex> vertices( 3);
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        vertices[i].position = glm::vec3( 7.f + i, -3.f, 2.f * i);
+        vertices[i].color = glm::vec4( 0.5f);
+        vertices[i].texCoord = glm::vec2( 0.25f * i, 1.f);
+        vertices[i].normal = glm::vec3( 0.f, 1.f, 0.f);
+        vertices[i].tangent = glm::vec3( 1.f, 0.f, 0.f);
+    }
+
+    return vertices;
+}
+
+
+static void WriteBytes( const std::string &path, size_t offset, uint32_t value) {
+
+    std::fstream file( path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp( offset);
+    file.write( reinterpret_cast<const char*>( &value), sizeof(value));
+}
+
+
+TEST_CASE( "cooked mesh round trip", "[mesh_cache]") {
+
+    std::string meshPath = (std::filesystem::temp_directory_path() / "vktg_test_cache_round_trip.obj").string();
+    WriteQuadMesh( meshPath);
+    uint64_t sourceSize = std::filesystem::file_size( meshPath);
+    int64_t sourceTime = std::filesystem::last_write_time( meshPath).time_since_epoch().count();
+
+    auto vertices = MarkerVertices();
+    std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 0};
+
+    SECTION( "16 bit indices") {
+
+        // optimized meshes are cooked with compact indices
+        WriteCookedMesh( meshPath + ".cooked", vertices, indices, sourceSize, sourceTime, true);
+
+        MappedMesh mesh;
+        LoadCookedMesh( meshPath, mesh);
+        REQUIRE( mesh.IndexType() == vk::IndexType::eUint16 );
+        REQUIRE( mesh.IndexCount() == indices.size() );
+        REQUIRE( mesh.IndexData().size() == indices.size() * sizeof(uint16_t) );
+        std::vector<uint16_t> mappedIndices( indices.size());
+        memcpy( mappedIndices.data(), mesh.IndexData().data(), mesh.IndexData().size());
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            REQUIRE( mappedIndices[i] == indices[i] );
+        }
+
+        REQUIRE( mesh.Vertices().size() == vertices.size() );
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            REQUIRE( mesh.Vertices()[i] == vertices[i] );
+        }
+        REQUIRE( mesh.BoundsMin() == glm::vec3( 7.f, -3.f, 0.f) );
+        REQUIRE( mesh.BoundsMax() == glm::vec3( 9.f, -3.f, 4.f) );
+
+        // streams start at 16 byte aligned offsets after the header
+        REQUIRE( mesh.Header().vertexOffset == 80 );
+        REQUIRE( mesh.Header().indexOffset % 16 == 0 );
+        mesh.Close();
+        std::filesystem::remove( meshPath + ".cooked");
+    }
+
+    SECTION( "32 bit indices") {
+
+        // unoptimized meshes keep 32 bit indices
+        WriteCookedMesh( meshPath + ".unoptimized.cooked", vertices, indices, sourceSize, sourceTime, false);
+
+        MappedMesh mesh;
+        LoadCookedMesh( meshPath, mesh, nullptr, false);
+        REQUIRE( mesh.IndexType() == vk::IndexType::eUint32 );
+        REQUIRE( mesh.IndexData().size() == indices.size() * sizeof(uint32_t) );
+        REQUIRE( memcmp( mesh.IndexData().data(), indices.data(), indices.size() * sizeof(uint32_t)) == 0 );
+
+        REQUIRE( mesh.Vertices().size() == vertices.size() );
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            REQUIRE( mesh.Vertices()[i] == vertices[i] );
+        }
+        mesh.Close();
+        std::filesystem::remove( meshPath + ".unoptimized.cooked");
+    }
+
+    // no temporary file is left behind
+    REQUIRE_FALSE( std::filesystem::exists( meshPath + ".cooked.tmp") );
+    REQUIRE_FALSE( std::filesystem::exists( meshPath + ".unoptimized.cooked.tmp") );
+    std::filesystem::remove( meshPath);
+}
+
+
+TEST_CASE( "invalid cooked meshes are rejected", "[mesh_cache]") {
+
+    std::string cookedPath = (std::filesystem::temp_directory_path() / "vktg_test_cache_invalid.cooked").string();
+    auto vertices = MarkerVertices();
+    std::vector<uint32_t> indices = { 0, 1, 2};
+    WriteCookedMesh( cookedPath, vertices, indices);
+
+    MappedMesh mesh;
+    REQUIRE( mesh.Open( cookedPath) );
+    mesh.Close();
+
+    SECTION( "bad magic") {
+
+        WriteBytes( cookedPath, offsetof( CookedMeshHeader, magic), 0x12345678);
+        REQUIRE_FALSE( mesh.Open( cookedPath) );
+    }
+
+    SECTION( "bad version") {
+
+        WriteBytes( cookedPath, offsetof( CookedMeshHeader, version), 1);
+        REQUIRE_FALSE( mesh.Open( cookedPath) );
+    }
+
+    SECTION( "truncated index stream") {
+
+        std::filesystem::resize_file( cookedPath, std::filesystem::file_size( cookedPath) - 1);
+        REQUIRE_FALSE( mesh.Open( cookedPath) );
+    }
+
+    SECTION( "truncated header") {
+
+        std::filesystem::resize_file( cookedPath, sizeof(CookedMeshHeader) - 1);
+        REQUIRE_FALSE( mesh.Open( cookedPath) );
+    }
+
+    SECTION( "missing file") {
+
+        std::filesystem::remove( cookedPath);
+        REQUIRE_FALSE( mesh.Open( cookedPath) );
+    }
+
+    std::filesystem::remove( cookedPath);
+}
+
+
+TEST_CASE( "stale or invalid cooked meshes are re-cooked", "[mesh_cache]") {
+
+    std::string meshPath = (std::filesystem::temp_directory_path() / "vktg_test_cache_stale.obj").string();
+    std::string cookedPath = meshPath + ".cooked";
+    WriteQuadMesh( meshPath);
+    uint64_t sourceSize = std::filesystem::file_size( meshPath);
+    int64_t sourceTime = std::filesystem::last_write_time( meshPath).time_since_epoch().count();
+
+    auto vertices = MarkerVertices();
+    std::vector<uint32_t> indices = { 0, 1, 2};
+
+    SECTION( "source size changed") {
+
+        WriteCookedMesh( cookedPath, vertices, indices, sourceSize + 1, sourceTime);
+    }
+
+    SECTION( "source time changed") {
+
+        WriteCookedMesh( cookedPath, vertices, indices, sourceSize, sourceTime - 1);
+    }
+
+    SECTION( "bad version") {
+
+        WriteCookedMesh( cookedPath, vertices, indices, sourceSize, sourceTime);
+        WriteBytes( cookedPath, offsetof( CookedMeshHeader, version), 1);
+    }
+
+    // the quad is imported and cooked again instead of mapping the marker vertices
+    MappedMesh mesh;
+    LoadCookedMesh( meshPath, mesh);
+    REQUIRE( mesh.Vertices().size() == 4 );
+    REQUIRE( mesh.IndexCount() == 6 );
+    REQUIRE( mesh.Header().sourceSize == sourceSize );
+    REQUIRE( mesh.Header().sourceTime == sourceTime );
+    REQUIRE( mesh.BoundsMin() == glm::vec3( 0.f) );
+    REQUIRE( mesh.BoundsMax() == glm::vec3( 1.f, 1.f, 0.f) );
+
+    // the fresh cooked mesh is used by the next load, re-cooking would replace the file with a current write time
+    mesh.Close();
+    auto cookedTime = std::filesystem::last_write_time( cookedPath) - std::chrono::hours( 1);
+    std::filesystem::last_write_time( cookedPath, cookedTime);
+    LoadCookedMesh( meshPath, mesh);
+    REQUIRE( std::filesystem::last_write_time( cookedPath) == cookedTime );
+    REQUIRE( mesh.Vertices().size() == 4 );
+
+    mesh.Close();
+    std::filesystem::remove( cookedPath);
+    std::filesystem::remove( meshPath);
+}
@@ -0,0 +1,151 @@
+#include <catch2/catch.hpp>
+
+#include "../examples/shared/mesh_import.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// triangle corners per import chunk, see mesh_import.cpp
+static constexpr size_t chunkCorners = 3 * (1 << 16);
+
+
+// grid of gridSize x gridSize quads with positions, uvs and a normal as .obj file, cornerVertices receives the .obj vertex of each triangle corner
+static void WriteGridMesh( const std::string &path, uint32_t gridSize, std::vector<uint32_t> &cornerVertices) {
+
+    std::ofstream file( path);
+    uint32_t rowSize = gridSize + 1;
+    for (uint32_t y = 0; y < rowSize; y++)
+    {
+        for (uint32_t x = 0; x < rowSize; x++)
+        {
+            float u = (float)x / gridSize;
+            float v = (float)y / gridSize;
+            file << "v " << u << " 0 " << v << '\n';
+            file << "vt " << u << ' ' << v << '\n';
+        }
+    }
+    file << "vn 0 1 0\n";
+    for (uint32_t y = 0; y < gridSize; y++)
+    {
+        for (uint32_t x = 0; x < gridSize; x++)
+        {
+            uint32_t i0 = y * rowSize + x + 1;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + rowSize;
+            uint32_t i3 = i2 + 1;
+            file << "f " << i0 << '/' << i0 << "/1 " << i2 << '/' << i2 << "/1 " << i1 << '/' << i1 << "/1\n";
+            file << "f " << i1 << '/' << i1 << "/1 " << i2 << '/' << i2 << "/1 " << i3 << '/' << i3 << "/1\n";
+            cornerVertices.insert( cornerVertices.end(), { i0, i2, i1, i1, i2, i3});
+        }
+    }
+}
+
+
+TEST_CASE( "vertex table deduplicates vertices", "[mesh_import]") {
+
+    std::vector<Vertex> vertices;
+    VertexTable table;
+
+    // more vertices than the initial capacity, so the table grows while keeping indices
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        Vertex vertex{};
+        vertex.position = glm::vec3( (float)i, 0.f, 0.f);
+        REQUIRE( table.Insert( vertex, vertices) == i );
+    }
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        Vertex vertex{};
+        vertex.position = glm::vec3( (float)i, 0.f, 0.f);
+        REQUIRE( table.Insert( vertex, vertices) == i );
+    }
+    REQUIRE( table.Size() == 1000 );
+    REQUIRE( vertices.size() == 1000 );
+}
+
+
+TEST_CASE( "mesh import matches serial mesh loading", "[mesh_import]") {
+
+    // 80000 triangles span two import chunks
+    const uint32_t gridSize = 200;
+    std::string meshPath = (std::filesystem::temp_directory_path() / "vktg_test_import_grid.obj").string();
+    std::vector<uint32_t> cornerVertices;
+    WriteGridMesh( meshPath, gridSize, cornerVertices);
+    REQUIRE( cornerVertices.size() > chunkCorners );
+
+    std::vector<Vertex> referenceVertices;
+    std::vector<uint32_t> referenceIndices;
+    LoadMesh( meshPath, referenceVertices, referenceIndices);
+
+    vktg::ThreadPool threadPool( 4);
+    vktg::ThreadPool *threadPools[] = { nullptr, &threadPool};
+    for (auto pThreadPool : threadPools)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        ImportMesh( meshPath, vertices, indices, pThreadPool);
+
+        REQUIRE( indices == referenceIndices );
+        REQUIRE( vertices.size() == referenceVertices.size() );
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            REQUIRE( vertices[i].position == referenceVertices[i].position );
+            REQUIRE( vertices[i].color == referenceVertices[i].color );
+            REQUIRE( vertices[i].texCoord == referenceVertices[i].texCoord );
+            REQUIRE( vertices[i].normal == referenceVertices[i].normal );
+            // tangents are summed per chunk first, so they may differ by rounding
+            for (int c = 0; c < 3; c++)
+            {
+                REQUIRE( vertices[i].tangent[c] == Approx( referenceVertices[i].tangent[c]).margin( 1e-3) );
+            }
+        }
+    }
+
+    std::filesystem::remove( meshPath);
+}
+
+
+TEST_CASE( "mesh import merges vertices shared by chunks", "[mesh_import]") {
+
+    const uint32_t gridSize = 200;
+    std::string meshPath = (std::filesystem::temp_directory_path() / "vktg_test_import_boundary.obj").string();
+    std::vector<uint32_t> cornerVertices;
+    WriteGridMesh( meshPath, gridSize, cornerVertices);
+
+    vktg::ThreadPool threadPool( 4);
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    ImportMesh( meshPath, vertices, indices, &threadPool);
+
+    // every grid vertex is imported once, also if its triangles are in different chunks
+    REQUIRE( vertices.size() == (gridSize + 1) * (gridSize + 1) );
+    REQUIRE( indices.size() == cornerVertices.size() );
+
+    // all corners of an .obj vertex get the same index, count the vertices used by both chunks
+    std::unordered_map<uint32_t, uint32_t> importedIndex;
+    std::unordered_map<uint32_t, uint32_t> firstChunk;
+    size_t sharedVertices = 0;
+    for (size_t i = 0; i < cornerVertices.size(); i++)
+    {
+        uint32_t chunk = (uint32_t)(i / chunkCorners);
+        auto [it, inserted] = importedIndex.emplace( cornerVertices[i], indices[i]);
+        if (inserted)
+        {
+            firstChunk[cornerVertices[i]] = chunk;
+            continue;
+        }
+        REQUIRE( it->second == indices[i] );
+        if (firstChunk[cornerVertices[i]] != chunk)
+        {
+            firstChunk[cornerVertices[i]] = chunk;
+            sharedVertices++;
+        }
+    }
+    REQUIRE( sharedVertices > 0 );
+
+    std::filesystem::remove( meshPath);
+}
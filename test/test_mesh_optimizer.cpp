@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+
+// grid of size x size quads with shuffled triangles
+static void CreateShuffledGrid( uint32_t size, std::vector<uint32_t> &indices, std::vector<float> &positions) {
+
+    for (uint32_t y = 0; y <= size; y++)
+    {
+        for (uint32_t x = 0; x <= size; x++)
+        {
+            positions.insert( positions.end(), { (float)x, (float)y, 0.f});
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i0 = y * (size + 1) + x;
+            uint32_t i2 = i0 + size + 1;
+            triangles.push_back( { i0, i2, i0 + 1});
+            triangles.push_back( { i0 + 1, i2, i2 + 1});
+        }
+    }
+    std::shuffle( triangles.begin(), triangles.end(), std::mt19937( 7));
+    for (auto &triangle : triangles)
+    {
+        indices.insert( indices.end(), triangle.begin(), triangle.end());
+    }
+}
+
+
+// sorted triangles, each rotated to start at its smallest index so winding is kept
+static std::vector<std::array<uint32_t, 3>> CanonicalTriangles( const std::vector<uint32_t> &indices) {
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate( triangle.begin(), std::min_element( triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back( triangle);
+    }
+    std::sort( triangles.begin(), triangles.end());
+
+    return triangles;
+}
+
+
+TEST_CASE( "vertex cache optimization", "[mesh_optimizer]") {
+
+    std::vector<uint32_t> indices;
+    std::vector<float> positions;
+    CreateShuffledGrid( 64, indices, positions);
+    uint32_t vertexCount = 65 * 65;
+    auto triangles = CanonicalTriangles( indices);
+
+    auto shuffledStats = vktg::AnalyzeVertexCache( indices, vertexCount);
+    REQUIRE( shuffledStats.acmr > 2.5f );
+
+    vktg::OptimizeVertexCache( indices, vertexCount);
+    auto optimizedStats = vktg::AnalyzeVertexCache( indices, vertexCount);
+    REQUIRE( optimizedStats.acmr < 0.8f );
+    REQUIRE( optimizedStats.atvr < 1.5f );
+    REQUIRE( CanonicalTriangles( indices) == triangles );
+
+    vktg::OptimizeOverdraw( indices, positions.data(), 3 * sizeof(float), vertexCount);
+    REQUIRE( CanonicalTriangles( indices) == triangles );
+    // clusters are only split where the cache is cold
+    REQUIRE( vktg::AnalyzeVertexCache( indices, vertexCount).acmr <= optimizedStats.acmr + 0.01f );
+}
+
+
+TEST_CASE( "vertex fetch optimization", "[mesh_optimizer]") {
+
+    std::vector<uint32_t> indices = { 3, 1, 4, 4, 1, 0};
+    std::vector<float> vertices = { 0.f, 1.f, 2.f, 3.f, 4.f, 5.f};
+
+    uint32_t referencedCount = vktg::OptimizeVertexFetch( indices, vertices.data(), (uint32_t)vertices.size(), sizeof(float));
+    REQUIRE( referencedCount == 4 );
+    REQUIRE( indices == std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3} );
+    REQUIRE( vertices[0] == 3.f );
+    REQUIRE( vertices[1] == 1.f );
+    REQUIRE( vertices[2] == 4.f );
+    REQUIRE( vertices[3] == 0.f );
+}
+
+
+TEST_CASE( "compact indices", "[mesh_optimizer]") {
+
+    std::vector<uint32_t> indices = { 0, 1, 65534};
+    std::vector<uint8_t> indexData;
+
+    REQUIRE( vktg::CompactIndices( indices, 65535, indexData) == vk::IndexType::eUint16 );
+    REQUIRE( indexData.size() == 3 * sizeof(uint16_t) );
+    REQUIRE( reinterpret_cast<uint16_t*>( indexData.data())[2] == 65534 );
+
+    REQUIRE( vktg::CompactIndices( indices, 65536, indexData) == vk::IndexType::eUint32 );
+    REQUIRE( indexData.size() == 3 * sizeof(uint32_t) );
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/meshlets.h"
+
+#include <vector>
+
+
+TEST_CASE( "meshlet building", "[meshlets]") {
+
+    // flat grid facing +z
+    const uint32_t size = 32;
+    std::vector<float> positions;
+    for (uint32_t y = 0; y <= size; y++)
+    {
+        for (uint32_t x = 0; x <= size; x++)
+        {
+            positions.insert( positions.end(), { (float)x, (float)y, 0.f});
+        }
+    }
+    std::vector<uint32_t> indices;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i0 = y * (size + 1) + x;
+            uint32_t i2 = i0 + size + 1;
+            indices.insert( indices.end(), { i0, i0 + 1, i2, i0 + 1, i2 + 1, i2});
+        }
+    }
+    uint32_t vertexCount = (size + 1) * (size + 1);
+
+    auto data = vktg::BuildMeshlets( indices, positions.data(), 3 * sizeof(float), vertexCount, 64, 124);
+    REQUIRE( data.meshlets.size() > 1 );
+    REQUIRE( data.bounds.size() == data.meshlets.size() );
+
+    // meshlets respect limits and reproduce the original triangles in order
+    size_t triangle = 0;
+    for (auto &meshlet : data.meshlets)
+    {
+        REQUIRE( meshlet.vertexCount <= 64 );
+        REQUIRE( meshlet.triangleCount <= 124 );
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++, triangle++)
+        {
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint8_t local = data.triangles[meshlet.triangleOffset + 3 * t + k];
+                REQUIRE( local < meshlet.vertexCount );
+                REQUIRE( data.vertices[meshlet.vertexOffset + local] == indices[3 * triangle + k] );
+            }
+        }
+    }
+    REQUIRE( triangle == indices.size() / 3 );
+
+    // the grid faces +z, cameras below it only see back faces
+    float above[3] = { 16.f, 16.f, 10.f};
+    float below[3] = { 16.f, 16.f, -10.f};
+    for (auto &bounds : data.bounds)
+    {
+        REQUIRE( bounds.coneAxis[2] > 0.99f );
+        REQUIRE( bounds.radius > 0.f );
+        REQUIRE_FALSE( vktg::IsMeshletBackfacing( bounds, above) );
+        REQUIRE( vktg::IsMeshletBackfacing( bounds, below) );
+    }
+
+    REQUIRE_THROWS( vktg::BuildMeshlets( indices, positions.data(), 3 * sizeof(float), vertexCount, 512, 124) );
+}
@@ -28,7 +28,7 @@ TEST_CASE( "load shader, wrong path", "[pipelines]") {
 
 TEST_CASE( "create shader module", "[commands]") {
 
-    vk::ShaderModule shader = vktg::LoadShader( "../res/shaders/test_comp.spv");
+    vk::ShaderModule shader = vktg::LoadShader( VKTG_SHADER_DIR "test_comp.spv");
 
     REQUIRE_FALSE( !shader );
 }
@@ -49,7 +49,7 @@ TEST_CASE( "build compute pipeline", "[pipelines]") {
 
     vktg::ComputePipelineBuilder builder;
 
-    vk::ShaderModule shader = vktg::LoadShader( "../res/shaders/test_comp.spv");
+    vk::ShaderModule shader = vktg::LoadShader( VKTG_SHADER_DIR "test_comp.spv");
 
     auto setBinding = vk::DescriptorSetLayoutBinding{}
         .setStageFlags( vk::ShaderStageFlagBits::eCompute )
@@ -102,8 +102,8 @@ TEST_CASE( "add shaders to graphics pipeline bulder", "[pipelines]") {
 
     vktg::GraphicsPipelineBuilder builder;
 
-    vk::ShaderModule vertShader = vktg::LoadShader( "../res/shaders/test_vert.spv");
-    vk::ShaderModule fragShader = vktg::LoadShader( "../res/shaders/test_frag.spv");
+    vk::ShaderModule vertShader = vktg::LoadShader( VKTG_SHADER_DIR "test_vert.spv");
+    vk::ShaderModule fragShader = vktg::LoadShader( VKTG_SHADER_DIR "test_frag.spv");
 
     builder
         .AddShader( vertShader, vk::ShaderStageFlagBits::eVertex, nullptr, "main")
@@ -327,8 +327,8 @@ TEST_CASE( "create graphics pipeline", "[pipelines]") {
 
     vktg::GraphicsPipelineBuilder builder;
     
-    vk::ShaderModule vertShader = vktg::LoadShader( "../res/shaders/test_vert.spv");
-    vk::ShaderModule fragShader = vktg::LoadShader( "../res/shaders/test_frag.spv");
+    vk::ShaderModule vertShader = vktg::LoadShader( VKTG_SHADER_DIR "test_vert.spv");
+    vk::ShaderModule fragShader = vktg::LoadShader( VKTG_SHADER_DIR "test_frag.spv");
     std::vector<vk::Format> colorAttachmentFormats = {vk::Format::eR16G16B16A16Sfloat};
     std::vector<vk::DynamicState> dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
     vktg::Pipeline pipeline = builder
@@ -0,0 +1,74 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/queries.h"
+#include "../vulkantogo/commands.h"
+#include "../vulkantogo/synchronization.h"
+
+#include <bit>
+
+
+TEST_CASE( "query results", "[queries]") {
+
+    vk::CommandPool cmdPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
+    vk::CommandBuffer cmd = vktg::AllocateCommandBuffer( cmdPool);
+    vk::Fence fence = vktg::CreateFence( vk::FenceCreateFlags{});
+
+    // small pools to cover queries spread over multiple pools
+    vktg::QueryManager queries( 1, vktg::QueryManager::defaultStatistics, 2);
+
+    auto record = [&]( const std::function<void()> &commands){
+        cmd.reset( vk::CommandBufferResetFlagBits::eReleaseResources);
+        auto cmdBeginInfo = vk::CommandBufferBeginInfo{}
+            .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+        cmd.begin( cmdBeginInfo);
+            commands();
+        cmd.end();
+
+        vk::CommandBufferSubmitInfo cmdInfos[] = {
+            vk::CommandBufferSubmitInfo{}
+                .setCommandBuffer( cmd )
+        };
+        vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, {}, {}, fence);
+        vktg::WaitForFence( fence);
+        vktg::ResetFence( fence);
+    };
+
+    record( [&](){
+        queries.BeginFrame( cmd);
+        REQUIRE( queries.Results().empty() );
+
+        queries.WriteTimestamp( cmd, "begin", vk::PipelineStageFlagBits2::eTopOfPipe);
+        uint32_t stats = queries.BeginQuery( cmd, vk::QueryType::ePipelineStatistics, "stats");
+        queries.EndQuery( cmd, stats);
+        queries.WriteTimestamp( cmd, "middle");
+        queries.WriteTimestamp( cmd, "end");
+        REQUIRE( queries.QueryCount() == 4 );
+        REQUIRE_THROWS( queries.BeginQuery( cmd, vk::QueryType::eTimestamp, "timestamp") );
+    });
+
+    record( [&](){
+        queries.BeginFrame( cmd);
+    });
+
+    auto results = queries.Results();
+    REQUIRE( results.size() == 4 );
+    REQUIRE( results[0].name == "begin" );
+    REQUIRE( results[1].name == "stats" );
+    REQUIRE( results[3].name == "end" );
+    for (auto &result : results)
+    {
+        REQUIRE( result.available );
+    }
+
+    REQUIRE( results[1].valueCount == (uint32_t)std::popcount( (uint32_t)vktg::QueryManager::defaultStatistics) );
+    REQUIRE( queries.Statistic( results[1], vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations) == 0 );
+    REQUIRE_THROWS( queries.Statistic( results[1], vk::QueryPipelineStatisticFlagBits::eGeometryShaderInvocations) );
+    REQUIRE_THROWS( queries.Statistic( results[0], vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations) );
+
+    REQUIRE( queries.Values( results[0]).size() == 1 );
+    REQUIRE( queries.Values( results[0])[0] <= queries.Values( results[3])[0] );
+
+    queries.Destroy();
+    vktg::DestroyCommandPool( cmdPool);
+    vktg::DestroyFence( fence);
+}
@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/readback.h"
+#include "../vulkantogo/storage.h"
+#include "../vulkantogo/commands.h"
+#include "../vulkantogo/synchronization.h"
+
+
+// records commands into a one time command buffer and submits them with the readback signal
+static void SubmitReadbacks( vktg::ReadbackQueue &readbacks, const std::function<void( vk::CommandBuffer)> &record) {
+
+    vk::CommandPool cmdPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
+    vk::CommandBuffer cmd = vktg::AllocateCommandBuffer( cmdPool);
+
+    auto cmdBeginInfo = vk::CommandBufferBeginInfo{}
+        .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+    cmd.begin( cmdBeginInfo);
+        record( cmd);
+    cmd.end();
+
+    vk::CommandBufferSubmitInfo cmdInfos[] = {
+        vk::CommandBufferSubmitInfo{}
+            .setCommandBuffer( cmd )
+    };
+    vk::SemaphoreSubmitInfo signalInfos[] = {
+        readbacks.SignalInfo()
+    };
+    vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, {}, signalInfos, VK_NULL_HANDLE);
+    readbacks.Wait();
+
+    vktg::DestroyCommandPool( cmdPool);
+}
+
+
+TEST_CASE( "buffer readback", "[readback]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 64, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuOnly, vma::AllocationCreateFlagBits::eMapped);
+    auto data = reinterpret_cast<uint32_t*>( buffer.Data());
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        data[i] = i * i;
+    }
+
+    vktg::ReadbackQueue readbacks( 256);
+    std::future<std::vector<uint8_t>> future;
+    uint32_t callbackValue = 0;
+    SubmitReadbacks( readbacks, [&]( vk::CommandBuffer cmd){
+        future = readbacks.ReadBuffer( cmd, buffer);
+        readbacks.ReadBuffer( cmd, buffer, 4 * sizeof(uint32_t), sizeof(uint32_t), [&]( std::span<const uint8_t> result){
+            callbackValue = *reinterpret_cast<const uint32_t*>( result.data());
+        });
+    });
+
+    REQUIRE( readbacks.PendingCount() == 0 );
+    REQUIRE( future.wait_for( std::chrono::seconds( 0)) == std::future_status::ready );
+    auto result = future.get();
+    REQUIRE( result.size() == 64 );
+    REQUIRE( reinterpret_cast<uint32_t*>( result.data())[15] == 225 );
+    REQUIRE( callbackValue == 16 );
+
+    readbacks.Destroy();
+    vktg::DestroyBuffer( buffer);
+}
+
+
+TEST_CASE( "readbacks larger than the ring buffer", "[readback]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 256, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuOnly, vma::AllocationCreateFlagBits::eMapped);
+    auto data = reinterpret_cast<uint8_t*>( buffer.Data());
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    // the ring fits two 48 byte readbacks, the others get temporary buffers
+    vktg::ReadbackQueue readbacks( 128);
+    std::vector<std::future<std::vector<uint8_t>>> futures;
+    SubmitReadbacks( readbacks, [&]( vk::CommandBuffer cmd){
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            futures.push_back( readbacks.ReadBuffer( cmd, buffer, 48 * i, 48));
+        }
+        futures.push_back( readbacks.ReadBuffer( cmd, buffer));
+    });
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        auto result = futures[i].get();
+        REQUIRE( result.size() == 48 );
+        REQUIRE( result[0] == 48 * i );
+        REQUIRE( result[47] == 48 * i + 47 );
+    }
+    REQUIRE( futures[4].get().size() == 256 );
+
+    readbacks.Destroy();
+    vktg::DestroyBuffer( buffer);
+}
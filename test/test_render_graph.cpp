@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/render_graph.h"
+#include "../vulkantogo/storage.h"
+#include "../vulkantogo/synchronization.h"
+
+
+TEST_CASE( "cull passes not contributing to imported resources", "[render_graph]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 16, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuOnly);
+
+    vktg::RenderGraph graph;
+    uint32_t output = graph.ImportBuffer( buffer);
+    uint32_t unused = graph.CreateImage( "unused", 64, 64, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferDst);
+
+    vktg::ResourceUsage transferWrite{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal};
+    graph.AddPass( "fill")
+        .Write( output, transferWrite);
+    graph.AddPass( "unused")
+        .Write( unused, transferWrite);
+    graph.Compile();
+
+    REQUIRE_FALSE( graph.IsPassCulled( "fill") );
+    REQUIRE( graph.IsPassCulled( "unused") );
+    REQUIRE( graph.TransientMemorySize() == 0 );
+
+    graph.Destroy();
+    vktg::DestroyBuffer( buffer);
+}
+
+
+TEST_CASE( "alias transient images with disjoint lifetimes", "[render_graph]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 16, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuOnly);
+
+    vktg::RenderGraph graph;
+    uint32_t output = graph.ImportBuffer( buffer);
+    uint32_t images[3];
+    for (int i = 0; i < 3; i++)
+    {
+        images[i] = graph.CreateImage( "image", 256, 256, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+    }
+
+    vktg::ResourceUsage transferWrite{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal};
+    vktg::ResourceUsage transferRead{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal};
+    graph.AddPass( "write 0")
+        .Write( images[0], transferWrite);
+    graph.AddPass( "copy 0 to 1")
+        .Read( images[0], transferRead)
+        .Write( images[1], transferWrite);
+    graph.AddPass( "copy 1 to 2")
+        .Read( images[1], transferRead)
+        .Write( images[2], transferWrite);
+    graph.AddPass( "copy 2 to output")
+        .Read( images[2], transferRead)
+        .Write( output, transferWrite);
+    graph.Compile();
+
+    // image 0 and image 2 are never alive at the same time
+    vk::MemoryRequirements requirements;
+    vktg::Device().getImageMemoryRequirements( graph.GetImage( images[0]).image, &requirements);
+    REQUIRE( graph.TransientMemorySize() < 3 * requirements.size );
+    REQUIRE_FALSE( !graph.GetImage( images[2]).imageView );
+
+    graph.Destroy();
+    vktg::DestroyBuffer( buffer);
+}
+
+
+TEST_CASE( "execute render graph", "[render_graph]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 4 * 16 * 16, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu, vma::AllocationCreateFlagBits::eMapped);
+
+    vktg::RenderGraph graph;
+    uint32_t output = graph.ImportBuffer( buffer, {}, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eHost, vk::AccessFlagBits2::eHostRead});
+    uint32_t image = graph.CreateImage( "clear", 16, 16, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+
+    graph.AddPass( "clear")
+        .Write( image, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eClear, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal})
+        .SetExecute( [&]( vk::CommandBuffer cmd) {
+            auto clearColor = vk::ClearColorValue{}.setFloat32( {1.f, 0.f, 0.f, 1.f} );
+            auto range = vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+            cmd.clearColorImage( graph.GetImage( image).image, vk::ImageLayout::eTransferDstOptimal, &clearColor, 1, &range);
+        });
+    graph.AddPass( "readback")
+        .Read( image, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal})
+        .Write( output, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite})
+        .SetExecute( [&]( vk::CommandBuffer cmd) {
+            auto region = vk::BufferImageCopy{}
+                .setImageSubresource( vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 0, 0, 1} )
+                .setImageExtent( vk::Extent3D{16, 16, 1} );
+            cmd.copyImageToBuffer( graph.GetImage( image).image, vk::ImageLayout::eTransferSrcOptimal, graph.GetBuffer( output).buffer, 1, &region);
+        });
+    graph.Compile();
+
+    vk::Fence fence = vktg::CreateFence( vk::FenceCreateFlags{});
+    graph.Execute( {}, {}, fence);
+    vktg::WaitForFence( fence);
+
+    uint8_t *pixels = reinterpret_cast<uint8_t*>( buffer.Data());
+    for (int i = 0; i < 16 * 16; i++)
+    {
+        REQUIRE( pixels[4*i] == 255 );
+        REQUIRE( pixels[4*i + 1] == 0 );
+    }
+
+    vktg::DestroyFence( fence);
+    graph.Destroy();
+    vktg::DestroyBuffer( buffer);
+}
@@ -2,6 +2,9 @@
 #include <catch2/catch.hpp>
 
 #include "../vulkantogo/storage.h"
+#include "../vulkantogo/transfer.h"
+
+#include <vector>
 
 
 TEST_CASE("unitialized buffer", "[storage]") {
@@ -84,3 +87,90 @@ TEST_CASE("create image", "[storage]") {
     vktg::DestroyImage( image);
 }
 
+
+
+TEST_CASE( "track image state", "[storage]") {
+
+    vktg::Image image;
+    vktg::CreateImage( image, 256, 256, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::ImageAspectFlagBits::eColor, 4, 2);
+
+    REQUIRE( image.Layout() == vk::ImageLayout::eUndefined );
+
+    // subresources in the same state are transitioned with one barrier
+    vktg::BarrierBatch batch;
+    vktg::Transition( batch, image, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal});
+    REQUIRE( batch.ImageBarriers().size() == 1 );
+    REQUIRE( batch.ImageBarriers()[0].oldLayout == vk::ImageLayout::eUndefined );
+    REQUIRE( batch.ImageBarriers()[0].subresourceRange.levelCount == 4 );
+    REQUIRE( batch.ImageBarriers()[0].subresourceRange.layerCount == 2 );
+    REQUIRE( image.Layout( 3, 1) == vk::ImageLayout::eTransferDstOptimal );
+    batch.Clear();
+
+    // source scope is the last write
+    vktg::ResourceUsage shaderRead{ vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal};
+    vktg::Transition( batch, image, shaderRead, vk::ImageSubresourceRange{ {}, 0, 1, 0, 1});
+    REQUIRE( batch.ImageBarriers().size() == 1 );
+    REQUIRE( batch.ImageBarriers()[0].srcStageMask == vk::PipelineStageFlagBits2::eTransfer );
+    REQUIRE( batch.ImageBarriers()[0].srcAccessMask == vk::AccessFlags2{ vk::AccessFlagBits2::eTransferWrite} );
+    REQUIRE( image.Layout( 0, 0) == vk::ImageLayout::eShaderReadOnlyOptimal );
+    REQUIRE( image.Layout( 1, 0) == vk::ImageLayout::eTransferDstOptimal );
+    batch.Clear();
+
+    // repeated reads need no barrier
+    vktg::Transition( batch, image, shaderRead, vk::ImageSubresourceRange{ {}, 0, 1, 0, 1});
+    REQUIRE( batch.Empty() );
+
+    vktg::DestroyImage( image);
+}
+
+
+TEST_CASE( "track image state after upload", "[storage]") {
+
+    vktg::Image image;
+    vktg::CreateImage( image, 16, 16, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled);
+
+    // the upload ends with a transition to a sampled read
+    std::vector<uint32_t> texels( 16 * 16, 0xff0000ff);
+    vktg::UploadImageData( texels.data(), image);
+    REQUIRE( image.Layout() == vk::ImageLayout::eShaderReadOnlyOptimal );
+
+    vktg::BarrierBatch batch;
+    vktg::ResourceUsage shaderRead{ vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal};
+    vktg::Transition( batch, image, shaderRead);
+    REQUIRE( batch.Empty() );
+
+    // the next write waits for the read, the transfer write of the upload was made available by the read transition
+    vktg::Transition( batch, image, vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal});
+    REQUIRE( batch.ImageBarriers().size() == 1 );
+    REQUIRE( batch.ImageBarriers()[0].srcStageMask == vk::PipelineStageFlagBits2::eFragmentShader );
+    REQUIRE( batch.ImageBarriers()[0].srcAccessMask == vk::AccessFlags2{} );
+    REQUIRE( batch.ImageBarriers()[0].oldLayout == vk::ImageLayout::eShaderReadOnlyOptimal );
+
+    vktg::DestroyImage( image);
+}
+
+
+TEST_CASE( "track buffer state", "[storage]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 256, vk::BufferUsageFlagBits::eStorageBuffer);
+
+    vktg::ResourceUsage computeRead{ vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead};
+    vktg::ResourceUsage computeWrite{ vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite};
+
+    // nothing to wait for before the first write
+    vktg::BarrierBatch batch;
+    vktg::Transition( batch, buffer, computeRead);
+    REQUIRE( batch.Empty() );
+
+    vktg::Transition( batch, buffer, computeWrite);
+    REQUIRE( batch.BufferBarriers().size() == 1 );
+    REQUIRE( batch.BufferBarriers()[0].srcAccessMask == vk::AccessFlags2{} );
+    batch.Clear();
+
+    vktg::Transition( batch, buffer, computeRead);
+    REQUIRE( batch.BufferBarriers().size() == 1 );
+    REQUIRE( batch.BufferBarriers()[0].srcAccessMask == vk::AccessFlags2{ vk::AccessFlagBits2::eShaderStorageWrite} );
+
+    vktg::DestroyBuffer( buffer);
+}
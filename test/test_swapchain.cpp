@@ -2,6 +2,13 @@
 #include <catch2/catch.hpp>
 
 #include "../vulkantogo/swapchain.h"
+#include "../vulkantogo/rendering.h"
+#include "../vulkantogo/submit_context.h"
+#include "../vulkantogo/synchronization.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 
 
 TEST_CASE("prepare swapchain", "[swapchain]") {
@@ -85,4 +92,265 @@ TEST_CASE("swapchain recreation", "[swapchain]") {
     }
 
     vktg::DestroySwapchain( swapchain);
-}
\ No newline at end of file
+}
+
+TEST_CASE("virtual swapchain", "[swapchain]") {
+
+    vktg::VirtualSwapchainSettings settings;
+    settings.width = 320;
+    settings.height = 240;
+    vktg::Swapchain swapchain = vktg::PrepareVirtualSwapchain( settings);
+
+    REQUIRE( swapchain.IsVirtual());
+    REQUIRE( !swapchain.isValid);
+
+    vktg::CreateSwapchain( swapchain);
+
+    REQUIRE( !swapchain.swapchain);
+    REQUIRE( swapchain.imageCount == 3);
+    REQUIRE( swapchain.images.size() == 3);
+    REQUIRE( swapchain.imageViews.size() == 3);
+    REQUIRE( swapchain.Width() == 320);
+    REQUIRE( swapchain.Height() == 240);
+    REQUIRE( swapchain.presentMode == vk::PresentModeKHR::eImmediate);
+    REQUIRE( swapchain.presentLayout == vk::ImageLayout::eTransferSrcOptimal);
+    REQUIRE( swapchain.isValid);
+
+    // images are acquired in order and reused after they have been presented
+    vk::Semaphore readySemaphore = vktg::CreateSemaphore();
+    for (uint32_t i = 0; i < 2 * swapchain.imageCount; i++)
+    {
+        uint32_t imageIndex;
+        REQUIRE( vktg::NextSwapchainImage( swapchain, readySemaphore, &imageIndex));
+        REQUIRE( imageIndex == i % swapchain.imageCount);
+        REQUIRE( vktg::PresentImage( swapchain, &readySemaphore, &imageIndex));
+    }
+
+    auto oldImages = swapchain.images;
+    vktg::CreateSwapchain( swapchain);
+
+    REQUIRE( swapchain.images.size() == oldImages.size());
+    REQUIRE( swapchain.isValid);
+
+    vktg::WaitIdle();
+    vktg::DestroySemaphore( readySemaphore);
+    vktg::DestroySwapchain( swapchain);
+
+    REQUIRE( swapchain.images.empty());
+    REQUIRE( !swapchain.isValid);
+}
+
+
+TEST_CASE("virtual swapchain readback", "[swapchain]") {
+
+    vktg::VirtualSwapchainSettings settings;
+    settings.width = 64;
+    settings.height = 32;
+    settings.readbackPath = "virtual_swapchain_";
+    settings.readbackInterval = 2;
+    vktg::Swapchain swapchain = vktg::PrepareVirtualSwapchain( settings);
+    vktg::CreateSwapchain( swapchain);
+    auto context = vktg::CreateSubmitContext( vktg::QueueType::eGraphics);
+
+    // clear each image to red before presenting it
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        uint32_t imageIndex;
+        vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+
+        context.Begin();
+            vktg::TransitionImageLayout(
+                context.cmd, swapchain.images[imageIndex], vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+                vk::PipelineStageFlagBits2::eClear, vk::AccessFlagBits2::eTransferWrite
+            );
+            auto red = vk::ClearColorValue{ std::array<float, 4>{ 1.f, 0.f, 0.f, 1.f}};
+            auto range = vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+            context.cmd.clearColorImage( swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, &red, 1, &range);
+            vktg::TransitionImageLayout(
+                context.cmd, swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, swapchain.presentLayout,
+                vk::PipelineStageFlagBits2::eClear, vk::AccessFlagBits2::eTransferWrite,
+                vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone
+            );
+        context.End();
+        context.Submit();
+        vktg::WaitForFence( context.fence);
+
+        vktg::PresentImage( swapchain, nullptr, &imageIndex);
+    }
+    vktg::DestroySwapchain( swapchain);
+    vktg::DestroySubmitContext( context);
+
+    // every second present is written
+    std::ifstream first( "virtual_swapchain_0.ppm", std::ios::binary);
+    std::ifstream second( "virtual_swapchain_1.ppm", std::ios::binary);
+    std::ifstream third( "virtual_swapchain_2.ppm", std::ios::binary);
+    REQUIRE( first.is_open());
+    REQUIRE( !second.is_open());
+    REQUIRE( third.is_open());
+
+    std::string magic;
+    uint32_t width, height;
+    first >> magic >> width >> height;
+    REQUIRE( magic == "P6");
+    REQUIRE( width == 64);
+    REQUIRE( height == 32);
+
+    // the BGRA image is written as RGB
+    uint32_t maxValue;
+    first >> maxValue;
+    first.get();
+    char pixel[3];
+    first.read( pixel, 3);
+    REQUIRE( (uint8_t)pixel[0] == 255);
+    REQUIRE( (uint8_t)pixel[1] == 0);
+    REQUIRE( (uint8_t)pixel[2] == 0);
+
+    first.close();
+    third.close();
+    std::remove( "virtual_swapchain_0.ppm");
+    std::remove( "virtual_swapchain_2.ppm");
+}
+
+
+TEST_CASE("virtual swapchain fixed rate", "[swapchain]") {
+
+    vktg::VirtualSwapchainSettings settings;
+    settings.width = 64;
+    settings.height = 64;
+    settings.presentMode = vktg::VirtualPresentMode::eFixedRate;
+    settings.presentRate = 100.0;
+    vktg::Swapchain swapchain = vktg::PrepareVirtualSwapchain( settings);
+    vktg::CreateSwapchain( swapchain);
+
+    REQUIRE( swapchain.presentMode == vk::PresentModeKHR::eFifo);
+
+    // after the first imageCount frames each acquire waits for the next display period
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        uint32_t imageIndex;
+        vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+        vktg::PresentImage( swapchain, nullptr, &imageIndex);
+    }
+    auto elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start).count();
+
+    REQUIRE( elapsed >= 0.06);
+
+    vktg::DestroySwapchain( swapchain);
+}
+
+
+TEST_CASE("swapchain recreation with retired swapchain", "[swapchain]") {
+
+    vktg::DeferredDeletionQueue retired;
+    vktg::Swapchain swapchain = vktg::PrepareSwapchain();
+    vktg::CreateSwapchain( swapchain);
+    auto oldSwapchain = swapchain;
+    vktg::CreateSwapchain( swapchain, &retired, 7);
+
+    // the old swapchain and image views stay alive until frame 7 retired
+    REQUIRE( swapchain.swapchain != oldSwapchain.swapchain);
+    REQUIRE( swapchain.isValid);
+    REQUIRE( retired.Size() == 1);
+
+    retired.Flush( 6);
+    REQUIRE( retired.Size() == 1);
+    retired.Flush( 7);
+    REQUIRE( retired.Size() == 0);
+
+    vktg::DestroySwapchain( swapchain);
+}
+
+
+TEST_CASE("virtual swapchain recreation with retired images", "[swapchain]") {
+
+    vktg::DeferredDeletionQueue retired;
+    vktg::VirtualSwapchainSettings settings;
+    settings.width = 64;
+    settings.height = 64;
+    vktg::Swapchain swapchain = vktg::PrepareVirtualSwapchain( settings);
+    vktg::CreateSwapchain( swapchain);
+
+    uint32_t imageIndex;
+    vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+    vktg::PresentImage( swapchain, nullptr, &imageIndex);
+
+    swapchain.extent = vk::Extent2D{ 128, 96};
+    vktg::CreateSwapchain( swapchain, &retired, 0);
+
+    REQUIRE( swapchain.Width() == 128);
+    REQUIRE( swapchain.images.size() == swapchain.imageCount);
+    REQUIRE( retired.Size() == 1);
+
+    vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+    vktg::PresentImage( swapchain, nullptr, &imageIndex);
+    retired.Flush( 0);
+    REQUIRE( retired.Size() == 0);
+
+    // images retired before the swapchain is destroyed are still destroyed with their present fences afterwards
+    swapchain.extent = vk::Extent2D{ 64, 64};
+    vktg::CreateSwapchain( swapchain, &retired, 1);
+    vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+    vktg::PresentImage( swapchain, nullptr, &imageIndex);
+    vktg::WaitIdle();
+    vktg::DestroySwapchain( swapchain);
+    REQUIRE( retired.Size() == 1);
+    retired.FlushAll();
+    REQUIRE( retired.Size() == 0);
+}
+
+
+TEST_CASE("present policies", "[swapchain]") {
+
+    auto defaultSwapchain = vktg::PrepareSwapchain();
+    auto lowLatency = vktg::PrepareSwapchain( vktg::PresentPolicy::eLowLatency);
+    auto throughput = vktg::PrepareSwapchain( vktg::PresentPolicy::eThroughput);
+
+    REQUIRE( defaultSwapchain.policy == vktg::PresentPolicy::eDefault);
+    REQUIRE( defaultSwapchain.framesInFlight == 2);
+
+    REQUIRE( lowLatency.policy == vktg::PresentPolicy::eLowLatency);
+    REQUIRE( lowLatency.framesInFlight == 1);
+    REQUIRE( (lowLatency.presentMode == vk::PresentModeKHR::eMailbox || lowLatency.presentMode == vk::PresentModeKHR::eFifo));
+    REQUIRE( lowLatency.imageCount <= defaultSwapchain.imageCount);
+
+    REQUIRE( throughput.policy == vktg::PresentPolicy::eThroughput);
+    REQUIRE( throughput.framesInFlight == 3);
+    REQUIRE( throughput.presentMode == vk::PresentModeKHR::eFifo);
+    REQUIRE( throughput.imageCount >= defaultSwapchain.imageCount);
+
+    REQUIRE( lowLatency.presentWait == vktg::PresentWaitEnabled());
+    REQUIRE( lowLatency.presentId == 0);
+}
+
+
+TEST_CASE("input to present latency", "[swapchain]") {
+
+    vktg::VirtualSwapchainSettings settings;
+    settings.width = 64;
+    settings.height = 64;
+    vktg::Swapchain swapchain = vktg::PrepareVirtualSwapchain( settings);
+    vktg::CreateSwapchain( swapchain);
+
+    uint32_t imageIndex;
+    vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+    vktg::PresentImage( swapchain, nullptr, &imageIndex);
+
+    REQUIRE( swapchain.presentId == 1);
+    REQUIRE( swapchain.inputLatency == 0.0);
+    REQUIRE( swapchain.inputLatencyCount == 0);
+
+    // virtual swapchains have no present wait, so latency is measured when the present is queued
+    auto inputTime = std::chrono::steady_clock::now() - std::chrono::milliseconds( 5);
+    vktg::NextSwapchainImage( swapchain, nullptr, &imageIndex);
+    vktg::PresentImage( swapchain, nullptr, &imageIndex, inputTime);
+
+    REQUIRE( swapchain.presentId == 2);
+    REQUIRE( swapchain.inputLatency >= 5.0);
+    REQUIRE( swapchain.inputLatencyCount == 1);
+    REQUIRE_FALSE( vktg::WaitForPresentPacing( swapchain));
+    REQUIRE( swapchain.inputLatencyCount == 1);
+
+    vktg::DestroySwapchain( swapchain);
+}
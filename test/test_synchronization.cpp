@@ -89,4 +89,72 @@ TEST_CASE("create image memory barrier", "[synchronization]") {
     REQUIRE( barrier.srcAccessMask == vk::AccessFlags2{ vk::AccessFlagBits2::eNone} );
     REQUIRE( barrier.dstStageMask == vk::PipelineStageFlagBits2::eColorAttachmentOutput );
     REQUIRE( barrier.dstAccessMask == vk::AccessFlags2{ vk::AccessFlagBits2::eColorAttachmentWrite} );
-}
\ No newline at end of file
+}
+
+TEST_CASE("merge barriers in barrier batch", "[synchronization]") {
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 256, vk::BufferUsageFlagBits::eUniformBuffer);
+    vktg::Image image;
+    vktg::CreateImage( image, 256, 256, vk::Format::eR8G8B8A8Srgb, vk::ImageUsageFlagBits::eTransferDst, vk::ImageAspectFlagBits::eColor, 4);
+
+    vktg::BarrierBatch batch;
+    REQUIRE( batch.Empty() );
+
+    // memory barriers with equal source scope
+    batch.Add( vktg::CreateMemoryBarrier(
+        vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eVertexShader, vk::AccessFlagBits2::eShaderRead
+    ));
+    batch.Add( vktg::CreateMemoryBarrier(
+        vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderRead
+    ));
+    REQUIRE( batch.MemoryBarriers().size() == 1 );
+    REQUIRE( batch.MemoryBarriers()[0].dstStageMask == (vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eFragmentShader) );
+
+    // adjacent buffer ranges
+    batch.Add( vktg::CreateBufferMemoryBarrier(
+        buffer.buffer, 
+        vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead,
+        0, 128
+    ));
+    batch.Add( vktg::CreateBufferMemoryBarrier(
+        buffer.buffer, 
+        vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+        vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead,
+        128, 128
+    ));
+    REQUIRE( batch.BufferBarriers().size() == 1 );
+    REQUIRE( batch.BufferBarriers()[0].offset == 0 );
+    REQUIRE( batch.BufferBarriers()[0].size == 256 );
+
+    // adjacent mip levels, different layouts are kept separate
+    for (uint32_t mip = 0; mip < 3; mip++)
+    {
+        batch.Add( vktg::CreateImageMemoryBarrier(
+            image.image, 
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+            vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+            vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+            vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, mip, 1, 0, 1}
+        ));
+    }
+    batch.Add( vktg::CreateImageMemoryBarrier(
+        image.image, 
+        vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferSrcOptimal,
+        vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone,
+        vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead,
+        vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 3, 1, 0, 1}
+    ));
+    REQUIRE( batch.ImageBarriers().size() == 2 );
+    REQUIRE( batch.ImageBarriers()[0].subresourceRange.baseMipLevel == 0 );
+    REQUIRE( batch.ImageBarriers()[0].subresourceRange.levelCount == 3 );
+
+    batch.Clear();
+    REQUIRE( batch.Empty() );
+
+    vktg::DestroyImage( image);
+    vktg::DestroyBuffer( buffer);
+}
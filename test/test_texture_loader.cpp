@@ -0,0 +1,179 @@
+
+#include <catch2/catch.hpp>
+
+#include "../examples/shared/texture_loader.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+// small texture files written by the tests, the loaders only read from disk
+
+static void WriteFixture( const std::string &path, const std::vector<uint8_t> &bytes) {
+
+    std::ofstream file( path, std::ios::binary);
+    file.write( reinterpret_cast<const char*>( bytes.data()), bytes.size());
+}
+
+
+template<typename T>
+static void Write( std::vector<uint8_t> &bytes, size_t offset, T value) {
+
+    if (bytes.size() < offset + sizeof(T))
+    {
+        bytes.resize( offset + sizeof(T));
+    }
+    memcpy( bytes.data() + offset, &value, sizeof(T));
+}
+
+
+// KTX2 file with one level index entry per level, levels are stored smallest first like in files written by ktx tools
+static std::vector<uint8_t> Ktx2Fixture( vk::Format format, uint32_t width, uint32_t height, uint32_t faceCount, const std::vector<std::vector<uint8_t>> &levels) {
+
+    static const uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    std::vector<uint8_t> bytes( 80 + 24 * levels.size(), 0);
+    memcpy( bytes.data(), identifier, sizeof(identifier));
+    Write<uint32_t>( bytes, 12, (uint32_t)format);
+    Write<uint32_t>( bytes, 16, 1);
+    Write<uint32_t>( bytes, 20, width);
+    Write<uint32_t>( bytes, 24, height);
+    Write<uint32_t>( bytes, 36, faceCount);
+    Write<uint32_t>( bytes, 40, (uint32_t)levels.size());
+
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        Write<uint64_t>( bytes, 80 + 24 * level, bytes.size());
+        Write<uint64_t>( bytes, 80 + 24 * level + 8, levels[level].size());
+        Write<uint64_t>( bytes, 80 + 24 * level + 16, levels[level].size());
+        bytes.insert( bytes.end(), levels[level].begin(), levels[level].end());
+    }
+
+    return bytes;
+}
+
+
+// DDS file with DX10 header, data is stored layer after layer, each with all its mip levels
+static std::vector<uint8_t> DdsFixture( uint32_t dxgiFormat, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t arraySize, const std::vector<uint8_t> &data) {
+
+    std::vector<uint8_t> bytes( 148, 0);
+    Write<uint32_t>( bytes, 0, 0x20534444);
+    Write<uint32_t>( bytes, 4, 124);
+    Write<uint32_t>( bytes, 12, height);
+    Write<uint32_t>( bytes, 16, width);
+    Write<uint32_t>( bytes, 28, mipCount);
+    Write<uint32_t>( bytes, 76, 32);
+    Write<uint32_t>( bytes, 80, 0x4);
+    Write<uint32_t>( bytes, 84, 0x30315844);
+    Write<uint32_t>( bytes, 128, dxgiFormat);
+    Write<uint32_t>( bytes, 132, 3);
+    Write<uint32_t>( bytes, 140, arraySize);
+    bytes.insert( bytes.end(), data.begin(), data.end());
+
+    return bytes;
+}
+
+
+TEST_CASE( "load block-compressed KTX2 texture", "[texture_loader]") {
+
+    // BC1 8x8 with two levels, 4 blocks and 1 block of 8 bytes
+    std::vector<std::vector<uint8_t>> levels = { std::vector<uint8_t>( 32, 0x11), std::vector<uint8_t>( 8, 0x22)};
+    auto path = (std::filesystem::temp_directory_path() / "vktg_test_bc1.ktx2").string();
+    WriteFixture( path, Ktx2Fixture( vk::Format::eBc1RgbaUnormBlock, 8, 8, 1, levels));
+
+    auto texture = LoadTexture( path);
+    REQUIRE( texture.format == vk::Format::eBc1RgbaUnormBlock );
+    REQUIRE( texture.width == 8 );
+    REQUIRE( texture.height == 8 );
+    REQUIRE( texture.mipLevels == 2 );
+    REQUIRE( texture.layers == 1 );
+    REQUIRE_FALSE( texture.cubemap );
+    // level 0 first, regardless of the order in the file
+    REQUIRE( texture.data.size() == 40 );
+    REQUIRE( texture.data[0] == 0x11 );
+    REQUIRE( texture.data[32] == 0x22 );
+
+    std::filesystem::remove( path);
+}
+
+
+TEST_CASE( "reject malformed KTX2 texture", "[texture_loader]") {
+
+    auto path = (std::filesystem::temp_directory_path() / "vktg_test_invalid.ktx2").string();
+
+    // no faces
+    WriteFixture( path, Ktx2Fixture( vk::Format::eR8G8B8A8Unorm, 2, 2, 0, { std::vector<uint8_t>( 16)}));
+    REQUIRE_THROWS( LoadKtx2( path) );
+
+    // level size does not match the format
+    WriteFixture( path, Ktx2Fixture( vk::Format::eR8G8B8A8Unorm, 2, 2, 1, { std::vector<uint8_t>( 12)}));
+    REQUIRE_THROWS( LoadKtx2( path) );
+
+    // level data past the end of the file
+    auto bytes = Ktx2Fixture( vk::Format::eR8G8B8A8Unorm, 2, 2, 1, { std::vector<uint8_t>( 16)});
+    bytes.resize( bytes.size() - 4);
+    WriteFixture( path, bytes);
+    REQUIRE_THROWS( LoadKtx2( path) );
+
+    std::filesystem::remove( path);
+}
+
+
+TEST_CASE( "load DDS texture array", "[texture_loader]") {
+
+    // RGBA8 2x2 with two levels and two layers, each texel holds 10 * layer + level
+    std::vector<uint8_t> data;
+    for (uint8_t layer = 0; layer < 2; layer++)
+    {
+        data.insert( data.end(), 4 * 4, (uint8_t)(10 * layer));
+        data.insert( data.end(), 4, (uint8_t)(10 * layer + 1));
+    }
+    auto path = (std::filesystem::temp_directory_path() / "vktg_test_array.dds").string();
+    WriteFixture( path, DdsFixture( 28, 2, 2, 2, 2, data));
+
+    auto texture = LoadTexture( path);
+    REQUIRE( texture.format == vk::Format::eR8G8B8A8Unorm );
+    REQUIRE( texture.mipLevels == 2 );
+    REQUIRE( texture.layers == 2 );
+    // reordered to all layers of one mip level after another
+    REQUIRE( texture.data.size() == data.size() );
+    REQUIRE( texture.data[0] == 0 );
+    REQUIRE( texture.data[16] == 10 );
+    REQUIRE( texture.data[32] == 1 );
+    REQUIRE( texture.data[36] == 11 );
+
+    std::filesystem::remove( path);
+}
+
+
+TEST_CASE( "load legacy DDS texture", "[texture_loader]") {
+
+    // DXT1 4x4, a single block
+    std::vector<uint8_t> bytes( 128, 0);
+    Write<uint32_t>( bytes, 0, 0x20534444);
+    Write<uint32_t>( bytes, 4, 124);
+    Write<uint32_t>( bytes, 12, 4);
+    Write<uint32_t>( bytes, 16, 4);
+    Write<uint32_t>( bytes, 76, 32);
+    Write<uint32_t>( bytes, 80, 0x4);
+    Write<uint32_t>( bytes, 84, 0x31545844);
+    bytes.insert( bytes.end(), 8, (uint8_t)0x33);
+    auto path = (std::filesystem::temp_directory_path() / "vktg_test_dxt1.dds").string();
+    WriteFixture( path, bytes);
+
+    auto texture = LoadDds( path, true);
+    REQUIRE( texture.format == vk::Format::eBc1RgbaSrgbBlock );
+    REQUIRE( texture.mipLevels == 1 );
+    REQUIRE( texture.data == std::vector<uint8_t>( 8, 0x33) );
+    REQUIRE( LoadDds( path, false).format == vk::Format::eBc1RgbaUnormBlock );
+
+    // truncated data
+    bytes.resize( bytes.size() - 1);
+    WriteFixture( path, bytes);
+    REQUIRE_THROWS( LoadDds( path) );
+
+    std::filesystem::remove( path);
+}
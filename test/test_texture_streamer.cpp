@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/texture_streamer.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+
+// runs streamer updates until all pending residency changes are done
+static void UpdateUntilIdle( vktg::TextureStreamer &streamer) {
+
+    for (int i = 0; i < 1000; i++)
+    {
+        streamer.Update();
+        if (streamer.PendingCount() == 0)
+        {
+            return;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1));
+    }
+}
+
+
+TEST_CASE( "stream texture mip levels", "[texture_streamer]") {
+
+    vktg::TextureStreamer streamer( 2);
+
+    vktg::StreamedTextureInfo info;
+    info.format = vk::Format::eR8G8B8A8Unorm;
+    info.width = 256;
+    info.height = 256;
+    info.mipLevels = 9;
+    info.loadLevel = []( uint32_t mipLevel, std::span<uint8_t> dst) {
+        memset( dst.data(), (int)mipLevel, dst.size());
+    };
+    uint32_t texture = streamer.AddTexture( info);
+
+    // only the mip tail up to 64x64 is resident at first
+    REQUIRE( streamer.ResidentMip( texture) == 2 );
+    REQUIRE( streamer.GetImage( texture).Width() == 64 );
+    REQUIRE( streamer.GetImage( texture).MipLevels() == 7 );
+
+    // covering 256 pixels on screen needs the full resolution
+    streamer.SetPriority( texture, 256.f);
+    UpdateUntilIdle( streamer);
+    streamer.Update();
+    REQUIRE( streamer.ResidentMip( texture) == 0 );
+    REQUIRE( streamer.GetImage( texture).Width() == 256 );
+    REQUIRE( streamer.GetImage( texture).MipLevels() == 9 );
+
+    // evict top levels under memory pressure, but keep the mip tail
+    vk::DeviceSize budget = streamer.MemoryUsage() / 2;
+    streamer.SetMemoryBudget( budget);
+    UpdateUntilIdle( streamer);
+    streamer.Update();
+    REQUIRE( streamer.ResidentMip( texture) > 0 );
+    REQUIRE( streamer.ResidentMip( texture) <= 2 );
+    REQUIRE( streamer.MemoryUsage() <= budget );
+
+    streamer.Destroy();
+}
+
+
+TEST_CASE( "skip failed mip level loads", "[texture_streamer]") {
+
+    vktg::TextureStreamer streamer( 2);
+
+    vktg::StreamedTextureInfo info;
+    info.format = vk::Format::eR8G8B8A8Unorm;
+    info.width = 256;
+    info.height = 256;
+    info.mipLevels = 9;
+    info.loadLevel = []( uint32_t mipLevel, std::span<uint8_t> dst) {
+        memset( dst.data(), (int)mipLevel, dst.size());
+    };
+    uint32_t texture = streamer.AddTexture( info);
+
+    // levels above the mip tail fail to load
+    info.loadLevel = []( uint32_t mipLevel, std::span<uint8_t> dst) {
+        if (mipLevel < 2)
+        {
+            throw std::runtime_error( "missing mip level");
+        }
+        memset( dst.data(), (int)mipLevel, dst.size());
+    };
+    uint32_t failingTexture = streamer.AddTexture( info);
+
+    // the failed load does not stop the other texture from streaming in
+    streamer.SetPriority( texture, 256.f);
+    streamer.SetPriority( failingTexture, 256.f);
+    UpdateUntilIdle( streamer);
+    streamer.Update();
+    REQUIRE( streamer.ResidentMip( texture) == 0 );
+    REQUIRE( streamer.ResidentMip( failingTexture) == 2 );
+    REQUIRE( streamer.LoadError( failingTexture) != nullptr );
+    REQUIRE( streamer.LoadError( texture) == nullptr );
+
+    // not loaded again until the error is cleared
+    streamer.Update();
+    REQUIRE( streamer.PendingCount() == 0 );
+    streamer.ClearLoadError( failingTexture);
+    streamer.Update();
+    REQUIRE( streamer.PendingCount() == 1 );
+
+    streamer.Destroy();
+}
+
+
+TEST_CASE( "remove streamed textures once", "[texture_streamer]") {
+
+    vktg::TextureStreamer streamer( 2);
+
+    vktg::StreamedTextureInfo info;
+    info.format = vk::Format::eR8G8B8A8Unorm;
+    info.width = 256;
+    info.height = 256;
+    info.mipLevels = 9;
+    info.loadLevel = []( uint32_t mipLevel, std::span<uint8_t> dst) {
+        memset( dst.data(), (int)mipLevel, dst.size());
+    };
+    uint32_t texture = streamer.AddTexture( info);
+    vk::DeviceSize textureUsage = streamer.MemoryUsage();
+    uint32_t otherTexture = streamer.AddTexture( info);
+
+    // removing twice or an unknown handle neither underflows the memory usage nor retires the image again
+    streamer.RemoveTexture( texture);
+    REQUIRE( streamer.MemoryUsage() == textureUsage );
+    streamer.RemoveTexture( texture);
+    streamer.RemoveTexture( otherTexture + 1);
+    REQUIRE( streamer.MemoryUsage() == textureUsage );
+
+    streamer.RemoveTexture( otherTexture);
+    REQUIRE( streamer.MemoryUsage() == 0 );
+
+    // retired images are destroyed once, after the frames in flight
+    for (int i = 0; i < 4; i++)
+    {
+        streamer.Update();
+    }
+    streamer.Destroy();
+}
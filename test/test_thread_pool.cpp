@@ -0,0 +1,39 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/util/thread_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+
+
+TEST_CASE("run jobs on thread pool", "[util, thread_pool]") {
+
+    vktg::ThreadPool threadPool( 4);
+    REQUIRE( threadPool.ThreadCount() == 4 );
+
+    std::atomic<int> counter = 0;
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; i++)
+    {
+        results.push_back( threadPool.Submit( [&counter, i](){
+            counter++;
+            return i * i;
+        }));
+    }
+    threadPool.Wait();
+
+    REQUIRE( counter == 100 );
+    for (int i = 0; i < 100; i++)
+    {
+        REQUIRE( results[i].get() == i * i );
+    }
+}
+
+
+TEST_CASE("forward job exceptions", "[util, thread_pool]") {
+
+    vktg::ThreadPool threadPool( 1);
+    auto result = threadPool.Submit( [](){ throw std::runtime_error( "failed job"); });
+
+    REQUIRE_THROWS_AS( result.get(), std::runtime_error );
+}
@@ -2,6 +2,7 @@
 #include <catch2/catch.hpp>
 
 #include "../vulkantogo/transfer.h"
+#include "../vulkantogo/formats.h"
 #include "../vulkantogo/storage.h"
 #include "../vulkantogo/commands.h"
 #include "../vulkantogo/synchronization.h"
@@ -116,3 +117,149 @@ TEST_CASE( "copy buffer regions to buffer", "[transfer]") {
     vktg::DestroyCommandPool( cmdPool);
     vktg::DestroyFence( fence);
 }
+
+
+TEST_CASE( "generate mipmaps", "[transfer]") {
+
+    REQUIRE( vktg::MipLevelCount( 16, 16) == 5 );
+    REQUIRE( vktg::MipLevelCount( 300, 20) == 9 );
+
+    vktg::Image image;
+    vktg::CreateImage( 
+        image, 16, 16, vk::Format::eR8G8B8A8Unorm, 
+        vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst, 
+        vk::ImageAspectFlagBits::eColor, vktg::MipLevelCount( 16, 16), 2
+    );
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 4, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu, vma::AllocationCreateFlagBits::eMapped);
+
+    vk::CommandPool cmdPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
+    vk::CommandBuffer cmd = vktg::AllocateCommandBuffer( cmdPool);
+    vk::Fence fence = vktg::CreateFence( vk::FenceCreateFlags{});
+
+    auto cmdBeginInfo = vk::CommandBufferBeginInfo{}
+        .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );		
+    cmd.begin( cmdBeginInfo);
+
+        // fill level 0 of all layers with one color
+        vktg::Transition( 
+            cmd, image, 
+            vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eClear, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal},
+            vk::ImageSubresourceRange{ {}, 0, 1, 0, 2}
+        );
+        auto clearColor = vk::ClearColorValue{}.setFloat32( {1.f, 0.f, 1.f, 1.f} );
+        auto range = vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 2};
+        cmd.clearColorImage( image.image, vk::ImageLayout::eTransferDstOptimal, &clearColor, 1, &range);
+
+        vktg::GenerateMipmaps( 
+            cmd, image, 
+            vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal}
+        );
+
+        // read back the 1x1 level of the second layer
+        auto region = vk::BufferImageCopy{}
+            .setImageSubresource( vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 4, 1, 1} )
+            .setImageExtent( vk::Extent3D{1, 1, 1} );
+        cmd.copyImageToBuffer( image.image, vk::ImageLayout::eTransferSrcOptimal, buffer.buffer, 1, &region);
+
+        auto hostBarrier = vktg::CreateMemoryBarrier(
+            vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eHost, vk::AccessFlagBits2::eHostRead
+        );
+        vktg::BarrierBatch().Add( hostBarrier).Flush( cmd);
+
+    cmd.end();
+
+    vk::CommandBufferSubmitInfo cmdInfos[] = {
+        vk::CommandBufferSubmitInfo{}
+            .setCommandBuffer( cmd )
+    };
+    vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, {}, {}, fence);
+    vktg::WaitForFence( fence);
+
+    REQUIRE( image.Layout( 4, 1) == vk::ImageLayout::eTransferSrcOptimal );
+    uint8_t *pixel = reinterpret_cast<uint8_t*>( buffer.Data());
+    REQUIRE( pixel[0] == 255 );
+    REQUIRE( pixel[1] == 0 );
+    REQUIRE( pixel[2] == 255 );
+
+    vktg::DestroyCommandPool( cmdPool);
+    vktg::DestroyFence( fence);
+    vktg::DestroyBuffer( buffer);
+    vktg::DestroyImage( image);
+}
+
+
+TEST_CASE( "upload all mip levels and layers of an image", "[transfer]") {
+
+    vktg::Image image;
+    vktg::CreateImage( 
+        image, 4, 4, vk::Format::eR8G8B8A8Unorm, 
+        vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst, 
+        vk::ImageAspectFlagBits::eColor, 3, 2
+    );
+
+    std::vector<vk::BufferImageCopy2> regions;
+    vk::DeviceSize packedSize = vktg::PackedImageRegions( image, regions);
+    REQUIRE( regions.size() == 3 );
+    REQUIRE( regions[2].imageSubresource.mipLevel == 2 );
+    REQUIRE( regions[2].imageSubresource.layerCount == 2 );
+    REQUIRE( packedSize == vktg::ImageDataSize( image.Format(), 4, 4, 3, 2) );
+
+    // every texel holds mip level and layer of its subresource
+    std::vector<uint8_t> data;
+    for (uint32_t mip = 0; mip < 3; mip++)
+    {
+        for (uint32_t layer = 0; layer < 2; layer++)
+        {
+            uint32_t texels = (4 >> mip) * (4 >> mip);
+            for (uint32_t i = 0; i < 4 * texels; i++)
+            {
+                data.push_back( uint8_t(16 * mip + layer) );
+            }
+        }
+    }
+    REQUIRE( data.size() == packedSize );
+
+    vktg::UploadImageData( 
+        data.data(), image, 
+        vktg::ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal}
+    );
+    REQUIRE( image.Layout( 2, 1) == vk::ImageLayout::eTransferSrcOptimal );
+
+    vktg::Buffer buffer;
+    vktg::CreateBuffer( buffer, 4 * 2 * 2, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu, vma::AllocationCreateFlagBits::eMapped);
+
+    vk::CommandPool cmdPool = vktg::CreateCommandPool( vktg::GraphicsQueueIndex());
+    vk::CommandBuffer cmd = vktg::AllocateCommandBuffer( cmdPool);
+    vk::Fence fence = vktg::CreateFence( vk::FenceCreateFlags{});
+
+    auto cmdBeginInfo = vk::CommandBufferBeginInfo{}
+        .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );		
+    cmd.begin( cmdBeginInfo);
+
+        vktg::CopyImageToBuffer( 
+            cmd, image.image, buffer.buffer, 0, 2, 2, 
+            vk::Offset3D{0, 0, 0}, vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 1, 1, 1}
+        );
+
+    cmd.end();
+
+    vk::CommandBufferSubmitInfo cmdInfos[] = {
+        vk::CommandBufferSubmitInfo{}
+            .setCommandBuffer( cmd )
+    };
+    vktg::SubmitCommands( vktg::GraphicsQueue(), cmdInfos, {}, {}, fence);
+    vktg::WaitForFence( fence);
+
+    uint8_t *pixels = reinterpret_cast<uint8_t*>( buffer.Data());
+    for (int i = 0; i < 4 * 2 * 2; i++)
+    {
+        REQUIRE( pixels[i] == 17 );
+    }
+
+    vktg::DestroyCommandPool( cmdPool);
+    vktg::DestroyFence( fence);
+    vktg::DestroyBuffer( buffer);
+    vktg::DestroyImage( image);
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch.hpp>
+
+#include "../vulkantogo/vertex_formats.h"
+
+#include <cmath>
+#include <cstddef>
+
+
+struct PackedTestVertex {
+
+    vktg::Float3 position;
+    vktg::Unorm8x4 color;
+    vktg::Half2 texCoord;
+    vktg::Snorm16x2 normal;
+    vktg::Snorm16x2 tangent;
+};
+using PackedTestLayout = vktg::VertexLayout<vktg::Float3, vktg::Unorm8x4, vktg::Half2, vktg::Snorm16x2, vktg::Snorm16x2>;
+
+static_assert( PackedTestLayout::stride == sizeof(PackedTestVertex));
+static_assert( PackedTestLayout::Attributes()[3].offset == offsetof(PackedTestVertex, normal));
+
+
+TEST_CASE( "vertex layout", "[vertex_formats]") {
+
+    REQUIRE( PackedTestLayout::stride == 28 );
+
+    auto binding = PackedTestLayout::Binding( 1, vk::VertexInputRate::eInstance);
+    REQUIRE( binding.binding == 1 );
+    REQUIRE( binding.stride == sizeof(PackedTestVertex) );
+    REQUIRE( binding.inputRate == vk::VertexInputRate::eInstance );
+
+    auto attributes = PackedTestLayout::Attributes( 1, 2);
+    REQUIRE( attributes.size() == 5 );
+    REQUIRE( attributes[0].location == 2 );
+    REQUIRE( attributes[0].binding == 1 );
+    REQUIRE( attributes[0].format == vk::Format::eR32G32B32Sfloat );
+    REQUIRE( attributes[1].format == vk::Format::eR8G8B8A8Unorm );
+    REQUIRE( attributes[1].offset == offsetof(PackedTestVertex, color) );
+    REQUIRE( attributes[2].format == vk::Format::eR16G16Sfloat );
+    REQUIRE( attributes[2].offset == offsetof(PackedTestVertex, texCoord) );
+    REQUIRE( attributes[4].location == 6 );
+    REQUIRE( attributes[4].format == vk::Format::eR16G16Snorm );
+    REQUIRE( attributes[4].offset == offsetof(PackedTestVertex, tangent) );
+
+    // trailing padding is part of the stride
+    REQUIRE( vktg::VertexLayout<vktg::Float3, vktg::Half2, vktg::Unorm8x4, uint8_t>::stride == 24 );
+}
+
+
+TEST_CASE( "half floats", "[vertex_formats]") {
+
+    REQUIRE( vktg::HalfToFloat( vktg::FloatToHalf( 1.f)) == 1.f );
+    REQUIRE( vktg::HalfToFloat( vktg::FloatToHalf( -2.5f)) == -2.5f );
+    REQUIRE( vktg::HalfToFloat( vktg::FloatToHalf( 65504.f)) == 65504.f );
+    REQUIRE( vktg::FloatToHalf( 1.f) == 0x3C00 );
+    REQUIRE( vktg::FloatToHalf( 1e6f) == 0x7C00 );
+    // smallest subnormal half
+    REQUIRE( vktg::HalfToFloat( vktg::FloatToHalf( std::ldexp( 1.f, -24))) == std::ldexp( 1.f, -24) );
+    REQUIRE( std::abs( vktg::HalfToFloat( vktg::FloatToHalf( 0.3333f)) - 0.3333f) < 1e-3f );
+}
+
+
+TEST_CASE( "octahedral encoding", "[vertex_formats]") {
+
+    vktg::Float3 directions[] = {
+        { 0.f, 0.f, 1.f}, { 0.f, 0.f, -1.f}, { 1.f, 0.f, 0.f}, { 0.f, -1.f, 0.f},
+        { 0.577f, -0.577f, 0.577f}, { -0.3f, 0.5f, -0.81f}
+    };
+    for (auto &direction : directions)
+    {
+        float length = std::sqrt( direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        auto decoded = vktg::UnpackOctahedral( vktg::PackOctahedral( direction));
+        float cosAngle = (direction.x * decoded.x + direction.y * decoded.y + direction.z * decoded.z) / length;
+        REQUIRE( cosAngle > 0.99999f );
+    }
+}
+
+
+TEST_CASE( "position quantization", "[vertex_formats]") {
+
+    vktg::Float3 boundsMin{ -1.f, -1.f, -1.f};
+    vktg::Float3 boundsMax{ 3.f, 1.f, 2.f};
+    vktg::Float3 position{ 0.3f, -1.f, 2.f};
+
+    auto quantized = vktg::QuantizePosition( position, boundsMin, boundsMax);
+    REQUIRE( quantized.y == 0 );
+    REQUIRE( quantized.z == 65535 );
+    REQUIRE( quantized.w == 65535 );
+
+    auto restored = vktg::DequantizePosition( quantized, boundsMin, boundsMax);
+    REQUIRE( std::abs( restored.x - position.x) < 4.f / 65535.f );
+    REQUIRE( restored.y == position.y );
+    REQUIRE( restored.z == position.z );
+
+    auto color = vktg::PackUnorm8x4( 1.f, 0.f, 0.5f, 2.f);
+    REQUIRE( color.r == 255 );
+    REQUIRE( color.g == 0 );
+    REQUIRE( color.b == 128 );
+    REQUIRE( color.a == 255 );
+}
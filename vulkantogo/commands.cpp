@@ -1,6 +1,7 @@
 
 
 #include "commands.h"
+#include "util/cpu_profiler.h"
 
 
 namespace vktg 
@@ -42,6 +43,8 @@ namespace vktg
 
     void SubmitCommands( vk::Queue queue, std::span<vk::CommandBufferSubmitInfo> commandBuffers, std::span<vk::SemaphoreSubmitInfo> waitSemaphores, std::span<vk::SemaphoreSubmitInfo> signalSemaphores, vk::Fence fence) {
 
+        VKTG_PROFILE_FUNCTION();
+
         auto submitInfo = vk::SubmitInfo2{}
             .setCommandBufferInfoCount( commandBuffers.size() )
             .setPCommandBufferInfos( commandBuffers.data() )
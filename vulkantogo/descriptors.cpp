@@ -1,5 +1,6 @@
 
 #include "descriptors.h"
+#include "util/cpu_profiler.h"
 
 
 namespace vktg
@@ -8,6 +9,8 @@ namespace vktg
 
     vk::DescriptorSetLayout DescriptorLayoutCache::CreateLayout( const vk::DescriptorSetLayoutCreateInfo *layoutInfo) {
 
+        VKTG_PROFILE_ZONE( "DescriptorLayoutCache::CreateLayout");
+
         // hash descriptor set layout
         uint64_t layoutId = 0;
         for (uint32_t i = 0; i < layoutInfo->bindingCount; i++)
@@ -72,6 +75,8 @@ namespace vktg
 
     vk::DescriptorSet DescriptorSetAllocator::Allocate( vk::DescriptorSetLayout layout) {
 
+        VKTG_PROFILE_ZONE( "DescriptorSetAllocator::Allocate");
+
         if (!mCurrPool)
         {
             mCurrPool = GetNewPool();
@@ -181,6 +186,8 @@ namespace vktg
 
     vk::DescriptorSet DescriptorSetBuilder::Build( vk::DescriptorSetLayout *pLayout) {
 
+        VKTG_PROFILE_ZONE( "DescriptorSetBuilder::Build");
+
         auto layoutCreateInfo = vk::DescriptorSetLayoutCreateInfo{}
             .setBindingCount( (uint32_t)mBindings.size())
             .setPBindings( mBindings.data());
@@ -240,6 +247,8 @@ namespace vktg
 
     vk::DescriptorSet AllocateDescriptorSet( vk::DescriptorPool pool, vk::DescriptorSetLayout layout) {
         
+        VKTG_PROFILE_FUNCTION();
+
         auto allocInfo = vk::DescriptorSetAllocateInfo{}
             .setDescriptorPool( pool )
             .setDescriptorSetCount( 1 )
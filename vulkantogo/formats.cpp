@@ -0,0 +1,286 @@
+#include "formats.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    FormatInfo GetFormatInfo( vk::Format format) {
+
+        switch (format)
+        {
+            case vk::Format::eR4G4UnormPack8:
+            case vk::Format::eR8Unorm:
+            case vk::Format::eR8Snorm:
+            case vk::Format::eR8Uscaled:
+            case vk::Format::eR8Sscaled:
+            case vk::Format::eR8Uint:
+            case vk::Format::eR8Sint:
+            case vk::Format::eR8Srgb:
+            case vk::Format::eS8Uint:
+                return FormatInfo{ 1};
+
+            case vk::Format::eR4G4B4A4UnormPack16:
+            case vk::Format::eB4G4R4A4UnormPack16:
+            case vk::Format::eR5G6B5UnormPack16:
+            case vk::Format::eB5G6R5UnormPack16:
+            case vk::Format::eR5G5B5A1UnormPack16:
+            case vk::Format::eB5G5R5A1UnormPack16:
+            case vk::Format::eA1R5G5B5UnormPack16:
+            case vk::Format::eR8G8Unorm:
+            case vk::Format::eR8G8Snorm:
+            case vk::Format::eR8G8Uscaled:
+            case vk::Format::eR8G8Sscaled:
+            case vk::Format::eR8G8Uint:
+            case vk::Format::eR8G8Sint:
+            case vk::Format::eR8G8Srgb:
+            case vk::Format::eR16Unorm:
+            case vk::Format::eR16Snorm:
+            case vk::Format::eR16Uscaled:
+            case vk::Format::eR16Sscaled:
+            case vk::Format::eR16Uint:
+            case vk::Format::eR16Sint:
+            case vk::Format::eR16Sfloat:
+            case vk::Format::eD16Unorm:
+                return FormatInfo{ 2};
+
+            case vk::Format::eR8G8B8Unorm:
+            case vk::Format::eR8G8B8Snorm:
+            case vk::Format::eR8G8B8Uscaled:
+            case vk::Format::eR8G8B8Sscaled:
+            case vk::Format::eR8G8B8Uint:
+            case vk::Format::eR8G8B8Sint:
+            case vk::Format::eR8G8B8Srgb:
+            case vk::Format::eB8G8R8Unorm:
+            case vk::Format::eB8G8R8Snorm:
+            case vk::Format::eB8G8R8Uscaled:
+            case vk::Format::eB8G8R8Sscaled:
+            case vk::Format::eB8G8R8Uint:
+            case vk::Format::eB8G8R8Sint:
+            case vk::Format::eB8G8R8Srgb:
+            case vk::Format::eD16UnormS8Uint:
+                return FormatInfo{ 3};
+
+            case vk::Format::eR8G8B8A8Unorm:
+            case vk::Format::eR8G8B8A8Snorm:
+            case vk::Format::eR8G8B8A8Uscaled:
+            case vk::Format::eR8G8B8A8Sscaled:
+            case vk::Format::eR8G8B8A8Uint:
+            case vk::Format::eR8G8B8A8Sint:
+            case vk::Format::eR8G8B8A8Srgb:
+            case vk::Format::eB8G8R8A8Unorm:
+            case vk::Format::eB8G8R8A8Snorm:
+            case vk::Format::eB8G8R8A8Uscaled:
+            case vk::Format::eB8G8R8A8Sscaled:
+            case vk::Format::eB8G8R8A8Uint:
+            case vk::Format::eB8G8R8A8Sint:
+            case vk::Format::eB8G8R8A8Srgb:
+            case vk::Format::eA8B8G8R8UnormPack32:
+            case vk::Format::eA8B8G8R8SnormPack32:
+            case vk::Format::eA8B8G8R8UscaledPack32:
+            case vk::Format::eA8B8G8R8SscaledPack32:
+            case vk::Format::eA8B8G8R8UintPack32:
+            case vk::Format::eA8B8G8R8SintPack32:
+            case vk::Format::eA8B8G8R8SrgbPack32:
+            case vk::Format::eA2R10G10B10UnormPack32:
+            case vk::Format::eA2R10G10B10SnormPack32:
+            case vk::Format::eA2R10G10B10UscaledPack32:
+            case vk::Format::eA2R10G10B10SscaledPack32:
+            case vk::Format::eA2R10G10B10UintPack32:
+            case vk::Format::eA2R10G10B10SintPack32:
+            case vk::Format::eA2B10G10R10UnormPack32:
+            case vk::Format::eA2B10G10R10SnormPack32:
+            case vk::Format::eA2B10G10R10UscaledPack32:
+            case vk::Format::eA2B10G10R10SscaledPack32:
+            case vk::Format::eA2B10G10R10UintPack32:
+            case vk::Format::eA2B10G10R10SintPack32:
+            case vk::Format::eR16G16Unorm:
+            case vk::Format::eR16G16Snorm:
+            case vk::Format::eR16G16Uscaled:
+            case vk::Format::eR16G16Sscaled:
+            case vk::Format::eR16G16Uint:
+            case vk::Format::eR16G16Sint:
+            case vk::Format::eR16G16Sfloat:
+            case vk::Format::eR32Uint:
+            case vk::Format::eR32Sint:
+            case vk::Format::eR32Sfloat:
+            case vk::Format::eB10G11R11UfloatPack32:
+            case vk::Format::eE5B9G9R9UfloatPack32:
+            case vk::Format::eX8D24UnormPack32:
+            case vk::Format::eD32Sfloat:
+            case vk::Format::eD24UnormS8Uint:
+                return FormatInfo{ 4};
+
+            case vk::Format::eD32SfloatS8Uint:
+                return FormatInfo{ 5};
+
+            case vk::Format::eR16G16B16Unorm:
+            case vk::Format::eR16G16B16Snorm:
+            case vk::Format::eR16G16B16Uscaled:
+            case vk::Format::eR16G16B16Sscaled:
+            case vk::Format::eR16G16B16Uint:
+            case vk::Format::eR16G16B16Sint:
+            case vk::Format::eR16G16B16Sfloat:
+                return FormatInfo{ 6};
+
+            case vk::Format::eR16G16B16A16Unorm:
+            case vk::Format::eR16G16B16A16Snorm:
+            case vk::Format::eR16G16B16A16Uscaled:
+            case vk::Format::eR16G16B16A16Sscaled:
+            case vk::Format::eR16G16B16A16Uint:
+            case vk::Format::eR16G16B16A16Sint:
+            case vk::Format::eR16G16B16A16Sfloat:
+            case vk::Format::eR32G32Uint:
+            case vk::Format::eR32G32Sint:
+            case vk::Format::eR32G32Sfloat:
+            case vk::Format::eR64Uint:
+            case vk::Format::eR64Sint:
+            case vk::Format::eR64Sfloat:
+                return FormatInfo{ 8};
+
+            case vk::Format::eR32G32B32Uint:
+            case vk::Format::eR32G32B32Sint:
+            case vk::Format::eR32G32B32Sfloat:
+                return FormatInfo{ 12};
+
+            case vk::Format::eR32G32B32A32Uint:
+            case vk::Format::eR32G32B32A32Sint:
+            case vk::Format::eR32G32B32A32Sfloat:
+            case vk::Format::eR64G64Uint:
+            case vk::Format::eR64G64Sint:
+            case vk::Format::eR64G64Sfloat:
+                return FormatInfo{ 16};
+
+            case vk::Format::eR64G64B64Uint:
+            case vk::Format::eR64G64B64Sint:
+            case vk::Format::eR64G64B64Sfloat:
+                return FormatInfo{ 24};
+
+            case vk::Format::eR64G64B64A64Uint:
+            case vk::Format::eR64G64B64A64Sint:
+            case vk::Format::eR64G64B64A64Sfloat:
+                return FormatInfo{ 32};
+
+            // block-compressed formats
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+            case vk::Format::eBc4UnormBlock:
+            case vk::Format::eBc4SnormBlock:
+            case vk::Format::eEtc2R8G8B8UnormBlock:
+            case vk::Format::eEtc2R8G8B8SrgbBlock:
+            case vk::Format::eEtc2R8G8B8A1UnormBlock:
+            case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+            case vk::Format::eEacR11UnormBlock:
+            case vk::Format::eEacR11SnormBlock:
+                return FormatInfo{ 8, 4, 4};
+
+            case vk::Format::eBc2UnormBlock:
+            case vk::Format::eBc2SrgbBlock:
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+            case vk::Format::eBc5UnormBlock:
+            case vk::Format::eBc5SnormBlock:
+            case vk::Format::eBc6HUfloatBlock:
+            case vk::Format::eBc6HSfloatBlock:
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+            case vk::Format::eEtc2R8G8B8A8UnormBlock:
+            case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+            case vk::Format::eEacR11G11UnormBlock:
+            case vk::Format::eEacR11G11SnormBlock:
+            case vk::Format::eAstc4x4UnormBlock:
+            case vk::Format::eAstc4x4SrgbBlock:
+            case vk::Format::eAstc4x4SfloatBlock:
+                return FormatInfo{ 16, 4, 4};
+
+            case vk::Format::eAstc5x4UnormBlock:
+            case vk::Format::eAstc5x4SrgbBlock:
+            case vk::Format::eAstc5x4SfloatBlock:
+                return FormatInfo{ 16, 5, 4};
+            case vk::Format::eAstc5x5UnormBlock:
+            case vk::Format::eAstc5x5SrgbBlock:
+            case vk::Format::eAstc5x5SfloatBlock:
+                return FormatInfo{ 16, 5, 5};
+            case vk::Format::eAstc6x5UnormBlock:
+            case vk::Format::eAstc6x5SrgbBlock:
+            case vk::Format::eAstc6x5SfloatBlock:
+                return FormatInfo{ 16, 6, 5};
+            case vk::Format::eAstc6x6UnormBlock:
+            case vk::Format::eAstc6x6SrgbBlock:
+            case vk::Format::eAstc6x6SfloatBlock:
+                return FormatInfo{ 16, 6, 6};
+            case vk::Format::eAstc8x5UnormBlock:
+            case vk::Format::eAstc8x5SrgbBlock:
+            case vk::Format::eAstc8x5SfloatBlock:
+                return FormatInfo{ 16, 8, 5};
+            case vk::Format::eAstc8x6UnormBlock:
+            case vk::Format::eAstc8x6SrgbBlock:
+            case vk::Format::eAstc8x6SfloatBlock:
+                return FormatInfo{ 16, 8, 6};
+            case vk::Format::eAstc8x8UnormBlock:
+            case vk::Format::eAstc8x8SrgbBlock:
+            case vk::Format::eAstc8x8SfloatBlock:
+                return FormatInfo{ 16, 8, 8};
+            case vk::Format::eAstc10x5UnormBlock:
+            case vk::Format::eAstc10x5SrgbBlock:
+            case vk::Format::eAstc10x5SfloatBlock:
+                return FormatInfo{ 16, 10, 5};
+            case vk::Format::eAstc10x6UnormBlock:
+            case vk::Format::eAstc10x6SrgbBlock:
+            case vk::Format::eAstc10x6SfloatBlock:
+                return FormatInfo{ 16, 10, 6};
+            case vk::Format::eAstc10x8UnormBlock:
+            case vk::Format::eAstc10x8SrgbBlock:
+            case vk::Format::eAstc10x8SfloatBlock:
+                return FormatInfo{ 16, 10, 8};
+            case vk::Format::eAstc10x10UnormBlock:
+            case vk::Format::eAstc10x10SrgbBlock:
+            case vk::Format::eAstc10x10SfloatBlock:
+                return FormatInfo{ 16, 10, 10};
+            case vk::Format::eAstc12x10UnormBlock:
+            case vk::Format::eAstc12x10SrgbBlock:
+            case vk::Format::eAstc12x10SfloatBlock:
+                return FormatInfo{ 16, 12, 10};
+            case vk::Format::eAstc12x12UnormBlock:
+            case vk::Format::eAstc12x12SrgbBlock:
+            case vk::Format::eAstc12x12SfloatBlock:
+                return FormatInfo{ 16, 12, 12};
+
+            default:
+                throw std::runtime_error( "Unsupported format " + vk::to_string( format) + "!");
+        }
+    }
+
+
+    bool IsCompressed( vk::Format format) {
+
+        auto info = GetFormatInfo( format);
+
+        return info.blockWidth > 1 || info.blockHeight > 1;
+    }
+
+
+    vk::DeviceSize ImageDataSize( vk::Format format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers) {
+
+        auto info = GetFormatInfo( format);
+
+        vk::DeviceSize size = 0;
+        for (uint32_t mip = 0; mip < mipLevels; mip++)
+        {
+            uint32_t mipWidth = std::max( width >> mip, 1u);
+            uint32_t mipHeight = std::max( height >> mip, 1u);
+            vk::DeviceSize blocksX = (mipWidth + info.blockWidth - 1) / info.blockWidth;
+            vk::DeviceSize blocksY = (mipHeight + info.blockHeight - 1) / info.blockHeight;
+            size += blocksX * blocksY * info.blockSize;
+        }
+
+        return size * layers;
+    }
+
+
+} // namespace vktg
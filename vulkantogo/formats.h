@@ -0,0 +1,40 @@
+#pragma once
+
+
+#include "vk_core.h"
+
+
+namespace vktg
+{
+
+
+    /// @brief Size and dimensions of the texel blocks of a format. Uncompressed formats have blocks of a single texel.
+    struct FormatInfo {
+
+        uint32_t blockSize = 0;
+        uint32_t blockWidth = 1;
+        uint32_t blockHeight = 1;
+    };
+
+    /// @brief Texel block size and dimensions of a format. Throws if the format is not supported.
+    /// @param format Vulkan format.
+    /// @return Format info of given format.
+    FormatInfo GetFormatInfo( vk::Format format);
+
+    /// @brief Check if a format is block-compressed, e.g. BC, ETC2 or ASTC formats.
+    /// @param format Vulkan format.
+    /// @return True if the texel blocks of the format are larger than a single texel.
+    bool IsCompressed( vk::Format format);
+
+    /// @brief Size of tightly packed image data of a given format.
+    ///        Mip level dimensions are rounded up to whole texel blocks.
+    /// @param format Image format.
+    /// @param width Width of mip level 0.
+    /// @param height Height of mip level 0.
+    /// @param mipLevels Number of mip levels.
+    /// @param layers Number of image layers.
+    /// @return Data size in bytes.
+    vk::DeviceSize ImageDataSize( vk::Format format, uint32_t width, uint32_t height, uint32_t mipLevels = 1, uint32_t layers = 1);
+
+
+} // namespace vktg
@@ -0,0 +1,308 @@
+#include "geometry_pool.h"
+#include "submit_context.h"
+#include "synchronization.h"
+#include "transfer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    RangeAllocator::RangeAllocator( uint64_t capacity) {
+
+        Reset( capacity);
+    }
+
+
+    uint64_t RangeAllocator::Allocate( uint64_t size) {
+
+        if (size == 0)
+        {
+            return invalidOffset;
+        }
+
+        // smallest free range of at least the requested size
+        auto it = mRangesBySize.lower_bound( { size, 0});
+        if (it == mRangesBySize.end())
+        {
+            return invalidOffset;
+        }
+
+        auto [rangeSize, offset] = *it;
+        EraseRange( offset, rangeSize);
+        if (rangeSize > size)
+        {
+            InsertRange( offset + size, rangeSize - size);
+        }
+        mFreeSize -= size;
+
+        return offset;
+    }
+
+
+    void RangeAllocator::Free( uint64_t offset, uint64_t size) {
+
+        if (size == 0)
+        {
+            return;
+        }
+        mFreeSize += size;
+
+        // merge with the following and preceding free range
+        auto next = mRangesByOffset.lower_bound( offset);
+        if (next != mRangesByOffset.end() && next->first == offset + size)
+        {
+            size += next->second;
+            EraseRange( next->first, next->second);
+        }
+        auto prev = mRangesByOffset.lower_bound( offset);
+        if (prev != mRangesByOffset.begin())
+        {
+            --prev;
+            if (prev->first + prev->second == offset)
+            {
+                offset = prev->first;
+                size += prev->second;
+                EraseRange( prev->first, prev->second);
+            }
+        }
+
+        InsertRange( offset, size);
+    }
+
+
+    void RangeAllocator::Reset( uint64_t capacity) {
+
+        mCapacity = capacity;
+        mFreeSize = capacity;
+        mRangesByOffset.clear();
+        mRangesBySize.clear();
+        if (capacity > 0)
+        {
+            InsertRange( 0, capacity);
+        }
+    }
+
+
+    void RangeAllocator::InsertRange( uint64_t offset, uint64_t size) {
+
+        mRangesByOffset.emplace( offset, size);
+        mRangesBySize.emplace( size, offset);
+    }
+
+
+    void RangeAllocator::EraseRange( uint64_t offset, uint64_t size) {
+
+        mRangesByOffset.erase( offset);
+        mRangesBySize.erase( { size, offset});
+    }
+
+
+    static void CreatePoolBuffers( Buffer &vertexBuffer, Buffer &indexBuffer, size_t vertexSize, size_t indexSize) {
+
+        // storage usage allows vertex pulling, e.g. from mesh shaders
+        CreateBuffer(
+            vertexBuffer, vertexSize,
+            vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst
+        );
+        CreateBuffer(
+            indexBuffer, indexSize,
+            vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst
+        );
+    }
+
+
+    GeometryPool::GeometryPool( uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity) :
+        mVertexStride{ vertexStride},
+        mVersion{ 0},
+        mVertexRanges{ vertexCapacity},
+        mIndexRanges{ indexCapacity}
+    {
+        CreatePoolBuffers( mVertexBuffer, mIndexBuffer, (size_t)vertexCapacity * vertexStride, (size_t)indexCapacity * sizeof(uint32_t));
+    }
+
+
+    uint32_t GeometryPool::Add( const void *vertices, uint32_t vertexCount, std::span<const uint32_t> indices) {
+
+        if (vertexCount == 0 || indices.empty())
+        {
+            throw std::runtime_error( "Geometry pool meshes need vertices and indices!");
+        }
+
+        uint64_t vertexOffset = mVertexRanges.Allocate( vertexCount);
+        uint64_t firstIndex = mIndexRanges.Allocate( indices.size());
+        if (vertexOffset == RangeAllocator::invalidOffset || firstIndex == RangeAllocator::invalidOffset)
+        {
+            mVertexRanges.Free( vertexOffset, vertexOffset == RangeAllocator::invalidOffset ? 0 : vertexCount);
+            mIndexRanges.Free( firstIndex, firstIndex == RangeAllocator::invalidOffset ? 0 : indices.size());
+
+            // compact if the free space suffices, otherwise at least double the capacity
+            if (mVertexRanges.FreeSize() >= vertexCount && mIndexRanges.FreeSize() >= indices.size())
+            {
+                Defragment();
+            }
+            else
+            {
+                auto grow = []( uint64_t capacity, uint64_t used, uint64_t needed){
+                    return (uint32_t)std::max( 2 * capacity, used + needed);
+                };
+                Repack(
+                    grow( mVertexRanges.Capacity(), mVertexRanges.Capacity() - mVertexRanges.FreeSize(), vertexCount),
+                    grow( mIndexRanges.Capacity(), mIndexRanges.Capacity() - mIndexRanges.FreeSize(), indices.size())
+                );
+            }
+            vertexOffset = mVertexRanges.Allocate( vertexCount);
+            firstIndex = mIndexRanges.Allocate( indices.size());
+        }
+
+        uint32_t mesh;
+        if (mFreeHandles.empty())
+        {
+            mesh = (uint32_t)mMeshes.size();
+            mMeshes.emplace_back();
+            mAlive.push_back( true);
+        }
+        else
+        {
+            mesh = mFreeHandles.back();
+            mFreeHandles.pop_back();
+            mAlive[mesh] = true;
+        }
+        mMeshes[mesh] = GeometryRange{ (uint32_t)vertexOffset, vertexCount, (uint32_t)firstIndex, (uint32_t)indices.size()};
+
+        // upload vertices and indices with one staging buffer
+        size_t vertexSize = (size_t)vertexCount * mVertexStride;
+        Buffer stagingBuffer;
+        CreateStagingBuffer( stagingBuffer, vertexSize + indices.size_bytes());
+        memcpy( stagingBuffer.Data(), vertices, vertexSize);
+        memcpy( static_cast<uint8_t*>( stagingBuffer.Data()) + vertexSize, indices.data(), indices.size_bytes());
+
+        auto submitContext = CreateSubmitContext( QueueType::eTransfer);
+        submitContext.Begin();
+            CopyBuffer( submitContext.cmd, stagingBuffer.buffer, mVertexBuffer.buffer, vertexSize, 0, vertexOffset * mVertexStride);
+            CopyBuffer( submitContext.cmd, stagingBuffer.buffer, mIndexBuffer.buffer, indices.size_bytes(), vertexSize, firstIndex * sizeof(uint32_t));
+        submitContext.End();
+        submitContext.Submit();
+        WaitForFence( submitContext.fence);
+
+        DestroySubmitContext( submitContext);
+        DestroyBuffer( stagingBuffer);
+
+        return mesh;
+    }
+
+
+    void GeometryPool::Remove( uint32_t mesh) {
+
+        if (mesh >= mMeshes.size() || !mAlive[mesh])
+        {
+            throw std::runtime_error( "Invalid geometry pool mesh handle!");
+        }
+
+        auto &range = mMeshes[mesh];
+        mVertexRanges.Free( range.vertexOffset, range.vertexCount);
+        mIndexRanges.Free( range.firstIndex, range.indexCount);
+        range = GeometryRange{};
+        mAlive[mesh] = false;
+        mFreeHandles.push_back( mesh);
+    }
+
+
+    void GeometryPool::Defragment() {
+
+        if (mVertexRanges.FreeRangeCount() <= 1 && mIndexRanges.FreeRangeCount() <= 1)
+        {
+            return;
+        }
+
+        Repack( (uint32_t)mVertexRanges.Capacity(), (uint32_t)mIndexRanges.Capacity());
+    }
+
+
+    void GeometryPool::Repack( uint32_t vertexCapacity, uint32_t indexCapacity) {
+
+        // overlapping copies within a buffer are not allowed, so meshes are copied into new buffers
+        Buffer vertexBuffer, indexBuffer;
+        CreatePoolBuffers( vertexBuffer, indexBuffer, (size_t)vertexCapacity * mVertexStride, (size_t)indexCapacity * sizeof(uint32_t));
+
+        // keep the buffer order of the meshes
+        std::vector<uint32_t> order;
+        for (uint32_t mesh = 0; mesh < mMeshes.size(); mesh++)
+        {
+            if (mAlive[mesh])
+            {
+                order.push_back( mesh);
+            }
+        }
+        std::sort( order.begin(), order.end(), [&]( uint32_t a, uint32_t b){
+            return mMeshes[a].vertexOffset < mMeshes[b].vertexOffset;
+        });
+
+        mVertexRanges.Reset( vertexCapacity);
+        mIndexRanges.Reset( indexCapacity);
+        std::vector<vk::BufferCopy2> vertexRegions, indexRegions;
+        for (auto mesh : order)
+        {
+            auto &range = mMeshes[mesh];
+            uint32_t vertexOffset = (uint32_t)mVertexRanges.Allocate( range.vertexCount);
+            uint32_t firstIndex = (uint32_t)mIndexRanges.Allocate( range.indexCount);
+            vertexRegions.push_back( vk::BufferCopy2{}
+                .setSrcOffset( (vk::DeviceSize)range.vertexOffset * mVertexStride )
+                .setDstOffset( (vk::DeviceSize)vertexOffset * mVertexStride )
+                .setSize( (vk::DeviceSize)range.vertexCount * mVertexStride )
+            );
+            indexRegions.push_back( vk::BufferCopy2{}
+                .setSrcOffset( (vk::DeviceSize)range.firstIndex * sizeof(uint32_t) )
+                .setDstOffset( (vk::DeviceSize)firstIndex * sizeof(uint32_t) )
+                .setSize( (vk::DeviceSize)range.indexCount * sizeof(uint32_t) )
+            );
+            range.vertexOffset = vertexOffset;
+            range.firstIndex = firstIndex;
+        }
+
+        // the old buffers may still be read by frames in flight
+        WaitIdle();
+
+        if (!order.empty())
+        {
+            auto submitContext = CreateSubmitContext( QueueType::eTransfer);
+            submitContext.Begin();
+                CopyBuffer( submitContext.cmd, mVertexBuffer.buffer, vertexBuffer.buffer, vertexRegions);
+                CopyBuffer( submitContext.cmd, mIndexBuffer.buffer, indexBuffer.buffer, indexRegions);
+            submitContext.End();
+            submitContext.Submit();
+            WaitForFence( submitContext.fence);
+            DestroySubmitContext( submitContext);
+        }
+
+        DestroyBuffer( mVertexBuffer);
+        DestroyBuffer( mIndexBuffer);
+        mVertexBuffer = vertexBuffer;
+        mIndexBuffer = indexBuffer;
+        mVersion++;
+    }
+
+
+    void GeometryPool::Bind( vk::CommandBuffer cmd) const {
+
+        vk::DeviceSize offset = 0;
+        cmd.bindVertexBuffers( 0, 1, &mVertexBuffer.buffer, &offset);
+        cmd.bindIndexBuffer( mIndexBuffer.buffer, 0, vk::IndexType::eUint32);
+    }
+
+
+    void GeometryPool::Destroy() {
+
+        DestroyBuffer( mVertexBuffer);
+        DestroyBuffer( mIndexBuffer);
+        mMeshes.clear();
+        mAlive.clear();
+        mFreeHandles.clear();
+    }
+
+
+} // namespace vktg
@@ -0,0 +1,151 @@
+#pragma once
+
+
+#include "vk_core.h"
+#include "storage.h"
+
+#include <map>
+#include <set>
+#include <span>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Free-list allocator for ranges of a linear address space, e.g. elements of a buffer.
+    ///        Free ranges are kept ordered by offset, to merge neighbours on free, and by size for best fit allocation in logarithmic time.
+    class RangeAllocator {
+
+        public:
+
+            static constexpr uint64_t invalidOffset = ~0ull;
+
+            /// @brief Initialize allocator with a single free range.
+            /// @param capacity Size of the address space.
+            RangeAllocator( uint64_t capacity = 0);
+
+            /// @brief Allocates the smallest free range that fits.
+            /// @param size Size of the range.
+            /// @return Offset of the allocated range, invalidOffset if no free range is large enough or size is 0.
+            uint64_t Allocate( uint64_t size);
+            /// @brief Returns a range to the free list, merging it with adjacent free ranges.
+            /// @param offset Offset returned by Allocate(...).
+            /// @param size Size passed to Allocate(...).
+            void Free( uint64_t offset, uint64_t size);
+            /// @brief Frees all ranges and sets a new capacity.
+            /// @param capacity Size of the address space.
+            void Reset( uint64_t capacity);
+
+            /// @brief Size of the address space.
+            /// @return Capacity.
+            uint64_t Capacity() const { return mCapacity; }
+            /// @brief Sum of all free ranges.
+            /// @return Free size.
+            uint64_t FreeSize() const { return mFreeSize; }
+            /// @brief Size of the largest free range.
+            /// @return Largest allocatable size.
+            uint64_t LargestFreeRange() const { return mRangesBySize.empty() ? 0 : mRangesBySize.rbegin()->first; }
+            /// @brief Number of separate free ranges.
+            /// @return Free range count.
+            size_t FreeRangeCount() const { return mRangesByOffset.size(); }
+
+        private:
+
+            void InsertRange( uint64_t offset, uint64_t size);
+            void EraseRange( uint64_t offset, uint64_t size);
+
+
+            uint64_t mCapacity;
+            uint64_t mFreeSize;
+            std::map<uint64_t, uint64_t> mRangesByOffset;
+            std::set<std::pair<uint64_t, uint64_t>> mRangesBySize;
+    };
+
+
+    /// @brief Location of a mesh inside the shared buffers of a GeometryPool.
+    struct GeometryRange {
+
+        /// @brief First vertex, used as vertexOffset of indexed draws.
+        uint32_t vertexOffset;
+        uint32_t vertexCount;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+
+    /// @brief Sub-allocates the vertices and 32 bit indices of many meshes from one vertex and one index buffer,
+    ///        so all meshes are drawn with a single buffer binding and can be merged into multi draw indirect calls.
+    ///        Mesh indices stay relative to the first vertex of the mesh, draws pass GeometryRange::vertexOffset as vertex offset.
+    class GeometryPool {
+
+        public:
+
+            /// @brief Initialize geometry pool and create its buffers.
+            /// @param vertexStride Size of a vertex in bytes.
+            /// @param vertexCapacity Initial number of vertices.
+            /// @param indexCapacity Initial number of indices.
+            GeometryPool( uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity);
+
+            /// @brief Allocates ranges for a mesh and uploads its data, waiting for the upload to finish.
+            ///        If no free ranges are large enough the pool is defragmented or grown, which moves other meshes
+            ///        and waits for the device to be idle, check Version() for changes.
+            /// @param vertices Pointer to vertexCount tightly packed vertices.
+            /// @param vertexCount Number of vertices.
+            /// @param indices Mesh indices.
+            /// @return Mesh handle.
+            uint32_t Add( const void *vertices, uint32_t vertexCount, std::span<const uint32_t> indices);
+            /// @brief Frees the ranges of a mesh. The mesh must no longer be used by any frame in flight.
+            /// @param mesh Mesh handle.
+            void Remove( uint32_t mesh);
+            /// @brief Moves all meshes to the front of the buffers, so the free space forms a single range.
+            ///        Waits for the device to be idle.
+            void Defragment();
+            /// @brief Binds the vertex buffer to binding 0 and the index buffer.
+            /// @param cmd Command buffer.
+            void Bind( vk::CommandBuffer cmd) const;
+            /// @brief Destroys the pool buffers.
+            void Destroy();
+
+            /// @brief Current location of a mesh.
+            /// @param mesh Mesh handle.
+            /// @return Geometry range.
+            const GeometryRange& Get( uint32_t mesh) const { return mMeshes[mesh]; }
+            /// @brief Incremented whenever meshes are moved or the buffers replaced, cached ranges and buffer handles need to be updated.
+            /// @return Version counter.
+            uint64_t Version() const { return mVersion; }
+            /// @brief Shared vertex buffer.
+            /// @return Buffer object.
+            const Buffer& VertexBuffer() const { return mVertexBuffer; }
+            /// @brief Shared index buffer.
+            /// @return Buffer object.
+            const Buffer& IndexBuffer() const { return mIndexBuffer; }
+            /// @brief Vertex free-list allocator, e.g. to check fragmentation.
+            /// @return Range allocator in units of vertices.
+            const RangeAllocator& VertexRanges() const { return mVertexRanges; }
+            /// @brief Index free-list allocator, e.g. to check fragmentation.
+            /// @return Range allocator in units of indices.
+            const RangeAllocator& IndexRanges() const { return mIndexRanges; }
+
+        private:
+
+            /// @brief Copies all meshes to the front of new buffers with the given capacities.
+            void Repack( uint32_t vertexCapacity, uint32_t indexCapacity);
+
+
+            const uint32_t mVertexStride;
+            uint64_t mVersion;
+
+            Buffer mVertexBuffer;
+            Buffer mIndexBuffer;
+            RangeAllocator mVertexRanges;
+            RangeAllocator mIndexRanges;
+
+            std::vector<GeometryRange> mMeshes;
+            std::vector<bool> mAlive;
+            std::vector<uint32_t> mFreeHandles;
+    };
+
+
+} // namespace vktg
@@ -0,0 +1,101 @@
+#include "gpu_profiler.h"
+
+
+namespace vktg
+{
+
+
+    static uint64_t TimestampMask() {
+
+        uint32_t validBits = Gpu().getQueueFamilyProperties()[GraphicsQueueIndex()].timestampValidBits;
+
+        return validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    }
+
+
+    GpuProfiler::GpuProfiler( uint8_t frameOverlap, uint32_t maxZones) :
+        mMaxZones{ maxZones},
+        mTimestampPeriod{ Gpu().getProperties().limits.timestampPeriod},
+        mTimestampMask{ TimestampMask()},
+        mFrameCount{ 0},
+        mQueries( frameOverlap, {}, 2 * maxZones),
+        mFrameZones( frameOverlap),
+        pFrameHandler{ nullptr}
+    {
+    }
+
+
+    void GpuProfiler::BeginFrame( vk::CommandBuffer cmd) {
+
+        auto &zones = mFrameZones[mFrameCount % mFrameZones.size()];
+        mFrameCount++;
+
+        mQueries.BeginFrame( cmd);
+        auto queries = mQueries.Results();
+
+        mResults.clear();
+        for (auto &zone : zones)
+        {
+            // zones left open at the end of the frame have no end timestamp
+            if (zone.end == ~0u || !queries[zone.begin].available || !queries[zone.end].available)
+            {
+                continue;
+            }
+
+            uint64_t begin = mQueries.Values( queries[zone.begin])[0];
+            uint64_t end = mQueries.Values( queries[zone.end])[0];
+            double milliseconds = ((end - begin) & mTimestampMask) * mTimestampPeriod * 1e-6;
+            mResults.push_back( GpuZoneResult{ queries[zone.begin].name, zone.depth, milliseconds});
+            if (pFrameHandler)
+            {
+                pFrameHandler->AddStat( "gpu/" + queries[zone.begin].name, milliseconds);
+            }
+        }
+
+        zones.clear();
+        mOpenZones.clear();
+    }
+
+
+    void GpuProfiler::BeginZone( vk::CommandBuffer cmd, std::string_view name, vk::PipelineStageFlags2 stage) {
+
+        auto &zones = mFrameZones[(mFrameCount + mFrameZones.size() - 1) % mFrameZones.size()];
+
+        uint32_t zone = (uint32_t)zones.size();
+        if (zone == mMaxZones)
+        {
+            mOpenZones.push_back( ~0u);
+            return;
+        }
+
+        uint32_t begin = mQueries.WriteTimestamp( cmd, name, stage);
+        zones.push_back( Zone{ begin, ~0u, (uint32_t)mOpenZones.size()});
+        mOpenZones.push_back( zone);
+    }
+
+
+    void GpuProfiler::EndZone( vk::CommandBuffer cmd, vk::PipelineStageFlags2 stage) {
+
+        if (mOpenZones.empty())
+        {
+            return;
+        }
+
+        uint32_t zone = mOpenZones.back();
+        mOpenZones.pop_back();
+        if (zone != ~0u)
+        {
+            auto &zones = mFrameZones[(mFrameCount + mFrameZones.size() - 1) % mFrameZones.size()];
+            zones[zone].end = mQueries.WriteTimestamp( cmd, "", stage);
+        }
+    }
+
+
+    void GpuProfiler::Destroy() {
+
+        mQueries.Destroy();
+        mFrameZones.clear();
+    }
+
+
+} // namespace vktg
@@ -0,0 +1,114 @@
+#pragma once
+
+
+#include "vk_core.h"
+#include "queries.h"
+#include "util/frame_handler.h"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief GPU time of a profiled zone.
+    struct GpuZoneResult {
+
+        std::string name;
+        /// @brief Nesting depth, 0 for top level zones.
+        uint32_t depth;
+        double milliseconds;
+    };
+
+
+    /// @brief Measures GPU time of nested zones with timestamp queries of a QueryManager. The timestamps of a frame
+    ///        are read without waiting once the frame comes around again, i.e. frameOverlap frames later.
+    class GpuProfiler {
+
+        public:
+
+            /// @brief Initialize profiler, query pools are created on first use.
+            /// @param frameOverlap Number of frames in flight.
+            /// @param maxZones Maximum number of zones per frame, additional zones are ignored.
+            GpuProfiler( uint8_t frameOverlap, uint32_t maxZones = 64);
+
+            /// @brief Resolves the zones recorded the last time this frame was in flight and resets its queries.
+            ///        Call once per frame after waiting for the frame fence, at the start of the first command buffer of the frame.
+            /// @param cmd Command buffer.
+            void BeginFrame( vk::CommandBuffer cmd);
+            /// @brief Writes the start timestamp of a zone. Zones nest and must be ended in reverse order.
+            /// @param cmd Command buffer.
+            /// @param name Zone name.
+            /// @param stage Pipeline stage to write the timestamp after.
+            void BeginZone( vk::CommandBuffer cmd, std::string_view name, vk::PipelineStageFlags2 stage = vk::PipelineStageFlagBits2::eTopOfPipe);
+            /// @brief Writes the end timestamp of the innermost open zone.
+            /// @param cmd Command buffer.
+            /// @param stage Pipeline stage to write the timestamp after.
+            void EndZone( vk::CommandBuffer cmd, vk::PipelineStageFlags2 stage = vk::PipelineStageFlagBits2::eAllCommands);
+
+            /// @brief Adds resolved zone times in milliseconds to the rolling stats of a frame handler, as "gpu/<zone name>".
+            /// @param frameHandler Frame handler, nullptr to detach.
+            void Attach( FrameHandler *frameHandler) { pFrameHandler = frameHandler; }
+            /// @brief Destroys the query pools.
+            void Destroy();
+
+            /// @brief Zones resolved by the last BeginFrame(...) in recording order, empty if that frame was not recorded.
+            /// @return List of zone results.
+            std::span<const GpuZoneResult> Results() const { return mResults; }
+
+        private:
+
+            /// @brief Query ids of the begin and end timestamps of a zone.
+            struct Zone {
+                uint32_t begin;
+                uint32_t end;
+                uint32_t depth;
+            };
+
+
+            const uint32_t mMaxZones;
+            const double mTimestampPeriod;
+            const uint64_t mTimestampMask;
+            uint64_t mFrameCount;
+
+            QueryManager mQueries;
+            std::vector<std::vector<Zone>> mFrameZones;
+            /// @brief Zone index of each open zone, ~0u for ignored zones.
+            std::vector<uint32_t> mOpenZones;
+            std::vector<GpuZoneResult> mResults;
+            FrameHandler *pFrameHandler;
+    };
+
+
+    /// @brief Profiles a GPU zone for the lifetime of the object.
+    class ScopedGpuZone {
+
+        public:
+
+            /// @brief Begins a zone.
+            /// @param profiler GPU profiler.
+            /// @param cmd Command buffer.
+            /// @param name Zone name.
+            ScopedGpuZone( GpuProfiler &profiler, vk::CommandBuffer cmd, std::string_view name) : mProfiler{ profiler}, mCmd{ cmd} {
+                mProfiler.BeginZone( mCmd, name);
+            }
+            /// @brief Ends the zone.
+            ~ScopedGpuZone() {
+                mProfiler.EndZone( mCmd);
+            }
+
+            ScopedGpuZone( const ScopedGpuZone&) = delete;
+            ScopedGpuZone& operator=( const ScopedGpuZone&) = delete;
+
+        private:
+
+            GpuProfiler &mProfiler;
+            vk::CommandBuffer mCmd;
+    };
+
+
+} // namespace vktg
@@ -0,0 +1,235 @@
+#include "indirect_draw.h"
+#include "descriptors.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    void ExtractFrustumPlanes( const float viewProj[16], float planes[6][4]) {
+
+        // row r of the column major matrix
+        auto row = [&]( uint32_t r, uint32_t c){ return viewProj[c * 4 + r]; };
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            planes[0][c] = row( 3, c) + row( 0, c);
+            planes[1][c] = row( 3, c) - row( 0, c);
+            planes[2][c] = row( 3, c) + row( 1, c);
+            planes[3][c] = row( 3, c) - row( 1, c);
+            planes[4][c] = row( 2, c);
+            planes[5][c] = row( 3, c) - row( 2, c);
+        }
+
+        for (uint32_t p = 0; p < 6; p++)
+        {
+            float length = std::sqrt( planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+            if (length > 0.f)
+            {
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    planes[p][c] /= length;
+                }
+            }
+        }
+    }
+
+
+    bool IsSphereInFrustum( const float planes[6][4], const float center[3], float radius) {
+
+        for (uint32_t p = 0; p < 6; p++)
+        {
+            if (planes[p][0] * center[0] + planes[p][1] * center[1] + planes[p][2] * center[2] + planes[p][3] < -radius)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    IndirectDrawer::IndirectDrawer( uint32_t maxInstances, uint32_t maxMeshes, uint8_t frameOverlap, std::string_view cullShaderPath) :
+        mMaxInstances{ maxInstances},
+        mMaxMeshes{ maxMeshes},
+        mMeshCount{ 0},
+        mFrameIndex{ 0},
+        mFrames( frameOverlap)
+    {
+        // meshes are appended or updated between frames, so a single mapped buffer is shared by all frames
+        CreateBuffer(
+            mMeshes, maxMeshes * sizeof(IndirectMesh), vk::BufferUsageFlagBits::eStorageBuffer,
+            vma::MemoryUsage::eCpuToGpu, vma::AllocationCreateFlagBits::eMapped
+        );
+        CreateBuffer(
+            mDrawCommands, maxInstances * sizeof(vk::DrawIndexedIndirectCommand),
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer
+        );
+        CreateBuffer(
+            mDrawCount, sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst
+        );
+
+        // descriptor set layout: instances, meshes, draw commands, draw count
+        vk::DescriptorSetLayoutBinding bindings[4];
+        for (uint32_t b = 0; b < 4; b++)
+        {
+            bindings[b] = vk::DescriptorSetLayoutBinding{}
+                .setBinding( b )
+                .setDescriptorType( vk::DescriptorType::eStorageBuffer )
+                .setDescriptorCount( 1 )
+                .setStageFlags( vk::ShaderStageFlagBits::eCompute );
+        }
+        mDescriptorLayout = CreateDescriptorSetLayout( bindings);
+
+        auto poolSize = vk::DescriptorPoolSize{}
+            .setType( vk::DescriptorType::eStorageBuffer )
+            .setDescriptorCount( 4 * frameOverlap );
+        mDescriptorPool = CreateDescriptorPool( std::span{ &poolSize, 1}, frameOverlap);
+
+        for (auto &frame : mFrames)
+        {
+            CreateBuffer(
+                frame.instances, maxInstances * sizeof(DrawInstance), vk::BufferUsageFlagBits::eStorageBuffer,
+                vma::MemoryUsage::eCpuToGpu, vma::AllocationCreateFlagBits::eMapped
+            );
+            frame.descriptorSet = AllocateDescriptorSet( mDescriptorPool, mDescriptorLayout);
+
+            vk::DescriptorBufferInfo bufferInfos[] = {
+                GetDescriptorBufferInfo( frame.instances.buffer),
+                GetDescriptorBufferInfo( mMeshes.buffer),
+                GetDescriptorBufferInfo( mDrawCommands.buffer),
+                GetDescriptorBufferInfo( mDrawCount.buffer)
+            };
+            vk::WriteDescriptorSet writes[4];
+            for (uint32_t b = 0; b < 4; b++)
+            {
+                writes[b] = vk::WriteDescriptorSet{}
+                    .setDstSet( frame.descriptorSet )
+                    .setDstBinding( b )
+                    .setDescriptorCount( 1 )
+                    .setDescriptorType( vk::DescriptorType::eStorageBuffer )
+                    .setPBufferInfo( &bufferInfos[b] );
+            }
+            Device().updateDescriptorSets( 4, writes, 0, nullptr);
+        }
+
+        // cull pipeline
+        auto cullShader = LoadShader( cullShaderPath);
+        auto pushConstant = vk::PushConstantRange{}
+            .setStageFlags( vk::ShaderStageFlagBits::eCompute )
+            .setOffset( 0 )
+            .setSize( sizeof(CullPushConstants) );
+        mCullPipeline = ComputePipelineBuilder()
+            .SetShader( cullShader )
+            .AddDescriptorLayout( mDescriptorLayout )
+            .AddPushConstant( pushConstant )
+            .Build();
+        DestroyShaderModule( cullShader);
+    }
+
+
+    uint32_t IndirectDrawer::AddMesh( uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset) {
+
+        if (mMeshCount == mMaxMeshes)
+        {
+            throw std::runtime_error( "Indirect drawer mesh capacity exceeded!");
+        }
+
+        auto meshes = reinterpret_cast<IndirectMesh*>( mMeshes.Data());
+        meshes[mMeshCount] = IndirectMesh{ indexCount, firstIndex, vertexOffset, 0};
+
+        return mMeshCount++;
+    }
+
+
+    void IndirectDrawer::UpdateMesh( uint32_t mesh, uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset) {
+
+        if (mesh >= mMeshCount)
+        {
+            throw std::runtime_error( "Invalid indirect drawer mesh handle!");
+        }
+
+        auto meshes = reinterpret_cast<IndirectMesh*>( mMeshes.Data());
+        meshes[mesh] = IndirectMesh{ indexCount, firstIndex, vertexOffset, 0};
+    }
+
+
+    void IndirectDrawer::NextFrame() {
+
+        mFrameIndex = (mFrameIndex + 1) % mFrames.size();
+    }
+
+
+    void IndirectDrawer::SetInstances( std::span<const DrawInstance> instances) {
+
+        if (instances.size() > mMaxInstances)
+        {
+            throw std::runtime_error( "Indirect drawer instance capacity exceeded!");
+        }
+
+        auto &frame = mFrames[mFrameIndex];
+        memcpy( frame.instances.Data(), instances.data(), instances.size_bytes());
+        frame.instanceCount = (uint32_t)instances.size();
+    }
+
+
+    void IndirectDrawer::Cull( vk::CommandBuffer cmd, const float viewProj[16]) {
+
+        auto &frame = mFrames[mFrameIndex];
+
+        // reset the draw count, waits for the indirect reads of the previous frame
+        Transition( cmd, mDrawCount, ResourceUsage{ vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite});
+        cmd.fillBuffer( mDrawCount.buffer, 0, sizeof(uint32_t), 0);
+
+        BarrierBatch batch;
+        Transition( batch, mDrawCount, ResourceUsage{ vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite});
+        Transition( batch, mDrawCommands, ResourceUsage{ vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite});
+        batch.Flush( cmd);
+
+        CullPushConstants pushConstants;
+        ExtractFrustumPlanes( viewProj, pushConstants.planes);
+        pushConstants.instanceCount = frame.instanceCount;
+
+        cmd.bindPipeline( vk::PipelineBindPoint::eCompute, mCullPipeline.pipeline);
+        cmd.bindDescriptorSets( vk::PipelineBindPoint::eCompute, mCullPipeline.pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+        cmd.pushConstants( mCullPipeline.pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(CullPushConstants), &pushConstants);
+        cmd.dispatch( (frame.instanceCount + 63) / 64, 1, 1);
+
+        Transition( batch, mDrawCount, ResourceUsage{ vk::PipelineStageFlagBits2::eDrawIndirect, vk::AccessFlagBits2::eIndirectCommandRead});
+        Transition( batch, mDrawCommands, ResourceUsage{ vk::PipelineStageFlagBits2::eDrawIndirect, vk::AccessFlagBits2::eIndirectCommandRead});
+        batch.Flush( cmd);
+    }
+
+
+    void IndirectDrawer::Draw( vk::CommandBuffer cmd) {
+
+        cmd.drawIndexedIndirectCount(
+            mDrawCommands.buffer, 0, mDrawCount.buffer, 0,
+            mFrames[mFrameIndex].instanceCount, sizeof(vk::DrawIndexedIndirectCommand)
+        );
+    }
+
+
+    void IndirectDrawer::Destroy() {
+
+        DestroyPipeline( mCullPipeline.pipeline);
+        DestroyPipelineLayout( mCullPipeline.pipelineLayout);
+        DestroyDesciptorPool( mDescriptorPool);
+        DestroyDescriptorSetLayout( mDescriptorLayout);
+
+        for (auto &frame : mFrames)
+        {
+            DestroyBuffer( frame.instances);
+        }
+        DestroyBuffer( mDrawCount);
+        DestroyBuffer( mDrawCommands);
+        DestroyBuffer( mMeshes);
+    }
+
+
+} // namespace vktg
@@ -0,0 +1,135 @@
+#pragma once
+
+
+#include "vk_core.h"
+#include "pipelines.h"
+#include "storage.h"
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Per-instance data read by the cull shader and the vertex shader via gl_InstanceIndex, layout matches std430 storage buffers.
+    struct DrawInstance {
+
+        /// @brief Column major model matrix.
+        float model[16];
+        /// @brief Bounding sphere center in model space.
+        float boundsCenter[3];
+        /// @brief Bounding sphere radius in model space.
+        float boundsRadius;
+        /// @brief Mesh handle returned by IndirectDrawer::AddMesh(...).
+        uint32_t mesh;
+        uint32_t padding[3];
+    };
+
+    /// @brief Index range of a mesh inside shared vertex and index buffers, layout matches std430 storage buffers.
+    struct IndirectMesh {
+
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t padding;
+    };
+
+
+    /// @brief Extracts the normalized frustum planes from a view projection matrix with Vulkan clip space depth [0, 1].
+    /// @param viewProj Column major view projection matrix.
+    /// @param planes Left, right, bottom, top, near and far plane as normal and distance, normals point inside the frustum.
+    void ExtractFrustumPlanes( const float viewProj[16], float planes[6][4]);
+
+    /// @brief CPU version of the sphere frustum test used in cull.comp.
+    /// @param planes Frustum planes as returned by ExtractFrustumPlanes(...).
+    /// @param center Sphere center.
+    /// @param radius Sphere radius.
+    /// @return True if the sphere intersects the frustum.
+    bool IsSphereInFrustum( const float planes[6][4], const float center[3], float radius);
+
+
+    /// @brief Draws many instances of meshes sharing one vertex and index buffer with a single drawIndexedIndirectCount call.
+    ///        A compute pass culls the instances against the view frustum and writes one indirect draw command per visible instance
+    ///        along with the draw count. Each command draws one instance with firstInstance set to the instance index,
+    ///        so the vertex shader reads its model matrix from InstanceBuffer() at gl_InstanceIndex.
+    class IndirectDrawer {
+
+        public:
+
+            /// @brief Initialize indirect drawer and build the cull pipeline.
+            /// @param maxInstances Maximum number of instances per frame.
+            /// @param maxMeshes Maximum number of meshes.
+            /// @param frameOverlap Number of frames in flight, each has its own instance buffer.
+            /// @param cullShaderPath Path to the compiled cull.comp shader.
+            IndirectDrawer( uint32_t maxInstances, uint32_t maxMeshes, uint8_t frameOverlap = 2, std::string_view cullShaderPath = VKTG_SHADER_DIR "cull_comp.spv");
+
+            /// @brief Register the index range of a mesh.
+            /// @param indexCount Number of indices.
+            /// @param firstIndex First index in the shared index buffer.
+            /// @param vertexOffset Offset added to the indices.
+            /// @return Mesh handle.
+            uint32_t AddMesh( uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset);
+            /// @brief Change the index range of a mesh, e.g. after its geometry moved. Must not be called while frames in flight use the mesh.
+            /// @param mesh Mesh handle.
+            /// @param indexCount Number of indices.
+            /// @param firstIndex First index in the shared index buffer.
+            /// @param vertexOffset Offset added to the indices.
+            void UpdateMesh( uint32_t mesh, uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset);
+            /// @brief Switch to the instance buffer of the next frame. Call once per frame, after waiting for the oldest frame in flight.
+            void NextFrame();
+            /// @brief Copy the instances of the current frame into its mapped instance buffer.
+            /// @param instances Instances to draw, at most maxInstances.
+            void SetInstances( std::span<const DrawInstance> instances);
+
+            /// @brief Records the cull pass and the barriers making its draw commands visible to indirect draws.
+            ///        Must be recorded outside of rendering.
+            /// @param cmd Command buffer.
+            /// @param viewProj Column major view projection matrix.
+            void Cull( vk::CommandBuffer cmd, const float viewProj[16]);
+            /// @brief Records the indirect draw of all visible instances. The graphics pipeline, descriptor sets, vertex and index buffer must be bound.
+            /// @param cmd Command buffer.
+            void Draw( vk::CommandBuffer cmd);
+            /// @brief Destroys all buffers and the cull pipeline.
+            void Destroy();
+
+            /// @brief Instance buffer of the current frame, to be bound as storage buffer for the vertex shader.
+            /// @return Buffer object.
+            const Buffer& InstanceBuffer() const { return mFrames[mFrameIndex].instances; }
+            /// @brief Number of instances set for the current frame.
+            /// @return Instance count.
+            uint32_t InstanceCount() const { return mFrames[mFrameIndex].instanceCount; }
+
+        private:
+
+            struct Frame {
+                Buffer instances;
+                uint32_t instanceCount = 0;
+                vk::DescriptorSet descriptorSet;
+            };
+
+            struct CullPushConstants {
+                float planes[6][4];
+                uint32_t instanceCount;
+            };
+
+
+            const uint32_t mMaxInstances;
+            const uint32_t mMaxMeshes;
+            uint32_t mMeshCount;
+            uint8_t mFrameIndex;
+
+            Buffer mMeshes;
+            Buffer mDrawCommands;
+            Buffer mDrawCount;
+            std::vector<Frame> mFrames;
+
+            vk::DescriptorSetLayout mDescriptorLayout;
+            vk::DescriptorPool mDescriptorPool;
+            Pipeline mCullPipeline;
+    };
+
+
+} // namespace vktg
@@ -0,0 +1,333 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+
+namespace vktg
+{
+
+
+    // triangles adjacent to each vertex in compressed row format
+    struct VertexAdjacency {
+
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+    };
+
+
+    static VertexAdjacency BuildAdjacency( std::span<const uint32_t> indices, uint32_t vertexCount) {
+
+        VertexAdjacency adjacency;
+        adjacency.offsets.resize( vertexCount + 1, 0);
+        for (auto index : indices)
+        {
+            adjacency.offsets[index + 1]++;
+        }
+        std::partial_sum( adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+        adjacency.triangles.resize( indices.size());
+        std::vector<uint32_t> fill( adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            adjacency.triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        return adjacency;
+    }
+
+
+    VertexCacheStats AnalyzeVertexCache( std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize) {
+
+        VertexCacheStats stats;
+        if (indices.empty())
+        {
+            return stats;
+        }
+
+        // a vertex is cached if it entered the fifo less than cacheSize misses ago
+        std::vector<uint32_t> cacheTime( vertexCount, 0);
+        std::vector<bool> referenced( vertexCount, false);
+        uint32_t time = cacheSize + 1;
+        uint32_t misses = 0;
+        uint32_t referencedCount = 0;
+        for (auto index : indices)
+        {
+            if (time - cacheTime[index] > cacheSize)
+            {
+                cacheTime[index] = time++;
+                misses++;
+            }
+            if (!referenced[index])
+            {
+                referenced[index] = true;
+                referencedCount++;
+            }
+        }
+
+        stats.acmr = (float)misses / (indices.size() / 3);
+        stats.atvr = (float)misses / referencedCount;
+
+        return stats;
+    }
+
+
+    void OptimizeVertexCache( std::span<uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize) {
+
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        auto adjacency = BuildAdjacency( indices, vertexCount);
+        std::vector<uint32_t> liveTriangles( vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+        }
+        std::vector<uint32_t> cacheTime( vertexCount, 0);
+        std::vector<bool> emitted( triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve( indices.size());
+
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+
+        // next vertex with live triangles from the dead-end stack, otherwise in input order
+        auto skipDeadEnd = [&]() -> int64_t {
+            while (!deadEnds.empty())
+            {
+                uint32_t v = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[v] > 0)
+                {
+                    return v;
+                }
+            }
+            while (cursor < vertexCount)
+            {
+                if (liveTriangles[cursor] > 0)
+                {
+                    return cursor;
+                }
+                cursor++;
+            }
+            return -1;
+        };
+
+        int64_t fan = skipDeadEnd();
+        while (fan >= 0)
+        {
+            // emit all remaining triangles around the fanning vertex
+            candidates.clear();
+            for (uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; a++)
+            {
+                uint32_t t = adjacency.triangles[a];
+                if (emitted[t])
+                {
+                    continue;
+                }
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t v = indices[3 * t + k];
+                    output.push_back( v);
+                    deadEnds.push_back( v);
+                    candidates.push_back( v);
+                    liveTriangles[v]--;
+                    if (time - cacheTime[v] > cacheSize)
+                    {
+                        cacheTime[v] = time++;
+                    }
+                }
+                emitted[t] = true;
+            }
+
+            // prefer the candidate that stays in cache longest while its remaining triangles are emitted
+            int64_t next = -1;
+            int64_t bestPriority = -1;
+            for (auto v : candidates)
+            {
+                if (liveTriangles[v] == 0)
+                {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                {
+                    priority = time - cacheTime[v];
+                }
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+            fan = next >= 0 ? next : skipDeadEnd();
+        }
+
+        std::copy( output.begin(), output.end(), indices.begin());
+    }
+
+
+    void OptimizeOverdraw( std::span<uint32_t> indices, const float *positions, size_t positionStride, uint32_t vertexCount, uint32_t cacheSize) {
+
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        auto position = [&]( uint32_t v){
+            return reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( positions) + v * positionStride);
+        };
+
+        // split into clusters where all vertices of a triangle miss the cache
+        std::vector<size_t> clusterStarts;
+        std::vector<uint32_t> cacheTime( vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t misses = 0;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[3 * t + k];
+                if (time - cacheTime[v] > cacheSize)
+                {
+                    cacheTime[v] = time++;
+                    misses++;
+                }
+            }
+            if (t == 0 || misses == 3)
+            {
+                clusterStarts.push_back( t);
+            }
+        }
+        clusterStarts.push_back( triangleCount);
+
+        // mesh centroid
+        double meshCenter[3] = { 0.0, 0.0, 0.0};
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            auto p = position( indices[i]);
+            meshCenter[0] += p[0];
+            meshCenter[1] += p[1];
+            meshCenter[2] += p[2];
+        }
+        for (auto &c : meshCenter)
+        {
+            c /= indices.size();
+        }
+
+        // occlusion potential: how far a cluster lies out along its average normal
+        size_t clusterCount = clusterStarts.size() - 1;
+        std::vector<float> potential( clusterCount);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            float center[3] = { 0.f, 0.f, 0.f};
+            float normal[3] = { 0.f, 0.f, 0.f};
+            float area = 0.f;
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+            {
+                auto p0 = position( indices[3 * t + 0]);
+                auto p1 = position( indices[3 * t + 1]);
+                auto p2 = position( indices[3 * t + 2]);
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                // area weighted normal
+                float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                float a = std::sqrt( n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    normal[k] += n[k];
+                    center[k] += a * (p0[k] + p1[k] + p2[k]) / 3.f;
+                }
+                area += a;
+            }
+
+            float normalLength = std::sqrt( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (area == 0.f || normalLength == 0.f)
+            {
+                potential[c] = 0.f;
+                continue;
+            }
+            potential[c] = 0.f;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                potential[c] += (center[k] / area - (float)meshCenter[k]) * normal[k] / normalLength;
+            }
+        }
+
+        std::vector<size_t> order( clusterCount);
+        std::iota( order.begin(), order.end(), 0);
+        std::stable_sort( order.begin(), order.end(), [&]( size_t a, size_t b){ return potential[a] > potential[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve( indices.size());
+        for (auto c : order)
+        {
+            output.insert( output.end(), indices.begin() + 3 * clusterStarts[c], indices.begin() + 3 * clusterStarts[c + 1]);
+        }
+        std::copy( output.begin(), output.end(), indices.begin());
+    }
+
+
+    uint32_t OptimizeVertexFetch( std::span<uint32_t> indices, void *vertices, uint32_t vertexCount, size_t vertexSize) {
+
+        constexpr uint32_t unused = ~0u;
+        std::vector<uint32_t> remap( vertexCount, unused);
+        uint32_t nextVertex = 0;
+        for (auto &index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = nextVertex++;
+            }
+            index = remap[index];
+        }
+        uint32_t referencedCount = nextVertex;
+        for (auto &target : remap)
+        {
+            if (target == unused)
+            {
+                target = nextVertex++;
+            }
+        }
+
+        auto data = static_cast<uint8_t*>( vertices);
+        std::vector<uint8_t> reordered( (size_t)vertexCount * vertexSize);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            memcpy( reordered.data() + remap[v] * vertexSize, data + v * vertexSize, vertexSize);
+        }
+        memcpy( data, reordered.data(), reordered.size());
+
+        return referencedCount;
+    }
+
+
+    vk::IndexType CompactIndices( std::span<const uint32_t> indices, uint32_t vertexCount, std::vector<uint8_t> &indexData) {
+
+        if (vertexCount < (1u << 16))
+        {
+            indexData.resize( indices.size() * sizeof(uint16_t));
+            auto data = reinterpret_cast<uint16_t*>( indexData.data());
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                data[i] = (uint16_t)indices[i];
+            }
+            return vk::IndexType::eUint16;
+        }
+
+        indexData.resize( indices.size_bytes());
+        memcpy( indexData.data(), indices.data(), indices.size_bytes());
+
+        return vk::IndexType::eUint32;
+    }
+
+
+} // namespace vktg
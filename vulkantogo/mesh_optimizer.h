@@ -0,0 +1,63 @@
+#pragma once
+
+
+#include "vk_core.h"
+
+#include <span>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Post-transform vertex cache efficiency of a triangle list.
+    struct VertexCacheStats {
+
+        /// @brief Average cache misses per triangle, between 0.5 for ideal grids and 3.
+        float acmr = 0.f;
+        /// @brief Average cache misses per referenced vertex, 1 is ideal.
+        float atvr = 0.f;
+    };
+
+    /// @brief Simulate a FIFO post-transform vertex cache for a triangle list.
+    /// @param indices Triangle list indices.
+    /// @param vertexCount Number of vertices referenced by the indices.
+    /// @param cacheSize Number of cached vertices.
+    /// @return Cache statistics.
+    VertexCacheStats AnalyzeVertexCache( std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+    /// @brief Reorder triangles for post-transform vertex cache locality (Tipsify, Sander et al. 2007).
+    ///        Runs in linear time, triangle winding is preserved.
+    /// @param indices Triangle list indices, reordered in place.
+    /// @param vertexCount Number of vertices referenced by the indices.
+    /// @param cacheSize Number of cached vertices to optimize for.
+    void OptimizeVertexCache( std::span<uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+    /// @brief Reorder clusters of cache-optimized triangles so that outward facing clusters, which likely occlude others, are drawn first.
+    ///        Clusters are split only where the vertex cache is cold anyway, so cache locality is kept.
+    /// @param indices Triangle list indices, reordered in place. Should be the output of OptimizeVertexCache.
+    /// @param positions Pointer to the position of the first vertex, three floats.
+    /// @param positionStride Byte stride between vertex positions.
+    /// @param vertexCount Number of vertices referenced by the indices.
+    /// @param cacheSize Number of cached vertices used for OptimizeVertexCache.
+    void OptimizeOverdraw( std::span<uint32_t> indices, const float *positions, size_t positionStride, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+    /// @brief Reorder vertices in order of first use by the indices for vertex fetch locality and remap the indices.
+    ///        Unreferenced vertices are moved to the end.
+    /// @param indices Triangle list indices, remapped in place.
+    /// @param vertices Vertex data, reordered in place.
+    /// @param vertexCount Number of vertices.
+    /// @param vertexSize Size of a single vertex in bytes.
+    /// @return Number of referenced vertices.
+    uint32_t OptimizeVertexFetch( std::span<uint32_t> indices, void *vertices, uint32_t vertexCount, size_t vertexSize);
+
+    /// @brief Convert indices to 16 bit if all vertices can be addressed with them.
+    /// @param indices Triangle list indices.
+    /// @param vertexCount Number of vertices referenced by the indices.
+    /// @param indexData Output index data.
+    /// @return Index type of indexData, eUint16 if vertexCount is less than 65536, eUint32 otherwise.
+    vk::IndexType CompactIndices( std::span<const uint32_t> indices, uint32_t vertexCount, std::vector<uint8_t> &indexData);
+
+
+} // namespace vktg
@@ -0,0 +1,193 @@
+#include "meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    static void ComputeMeshletBounds( const MeshletData &data, const Meshlet &meshlet, const float *positions, size_t positionStride, MeshletBounds &bounds) {
+
+        auto position = [&]( uint32_t localIndex){
+            uint32_t v = data.vertices[meshlet.vertexOffset + localIndex];
+            return reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( positions) + v * positionStride);
+        };
+
+        // bounding sphere around the vertex centroid
+        float center[3] = { 0.f, 0.f, 0.f};
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+        {
+            auto p = position( i);
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                center[k] += p[k] / meshlet.vertexCount;
+            }
+        }
+        float radius = 0.f;
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+        {
+            auto p = position( i);
+            float d[3] = { p[0] - center[0], p[1] - center[1], p[2] - center[2]};
+            radius = std::max( radius, std::sqrt( d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+        }
+
+        // triangle normals and their average direction
+        std::vector<float> normals( 3 * meshlet.triangleCount, 0.f);
+        float axis[3] = { 0.f, 0.f, 0.f};
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const uint8_t *triangle = &data.triangles[meshlet.triangleOffset + 3 * t];
+            auto p0 = position( triangle[0]);
+            auto p1 = position( triangle[1]);
+            auto p2 = position( triangle[2]);
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float length = std::sqrt( n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length == 0.f)
+            {
+                continue;
+            }
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                normals[3 * t + k] = n[k] / length;
+                axis[k] += n[k] / length;
+            }
+        }
+        float axisLength = std::sqrt( axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+        bounds = MeshletBounds{};
+        std::copy( center, center + 3, bounds.center);
+        bounds.radius = radius;
+        bounds.coneCutoff = 1.f;
+        if (axisLength == 0.f)
+        {
+            return;
+        }
+        for (auto &a : axis)
+        {
+            a /= axisLength;
+        }
+        std::copy( axis, axis + 3, bounds.coneAxis);
+
+        float minDot = 1.f;
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const float *n = &normals[3 * t];
+            minDot = std::min( minDot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+        }
+        // normals spread over more than a hemisphere, no camera position sees only back faces
+        if (minDot <= 0.1f)
+        {
+            return;
+        }
+
+        // move the apex back along the axis until it lies behind all triangle planes
+        float maxT = 0.f;
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const float *n = &normals[3 * t];
+            auto p0 = position( data.triangles[meshlet.triangleOffset + 3 * t]);
+            float distance = (center[0] - p0[0]) * n[0] + (center[1] - p0[1]) * n[1] + (center[2] - p0[2]) * n[2];
+            float cosine = axis[0] * n[0] + axis[1] * n[1] + axis[2] * n[2];
+            if (cosine > 0.f)
+            {
+                maxT = std::max( maxT, distance / cosine);
+            }
+        }
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            bounds.coneApex[k] = center[k] - axis[k] * maxT;
+        }
+        bounds.coneCutoff = std::sqrt( 1.f - minDot * minDot);
+    }
+
+
+    MeshletData BuildMeshlets( std::span<const uint32_t> indices, const float *positions, size_t positionStride, uint32_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles) {
+
+        if (maxVertices < 3 || maxVertices > 256 || maxTriangles < 1 || maxTriangles > 512)
+        {
+            throw std::runtime_error( "Invalid meshlet size limits!");
+        }
+
+        MeshletData data;
+        constexpr uint32_t notInMeshlet = ~0u;
+        std::vector<uint32_t> localIndex( vertexCount, notInMeshlet);
+        Meshlet current{ 0, 0, 0, 0};
+
+        auto finishMeshlet = [&](){
+            if (current.triangleCount == 0)
+            {
+                return;
+            }
+            for (uint32_t i = 0; i < current.vertexCount; i++)
+            {
+                localIndex[data.vertices[current.vertexOffset + i]] = notInMeshlet;
+            }
+            data.meshlets.push_back( current);
+            current = Meshlet{ (uint32_t)data.vertices.size(), (uint32_t)data.triangles.size(), 0, 0};
+        };
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            uint32_t newVertices = 0;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                newVertices += localIndex[indices[i + k]] == notInMeshlet ? 1 : 0;
+            }
+            // degenerate triangles with repeated new vertices are counted conservatively
+            if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1 > maxTriangles)
+            {
+                finishMeshlet();
+            }
+
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[i + k];
+                if (localIndex[v] == notInMeshlet)
+                {
+                    localIndex[v] = current.vertexCount++;
+                    data.vertices.push_back( v);
+                }
+                data.triangles.push_back( (uint8_t)localIndex[v]);
+            }
+            current.triangleCount++;
+        }
+        finishMeshlet();
+
+        data.bounds.resize( data.meshlets.size());
+        for (size_t m = 0; m < data.meshlets.size(); m++)
+        {
+            ComputeMeshletBounds( data, data.meshlets[m], positions, positionStride, data.bounds[m]);
+        }
+
+        return data;
+    }
+
+
+    bool IsMeshletBackfacing( const MeshletBounds &bounds, const float cameraPosition[3]) {
+
+        if (bounds.coneCutoff >= 1.f)
+        {
+            return false;
+        }
+
+        float view[3] = {
+            bounds.coneApex[0] - cameraPosition[0],
+            bounds.coneApex[1] - cameraPosition[1],
+            bounds.coneApex[2] - cameraPosition[2]
+        };
+        float length = std::sqrt( view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+        if (length == 0.f)
+        {
+            return false;
+        }
+
+        return (view[0] * bounds.coneAxis[0] + view[1] * bounds.coneAxis[1] + view[2] * bounds.coneAxis[2]) / length >= bounds.coneCutoff;
+    }
+
+
+} // namespace vktg
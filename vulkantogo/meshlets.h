@@ -0,0 +1,71 @@
+#pragma once
+
+
+#include "vk_core.h"
+
+#include <span>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Cluster of triangles with a bounded number of unique vertices, layout matches std430 storage buffers.
+    struct Meshlet {
+
+        /// @brief First entry of the meshlet in MeshletData::vertices.
+        uint32_t vertexOffset;
+        /// @brief First entry of the meshlet in MeshletData::triangles, counted in bytes.
+        uint32_t triangleOffset;
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+    };
+
+    /// @brief Culling bounds of a meshlet, layout matches std430 storage buffers.
+    struct MeshletBounds {
+
+        /// @brief Bounding sphere center.
+        float center[3];
+        /// @brief Bounding sphere radius.
+        float radius;
+        /// @brief Apex of the normal cone, all triangles are backfacing for cameras inside the cone.
+        float coneApex[3];
+        /// @brief Cosine of the half angle of the cone around the axis in which cameras only see back faces, 1 if the meshlet can not be cone culled.
+        float coneCutoff;
+        /// @brief Average triangle normal direction.
+        float coneAxis[3];
+        float padding;
+    };
+
+    /// @brief Meshlets of a mesh with their vertex and triangle lists.
+    struct MeshletData {
+
+        std::vector<Meshlet> meshlets;
+        std::vector<MeshletBounds> bounds;
+        /// @brief Mesh vertex indices referenced by the meshlets.
+        std::vector<uint32_t> vertices;
+        /// @brief Three meshlet local vertex indices per triangle.
+        std::vector<uint8_t> triangles;
+    };
+
+
+    /// @brief Split a triangle list into meshlets with bounding spheres and normal cones.
+    ///        Triangles are grouped in index order, so the indices should be optimized with OptimizeVertexCache first.
+    /// @param indices Triangle list indices.
+    /// @param positions Pointer to the position of the first vertex, three floats.
+    /// @param positionStride Byte stride between vertex positions.
+    /// @param vertexCount Number of vertices referenced by the indices.
+    /// @param maxVertices Maximum number of unique vertices per meshlet, at most 256.
+    /// @param maxTriangles Maximum number of triangles per meshlet, at most 512.
+    /// @return Meshlet data.
+    MeshletData BuildMeshlets( std::span<const uint32_t> indices, const float *positions, size_t positionStride, uint32_t vertexCount, uint32_t maxVertices = 64, uint32_t maxTriangles = 124);
+
+    /// @brief CPU version of the meshlet cone test used in meshlet.task.
+    /// @param bounds Meshlet bounds.
+    /// @param cameraPosition Camera position in the space of the meshlet positions.
+    /// @return True if all triangles of the meshlet face away from the camera.
+    bool IsMeshletBackfacing( const MeshletBounds &bounds, const float cameraPosition[3]);
+
+
+} // namespace vktg
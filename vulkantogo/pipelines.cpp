@@ -1,6 +1,8 @@
 
 #include "pipelines.h"
+#include "util/cpu_profiler.h"
 
+#include <algorithm>
 #include <fstream>
 
 
@@ -29,6 +31,8 @@ namespace vktg
 
     Pipeline ComputePipelineBuilder::Build() {
 
+        VKTG_PROFILE_ZONE( "ComputePipelineBuilder::Build");
+
         Pipeline pipeline;
 		pipeline.type = Pipeline::Type::eCompute;
 		pipeline.pipelineLayout = CreatePipelineLayout( descriptorLayouts, pushConstants);
@@ -106,6 +110,8 @@ namespace vktg
     
     Pipeline GraphicsPipelineBuilder::Build() {
 
+        VKTG_PROFILE_ZONE( "GraphicsPipelineBuilder::Build");
+
         Pipeline pipeline;
 		pipeline.type = Pipeline::Type::eGraphics;
 		pipeline.pipelineLayout = CreatePipelineLayout( descriptorLayouts, pushConstants);
@@ -120,6 +126,11 @@ namespace vktg
                 .setPVertexBindingDescriptions( &vertexInputBinding );
         }
 
+        // vertex input and input assembly are replaced by task and mesh shaders
+        bool meshShading = std::any_of( shaderInfos.begin(), shaderInfos.end(), []( const vk::PipelineShaderStageCreateInfo &info){
+            return info.stage == vk::ShaderStageFlagBits::eMeshEXT;
+        });
+
         auto colorBlendInfo = vk::PipelineColorBlendStateCreateInfo{}
             .setAttachmentCount( 1 )
             .setPAttachments( &colorBlendAttachment );
@@ -132,9 +143,9 @@ namespace vktg
 		auto pipelineInfo = vk::GraphicsPipelineCreateInfo{}
 			.setStageCount( (uint32_t)shaderInfos.size() )
 			.setPStages( shaderInfos.data() )
-			.setPVertexInputState( &vertexInputInfo )
+			.setPVertexInputState( meshShading ? nullptr : &vertexInputInfo )
 			.setPTessellationState( &tesselationInfo)
-			.setPInputAssemblyState( &inputAssemblyInfo )
+			.setPInputAssemblyState( meshShading ? nullptr : &inputAssemblyInfo )
 			.setPViewportState( &viewportInfo )
 			.setPRasterizationState( &rasterizerInfo )
 			.setPMultisampleState( &multisampleInfo )
@@ -236,7 +247,7 @@ namespace vktg
     }
 
     
-    GraphicsPipelineBuilder &GraphicsPipelineBuilder::SetVertexAttributes( std::span<vk::VertexInputAttributeDescription> attributes) {
+    GraphicsPipelineBuilder &GraphicsPipelineBuilder::SetVertexAttributes( std::span<const vk::VertexInputAttributeDescription> attributes) {
 
         vertexAttributes = std::vector<vk::VertexInputAttributeDescription>( attributes.begin(), attributes.end());
 
@@ -97,6 +97,7 @@ namespace vktg
         Pipeline Build() override;
 
         /// @brief Adds shader used in the graphics pipeline.
+        ///        Pipelines with a mesh shader stage, optionally preceded by a task shader, ignore vertex input and input assembly settings.
         /// @param shaderModule Shader module.
         /// @param shaderStage Shader stage.
         /// @param pSpecialization Optional shader specialization constants.
@@ -136,7 +137,7 @@ namespace vktg
         /// @brief Specify vertex attributes.
         /// @param attributes List of vertex attribute descriptions.
         /// @return Reference to GraphicsPipelineBuilder for chaining.
-        GraphicsPipelineBuilder& SetVertexAttributes( std::span<vk::VertexInputAttributeDescription> attributes);
+        GraphicsPipelineBuilder& SetVertexAttributes( std::span<const vk::VertexInputAttributeDescription> attributes);
         /// @brief Specify input assembly settings.
         /// @param topology Primitive topology.
         /// @param enablePrimitiveRestart Enable/Disable primitive restart.
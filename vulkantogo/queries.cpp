@@ -0,0 +1,211 @@
+#include "queries.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    QueryManager::QueryManager( uint8_t frameOverlap, vk::QueryPipelineStatisticFlags statistics, uint32_t poolSize) :
+        mStatistics{ statistics},
+        mStatisticCount{ (uint32_t)std::popcount( (uint32_t)statistics)},
+        mPoolSize{ poolSize},
+        mFrameIndex{ 0},
+        mFirstFrame{ true},
+        mFrames( frameOverlap)
+    {
+    }
+
+
+    void QueryManager::BeginFrame( vk::CommandBuffer cmd) {
+
+        if (!mFirstFrame)
+        {
+            mFrameIndex = (mFrameIndex + 1) % mFrames.size();
+        }
+        mFirstFrame = false;
+        auto &frame = mFrames[mFrameIndex];
+
+        // read the used queries of each pool at once, the results of a pool set are laid out by query slot
+        uint32_t setOffsets[3];
+        uint32_t dataSize = 0;
+        for (uint32_t set = 0; set < 3; set++)
+        {
+            setOffsets[set] = dataSize;
+            uint32_t stride = ValueCount( set == 2 ? vk::QueryType::ePipelineStatistics : vk::QueryType::eTimestamp) + 1;
+            dataSize += frame.poolSets[set].used * stride;
+        }
+        mQueryData.assign( dataSize, 0);
+
+        for (uint32_t set = 0; set < 3; set++)
+        {
+            auto &poolSet = frame.poolSets[set];
+            uint32_t stride = ValueCount( set == 2 ? vk::QueryType::ePipelineStatistics : vk::QueryType::eTimestamp) + 1;
+            for (uint32_t pool = 0; pool * mPoolSize < poolSet.used; pool++)
+            {
+                uint32_t count = std::min( poolSet.used - pool * mPoolSize, mPoolSize);
+                // the frame fence has been waited on, so results are only missing if a query was never submitted
+                auto result = Device().getQueryPoolResults(
+                    poolSet.pools[pool], 0, count,
+                    count * stride * sizeof(uint64_t), &mQueryData[setOffsets[set] + pool * mPoolSize * stride], stride * sizeof(uint64_t),
+                    vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability
+                );
+                if (result != vk::Result::eSuccess && result != vk::Result::eNotReady)
+                {
+                    throw std::runtime_error( "Failed to read query pool results!");
+                }
+                cmd.resetQueryPool( poolSet.pools[pool], 0, count);
+            }
+            poolSet.used = 0;
+        }
+
+        mResults.clear();
+        mValues.clear();
+        for (auto &query : frame.queries)
+        {
+            uint32_t set = PoolSetIndex( query.type);
+            uint32_t valueCount = ValueCount( query.type);
+            const uint64_t *data = &mQueryData[setOffsets[set] + query.slot * (valueCount + 1)];
+
+            QueryResult result;
+            result.name = std::move( query.name);
+            result.type = query.type;
+            result.available = data[valueCount] != 0;
+            result.firstValue = (uint32_t)mValues.size();
+            result.valueCount = valueCount;
+            mValues.insert( mValues.end(), data, data + valueCount);
+            mResults.push_back( std::move( result));
+        }
+        frame.queries.clear();
+    }
+
+
+    uint32_t QueryManager::BeginQuery( vk::CommandBuffer cmd, vk::QueryType type, std::string_view name, vk::QueryControlFlags flags) {
+
+        if (type == vk::QueryType::eTimestamp)
+        {
+            throw std::runtime_error( "Timestamp queries are written with WriteTimestamp(...)!");
+        }
+
+        uint32_t query = Allocate( type, name);
+        auto [pool, index] = Location( query);
+        cmd.beginQuery( pool, index, flags);
+
+        return query;
+    }
+
+
+    void QueryManager::EndQuery( vk::CommandBuffer cmd, uint32_t query) {
+
+        auto [pool, index] = Location( query);
+        cmd.endQuery( pool, index);
+    }
+
+
+    uint32_t QueryManager::WriteTimestamp( vk::CommandBuffer cmd, std::string_view name, vk::PipelineStageFlags2 stage) {
+
+        uint32_t query = Allocate( vk::QueryType::eTimestamp, name);
+        auto [pool, index] = Location( query);
+        cmd.writeTimestamp2( stage, pool, index);
+
+        return query;
+    }
+
+
+    void QueryManager::Destroy() {
+
+        for (auto &frame : mFrames)
+        {
+            for (auto &poolSet : frame.poolSets)
+            {
+                for (auto pool : poolSet.pools)
+                {
+                    Device().destroyQueryPool( pool);
+                }
+                poolSet.pools.clear();
+                poolSet.used = 0;
+            }
+            frame.queries.clear();
+        }
+    }
+
+
+    uint64_t QueryManager::Statistic( const QueryResult &result, vk::QueryPipelineStatisticFlagBits statistic) const {
+
+        if (result.type != vk::QueryType::ePipelineStatistics || !(mStatistics & statistic))
+        {
+            throw std::runtime_error( "Pipeline statistic was not queried!");
+        }
+        if (!result.available)
+        {
+            return 0;
+        }
+
+        // counters are written in order of their flag bits, only for enabled statistics
+        uint32_t bit = (uint32_t)statistic;
+        uint32_t index = (uint32_t)std::popcount( (uint32_t)mStatistics & (bit - 1));
+
+        return mValues[result.firstValue + index];
+    }
+
+
+    uint32_t QueryManager::PoolSetIndex( vk::QueryType type) const {
+
+        switch (type)
+        {
+            case vk::QueryType::eTimestamp:
+                return 0;
+            case vk::QueryType::eOcclusion:
+                return 1;
+            case vk::QueryType::ePipelineStatistics:
+                return 2;
+            default:
+                throw std::runtime_error( "Query type " + vk::to_string( type) + " is not supported!");
+        }
+    }
+
+
+    uint32_t QueryManager::ValueCount( vk::QueryType type) const {
+
+        return type == vk::QueryType::ePipelineStatistics ? mStatisticCount : 1;
+    }
+
+
+    uint32_t QueryManager::Allocate( vk::QueryType type, std::string_view name) {
+
+        auto &frame = mFrames[mFrameIndex];
+        auto &poolSet = frame.poolSets[PoolSetIndex( type)];
+
+        if (poolSet.used == poolSet.pools.size() * mPoolSize)
+        {
+            auto queryPoolInfo = vk::QueryPoolCreateInfo{}
+                .setQueryType( type )
+                .setQueryCount( mPoolSize )
+                .setPipelineStatistics( type == vk::QueryType::ePipelineStatistics ? mStatistics : vk::QueryPipelineStatisticFlags{} );
+            vk::QueryPool pool;
+            VK_CHECK( Device().createQueryPool( &queryPoolInfo, nullptr, &pool) );
+            // queries must be reset before first use, the pool may be created during a render pass
+            Device().resetQueryPool( pool, 0, mPoolSize);
+            poolSet.pools.push_back( pool);
+        }
+
+        frame.queries.push_back( Query{ std::string( name), type, poolSet.used++});
+
+        return (uint32_t)frame.queries.size() - 1;
+    }
+
+
+    std::pair<vk::QueryPool, uint32_t> QueryManager::Location( uint32_t query) const {
+
+        auto &frame = mFrames[mFrameIndex];
+        auto &info = frame.queries.at( query);
+        auto &poolSet = frame.poolSets[PoolSetIndex( info.type)];
+
+        return { poolSet.pools[info.slot / mPoolSize], info.slot % mPoolSize};
+    }
+
+
+} // namespace vktg
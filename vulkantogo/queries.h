@@ -0,0 +1,136 @@
+#pragma once
+
+
+#include "vk_core.h"
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Result of a query resolved by QueryManager::BeginFrame(...).
+    struct QueryResult {
+
+        std::string name;
+        vk::QueryType type;
+        /// @brief False if the query was not written or its submit did not complete.
+        bool available;
+        /// @brief First value in QueryManager::Values(), timestamp ticks, passed samples or one counter per enabled pipeline statistic.
+        uint32_t firstValue;
+        uint32_t valueCount;
+    };
+
+
+    /// @brief Pools timestamp, occlusion and pipeline statistics queries per frame in flight. Query pools of a frame are reused
+    ///        once the frame comes around again, its results are read without waiting and the used queries are reset in one command per pool.
+    ///        New pools are created as needed and reset from the host, so pipeline statistics and host query reset must be enabled,
+    ///        which the default device features do.
+    class QueryManager {
+
+        public:
+
+            /// @brief Pipeline statistics collected if none are specified.
+            static constexpr vk::QueryPipelineStatisticFlags defaultStatistics =
+                vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+                vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+                vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+                vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+                vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+                vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+
+            /// @brief Initialize query manager, pools are created on first use.
+            /// @param frameOverlap Number of frames in flight.
+            /// @param statistics Pipeline statistics counted by pipeline statistics queries.
+            /// @param poolSize Number of queries per query pool.
+            QueryManager( uint8_t frameOverlap, vk::QueryPipelineStatisticFlags statistics = defaultStatistics, uint32_t poolSize = 64);
+
+            /// @brief Resolves the queries recorded the last time this frame was in flight and resets them.
+            ///        Call once per frame after waiting for the frame fence, at the start of the first command buffer of the frame.
+            /// @param cmd Command buffer, outside of rendering.
+            void BeginFrame( vk::CommandBuffer cmd);
+            /// @brief Begins an occlusion or pipeline statistics query.
+            /// @param cmd Command buffer.
+            /// @param type Query type, occlusion or pipeline statistics.
+            /// @param name Name to identify the query result.
+            /// @param flags Query control flags, e.g. precise occlusion.
+            /// @return Query id, the index of the result in Results() once this frame is resolved.
+            uint32_t BeginQuery( vk::CommandBuffer cmd, vk::QueryType type, std::string_view name, vk::QueryControlFlags flags = {});
+            /// @brief Ends an occlusion or pipeline statistics query.
+            /// @param cmd Command buffer.
+            /// @param query Query id returned by BeginQuery(...).
+            void EndQuery( vk::CommandBuffer cmd, uint32_t query);
+            /// @brief Writes a timestamp.
+            /// @param cmd Command buffer.
+            /// @param name Name to identify the query result.
+            /// @param stage Pipeline stage to write the timestamp after.
+            /// @return Query id, the index of the result in Results() once this frame is resolved.
+            uint32_t WriteTimestamp( vk::CommandBuffer cmd, std::string_view name, vk::PipelineStageFlags2 stage = vk::PipelineStageFlagBits2::eAllCommands);
+            /// @brief Destroys all query pools.
+            void Destroy();
+
+            /// @brief Queries resolved by the last BeginFrame(...) in recording order.
+            /// @return List of query results.
+            std::span<const QueryResult> Results() const { return mResults; }
+            /// @brief Values of a query result.
+            /// @param result Query result.
+            /// @return Result values.
+            std::span<const uint64_t> Values( const QueryResult &result) const { return std::span<const uint64_t>( mValues).subspan( result.firstValue, result.valueCount); }
+            /// @brief Single counter of a pipeline statistics query result.
+            /// @param result Pipeline statistics query result.
+            /// @param statistic Counter to read, must be one of the enabled statistics.
+            /// @return Counter value, 0 if not available.
+            uint64_t Statistic( const QueryResult &result, vk::QueryPipelineStatisticFlagBits statistic) const;
+            /// @brief Number of queries recorded in the current frame.
+            /// @return Query count.
+            uint32_t QueryCount() const { return (uint32_t)mFrames[mFrameIndex].queries.size(); }
+
+        private:
+
+            /// @brief Pools of one query type, the first used queries of the pools are in use.
+            struct PoolSet {
+                std::vector<vk::QueryPool> pools;
+                uint32_t used = 0;
+            };
+
+            struct Query {
+                std::string name;
+                vk::QueryType type;
+                /// @brief Index among the queries of its type, pool slot / poolSize at query slot % poolSize.
+                uint32_t slot;
+            };
+
+            struct Frame {
+                std::array<PoolSet, 3> poolSets;
+                std::vector<Query> queries;
+            };
+
+            /// @brief Pool set index and number of result values of a query type.
+            uint32_t PoolSetIndex( vk::QueryType type) const;
+            uint32_t ValueCount( vk::QueryType type) const;
+            /// @brief Takes the next free query of given type from the current frame, creating a pool if needed.
+            uint32_t Allocate( vk::QueryType type, std::string_view name);
+            /// @brief Pool and index in that pool of a query of the current frame.
+            std::pair<vk::QueryPool, uint32_t> Location( uint32_t query) const;
+
+
+            const vk::QueryPipelineStatisticFlags mStatistics;
+            const uint32_t mStatisticCount;
+            const uint32_t mPoolSize;
+            uint8_t mFrameIndex;
+            bool mFirstFrame;
+
+            std::vector<Frame> mFrames;
+            std::vector<QueryResult> mResults;
+            std::vector<uint64_t> mValues;
+            std::vector<uint64_t> mQueryData;
+    };
+
+
+} // namespace vktg
@@ -0,0 +1,239 @@
+#include "readback.h"
+#include "formats.h"
+#include "synchronization.h"
+#include "transfer.h"
+
+#include <algorithm>
+#include <memory>
+
+
+namespace vktg
+{
+
+
+    ReadbackQueue::ReadbackQueue( vk::DeviceSize ringSize) :
+        mAlignment{ 16},
+        mHead{ 0},
+        mTail{ 0},
+        mNextValue{ 1},
+        mSignaledValue{ 0}
+    {
+        // gpu to cpu memory prefers host cached memory types, reads from uncached memory are very slow
+        CreateBuffer( mRing, ringSize, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu, vma::AllocationCreateFlagBits::eMapped);
+        mSemaphore = CreateSemaphore( vk::SemaphoreType::eTimeline);
+    }
+
+
+    void ReadbackQueue::ReadBuffer( vk::CommandBuffer cmd, Buffer &buffer, vk::DeviceSize offset, vk::DeviceSize size, Callback callback) {
+
+        Readback readback;
+        readback.size = size == VK_WHOLE_SIZE ? buffer.Size() - offset : size;
+        readback.value = 0;
+        readback.callback = std::move( callback);
+        vk::Buffer dstBuffer = Reserve( readback);
+
+        Transition( cmd, buffer, ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead});
+        CopyBuffer( cmd, buffer.buffer, dstBuffer, readback.size, offset, readback.offset);
+        RecordHostBarrier( cmd, dstBuffer, readback.offset, readback.size);
+
+        mPending.push_back( std::move( readback));
+    }
+
+
+    std::future<std::vector<uint8_t>> ReadbackQueue::ReadBuffer( vk::CommandBuffer cmd, Buffer &buffer, vk::DeviceSize offset, vk::DeviceSize size) {
+
+        auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+        auto future = promise->get_future();
+        ReadBuffer( cmd, buffer, offset, size, [promise]( std::span<const uint8_t> data){
+            promise->set_value( std::vector<uint8_t>( data.begin(), data.end()));
+        });
+
+        return future;
+    }
+
+
+    void ReadbackQueue::ReadImage( vk::CommandBuffer cmd, Image &image, uint32_t mipLevel, uint32_t layer, Callback callback) {
+
+        uint32_t width = std::max( image.Width() >> mipLevel, 1u);
+        uint32_t height = std::max( image.Height() >> mipLevel, 1u);
+
+        Readback readback;
+        readback.size = ImageDataSize( image.Format(), width, height);
+        readback.value = 0;
+        readback.callback = std::move( callback);
+        vk::Buffer dstBuffer = Reserve( readback);
+
+        // only the depth aspect of depth stencil images is read
+        auto aspect = image.imageAspect & vk::ImageAspectFlagBits::eDepth ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+        Transition(
+            cmd, image,
+            ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal},
+            vk::ImageSubresourceRange{ {}, mipLevel, 1, layer, 1}
+        );
+        CopyImageToBuffer(
+            cmd, image.image, dstBuffer, readback.offset, width, height,
+            vk::Offset3D{ 0, 0, 0}, vk::ImageSubresourceLayers{ aspect, mipLevel, layer, 1}
+        );
+        RecordHostBarrier( cmd, dstBuffer, readback.offset, readback.size);
+
+        mPending.push_back( std::move( readback));
+    }
+
+
+    std::future<std::vector<uint8_t>> ReadbackQueue::ReadImage( vk::CommandBuffer cmd, Image &image, uint32_t mipLevel, uint32_t layer) {
+
+        auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+        auto future = promise->get_future();
+        ReadImage( cmd, image, mipLevel, layer, [promise]( std::span<const uint8_t> data){
+            promise->set_value( std::vector<uint8_t>( data.begin(), data.end()));
+        });
+
+        return future;
+    }
+
+
+    vk::SemaphoreSubmitInfo ReadbackQueue::SignalInfo( vk::PipelineStageFlags2 stage) {
+
+        uint64_t value = mNextValue++;
+        for (auto it = mPending.rbegin(); it != mPending.rend() && it->value == 0; ++it)
+        {
+            it->value = value;
+        }
+        mSignaledValue = value;
+
+        return vk::SemaphoreSubmitInfo{}
+            .setSemaphore( mSemaphore )
+            .setValue( value )
+            .setStageMask( stage );
+    }
+
+
+    uint32_t ReadbackQueue::Update() {
+
+        if (mPending.empty() || mPending.front().value == 0)
+        {
+            return 0;
+        }
+
+        uint64_t completedValue;
+        VK_CHECK( Device().getSemaphoreCounterValue( mSemaphore, &completedValue) );
+
+        return Deliver( completedValue);
+    }
+
+
+    void ReadbackQueue::Wait( uint64_t timeout) {
+
+        auto waitInfo = vk::SemaphoreWaitInfo{}
+            .setSemaphoreCount( 1 )
+            .setPSemaphores( &mSemaphore )
+            .setPValues( &mSignaledValue );
+        VK_CHECK( Device().waitSemaphores( &waitInfo, timeout) );
+
+        Deliver( mSignaledValue);
+    }
+
+
+    void ReadbackQueue::Destroy() {
+
+        for (auto &readback : mPending)
+        {
+            DestroyBuffer( readback.dedicated);
+        }
+        mPending.clear();
+
+        DestroyBuffer( mRing);
+        DestroySemaphore( mSemaphore);
+    }
+
+
+    vk::Buffer ReadbackQueue::Reserve( Readback &readback) {
+
+        vk::DeviceSize size = (readback.size + mAlignment - 1) / mAlignment * mAlignment;
+        vk::DeviceSize capacity = mRing.Size();
+
+        // ring buffer regions are freed in order, the free space is [head, capacity) and [0, tail) or [head, tail)
+        bool ringInUse = std::any_of( mPending.begin(), mPending.end(), []( const Readback &r){ return !r.dedicated.buffer; });
+        if (!ringInUse)
+        {
+            mHead = mTail = 0;
+        }
+
+        bool fits = false;
+        if (!ringInUse || mHead > mTail)
+        {
+            if (capacity - mHead >= size)
+            {
+                fits = true;
+            }
+            else if (mTail >= size)
+            {
+                mHead = 0;
+                fits = true;
+            }
+        }
+        else if (mHead < mTail)
+        {
+            fits = mTail - mHead >= size;
+        }
+
+        if (fits)
+        {
+            readback.offset = mHead;
+            mHead += size;
+            return mRing.buffer;
+        }
+
+        CreateBuffer( readback.dedicated, readback.size, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu, vma::AllocationCreateFlagBits::eMapped);
+        readback.offset = 0;
+
+        return readback.dedicated.buffer;
+    }
+
+
+    void ReadbackQueue::RecordHostBarrier( vk::CommandBuffer cmd, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size) {
+
+        BarrierBatch batch;
+        batch.Add( CreateBufferMemoryBarrier(
+            buffer,
+            vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eHost, vk::AccessFlagBits2::eHostRead,
+            offset, size
+        ));
+        batch.Flush( cmd);
+    }
+
+
+    uint32_t ReadbackQueue::Deliver( uint64_t completedValue) {
+
+        uint32_t delivered = 0;
+        while (!mPending.empty() && mPending.front().value != 0 && mPending.front().value <= completedValue)
+        {
+            auto readback = std::move( mPending.front());
+            mPending.pop_front();
+
+            // invalidate is a no-op for host coherent memory
+            auto &buffer = readback.dedicated.buffer ? readback.dedicated : mRing;
+            Allocator().invalidateAllocation( buffer.allocation, readback.offset, readback.size);
+            auto data = static_cast<const uint8_t*>( buffer.Data()) + readback.offset;
+            if (readback.callback)
+            {
+                readback.callback( std::span<const uint8_t>( data, readback.size));
+            }
+
+            if (readback.dedicated.buffer)
+            {
+                DestroyBuffer( readback.dedicated);
+            }
+            else
+            {
+                mTail = readback.offset + (readback.size + mAlignment - 1) / mAlignment * mAlignment;
+            }
+            delivered++;
+        }
+
+        return delivered;
+    }
+
+
+} // namespace vktg
@@ -0,0 +1,117 @@
+#pragma once
+
+
+#include "vk_core.h"
+#include "storage.h"
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <span>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Reads buffer and image data back to the host without stalling the frame.
+    ///        Copies are recorded into the command buffers of the caller and land in a persistently mapped, host cached ring buffer.
+    ///        Each submit containing readbacks signals the timeline semaphore of the queue with the value returned by SignalInfo(),
+    ///        and Update() delivers the data of all completed readbacks through callbacks or futures.
+    class ReadbackQueue {
+
+        public:
+
+            /// @brief Called with the read back data, which is only valid until the callback returns.
+            using Callback = std::function<void( std::span<const uint8_t> data)>;
+
+            /// @brief Initialize readback queue and create its ring buffer.
+            /// @param ringSize Size of the mapped ring buffer. Readbacks that do not fit get a temporary buffer of their own.
+            ReadbackQueue( vk::DeviceSize ringSize = 16 << 20);
+
+            /// @brief Records a copy of a buffer region to the ring buffer. The buffer is transitioned to transfer reads.
+            /// @param cmd Command buffer.
+            /// @param buffer Buffer to read.
+            /// @param offset Offset of the buffer region.
+            /// @param size Size of the buffer region, VK_WHOLE_SIZE for the rest of the buffer.
+            /// @param callback Called by Update() once the copy completed.
+            void ReadBuffer( vk::CommandBuffer cmd, Buffer &buffer, vk::DeviceSize offset, vk::DeviceSize size, Callback callback);
+            /// @brief Records a copy of a buffer region to the ring buffer. The buffer is transitioned to transfer reads.
+            /// @param cmd Command buffer.
+            /// @param buffer Buffer to read.
+            /// @param offset Offset of the buffer region.
+            /// @param size Size of the buffer region, VK_WHOLE_SIZE for the rest of the buffer.
+            /// @return Future receiving a copy of the data once Update() found the copy completed.
+            std::future<std::vector<uint8_t>> ReadBuffer( vk::CommandBuffer cmd, Buffer &buffer, vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE);
+            /// @brief Records a copy of an image subresource to the ring buffer as tightly packed texel blocks.
+            ///        The subresource is transitioned to transfer source layout.
+            /// @param cmd Command buffer.
+            /// @param image Image to read.
+            /// @param mipLevel Mip level to read.
+            /// @param layer Array layer to read.
+            /// @param callback Called by Update() once the copy completed.
+            void ReadImage( vk::CommandBuffer cmd, Image &image, uint32_t mipLevel, uint32_t layer, Callback callback);
+            /// @brief Records a copy of an image subresource to the ring buffer as tightly packed texel blocks.
+            ///        The subresource is transitioned to transfer source layout.
+            /// @param cmd Command buffer.
+            /// @param image Image to read.
+            /// @param mipLevel Mip level to read.
+            /// @param layer Array layer to read.
+            /// @return Future receiving a copy of the data once Update() found the copy completed.
+            std::future<std::vector<uint8_t>> ReadImage( vk::CommandBuffer cmd, Image &image, uint32_t mipLevel = 0, uint32_t layer = 0);
+
+            /// @brief Timeline semaphore signal for the submit of all readbacks recorded since the last call.
+            ///        Add it to the signal semaphores of that submit.
+            /// @param stage Pipeline stages to complete before signaling.
+            /// @return Semaphore submit info.
+            vk::SemaphoreSubmitInfo SignalInfo( vk::PipelineStageFlags2 stage = vk::PipelineStageFlagBits2::eAllCommands);
+            /// @brief Delivers the data of all completed readbacks without blocking. Call once per frame.
+            /// @return Number of delivered readbacks.
+            uint32_t Update();
+            /// @brief Waits for all signaled readbacks and delivers their data.
+            /// @param timeout Timeout in nanoseconds. Will throw if waiting takes longer than this value.
+            void Wait( uint64_t timeout = 1e9);
+            /// @brief Destroys the ring buffer, temporary buffers and the timeline semaphore. Pending readbacks are dropped.
+            void Destroy();
+
+            /// @brief Timeline semaphore signaled by the readback submits.
+            /// @return Vulkan semaphore.
+            vk::Semaphore Semaphore() const { return mSemaphore; }
+            /// @brief Number of recorded readbacks that have not been delivered yet.
+            /// @return Pending readback count.
+            size_t PendingCount() const { return mPending.size(); }
+
+        private:
+
+            struct Readback {
+                vk::DeviceSize offset;
+                vk::DeviceSize size;
+                /// @brief Timeline value signaled after the copy, 0 until SignalInfo() is called.
+                uint64_t value;
+                /// @brief Temporary buffer if the readback did not fit into the ring.
+                Buffer dedicated;
+                Callback callback;
+            };
+
+            /// @brief Reserves staging memory for a readback, returns the buffer to copy into and the offset in that buffer.
+            vk::Buffer Reserve( Readback &readback);
+            /// @brief Records the barrier making the copy visible to host reads.
+            void RecordHostBarrier( vk::CommandBuffer cmd, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size);
+            /// @brief Delivers all readbacks up to the completed timeline value.
+            uint32_t Deliver( uint64_t completedValue);
+
+
+            const vk::DeviceSize mAlignment;
+            Buffer mRing;
+            vk::DeviceSize mHead;
+            vk::DeviceSize mTail;
+
+            vk::Semaphore mSemaphore;
+            uint64_t mNextValue;
+            uint64_t mSignaledValue;
+            std::deque<Readback> mPending;
+    };
+
+
+} // namespace vktg
@@ -0,0 +1,1071 @@
+
+#include "render_graph.h"
+#include "commands.h"
+#include "synchronization.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    /***    RENDER GRAPH PASS    ***/
+
+    RenderGraphPass& RenderGraphPass::Read( uint32_t resource, const ResourceUsage &usage) {
+
+        reads.emplace_back( resource, usage);
+
+        return *this;
+    }
+
+
+    RenderGraphPass& RenderGraphPass::Write( uint32_t resource, const ResourceUsage &usage) {
+
+        writes.emplace_back( resource, usage);
+
+        return *this;
+    }
+
+
+    RenderGraphPass& RenderGraphPass::SetExecute( std::function<void(vk::CommandBuffer)> func) {
+
+        execute = std::move( func);
+
+        return *this;
+    }
+
+
+    /***    RENDER GRAPH    ***/
+
+    static bool IsEmptyUsage( const ResourceUsage &usage) {
+
+        return usage.stage == vk::PipelineStageFlags2{} && usage.access == vk::AccessFlags2{} && usage.layout == vk::ImageLayout::eUndefined;
+    }
+
+
+    static ResourceUsage TrackedUsage( const TrackedState &state) {
+
+        return ResourceUsage{ state.writeStage | state.readStages, state.writeAccess, state.layout};
+    }
+
+
+
+    RenderGraph::RenderGraph( uint8_t frameOverlap) :
+        mFrameOverlap{frameOverlap}, mExecuteCount{0}, mCompiled{false}, mTransientMemorySize{0}
+    {
+        // one lane per distinct queue, queue types sharing a queue share a lane
+        QueueType queueTypes[] = {QueueType::eGraphics, QueueType::eCompute, QueueType::eTransfer};
+        for (auto type : queueTypes)
+        {
+            uint32_t lane = (uint32_t)mLaneTypes.size();
+            for (uint32_t i = 0; i < mLaneTypes.size(); i++)
+            {
+                if (Queue( mLaneTypes[i]) == Queue( type))
+                {
+                    lane = i;
+                    break;
+                }
+            }
+            if (lane == mLaneTypes.size())
+            {
+                mLaneTypes.push_back( type);
+            }
+            mLaneOf[(uint8_t)type] = lane;
+        }
+
+        for (size_t i = 0; i < mLaneTypes.size(); i++)
+        {
+            mLaneSemaphores.push_back( CreateSemaphore( vk::SemaphoreType::eTimeline));
+        }
+        mLaneValues.assign( mLaneTypes.size(), 0);
+        mFrameLaneValues.assign( mFrameOverlap, std::vector<uint64_t>( mLaneTypes.size(), 0));
+    }
+
+
+    uint32_t RenderGraph::ImportImage( Image &image, const ResourceUsage &initialUsage, const ResourceUsage &finalUsage) {
+
+        Resource resource;
+        resource.type = Resource::Type::eImage;
+        resource.imported = true;
+        resource.pImage = &image;
+        resource.initialUsage = initialUsage;
+        if (IsEmptyUsage( initialUsage) && !image.subresourceStates.empty())
+        {
+            resource.initialUsage = TrackedUsage( image.subresourceStates[0]);
+        }
+        resource.finalUsage = finalUsage;
+
+        mResources.push_back( resource);
+        mCompiled = false;
+
+        return (uint32_t)mResources.size() - 1;
+    }
+
+
+    uint32_t RenderGraph::ImportImage(
+        vk::Image image, vk::ImageView imageView, vk::Format format, vk::Extent2D extent,
+        const ResourceUsage &initialUsage, const ResourceUsage &finalUsage)
+    {
+        Resource resource;
+        resource.type = Resource::Type::eImage;
+        resource.imported = true;
+        resource.image.image = image;
+        resource.image.imageView = imageView;
+        resource.image.imageAspect = vk::ImageAspectFlagBits::eColor;
+        resource.image.imageInfo = vk::ImageCreateInfo{}
+            .setImageType( vk::ImageType::e2D )
+            .setFormat( format )
+            .setExtent( vk::Extent3D{extent.width, extent.height, 1} )
+            .setMipLevels( 1 )
+            .setArrayLayers( 1 )
+            .setSharingMode( vk::SharingMode::eExclusive );
+        resource.initialUsage = initialUsage;
+        resource.finalUsage = finalUsage;
+
+        mResources.push_back( resource);
+        mCompiled = false;
+
+        return (uint32_t)mResources.size() - 1;
+    }
+
+
+    void RenderGraph::UpdateImportedImage( uint32_t resource, vk::Image image, vk::ImageView imageView) {
+
+        auto &importedImage = mResources[resource];
+        if (!importedImage.imported || importedImage.pImage != nullptr)
+        {
+            throw std::runtime_error( "Only raw imported images can be updated!");
+        }
+
+        importedImage.image.image = image;
+        importedImage.image.imageView = imageView;
+    }
+
+
+    uint32_t RenderGraph::ImportBuffer( Buffer &buffer, const ResourceUsage &initialUsage, const ResourceUsage &finalUsage) {
+
+        Resource resource;
+        resource.type = Resource::Type::eBuffer;
+        resource.imported = true;
+        resource.pBuffer = &buffer;
+        resource.initialUsage = IsEmptyUsage( initialUsage) ? TrackedUsage( buffer.state) : initialUsage;
+        resource.finalUsage = finalUsage;
+
+        mResources.push_back( resource);
+        mCompiled = false;
+
+        return (uint32_t)mResources.size() - 1;
+    }
+
+
+    uint32_t RenderGraph::CreateImage(
+        std::string_view name,
+        uint32_t width, uint32_t height,
+        vk::Format format, vk::ImageUsageFlags usage,
+        vk::ImageAspectFlags imageAspect,
+        uint32_t mipLevels, uint32_t layers, vk::SampleCountFlagBits numSamples)
+    {
+        Resource resource;
+        resource.type = Resource::Type::eImage;
+        resource.imported = false;
+        resource.name = name;
+        resource.image.imageAspect = imageAspect;
+        resource.image.imageInfo = vk::ImageCreateInfo{}
+            .setImageType( vk::ImageType::e2D )
+            .setFormat( format )
+            .setExtent( vk::Extent3D{width, height, 1} )
+            .setMipLevels( mipLevels )
+            .setArrayLayers( layers )
+            .setSamples( numSamples )
+            .setTiling( vk::ImageTiling::eOptimal )
+            .setUsage( usage )
+            .setSharingMode( vk::SharingMode::eExclusive )
+            .setInitialLayout( vk::ImageLayout::eUndefined );
+
+        mResources.push_back( resource);
+        mCompiled = false;
+
+        return (uint32_t)mResources.size() - 1;
+    }
+
+
+    RenderGraphPass& RenderGraph::AddPass( std::string_view name, QueueType queueType) {
+
+        auto &pass = mPasses.emplace_back();
+        pass.name = name;
+        pass.queueType = queueType;
+        mCompiled = false;
+
+        return pass;
+    }
+
+
+    void RenderGraph::Compile() {
+
+        WaitForCompletion();
+        ReleaseCompiledData();
+
+        mPassAccesses.clear();
+        for (auto &pass : mPasses)
+        {
+            mPassAccesses.push_back( PassAccesses( pass));
+        }
+
+        CullPasses();
+        AllocateTransientImages();
+        ScheduleBatches();
+
+        // one command pool per frame and lane, one command buffer per batch
+        mCommandPools.resize( mFrameOverlap);
+        mCommandBuffers.resize( mFrameOverlap);
+        for (uint8_t frame = 0; frame < mFrameOverlap; frame++)
+        {
+            for (auto type : mLaneTypes)
+            {
+                mCommandPools[frame].push_back( CreateCommandPool( QueueIndex( type), vk::CommandPoolCreateFlagBits::eTransient));
+            }
+            for (auto &batch : mBatches)
+            {
+                mCommandBuffers[frame].push_back( AllocateCommandBuffer( mCommandPools[frame][batch.lane]));
+            }
+        }
+
+        mCompiled = true;
+    }
+
+
+    void RenderGraph::Execute(
+        std::span<vk::SemaphoreSubmitInfo> waitSemaphores,
+        std::span<vk::SemaphoreSubmitInfo> signalSemaphores,
+        vk::Fence fence)
+    {
+        if (!mCompiled)
+        {
+            Compile();
+        }
+
+        // wait until the command buffers of this frame are no longer in use
+        uint8_t frame = mExecuteCount % mFrameOverlap;
+        auto waitInfo = vk::SemaphoreWaitInfo{}
+            .setSemaphoreCount( (uint32_t)mLaneSemaphores.size() )
+            .setPSemaphores( mLaneSemaphores.data() )
+            .setPValues( mFrameLaneValues[frame].data() );
+        VK_CHECK( Device().waitSemaphores( &waitInfo, UINT64_MAX) );
+
+        for (auto pool : mCommandPools[frame])
+        {
+            Device().resetCommandPool( pool);
+        }
+
+        if (mBatches.empty())
+        {
+            SubmitCommands( GraphicsQueue(), {}, waitSemaphores, signalSemaphores, fence);
+            mExecuteCount++;
+            return;
+        }
+
+        const auto &baseValues = mLaneValues;
+        for (uint32_t b = 0; b < mBatches.size(); b++)
+        {
+            auto &batch = mBatches[b];
+            auto cmd = mCommandBuffers[frame][b];
+
+            auto beginInfo = vk::CommandBufferBeginInfo{}
+                .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+            VK_CHECK( cmd.begin( &beginInfo) );
+
+            for (uint32_t i = 0; i < batch.passes.size(); i++)
+            {
+                RecordBarriers( cmd, batch.passBarriers[i]);
+                auto &pass = mPasses[batch.passes[i]];
+                if (pass.execute)
+                {
+                    pass.execute( cmd);
+                }
+            }
+            RecordBarriers( cmd, batch.endBarriers);
+
+            cmd.end();
+
+            // wait for batches on other lanes this batch depends on
+            std::vector<vk::SemaphoreSubmitInfo> waits;
+            for (auto &wait : batch.waits)
+            {
+                uint64_t value = wait.laneBatch < 0 ? baseValues[wait.lane] : baseValues[wait.lane] + wait.laneBatch + 1;
+                waits.push_back( vk::SemaphoreSubmitInfo{}
+                    .setSemaphore( mLaneSemaphores[wait.lane] )
+                    .setValue( value )
+                    .setStageMask( vk::PipelineStageFlagBits2::eAllCommands )
+                );
+            }
+            std::vector<vk::SemaphoreSubmitInfo> signals = {
+                vk::SemaphoreSubmitInfo{}
+                    .setSemaphore( mLaneSemaphores[batch.lane] )
+                    .setValue( baseValues[batch.lane] + batch.laneBatch + 1 )
+                    .setStageMask( vk::PipelineStageFlagBits2::eAllCommands )
+            };
+            vk::Fence batchFence = VK_NULL_HANDLE;
+
+            if (b == 0)
+            {
+                waits.insert( waits.end(), waitSemaphores.begin(), waitSemaphores.end());
+            }
+            if (b == mBatches.size() - 1)
+            {
+                // last batch joins all other lanes, so external signals and fence cover the whole graph
+                for (uint32_t lane = 0; lane < mLaneTypes.size(); lane++)
+                {
+                    if (lane != batch.lane && mLaneBatchCounts[lane] > 0)
+                    {
+                        waits.push_back( vk::SemaphoreSubmitInfo{}
+                            .setSemaphore( mLaneSemaphores[lane] )
+                            .setValue( baseValues[lane] + mLaneBatchCounts[lane] )
+                            .setStageMask( vk::PipelineStageFlagBits2::eAllCommands )
+                        );
+                    }
+                }
+                signals.insert( signals.end(), signalSemaphores.begin(), signalSemaphores.end());
+                batchFence = fence;
+            }
+
+            vk::CommandBufferSubmitInfo cmdInfos[] = {
+                vk::CommandBufferSubmitInfo{}.setCommandBuffer( cmd )
+            };
+            SubmitCommands( Queue( mLaneTypes[batch.lane]), cmdInfos, waits, signals, batchFence);
+        }
+
+        for (uint32_t lane = 0; lane < mLaneTypes.size(); lane++)
+        {
+            mLaneValues[lane] += mLaneBatchCounts[lane];
+        }
+        mFrameLaneValues[frame] = mLaneValues;
+        mExecuteCount++;
+
+        // keep tracked states of imported images and buffers up to date for use outside the graph
+        for (auto &resource : mResources)
+        {
+            if (resource.lastPass < 0)
+            {
+                continue;
+            }
+            if (resource.pImage != nullptr)
+            {
+                SetTrackedState( *resource.pImage, resource.endUsage);
+            }
+            if (resource.pBuffer != nullptr)
+            {
+                SetTrackedState( *resource.pBuffer, resource.endUsage);
+            }
+        }
+    }
+
+
+    void RenderGraph::Reset() {
+
+        WaitForCompletion();
+        ReleaseCompiledData();
+
+        mResources.clear();
+        mPasses.clear();
+        mPassAccesses.clear();
+    }
+
+
+    void RenderGraph::Destroy() {
+
+        Reset();
+
+        for (auto semaphore : mLaneSemaphores)
+        {
+            DestroySemaphore( semaphore);
+        }
+        mLaneSemaphores.clear();
+    }
+
+
+    const Image& RenderGraph::GetImage( uint32_t resource) const {
+
+        return ResourceImage( mResources[resource]);
+    }
+
+
+    const Buffer& RenderGraph::GetBuffer( uint32_t resource) const {
+
+        return ResourceBuffer( mResources[resource]);
+    }
+
+
+    bool RenderGraph::IsPassCulled( std::string_view name) const {
+
+        for (uint32_t p = 0; p < mPasses.size() && p < mCulled.size(); p++)
+        {
+            if (mPasses[p].name == name)
+            {
+                return mCulled[p];
+            }
+        }
+
+        return false;
+    }
+
+
+    vk::DeviceSize RenderGraph::TransientMemorySize() const {
+
+        return mTransientMemorySize;
+    }
+
+
+    std::vector<RenderGraph::Access> RenderGraph::PassAccesses( const RenderGraphPass &pass) const {
+
+        std::vector<Access> accesses;
+        auto addAccess = [&]( uint32_t resource, const ResourceUsage &usage, bool write) {
+
+            if (resource >= mResources.size())
+            {
+                throw std::runtime_error( "Render graph pass " + pass.name + " uses an invalid resource!");
+            }
+
+            for (auto &access : accesses)
+            {
+                if (access.resource != resource)
+                {
+                    continue;
+                }
+                if (mResources[resource].type == Resource::Type::eImage && access.usage.layout != usage.layout)
+                {
+                    throw std::runtime_error( "Render graph pass " + pass.name + " uses an image in two different layouts!");
+                }
+                access.usage.stage |= usage.stage;
+                access.usage.access |= usage.access;
+                access.write = access.write || write;
+                return;
+            }
+            accesses.push_back( Access{resource, usage, write});
+        };
+
+        for (auto &[resource, usage] : pass.reads)
+        {
+            addAccess( resource, usage, false);
+        }
+        for (auto &[resource, usage] : pass.writes)
+        {
+            addAccess( resource, usage, true);
+        }
+
+        return accesses;
+    }
+
+
+    void RenderGraph::CullPasses() {
+
+        // passes are referenced by the resources they write, resources by the passes reading them
+        std::vector<uint32_t> passRefCounts( mPasses.size(), 0);
+        std::vector<std::vector<uint32_t>> producers( mResources.size());
+        for (auto &resource : mResources)
+        {
+            resource.refCount = resource.imported ? 1 : 0;
+        }
+        for (uint32_t p = 0; p < mPasses.size(); p++)
+        {
+            for (auto &access : mPassAccesses[p])
+            {
+                if (access.write)
+                {
+                    passRefCounts[p]++;
+                    producers[access.resource].push_back( p);
+                }
+                else
+                {
+                    mResources[access.resource].refCount++;
+                }
+            }
+        }
+
+        // flood unreferenced resources back to their producers
+        mCulled.assign( mPasses.size(), false);
+        std::vector<uint32_t> unreferencedResources;
+        std::vector<uint32_t> culledPasses;
+        for (uint32_t r = 0; r < mResources.size(); r++)
+        {
+            if (mResources[r].refCount == 0)
+            {
+                unreferencedResources.push_back( r);
+            }
+        }
+        for (uint32_t p = 0; p < mPasses.size(); p++)
+        {
+            if (passRefCounts[p] == 0)
+            {
+                mCulled[p] = true;
+                culledPasses.push_back( p);
+            }
+        }
+
+        while (!unreferencedResources.empty() || !culledPasses.empty())
+        {
+            if (!culledPasses.empty())
+            {
+                uint32_t p = culledPasses.back();
+                culledPasses.pop_back();
+                for (auto &access : mPassAccesses[p])
+                {
+                    if (!access.write && --mResources[access.resource].refCount == 0)
+                    {
+                        unreferencedResources.push_back( access.resource);
+                    }
+                }
+                continue;
+            }
+
+            uint32_t r = unreferencedResources.back();
+            unreferencedResources.pop_back();
+            for (auto p : producers[r])
+            {
+                if (!mCulled[p] && --passRefCounts[p] == 0)
+                {
+                    mCulled[p] = true;
+                    culledPasses.push_back( p);
+                }
+            }
+        }
+
+        // lifetimes of resources in the order of remaining passes
+        mOrder.clear();
+        for (auto &resource : mResources)
+        {
+            resource.firstPass = -1;
+            resource.lastPass = -1;
+        }
+        for (uint32_t p = 0; p < mPasses.size(); p++)
+        {
+            if (mCulled[p])
+            {
+                continue;
+            }
+
+            int position = (int)mOrder.size();
+            mOrder.push_back( p);
+            for (auto &access : mPassAccesses[p])
+            {
+                auto &resource = mResources[access.resource];
+                if (resource.firstPass < 0)
+                {
+                    resource.firstPass = position;
+                }
+                resource.lastPass = position;
+            }
+        }
+    }
+
+
+    void RenderGraph::AllocateTransientImages() {
+
+        // create transient images without memory to query their requirements
+        std::vector<uint32_t> transients;
+        for (uint32_t r = 0; r < mResources.size(); r++)
+        {
+            auto &resource = mResources[r];
+            resource.aliases.clear();
+            if (resource.imported || resource.firstPass < 0)
+            {
+                continue;
+            }
+
+            VK_CHECK( Device().createImage( &resource.image.imageInfo, nullptr, &resource.image.image) );
+            Device().getImageMemoryRequirements( resource.image.image, &resource.memoryRequirements);
+            transients.push_back( r);
+        }
+
+        // place largest images first at the lowest offset not used by an image alive at the same time
+        std::sort( transients.begin(), transients.end(), [&]( uint32_t a, uint32_t b) {
+            return mResources[a].memoryRequirements.size > mResources[b].memoryRequirements.size;
+        });
+
+        std::vector<uint32_t> placed;
+        std::vector<uint32_t> separate;
+        vk::DeviceSize alignment = 1;
+        uint32_t memoryTypeBits = ~0u;
+        mTransientMemorySize = 0;
+        for (auto r : transients)
+        {
+            auto &resource = mResources[r];
+            auto &requirements = resource.memoryRequirements;
+            if ((memoryTypeBits & requirements.memoryTypeBits) == 0)
+            {
+                separate.push_back( r);
+                continue;
+            }
+
+            std::vector<std::pair<vk::DeviceSize, vk::DeviceSize>> occupied;
+            for (auto other : placed)
+            {
+                auto &otherResource = mResources[other];
+                if (otherResource.firstPass <= resource.lastPass && resource.firstPass <= otherResource.lastPass)
+                {
+                    occupied.emplace_back( otherResource.memoryOffset, otherResource.memoryOffset + otherResource.memoryRequirements.size);
+                }
+            }
+            std::sort( occupied.begin(), occupied.end());
+
+            vk::DeviceSize offset = 0;
+            for (auto &[begin, end] : occupied)
+            {
+                if (offset + requirements.size <= begin)
+                {
+                    break;
+                }
+                offset = std::max( offset, (end + requirements.alignment - 1) / requirements.alignment * requirements.alignment);
+            }
+
+            resource.memoryOffset = offset;
+            mTransientMemorySize = std::max( mTransientMemorySize, offset + requirements.size);
+            alignment = std::max( alignment, requirements.alignment);
+            memoryTypeBits &= requirements.memoryTypeBits;
+            placed.push_back( r);
+        }
+
+        // images sharing memory must wait for each other before their first use in a frame
+        for (auto a : placed)
+        {
+            for (auto b : placed)
+            {
+                auto &resourceA = mResources[a];
+                auto &resourceB = mResources[b];
+                if (a != b
+                    && resourceA.memoryOffset < resourceB.memoryOffset + resourceB.memoryRequirements.size
+                    && resourceB.memoryOffset < resourceA.memoryOffset + resourceA.memoryRequirements.size)
+                {
+                    resourceA.aliases.push_back( b);
+                }
+            }
+        }
+
+        auto allocationCreateInfo = vma::AllocationCreateInfo{}
+            .setUsage( vma::MemoryUsage::eGpuOnly );
+        if (!placed.empty())
+        {
+            vk::MemoryRequirements requirements{ mTransientMemorySize, alignment, memoryTypeBits };
+            vma::Allocation allocation;
+            VK_CHECK( Allocator().allocateMemory( &requirements, &allocationCreateInfo, &allocation, nullptr) );
+            mTransientMemory.push_back( allocation);
+
+            for (auto r : placed)
+            {
+                Allocator().bindImageMemory2( allocation, mResources[r].memoryOffset, mResources[r].image.image, nullptr);
+            }
+        }
+        for (auto r : separate)
+        {
+            vma::Allocation allocation;
+            VK_CHECK( Allocator().allocateMemory( &mResources[r].memoryRequirements, &allocationCreateInfo, &allocation, nullptr) );
+            Allocator().bindImageMemory( allocation, mResources[r].image.image);
+            mTransientMemory.push_back( allocation);
+            mTransientMemorySize += mResources[r].memoryRequirements.size;
+        }
+
+        for (auto r : transients)
+        {
+            auto &image = mResources[r].image;
+            image.imageView = CreateImageView(
+                image.image, image.Format(), image.imageAspect,
+                0, image.MipLevels(), 0, image.Layers(),
+                image.Layers() > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D
+            );
+        }
+    }
+
+
+    void RenderGraph::ScheduleBatches() {
+
+        // consecutive passes on the same lane form one submission batch
+        mBatches.clear();
+        mLaneBatchCounts.assign( mLaneTypes.size(), 0);
+        for (auto p : mOrder)
+        {
+            uint32_t lane = mLaneOf[(uint8_t)mPasses[p].queueType];
+            if (mBatches.empty() || mBatches.back().lane != lane)
+            {
+                Batch batch;
+                batch.lane = lane;
+                batch.laneBatch = mLaneBatchCounts[lane]++;
+                mBatches.push_back( batch);
+            }
+            mBatches.back().passes.push_back( p);
+            mBatches.back().passBarriers.emplace_back();
+        }
+
+        // the first simulated frame provides the final transient states the next frame starts from
+        std::vector<ResourceState> states;
+        for (auto &resource : mResources)
+        {
+            states.push_back( InitialState( resource));
+        }
+        SimulateFrame( states, false);
+
+        for (uint32_t r = 0; r < mResources.size(); r++)
+        {
+            auto &state = states[r];
+            if (mResources[r].imported)
+            {
+                state = InitialState( mResources[r]);
+                continue;
+            }
+
+            // previous frame contents are discarded, only its accesses have to complete
+            if (state.writeLane >= 0)
+            {
+                state.writeLaneBatch = -1;
+            }
+            for (auto &reader : state.readers)
+            {
+                reader.laneBatch = -1;
+            }
+            state.layout = vk::ImageLayout::eUndefined;
+            state.ownerLane = -1;
+            state.lastBatch = -1;
+            state.touched = false;
+        }
+        for (auto &batch : mBatches)
+        {
+            batch.waits.clear();
+        }
+        SimulateFrame( states, true);
+    }
+
+
+    void RenderGraph::SimulateFrame( std::vector<ResourceState> &states, bool recordBarriers) {
+
+        for (uint32_t b = 0; b < mBatches.size(); b++)
+        {
+            auto &batch = mBatches[b];
+            int32_t lane = (int32_t)batch.lane;
+            uint32_t queueFamily = QueueIndex( mLaneTypes[lane]);
+
+            for (uint32_t i = 0; i < batch.passes.size(); i++)
+            {
+                for (auto &access : mPassAccesses[batch.passes[i]])
+                {
+                    auto &resource = mResources[access.resource];
+                    auto &state = states[access.resource];
+                    bool isImage = resource.type == Resource::Type::eImage;
+                    bool layoutChange = isImage && access.usage.layout != state.layout;
+
+                    Barrier barrier{};
+                    barrier.resource = access.resource;
+                    barrier.dstStage = access.usage.stage;
+                    barrier.dstAccess = access.usage.access;
+                    barrier.oldLayout = state.layout;
+                    barrier.newLayout = isImage ? access.usage.layout : state.layout;
+
+                    // first use of a transient image also waits for all images sharing its memory
+                    std::vector<const ResourceState*> sources = {&state};
+                    if (!resource.imported && !state.touched)
+                    {
+                        for (auto alias : resource.aliases)
+                        {
+                            sources.push_back( &states[alias]);
+                        }
+                    }
+
+                    // same lane dependencies are covered by the barrier, other lanes by a semaphore wait
+                    bool crossLane = false;
+                    bool covered = false;
+                    for (auto source : sources)
+                    {
+                        bool hazardWithReaders = access.write || layoutChange || source != &state;
+                        if (source->writeLane >= 0 && source->writeLane != lane)
+                        {
+                            crossLane = true;
+                            AddWait( batch, source->writeLane, source->writeLaneBatch);
+                        }
+                        else
+                        {
+                            barrier.srcStage |= source->writeStage;
+                            barrier.srcAccess |= source->writeAccess;
+                        }
+
+                        vk::PipelineStageFlags2 laneReadStages;
+                        vk::AccessFlags2 laneReadAccess;
+                        for (auto &reader : source->readers)
+                        {
+                            if ((int32_t)reader.lane == lane)
+                            {
+                                laneReadStages |= reader.stage;
+                                laneReadAccess |= reader.access;
+                            }
+                            else if (hazardWithReaders)
+                            {
+                                crossLane = true;
+                                AddWait( batch, reader.lane, reader.laneBatch);
+                            }
+                        }
+                        if (hazardWithReaders)
+                        {
+                            barrier.srcStage |= laneReadStages;
+                        }
+                        else if (source == &state)
+                        {
+                            // an earlier read on this lane already made the last write visible
+                            covered = (laneReadStages & access.usage.stage) == access.usage.stage
+                                && (laneReadAccess & access.usage.access) == access.usage.access;
+                        }
+                    }
+
+                    // exclusive resources changing queue family need a release and acquire barrier
+                    bool ownershipTransfer = state.ownerLane >= 0 && state.ownerLane != lane && state.lastBatch >= 0
+                        && IsExclusive( resource) && QueueIndex( mLaneTypes[state.ownerLane]) != queueFamily;
+                    if (ownershipTransfer)
+                    {
+                        auto &ownerBatch = mBatches[state.lastBatch];
+                        AddWait( batch, ownerBatch.lane, ownerBatch.laneBatch);
+
+                        Barrier release = barrier;
+                        release.srcStage = state.writeStage;
+                        for (auto &reader : state.readers)
+                        {
+                            release.srcStage |= reader.stage;
+                        }
+                        release.srcAccess = state.writeAccess;
+                        release.dstStage = vk::PipelineStageFlagBits2::eNone;
+                        release.dstAccess = vk::AccessFlagBits2::eNone;
+                        release.srcQueueFamily = QueueIndex( mLaneTypes[state.ownerLane]);
+                        release.dstQueueFamily = queueFamily;
+                        if (recordBarriers)
+                        {
+                            ownerBatch.endBarriers.push_back( release);
+                        }
+
+                        crossLane = true;
+                        barrier.srcQueueFamily = release.srcQueueFamily;
+                        barrier.dstQueueFamily = release.dstQueueFamily;
+                    }
+
+                    bool needed = ownershipTransfer || layoutChange || (!covered && barrier.srcStage != vk::PipelineStageFlags2{});
+                    if (crossLane)
+                    {
+                        // chain to the semaphore wait at the start of the batch
+                        barrier.srcStage |= vk::PipelineStageFlagBits2::eAllCommands;
+                    }
+                    if (needed && recordBarriers)
+                    {
+                        batch.passBarriers[i].push_back( barrier);
+                    }
+
+                    // update resource state
+                    if (access.write || layoutChange)
+                    {
+                        // a layout transition acts as a write on this lane
+                        // a read transition leaves no write access behind, its barrier makes the transition available
+                        state.writeStage = access.usage.stage;
+                        state.writeAccess = access.write ? access.usage.access : vk::AccessFlags2{};
+                        state.writeLane = lane;
+                        state.writeLaneBatch = (int32_t)batch.laneBatch;
+                        state.readers.clear();
+                    }
+                    if (!access.write)
+                    {
+                        state.readers.push_back( Reader{batch.lane, (int32_t)batch.laneBatch, access.usage.stage, access.usage.access});
+                    }
+                    state.layout = barrier.newLayout;
+                    state.ownerLane = lane;
+                    state.lastBatch = (int32_t)b;
+                    state.touched = true;
+                }
+            }
+        }
+
+        if (!recordBarriers)
+        {
+            return;
+        }
+
+        // transition imported resources to their final usage
+        for (uint32_t r = 0; r < mResources.size(); r++)
+        {
+            auto &resource = mResources[r];
+            auto &state = states[r];
+            if (!resource.imported || !state.touched)
+            {
+                continue;
+            }
+
+            resource.endUsage = ResourceUsage{ state.writeStage, state.writeAccess, state.layout};
+            for (auto &reader : state.readers)
+            {
+                resource.endUsage.stage |= reader.stage;
+                resource.endUsage.access |= reader.access;
+            }
+            if (IsEmptyUsage( resource.finalUsage))
+            {
+                continue;
+            }
+            Barrier barrier{};
+            barrier.resource = r;
+            barrier.srcStage = state.writeStage;
+            for (auto &reader : state.readers)
+            {
+                barrier.srcStage |= reader.stage;
+            }
+            barrier.srcAccess = state.writeAccess;
+            barrier.dstStage = resource.finalUsage.stage;
+            barrier.dstAccess = resource.finalUsage.access;
+            barrier.oldLayout = state.layout;
+            barrier.newLayout = resource.finalUsage.layout != vk::ImageLayout::eUndefined ? resource.finalUsage.layout : state.layout;
+            resource.endUsage = ResourceUsage{ resource.finalUsage.stage, resource.finalUsage.access, barrier.newLayout};
+
+            mBatches[state.lastBatch].endBarriers.push_back( barrier);
+        }
+    }
+
+
+    void RenderGraph::WaitForCompletion() {
+
+        if (mLaneSemaphores.empty())
+        {
+            return;
+        }
+
+        auto waitInfo = vk::SemaphoreWaitInfo{}
+            .setSemaphoreCount( (uint32_t)mLaneSemaphores.size() )
+            .setPSemaphores( mLaneSemaphores.data() )
+            .setPValues( mLaneValues.data() );
+        VK_CHECK( Device().waitSemaphores( &waitInfo, UINT64_MAX) );
+    }
+
+
+    void RenderGraph::ReleaseCompiledData() {
+
+        for (auto &resource : mResources)
+        {
+            if (resource.imported)
+            {
+                continue;
+            }
+
+            DestroyImageView( resource.image.imageView);
+            if (resource.image.image)
+            {
+                Device().destroyImage( resource.image.image);
+            }
+            resource.image.imageView = nullptr;
+            resource.image.image = nullptr;
+        }
+        for (auto allocation : mTransientMemory)
+        {
+            Allocator().freeMemory( allocation);
+        }
+        mTransientMemory.clear();
+        mTransientMemorySize = 0;
+
+        for (auto &pools : mCommandPools)
+        {
+            for (auto pool : pools)
+            {
+                DestroyCommandPool( pool);
+            }
+        }
+        mCommandPools.clear();
+        mCommandBuffers.clear();
+
+        mCulled.clear();
+        mOrder.clear();
+        mBatches.clear();
+        mLaneBatchCounts.clear();
+        mCompiled = false;
+    }
+
+
+    RenderGraph::ResourceState RenderGraph::InitialState( const Resource &resource) const {
+
+        ResourceState state;
+        if (resource.imported)
+        {
+            state.writeStage = resource.initialUsage.stage;
+            state.writeAccess = resource.initialUsage.access;
+            state.layout = resource.initialUsage.layout;
+        }
+
+        return state;
+    }
+
+
+    const Image& RenderGraph::ResourceImage( const Resource &resource) const {
+
+        return resource.pImage != nullptr ? *resource.pImage : resource.image;
+    }
+
+
+    const Buffer& RenderGraph::ResourceBuffer( const Resource &resource) const {
+
+        return resource.pBuffer != nullptr ? *resource.pBuffer : resource.buffer;
+    }
+
+
+    bool RenderGraph::IsExclusive( const Resource &resource) const {
+
+        if (resource.type == Resource::Type::eBuffer)
+        {
+            return ResourceBuffer( resource).bufferInfo.sharingMode == vk::SharingMode::eExclusive;
+        }
+
+        return ResourceImage( resource).imageInfo.sharingMode == vk::SharingMode::eExclusive;
+    }
+
+
+    void RenderGraph::AddWait( Batch &batch, uint32_t lane, int32_t laneBatch) {
+
+        if (lane == batch.lane)
+        {
+            return;
+        }
+
+        for (auto &wait : batch.waits)
+        {
+            if (wait.lane == lane)
+            {
+                wait.laneBatch = std::max( wait.laneBatch, laneBatch);
+                return;
+            }
+        }
+        batch.waits.push_back( Wait{lane, laneBatch});
+    }
+
+
+    void RenderGraph::RecordBarriers( vk::CommandBuffer cmd, std::span<const Barrier> barriers) const {
+
+        BarrierBatch batch;
+        for (auto &barrier : barriers)
+        {
+            auto &resource = mResources[barrier.resource];
+            if (resource.type == Resource::Type::eImage)
+            {
+                auto &image = ResourceImage( resource);
+                batch.Add( CreateImageMemoryBarrier(
+                        image.image, barrier.oldLayout, barrier.newLayout,
+                        barrier.srcStage, barrier.srcAccess, barrier.dstStage, barrier.dstAccess,
+                        vk::ImageSubresourceRange{image.imageAspect, 0, image.MipLevels(), 0, image.Layers()}
+                    )
+                    .setSrcQueueFamilyIndex( barrier.srcQueueFamily )
+                    .setDstQueueFamilyIndex( barrier.dstQueueFamily )
+                );
+            }
+            else
+            {
+                auto &buffer = ResourceBuffer( resource);
+                batch.Add( CreateBufferMemoryBarrier(
+                        buffer.buffer,
+                        barrier.srcStage, barrier.srcAccess, barrier.dstStage, barrier.dstAccess
+                    )
+                    .setSrcQueueFamilyIndex( barrier.srcQueueFamily )
+                    .setDstQueueFamilyIndex( barrier.dstQueueFamily )
+                );
+            }
+        }
+
+        batch.Flush( cmd);
+    }
+
+
+} // namespace vktg
@@ -0,0 +1,272 @@
+#pragma once
+
+
+#include "vk_core.h"
+#include "storage.h"
+
+#include <deque>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Single pass of a render graph. Declares the resources it reads and writes and the commands it records.
+    struct RenderGraphPass {
+
+        std::string name;
+        QueueType queueType;
+        std::vector<std::pair<uint32_t, ResourceUsage>> reads;
+        std::vector<std::pair<uint32_t, ResourceUsage>> writes;
+        std::function<void(vk::CommandBuffer)> execute;
+
+        /// @brief Declare that the pass reads a resource.
+        /// @param resource Render graph resource handle.
+        /// @param usage Pipeline stage, memory access and image layout the resource is read with.
+        /// @return Reference to RenderGraphPass for chaining.
+        RenderGraphPass& Read( uint32_t resource, const ResourceUsage &usage);
+        /// @brief Declare that the pass writes a resource.
+        /// @param resource Render graph resource handle.
+        /// @param usage Pipeline stage, memory access and image layout the resource is written with.
+        /// @return Reference to RenderGraphPass for chaining.
+        RenderGraphPass& Write( uint32_t resource, const ResourceUsage &usage);
+        /// @brief Set the function recording the pass commands.
+        /// @param func Function recording commands into the given command buffer.
+        /// @return Reference to RenderGraphPass for chaining.
+        RenderGraphPass& SetExecute( std::function<void(vk::CommandBuffer)> func);
+    };
+
+
+    /// @brief Frame graph of passes with automatic barrier placement, pass culling, transient image aliasing and multi queue scheduling.
+    ///        Build the graph once, call Compile() and then Execute() every frame. Reset and rebuild the graph if resources change size.
+    class RenderGraph {
+
+        public:
+
+            /// @brief Initialize render graph with command buffers for a given number of overlapping frames.
+            /// @param frameOverlap Number of frames that can be in flight at the same time.
+            RenderGraph( uint8_t frameOverlap = 2);
+
+            /// @brief Import an image that lives outside the graph. Imported images are never culled.
+            /// @param image Image object, must outlive the graph.
+            /// @param initialUsage Usage of the image at the start of each frame. Taken from the tracked image state if empty.
+            /// @param finalUsage Usage the image is transitioned to at the end of each frame. Left untouched if empty.
+            /// @return Resource handle.
+            uint32_t ImportImage( Image &image, const ResourceUsage &initialUsage = {}, const ResourceUsage &finalUsage = {});
+            /// @brief Import a raw Vulkan image, e.g. a swapchain image. Imported images are never culled.
+            /// @param image Vulkan image.
+            /// @param imageView Vulkan image view.
+            /// @param format Image format.
+            /// @param extent Image extent.
+            /// @param initialUsage Usage of the image at the start of each frame.
+            /// @param finalUsage Usage the image is transitioned to at the end of each frame. Left untouched if empty.
+            /// @return Resource handle.
+            uint32_t ImportImage(
+                vk::Image image, vk::ImageView imageView, vk::Format format, vk::Extent2D extent,
+                const ResourceUsage &initialUsage = {}, const ResourceUsage &finalUsage = {}
+            );
+            /// @brief Replace the Vulkan image of an imported raw image, e.g. with the next swapchain image.
+            /// @param resource Resource handle of imported image.
+            /// @param image Vulkan image.
+            /// @param imageView Vulkan image view.
+            void UpdateImportedImage( uint32_t resource, vk::Image image, vk::ImageView imageView);
+            /// @brief Import a buffer that lives outside the graph. Imported buffers are never culled.
+            /// @param buffer Buffer object, must outlive the graph.
+            /// @param initialUsage Usage of the buffer at the start of each frame. Taken from the tracked buffer state if empty.
+            /// @param finalUsage Usage the buffer is synchronized with at the end of each frame. Left untouched if empty.
+            /// @return Resource handle.
+            uint32_t ImportBuffer( Buffer &buffer, const ResourceUsage &initialUsage = {}, const ResourceUsage &finalUsage = {});
+            /// @brief Declare a transient image owned by the graph. Its contents are undefined at the start of each frame
+            ///        and its memory may be shared with other transient images whose lifetimes do not overlap.
+            /// @param name Image name.
+            /// @param width Image width.
+            /// @param height Image height.
+            /// @param format Image format.
+            /// @param usage Image usage.
+            /// @param imageAspect Image aspect.
+            /// @param mipLevels Image mip levels.
+            /// @param layers Image array layers.
+            /// @param numSamples Number of image samples.
+            /// @return Resource handle.
+            uint32_t CreateImage(
+                std::string_view name,
+                uint32_t width, uint32_t height,
+                vk::Format format, vk::ImageUsageFlags usage,
+                vk::ImageAspectFlags imageAspect = vk::ImageAspectFlagBits::eColor,
+                uint32_t mipLevels = 1, uint32_t layers = 1, vk::SampleCountFlagBits numSamples = vk::SampleCountFlagBits::e1
+            );
+
+            /// @brief Add a new pass to the graph. Passes execute in the order they are added.
+            /// @param name Pass name.
+            /// @param queueType Queue the pass is submitted to.
+            /// @return Reference to the new pass for declaring resources and setting the execute function.
+            RenderGraphPass& AddPass( std::string_view name, QueueType queueType = QueueType::eGraphics);
+
+            /// @brief Culls unused passes, allocates transient images and computes barriers and queue submissions.
+            void Compile();
+            /// @brief Records and submits all passes of the compiled graph.
+            /// @param waitSemaphores Semaphores the first submission waits on.
+            /// @param signalSemaphores Semaphores signaled once all passes have been executed.
+            /// @param fence Fence signaled once all passes have been executed.
+            void Execute(
+                std::span<vk::SemaphoreSubmitInfo> waitSemaphores = {},
+                std::span<vk::SemaphoreSubmitInfo> signalSemaphores = {},
+                vk::Fence fence = VK_NULL_HANDLE
+            );
+            /// @brief Waits for submitted work, then removes all passes and resources and frees transient images.
+            void Reset();
+            /// @brief Resets the graph and destroys command pools and semaphores.
+            void Destroy();
+
+            /// @brief Access image of a resource, e.g. inside a pass execute function. Transient images are valid after Compile().
+            /// @param resource Resource handle.
+            /// @return Image object.
+            const Image& GetImage( uint32_t resource) const;
+            /// @brief Access buffer of a resource.
+            /// @param resource Resource handle.
+            /// @return Buffer object.
+            const Buffer& GetBuffer( uint32_t resource) const;
+            /// @brief Check if a pass was culled during Compile().
+            /// @param name Pass name.
+            /// @return True if the pass does not contribute to any imported resource.
+            bool IsPassCulled( std::string_view name) const;
+            /// @brief Size of the device memory shared by all transient images.
+            /// @return Memory size in bytes.
+            vk::DeviceSize TransientMemorySize() const;
+
+        private:
+
+            struct Resource {
+
+                enum class Type : uint8_t {
+                    eImage = 0,
+                    eBuffer
+                };
+
+                Type type;
+                bool imported;
+                std::string name;
+                Image image;
+                Image *pImage = nullptr;
+                Buffer buffer;
+                Buffer *pBuffer = nullptr;
+                ResourceUsage initialUsage;
+                ResourceUsage finalUsage;
+                ResourceUsage endUsage;
+
+                // compile data
+                uint32_t refCount = 0;
+                int firstPass = -1;
+                int lastPass = -1;
+                vk::DeviceSize memoryOffset = 0;
+                vk::MemoryRequirements memoryRequirements;
+                std::vector<uint32_t> aliases;
+            };
+
+            struct Access {
+                uint32_t resource;
+                ResourceUsage usage;
+                bool write;
+            };
+
+            struct Barrier {
+                uint32_t resource;
+                vk::PipelineStageFlags2 srcStage;
+                vk::AccessFlags2 srcAccess;
+                vk::PipelineStageFlags2 dstStage;
+                vk::AccessFlags2 dstAccess;
+                vk::ImageLayout oldLayout;
+                vk::ImageLayout newLayout;
+                uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+                uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+            };
+
+            struct Wait {
+                uint32_t lane;
+                int32_t laneBatch;  // -1 waits for the last batch of the lane in the previous frame
+            };
+
+            struct Reader {
+                uint32_t lane;
+                int32_t laneBatch;
+                vk::PipelineStageFlags2 stage;
+                vk::AccessFlags2 access;
+            };
+
+            struct Batch {
+                uint32_t lane;
+                uint32_t laneBatch;
+                std::vector<uint32_t> passes;
+                std::vector<std::vector<Barrier>> passBarriers;
+                std::vector<Barrier> endBarriers;
+                std::vector<Wait> waits;
+            };
+
+            struct ResourceState {
+                vk::PipelineStageFlags2 writeStage;
+                vk::AccessFlags2 writeAccess;
+                vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+                int32_t writeLane = -1;
+                int32_t writeLaneBatch = -1;
+                std::vector<Reader> readers;
+                int32_t ownerLane = -1;
+                int32_t lastBatch = -1;
+                bool touched = false;
+            };
+
+            /// @brief Merges the reads and writes of a pass into one access per resource.
+            std::vector<Access> PassAccesses( const RenderGraphPass &pass) const;
+            /// @brief Removes passes that do not contribute to imported resources.
+            void CullPasses();
+            /// @brief Creates transient images and places them in shared memory.
+            void AllocateTransientImages();
+            /// @brief Computes batches, barriers and semaphore waits.
+            void ScheduleBatches();
+            /// @brief Simulates resource states of one frame, recording barriers if requested.
+            void SimulateFrame( std::vector<ResourceState> &states, bool recordBarriers);
+            /// @brief Waits for all submitted batches to complete.
+            void WaitForCompletion();
+            /// @brief Destroys transient images and memory, command pools and compile data.
+            void ReleaseCompiledData();
+            /// @brief State of a resource at the start of a frame.
+            ResourceState InitialState( const Resource &resource) const;
+
+            const Image& ResourceImage( const Resource &resource) const;
+            const Buffer& ResourceBuffer( const Resource &resource) const;
+            bool IsExclusive( const Resource &resource) const;
+            void AddWait( Batch &batch, uint32_t lane, int32_t laneBatch);
+            void RecordBarriers( vk::CommandBuffer cmd, std::span<const Barrier> barriers) const;
+
+
+            const uint8_t mFrameOverlap;
+            uint64_t mExecuteCount;
+
+            std::vector<Resource> mResources;
+            std::deque<RenderGraphPass> mPasses;
+
+            // queue lanes
+            std::vector<QueueType> mLaneTypes;
+            uint32_t mLaneOf[3];
+            std::vector<vk::Semaphore> mLaneSemaphores;
+            std::vector<uint64_t> mLaneValues;
+            std::vector<std::vector<uint64_t>> mFrameLaneValues;
+
+            // compile data
+            bool mCompiled;
+            std::vector<bool> mCulled;
+            std::vector<std::vector<Access>> mPassAccesses;
+            std::vector<uint32_t> mOrder;
+            std::vector<Batch> mBatches;
+            std::vector<uint32_t> mLaneBatchCounts;
+            std::vector<vma::Allocation> mTransientMemory;
+            vk::DeviceSize mTransientMemorySize;
+            std::vector<std::vector<vk::CommandPool>> mCommandPools;
+            std::vector<std::vector<vk::CommandBuffer>> mCommandBuffers;
+    };
+
+
+} // namespace vktg
@@ -79,4 +79,10 @@ namespace vktg
     }
 
 
+    void TransitionImageLayout( BarrierBatch &batch, vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, vk::PipelineStageFlags2 srcStage, vk::AccessFlags2 srcAccessMask, vk::PipelineStageFlags2 dststage, vk::AccessFlags2 dstAccessMask, const vk::ImageSubresourceRange &subResource) {
+
+        batch.Add( CreateImageMemoryBarrier( image, oldLayout, newLayout, srcStage, srcAccessMask, dststage, dstAccessMask, subResource));
+    }
+
+
 } // namespace vktg
@@ -2,6 +2,7 @@
 
 
 #include "vk_core.h"
+#include "synchronization.h"
 
 #include <span>
 
@@ -76,6 +77,23 @@ namespace vktg
         vk::PipelineStageFlags2 dststage, vk::AccessFlags2 dstAccessMask,
         const vk::ImageSubresourceRange &subResource = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1} 
     );
+    /// @brief Adds an image layout transition to a barrier batch, to be recorded together with other barriers on the next flush.
+    /// @param batch Barrier batch to add the image barrier to.
+    /// @param image Image to change layout.
+    /// @param oldLayout Old image layout.
+    /// @param newLayout New image layout.
+    /// @param srcStage Source pipeline stage for pipeline barrier.
+    /// @param srcAccessMask Source memory access for pipeline barrier.
+    /// @param dststage Destination pipeline stage for pipeline barrier.
+    /// @param dstAccessMask Destination memory access for pipeline barrier,
+    /// @param subResource Image subresource.
+    void TransitionImageLayout( 
+        BarrierBatch &batch, vk::Image image, 
+        vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+        vk::PipelineStageFlags2 srcStage, vk::AccessFlags2 srcAccessMask, 
+        vk::PipelineStageFlags2 dststage, vk::AccessFlags2 dstAccessMask,
+        const vk::ImageSubresourceRange &subResource = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1} 
+    );
 
     
 } // namespace vktg
@@ -1,5 +1,6 @@
 
 #include "storage.h"
+#include "util/cpu_profiler.h"
 
 
 namespace vktg
@@ -11,6 +12,8 @@ namespace vktg
         vma::MemoryUsage memoryUsage, vma::AllocationCreateFlags flags, 
         vk::SharingMode sharingMode, std::span<uint32_t>  queueFamilies)
     {
+        VKTG_PROFILE_FUNCTION();
+
         buffer.bufferInfo = vk::BufferCreateInfo{}
             .setSize( bufferSize )
             .setUsage( bufferUsage )
@@ -23,6 +26,7 @@ namespace vktg
             .setFlags( flags );
 
         VK_CHECK( Allocator().createBuffer( &buffer.bufferInfo, &buffer.allocationCreateInfo, &buffer.buffer, &buffer.allocation, &buffer.allocationInfo) );
+        buffer.state = TrackedState{};
     }
 
 
@@ -31,6 +35,7 @@ namespace vktg
         DestroyBuffer( buffer);
         buffer.bufferInfo.setSize( newSize );
         VK_CHECK( Allocator().createBuffer( &buffer.bufferInfo, &buffer.allocationCreateInfo, &buffer.buffer, &buffer.allocation, &buffer.allocationInfo) );
+        buffer.state = TrackedState{};
     }
 
 
@@ -73,6 +78,8 @@ namespace vktg
         vk::ImageTiling tiling, 
         vk::SharingMode sharingMode, std::span<uint32_t>  queueFamilies)
     {
+        VKTG_PROFILE_FUNCTION();
+
         image.imageAspect = imageAspect;
         image.imageInfo = vk::ImageCreateInfo{}
             .setImageType( vk::ImageType::e2D )
@@ -97,18 +104,29 @@ namespace vktg
             image.image, image.imageInfo.format, image.imageAspect, 
             0, image.imageInfo.mipLevels, 0, image.imageInfo.arrayLayers
         );
+        image.subresourceStates.assign( mipLevels * layers, TrackedState{});
     }
 
     
-    void ResizeImage( Image &image, uint32_t newWidth, uint32_t newHeight) {
+    void ResizeImage( Image &image, uint32_t newWidth, uint32_t newHeight, DeferredDeletionQueue *pRetired, uint64_t frame) {
 
-        DestroyImage( image);
+        if (pRetired)
+        {
+            pRetired->Push( frame, [oldImage = image](){
+                DestroyImage( oldImage);
+            });
+        }
+        else
+        {
+            DestroyImage( image);
+        }
         image.imageInfo.setExtent( vk::Extent3D{newWidth, newHeight, 1} );
         VK_CHECK( Allocator().createImage( &image.imageInfo, &image.allocationCreateInfo, &image.image, &image.allocation, &image.allocationInfo) );
         image.imageView = CreateImageView( 
             image.image, image.Format(), image.imageAspect, 
             0, image.MipLevels(), 0, image.Layers()
         );
+        image.subresourceStates.assign( image.MipLevels() * image.Layers(), TrackedState{});
     }
 
 
@@ -154,4 +172,164 @@ namespace vktg
     }
 
 
+    static bool IsWriteAccess( vk::AccessFlags2 access) {
+
+        const vk::AccessFlags2 writeAccess = 
+            vk::AccessFlagBits2::eShaderWrite | vk::AccessFlagBits2::eShaderStorageWrite | 
+            vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eDepthStencilAttachmentWrite | 
+            vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eHostWrite | vk::AccessFlagBits2::eMemoryWrite;
+
+        return (bool)(access & writeAccess);
+    }
+
+
+    // Advances a tracked state to a new usage. Returns true if a barrier is required, with its source scope and old layout.
+    static bool AdvanceState( 
+        TrackedState &state, const ResourceUsage &usage, bool trackLayout, 
+        vk::PipelineStageFlags2 &srcStage, vk::AccessFlags2 &srcAccess, vk::ImageLayout &oldLayout) 
+    {
+        bool layoutChange = trackLayout && usage.layout != state.layout;
+        bool write = IsWriteAccess( usage.access);
+        bool needed = false;
+
+        oldLayout = state.layout;
+        if (write || layoutChange)
+        {
+            // write after write or read, layout transitions count as writes
+            srcStage = state.writeStage | state.readStages;
+            srcAccess = state.writeAccess;
+            needed = layoutChange || srcStage != vk::PipelineStageFlags2{};
+
+            // the transition of a read is made available by its own barrier, so no write access is left to wait on
+            state.writeStage = usage.stage;
+            state.writeAccess = write ? usage.access : vk::AccessFlags2{};
+            state.readStages = write ? vk::PipelineStageFlags2{} : usage.stage;
+            state.readAccess = write ? vk::AccessFlags2{} : usage.access;
+        }
+        else
+        {
+            // read after write, skipped if an earlier read already made the write visible to this stage and access
+            bool covered = (state.readStages & usage.stage) == usage.stage && (state.readAccess & usage.access) == usage.access;
+            srcStage = state.writeStage;
+            srcAccess = state.writeAccess;
+            needed = !covered && srcStage != vk::PipelineStageFlags2{};
+
+            state.readStages |= usage.stage;
+            state.readAccess |= usage.access;
+        }
+        if (trackLayout)
+        {
+            state.layout = usage.layout;
+        }
+
+        return needed;
+    }
+
+
+    static TrackedState UsageState( const ResourceUsage &usage) {
+
+        TrackedState state;
+        state.layout = usage.layout;
+        state.writeStage = usage.stage;
+        if (IsWriteAccess( usage.access))
+        {
+            state.writeAccess = usage.access;
+        }
+        else
+        {
+            state.readStages = usage.stage;
+            state.readAccess = usage.access;
+        }
+
+        return state;
+    }
+
+
+    void Transition( vk::CommandBuffer cmd, Image &image, const ResourceUsage &usage, const vk::ImageSubresourceRange &subResource) {
+
+        BarrierBatch batch;
+        Transition( batch, image, usage, subResource);
+        batch.Flush( cmd);
+    }
+
+
+    void Transition( BarrierBatch &batch, Image &image, const ResourceUsage &usage, const vk::ImageSubresourceRange &subResource) {
+
+        if (image.subresourceStates.empty())
+        {
+            image.subresourceStates.resize( image.MipLevels() * image.Layers());
+        }
+
+        uint32_t levelCount = subResource.levelCount == VK_REMAINING_MIP_LEVELS ? image.MipLevels() - subResource.baseMipLevel : subResource.levelCount;
+        uint32_t layerCount = subResource.layerCount == VK_REMAINING_ARRAY_LAYERS ? image.Layers() - subResource.baseArrayLayer : subResource.layerCount;
+        auto aspect = subResource.aspectMask ? subResource.aspectMask : image.imageAspect;
+
+        // one barrier per subresource, merged by the batch where states match
+        for (uint32_t layer = subResource.baseArrayLayer; layer < subResource.baseArrayLayer + layerCount; layer++)
+        {
+            for (uint32_t mip = subResource.baseMipLevel; mip < subResource.baseMipLevel + levelCount; mip++)
+            {
+                vk::PipelineStageFlags2 srcStage;
+                vk::AccessFlags2 srcAccess;
+                vk::ImageLayout oldLayout;
+                auto &state = image.subresourceStates[layer * image.MipLevels() + mip];
+                if (AdvanceState( state, usage, true, srcStage, srcAccess, oldLayout))
+                {
+                    batch.Add( CreateImageMemoryBarrier(
+                        image.image, oldLayout, usage.layout,
+                        srcStage, srcAccess, usage.stage, usage.access,
+                        vk::ImageSubresourceRange{ aspect, mip, 1, layer, 1}
+                    ));
+                }
+            }
+        }
+    }
+
+
+    void Transition( vk::CommandBuffer cmd, Buffer &buffer, const ResourceUsage &usage) {
+
+        BarrierBatch batch;
+        Transition( batch, buffer, usage);
+        batch.Flush( cmd);
+    }
+
+
+    void Transition( BarrierBatch &batch, Buffer &buffer, const ResourceUsage &usage) {
+
+        vk::PipelineStageFlags2 srcStage;
+        vk::AccessFlags2 srcAccess;
+        vk::ImageLayout oldLayout;
+        if (AdvanceState( buffer.state, usage, false, srcStage, srcAccess, oldLayout))
+        {
+            batch.Add( CreateBufferMemoryBarrier( buffer.buffer, srcStage, srcAccess, usage.stage, usage.access));
+        }
+    }
+
+
+    void SetTrackedState( Image &image, const ResourceUsage &usage, const vk::ImageSubresourceRange &subResource) {
+
+        if (image.subresourceStates.empty())
+        {
+            image.subresourceStates.resize( image.MipLevels() * image.Layers());
+        }
+
+        uint32_t levelCount = subResource.levelCount == VK_REMAINING_MIP_LEVELS ? image.MipLevels() - subResource.baseMipLevel : subResource.levelCount;
+        uint32_t layerCount = subResource.layerCount == VK_REMAINING_ARRAY_LAYERS ? image.Layers() - subResource.baseArrayLayer : subResource.layerCount;
+        for (uint32_t layer = subResource.baseArrayLayer; layer < subResource.baseArrayLayer + layerCount; layer++)
+        {
+            for (uint32_t mip = subResource.baseMipLevel; mip < subResource.baseMipLevel + levelCount; mip++)
+            {
+                image.subresourceStates[layer * image.MipLevels() + mip] = UsageState( usage);
+            }
+        }
+    }
+
+
+    void SetTrackedState( Buffer &buffer, const ResourceUsage &usage) {
+
+        buffer.state = UsageState( usage);
+        buffer.state.layout = vk::ImageLayout::eUndefined;
+    }
+
+
 } // namespace vktg
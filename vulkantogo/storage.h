@@ -2,14 +2,37 @@
 
 
 #include "vk_core.h"
+#include "synchronization.h"
+#include "util/deletion_stack.h"
 
 #include <span>
+#include <vector>
 
 
 namespace vktg
 {
 
 
+    /// @brief Pipeline stage, memory access and image layout a resource is used with.
+    struct ResourceUsage {
+
+        vk::PipelineStageFlags2 stage = vk::PipelineStageFlagBits2::eNone;
+        vk::AccessFlags2 access = vk::AccessFlagBits2::eNone;
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+    };
+
+
+    /// @brief Synchronization state of a buffer or image subresource, i.e. its layout, last write and reads since then.
+    struct TrackedState {
+
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+        vk::PipelineStageFlags2 writeStage;
+        vk::AccessFlags2 writeAccess;
+        vk::PipelineStageFlags2 readStages;
+        vk::AccessFlags2 readAccess;
+    };
+
+
     /// @brief Holds Vulkan buffer and all the information used to (re-)create it.
     struct Buffer {
 
@@ -20,6 +43,8 @@ namespace vktg
         vma::AllocationCreateInfo allocationCreateInfo;
         vma::AllocationInfo allocationInfo;
 
+        TrackedState state;
+
         /// @brief Buffer size in bytes.
         /// @return Buffer size in bytes. 
         size_t Size() const { return bufferInfo.size; }
@@ -78,6 +103,8 @@ namespace vktg
         vma::AllocationCreateInfo allocationCreateInfo;;
         vma::AllocationInfo allocationInfo;
 
+        std::vector<TrackedState> subresourceStates;
+
         /// @brief Image width.
         /// @return Image width.
         uint32_t Width() const { return imageInfo.extent.width; }
@@ -102,6 +129,13 @@ namespace vktg
         /// @brief Pointer to image data if created with mapped memory.
         /// @return Pointer to mapped image memory.
         void* Data() const { return allocationInfo.pMappedData; }
+        /// @brief Tracked layout of an image subresource.
+        /// @param mipLevel Mip level of the subresource.
+        /// @param layer Array layer of the subresource.
+        /// @return Current image layout, undefined if the image is not tracked.
+        vk::ImageLayout Layout( uint32_t mipLevel = 0, uint32_t layer = 0) const { 
+            return subresourceStates.empty() ? vk::ImageLayout::eUndefined : subresourceStates[layer * MipLevels() + mipLevel].layout; 
+        }
     };
 
     /// @brief Creates Vulkan image and stores it in given Image object along all the data used to create it.
@@ -134,7 +168,10 @@ namespace vktg
     /// @param image Image object to resize.
     /// @param newWidth New image size.
     /// @param newHeight New image height.
-    void ResizeImage( Image &image, uint32_t newWidth, uint32_t newHeight);
+    /// @param pRetired Optional deferred deletion queue to retire the old image in, instead of destroying it immediately, 
+    ///        so frames in flight can still use it.
+    /// @param frame Last frame using the old image, if retired.
+    void ResizeImage( Image &image, uint32_t newWidth, uint32_t newHeight, DeferredDeletionQueue *pRetired = nullptr, uint64_t frame = 0);
     
     /// @brief Destroys given image object
     /// @param image Image object to destroy.
@@ -164,6 +201,50 @@ namespace vktg
     /// @brief Destroys given Vulkan image view.
     /// @param imageView Image view to destroy.
     void DestroyImageView( vk::ImageView imageView);
+
+
+    /// @brief Transitions image subresources to a new usage and records the required barrier. Source stages, access and old layout
+    ///        are taken from the tracked subresource states and no barrier is recorded if the subresources are already in a compatible state.
+    /// @param cmd Command buffer to record pipeline barrier.
+    /// @param image Image to transition.
+    /// @param usage New pipeline stage, memory access and layout of the image.
+    /// @param subResource Image subresource to transition, an empty aspect mask uses the image aspect.
+    void Transition( 
+        vk::CommandBuffer cmd, Image &image, const ResourceUsage &usage,
+        const vk::ImageSubresourceRange &subResource = vk::ImageSubresourceRange{{}, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+    );
+    /// @brief Transitions image subresources to a new usage and adds the required barriers to a barrier batch.
+    /// @param batch Barrier batch to add barriers to.
+    /// @param image Image to transition.
+    /// @param usage New pipeline stage, memory access and layout of the image.
+    /// @param subResource Image subresource to transition, an empty aspect mask uses the image aspect.
+    void Transition( 
+        BarrierBatch &batch, Image &image, const ResourceUsage &usage,
+        const vk::ImageSubresourceRange &subResource = vk::ImageSubresourceRange{{}, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+    );
+    /// @brief Synchronizes a buffer with a new usage and records the required barrier, skipping it if the buffer is already in a compatible state.
+    /// @param cmd Command buffer to record pipeline barrier.
+    /// @param buffer Buffer to synchronize.
+    /// @param usage New pipeline stage and memory access of the buffer.
+    void Transition( vk::CommandBuffer cmd, Buffer &buffer, const ResourceUsage &usage);
+    /// @brief Synchronizes a buffer with a new usage and adds the required barrier to a barrier batch.
+    /// @param batch Barrier batch to add barrier to.
+    /// @param buffer Buffer to synchronize.
+    /// @param usage New pipeline stage and memory access of the buffer.
+    void Transition( BarrierBatch &batch, Buffer &buffer, const ResourceUsage &usage);
+
+    /// @brief Overwrites the tracked state of image subresources, e.g. after synchronizing the image without Transition(...).
+    /// @param image Image to update.
+    /// @param usage Pipeline stage, memory access and layout the image was last used with.
+    /// @param subResource Image subresource to update.
+    void SetTrackedState( 
+        Image &image, const ResourceUsage &usage,
+        const vk::ImageSubresourceRange &subResource = vk::ImageSubresourceRange{{}, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+    );
+    /// @brief Overwrites the tracked state of a buffer, e.g. after synchronizing the buffer without Transition(...).
+    /// @param buffer Buffer to update.
+    /// @param usage Pipeline stage and memory access the buffer was last used with.
+    void SetTrackedState( Buffer &buffer, const ResourceUsage &usage);
     
 
 } // namespace vktg
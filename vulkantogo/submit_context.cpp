@@ -2,6 +2,7 @@
 #include "submit_context.h"
 #include "commands.h"
 #include "synchronization.h"
+#include "util/cpu_profiler.h"
 
 
 namespace vktg
@@ -46,6 +47,8 @@ namespace vktg
     
     void SubmitContext::Submit() {
 
+        VKTG_PROFILE_ZONE( "SubmitContext::Submit");
+
         auto submitInfo = vk::SubmitInfo{}
             .setCommandBufferCount( 1 )
             .setPCommandBuffers( &cmd );
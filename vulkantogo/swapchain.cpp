@@ -1,21 +1,283 @@
 
 #include "swapchain.h"
+#include "commands.h"
+#include "formats.h"
+#include "readback.h"
 #include "storage.h"
+#include "synchronization.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <thread>
 
 
 namespace vktg
 {
 
 
-    Swapchain PrepareSwapchain() {
+    struct VirtualSwapchainData {
+        VirtualSwapchainSettings settings;
+        std::vector<Image> images;
+        // signaled once the present of an image completed on the GPU
+        std::vector<vk::Fence> fences;
+        vk::CommandPool commandPool;
+        std::vector<vk::CommandBuffer> commandBuffers;
+        std::unique_ptr<ReadbackQueue> pReadback;
+        // simulated pacing, an image is released once the next image has been shown for one period
+        std::vector<std::chrono::steady_clock::time_point> releaseTimes;
+        std::chrono::steady_clock::time_point lastDisplayTime;
+        uint32_t nextImage;
+        uint64_t presentCount;
+    };
+
+
+    // writes 8 bit RGBA and BGRA images as binary PPM, any other format as raw texel data
+    static void WritePresentedImage( const std::string &path, uint64_t presentIndex, vk::Format format, vk::Extent2D extent, std::span<const uint8_t> data) {
+
+        bool isRgba = format == vk::Format::eR8G8B8A8Unorm || format == vk::Format::eR8G8B8A8Srgb;
+        bool isBgra = format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+        std::string fileName = path + std::to_string( presentIndex) + (isRgba || isBgra ? ".ppm" : ".raw");
+        std::ofstream file( fileName, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error( "Failed to open file " + fileName + " for writing!");
+        }
+
+        if (!isRgba && !isBgra)
+        {
+            file.write( reinterpret_cast<const char*>( data.data()), data.size());
+            return;
+        }
+
+        file << "P6\n" << extent.width << ' ' << extent.height << "\n255\n";
+        std::vector<uint8_t> rgb( 3 * (size_t)extent.width * extent.height);
+        for (size_t i = 0; i < rgb.size() / 3; i++)
+        {
+            rgb[3*i + 0] = data[4*i + (isBgra ? 2 : 0)];
+            rgb[3*i + 1] = data[4*i + 1];
+            rgb[3*i + 2] = data[4*i + (isBgra ? 0 : 2)];
+        }
+        file.write( reinterpret_cast<const char*>( rgb.data()), rgb.size());
+    }
+
+
+    static void DestroyVirtualImages( Swapchain &swapchain) {
+
+        auto &data = *swapchain.virtualData;
+        WaitForFences( data.fences);
+        if (data.pReadback)
+        {
+            data.pReadback->Wait();
+        }
+        for (auto &image : data.images)
+        {
+            DestroyImage( image);
+        }
+        data.images.clear();
+        swapchain.images.clear();
+        swapchain.imageViews.clear();
+    }
+
+
+    static void CreateVirtualSwapchain( Swapchain &swapchain, DeferredDeletionQueue *pRetired, uint64_t frame) {
+
+        auto &data = *swapchain.virtualData;
+        if (!data.commandPool)
+        {
+            data.commandPool = CreateCommandPool( GraphicsQueueIndex());
+            if (!data.settings.readbackPath.empty())
+            {
+                data.pReadback = std::make_unique<ReadbackQueue>( swapchain.imageCount * ImageDataSize( swapchain.imageFormat, swapchain.Width(), swapchain.Height()));
+            }
+            data.releaseTimes.assign( swapchain.imageCount, std::chrono::steady_clock::now());
+            data.lastDisplayTime = std::chrono::steady_clock::now();
+            data.nextImage = 0;
+            data.presentCount = 0;
+        }
+        else if (pRetired)
+        {
+            // presents are submitted after the frame fence, so the old images retire together with the fences and command buffers
+            // of their presents, which are complete by the time the frame retires, new ones are created for the new images
+            pRetired->Push( frame, [
+                pData = swapchain.virtualData, oldPool = data.commandPool,
+                oldImages = std::move( data.images), oldFences = std::move( data.fences), oldCommandBuffers = std::move( data.commandBuffers)
+            ]() mutable {
+                WaitForFences( oldFences);
+                for (auto fence : oldFences)
+                {
+                    DestroyFence( fence);
+                }
+                // destroying the swapchain in the meantime already freed the command buffers with their pool
+                if (pData->commandPool == oldPool)
+                {
+                    Device().freeCommandBuffers( oldPool, oldCommandBuffers);
+                }
+                for (auto &image : oldImages)
+                {
+                    DestroyImage( image);
+                }
+            });
+            data.images.clear();
+            data.fences.clear();
+            data.commandBuffers.clear();
+        }
+        else
+        {
+            DestroyVirtualImages( swapchain);
+        }
+
+        // one present fence and command buffer per image, kept if the swapchain is recreated without a deletion queue
+        if (data.fences.empty())
+        {
+            data.commandBuffers.resize( swapchain.imageCount);
+            data.fences.resize( swapchain.imageCount);
+            for (uint32_t i = 0; i < swapchain.imageCount; i++)
+            {
+                data.commandBuffers[i] = AllocateCommandBuffer( data.commandPool);
+                data.fences[i] = CreateFence();
+            }
+        }
+
+        // the images live on until recreation, like the images of a real swapchain
+        data.images.resize( swapchain.imageCount);
+        swapchain.images.resize( swapchain.imageCount);
+        swapchain.imageViews.resize( swapchain.imageCount);
+        for (uint32_t i = 0; i < swapchain.imageCount; i++)
+        {
+            CreateImage( 
+                data.images[i], swapchain.Width(), swapchain.Height(), swapchain.imageFormat, 
+                vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc
+            );
+            swapchain.images[i] = data.images[i].image;
+            swapchain.imageViews[i] = data.images[i].imageView;
+        }
+        swapchain.isValid = true;
+    }
+
+
+    static bool NextVirtualImage( Swapchain &swapchain, vk::Semaphore readySemaphore, uint32_t *imageIndex) {
+
+        auto &data = *swapchain.virtualData;
+        uint32_t index = data.nextImage;
+        data.nextImage = (index + 1) % swapchain.imageCount;
+
+        // wait until the image is no longer shown and its present completed
+        if (data.settings.presentMode == VirtualPresentMode::eFixedRate)
+        {
+            std::this_thread::sleep_until( data.releaseTimes[index]);
+        }
+        WaitForFence( data.fences[index], UINT64_MAX);
+        if (data.pReadback)
+        {
+            data.pReadback->Update();
+        }
+
+        if (readySemaphore)
+        {
+            vk::SemaphoreSubmitInfo signalInfos[] = {
+                vk::SemaphoreSubmitInfo{}
+                    .setSemaphore( readySemaphore )
+                    .setStageMask( vk::PipelineStageFlagBits2::eAllCommands )
+            };
+            SubmitCommands( GraphicsQueue(), {}, {}, signalInfos, nullptr);
+        }
+        *imageIndex = index;
+
+        return swapchain.isValid;
+    }
+
+
+    static bool PresentVirtualImage( Swapchain &swapchain, const vk::Semaphore *waitSemaphore, uint32_t *imageIndex) {
+
+        auto &data = *swapchain.virtualData;
+        uint32_t index = *imageIndex;
+        uint64_t presentIndex = data.presentCount++;
+
+        std::vector<vk::CommandBufferSubmitInfo> cmdInfos;
+        std::vector<vk::SemaphoreSubmitInfo> waitInfos;
+        std::vector<vk::SemaphoreSubmitInfo> signalInfos;
+        if (waitSemaphore)
+        {
+            waitInfos.push_back( vk::SemaphoreSubmitInfo{}
+                .setSemaphore( *waitSemaphore )
+                .setStageMask( vk::PipelineStageFlagBits2::eAllCommands )
+            );
+        }
+        if (data.pReadback && presentIndex % std::max( data.settings.readbackInterval, 1u) == 0)
+        {
+            auto cmd = data.commandBuffers[index];
+            cmd.reset();
+            auto beginInfo = vk::CommandBufferBeginInfo{}
+                .setFlags( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+            cmd.begin( beginInfo);
+
+                // the wait on the render semaphore already makes the image contents visible
+                auto &image = data.images[index];
+                SetTrackedState( image, ResourceUsage{ vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone, swapchain.presentLayout});
+                data.pReadback->ReadImage( 
+                    cmd, image, 0, 0, 
+                    [path = data.settings.readbackPath, presentIndex, format = swapchain.imageFormat, extent = swapchain.extent]( std::span<const uint8_t> texels){
+                        WritePresentedImage( path, presentIndex, format, extent, texels);
+                    }
+                );
+
+            cmd.end();
+            cmdInfos.push_back( vk::CommandBufferSubmitInfo{}
+                .setCommandBuffer( cmd )
+            );
+            signalInfos.push_back( data.pReadback->SignalInfo());
+        }
+        ResetFence( data.fences[index]);
+        SubmitCommands( GraphicsQueue(), cmdInfos, waitInfos, signalInfos, data.fences[index]);
+
+        if (data.settings.presentMode == VirtualPresentMode::eFixedRate)
+        {
+            auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( 1.0 / data.settings.presentRate));
+            data.lastDisplayTime = std::max( std::chrono::steady_clock::now(), data.lastDisplayTime + period);
+            data.releaseTimes[index] = data.lastDisplayTime + period;
+        }
+
+        return swapchain.isValid;
+    }
+
+
+    Swapchain PrepareSwapchain( PresentPolicy policy) {
 
         Swapchain swapchain;
 
         auto capabilities = Gpu().getSurfaceCapabilitiesKHR( Surface() );
         auto formats      = Gpu().getSurfaceFormatsKHR( Surface() );
+        auto presentModes = Gpu().getSurfacePresentModesKHR( Surface() );
+        bool hasMailbox = std::find( presentModes.begin(), presentModes.end(), vk::PresentModeKHR::eMailbox) != presentModes.end();
         
-        // find image count
-        swapchain.imageCount = capabilities.minImageCount + 1;
+        // find present mode, image count and frames in flight
+        swapchain.policy = policy;
+        switch (policy)
+        {
+            case PresentPolicy::eLowLatency:
+                // mailbox needs a spare image to replace queued frames with newer ones, FIFO only the minimum
+                swapchain.presentMode = hasMailbox ? vk::PresentModeKHR::eMailbox : vk::PresentModeKHR::eFifo;
+                swapchain.imageCount = hasMailbox ? capabilities.minImageCount + 1 : capabilities.minImageCount;
+                swapchain.framesInFlight = 1;
+                break;
+            case PresentPolicy::eThroughput:
+                swapchain.presentMode = vk::PresentModeKHR::eFifo;
+                swapchain.imageCount = capabilities.minImageCount + 2;
+                swapchain.framesInFlight = 3;
+                break;
+            default:
+#ifdef NDEBUG
+                swapchain.presentMode = vk::PresentModeKHR::eFifo;
+#else
+                swapchain.presentMode = vk::PresentModeKHR::eImmediate;
+#endif
+                swapchain.imageCount = capabilities.minImageCount + 1;
+                swapchain.framesInFlight = 2;
+                break;
+        }
         if (capabilities.maxImageCount > 0)
         {
             swapchain.imageCount = std::min( swapchain.imageCount, capabilities.maxImageCount);
@@ -34,29 +296,70 @@ namespace vktg
             }
         }
 
-        // find present mode
-#ifdef NDEBUG
-        swapchain.presentMode = vk::PresentModeKHR::eFifo;
-#else
-        swapchain.presentMode = vk::PresentModeKHR::eImmediate;
-#endif
+        swapchain.isValid = false;
+        swapchain.presentLayout = vk::ImageLayout::ePresentSrcKHR;
+        swapchain.presentWait = PresentWaitEnabled();
+        swapchain.presentId = 0;
+        swapchain.inputLatency = 0.0;
+        swapchain.inputLatencyCount = 0;
 
+        return swapchain;
+    }
+
+
+    Swapchain PrepareVirtualSwapchain( const VirtualSwapchainSettings &settings) {
+
+        Swapchain swapchain;
+        swapchain.imageCount = settings.imageCount;
+        swapchain.imageFormat = settings.format;
+        swapchain.colorSpace = vk::ColorSpaceKHR::eSrgbNonlinear;
+        swapchain.presentMode = settings.presentMode == VirtualPresentMode::eFixedRate ? vk::PresentModeKHR::eFifo : vk::PresentModeKHR::eImmediate;
+        swapchain.extent = vk::Extent2D{ settings.width, settings.height};
         swapchain.isValid = false;
+        // offscreen images can be read back in the layout they are presented in
+        swapchain.presentLayout = vk::ImageLayout::eTransferSrcOptimal;
+        swapchain.policy = PresentPolicy::eDefault;
+        swapchain.framesInFlight = 2;
+        swapchain.presentWait = false;
+        swapchain.presentId = 0;
+        swapchain.inputLatency = 0.0;
+        swapchain.inputLatencyCount = 0;
+        swapchain.virtualData = std::make_shared<VirtualSwapchainData>();
+        swapchain.virtualData->settings = settings;
 
         return swapchain;
     }
 
 
-    void CreateSwapchain( Swapchain &swapchain) {
+    void CreateSwapchain( Swapchain &swapchain, DeferredDeletionQueue *pRetired, uint64_t frame) {
+
+        if (swapchain.IsVirtual())
+        {
+            CreateVirtualSwapchain( swapchain, pRetired, frame);
+            return;
+        }
 
         // in case of swapchain recreation
         vk::SwapchainKHR oldSwapchain;
+        std::vector<vk::ImageView> oldImageViews;
         if (swapchain.swapchain)
         {
             oldSwapchain = swapchain.swapchain;
-            DestroySwapchainImageViews( swapchain);
+            if (pRetired)
+            {
+                oldImageViews = std::move( swapchain.imageViews);
+                swapchain.imageViews.clear();
+            }
+            else
+            {
+                DestroySwapchainImageViews( swapchain);
+            }
         }
 
+        // present ids count per swapchain
+        swapchain.presentId = 0;
+        swapchain.pendingInputTimes.clear();
+
         // update swapchain extent to current window size
         swapchain.extent = Gpu().getSurfaceCapabilitiesKHR( Surface()).currentExtent;
         
@@ -81,14 +384,24 @@ namespace vktg
 
         // create swapchain images
         swapchain.images = Device().getSwapchainImagesKHR( swapchain.swapchain);
-        swapchain.imageViews.resize( swapchain.imageCount);
-        for (uint32_t i = 0; i < swapchain.imageCount; i++)
+        swapchain.imageViews.resize( swapchain.images.size());
+        for (uint32_t i = 0; i < swapchain.images.size(); i++)
         {
             swapchain.imageViews[i] = CreateImageView( swapchain.images[i], swapchain.imageFormat, vk::ImageAspectFlagBits::eColor);
         }
 
-        //destroy old swapchain
-        if (oldSwapchain)
+        // destroy old swapchain, or retire it along with its image views once the frames still using them are done
+        if (oldSwapchain && pRetired)
+        {
+            pRetired->Push( frame, [oldSwapchain, oldImageViews](){
+                for (auto imageView : oldImageViews)
+                {
+                    Device().destroyImageView( imageView);
+                }
+                Device().destroySwapchainKHR( oldSwapchain);
+            });
+        }
+        else if (oldSwapchain)
         {
             Device().destroySwapchainKHR( oldSwapchain);
         }
@@ -97,6 +410,30 @@ namespace vktg
 
     void DestroySwapchain( Swapchain &swapchain) {
 
+        if (swapchain.IsVirtual())
+        {
+            auto &data = *swapchain.virtualData;
+            if (data.commandPool)
+            {
+                DestroyVirtualImages( swapchain);
+                if (data.pReadback)
+                {
+                    data.pReadback->Destroy();
+                    data.pReadback.reset();
+                }
+                for (auto fence : data.fences)
+                {
+                    DestroyFence( fence);
+                }
+                data.fences.clear();
+                data.commandBuffers.clear();
+                DestroyCommandPool( data.commandPool);
+                data.commandPool = nullptr;
+            }
+            swapchain.isValid = false;
+            return;
+        }
+
         if (!swapchain.swapchain)
         {
             return;
@@ -112,6 +449,12 @@ namespace vktg
     
     void DestroySwapchainImageViews( Swapchain &swapchain) {
 
+        // views of virtual swapchain images are destroyed with their images
+        if (swapchain.IsVirtual())
+        {
+            return;
+        }
+
         for (auto imageView : swapchain.imageViews)
         {
             Device().destroyImageView( imageView);
@@ -122,6 +465,11 @@ namespace vktg
 
     bool NextSwapchainImage( Swapchain &swapchain, vk::Semaphore readySemaphore, uint32_t *imageIndex) {
 
+        if (swapchain.IsVirtual())
+        {
+            return NextVirtualImage( swapchain, readySemaphore, imageIndex);
+        }
+
         vk::Result result;
         try
         {
@@ -144,7 +492,26 @@ namespace vktg
     }
 
 
-    bool PresentImage( Swapchain &swapchain, const vk::Semaphore *waitSemaphore, uint32_t *imageIndex) {
+    bool PresentImage( Swapchain &swapchain, const vk::Semaphore *waitSemaphore, uint32_t *imageIndex, std::chrono::steady_clock::time_point inputTime) {
+
+        swapchain.presentId++;
+        if (inputTime != std::chrono::steady_clock::time_point{})
+        {
+            if (swapchain.presentWait)
+            {
+                swapchain.pendingInputTimes.emplace_back( swapchain.presentId, inputTime);
+            }
+            else
+            {
+                swapchain.inputLatency = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - inputTime).count();
+                swapchain.inputLatencyCount++;
+            }
+        }
+
+        if (swapchain.IsVirtual())
+        {
+            return PresentVirtualImage( swapchain, waitSemaphore, imageIndex);
+        }
 
         auto presentInfo = vk::PresentInfoKHR{}
             .setWaitSemaphoreCount( 1 )
@@ -152,6 +519,13 @@ namespace vktg
             .setSwapchainCount( 1 )
             .setPSwapchains( &swapchain.swapchain )
             .setPImageIndices( imageIndex );
+        auto presentIdInfo = vk::PresentIdKHR{}
+            .setSwapchainCount( 1 )
+            .setPPresentIds( &swapchain.presentId );
+        if (swapchain.presentWait)
+        {
+            presentInfo.setPNext( &presentIdInfo );
+        }
 	
         vk::Result result;
         try
@@ -174,4 +548,40 @@ namespace vktg
     }
 
 
+    bool WaitForPresentPacing( Swapchain &swapchain, uint64_t timeout) {
+
+        if (!swapchain.presentWait || swapchain.IsVirtual() || swapchain.presentId < swapchain.framesInFlight)
+        {
+            return false;
+        }
+
+        // with one frame in flight the last present has to be done, with more the ones before it
+        uint64_t waitId = swapchain.presentId + 1 - swapchain.framesInFlight;
+        vk::Result result;
+        try
+        {
+            result = Device().waitForPresentKHR( swapchain.swapchain, waitId, timeout);
+        }
+        catch (vk::OutOfDateKHRError&)
+        {
+            swapchain.isValid = false;
+            return false;
+        }
+        if (result == vk::Result::eTimeout)
+        {
+            return false;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        while (!swapchain.pendingInputTimes.empty() && swapchain.pendingInputTimes.front().first <= waitId)
+        {
+            swapchain.inputLatency = std::chrono::duration<double, std::milli>( now - swapchain.pendingInputTimes.front().second).count();
+            swapchain.inputLatencyCount++;
+            swapchain.pendingInputTimes.pop_front();
+        }
+
+        return true;
+    }
+
+
 } // namespace vktg
\ No newline at end of file
@@ -3,12 +3,57 @@
 
 
 #include "vk_core.h"
+#include "util/deletion_stack.h"
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
 
 
 namespace vktg
 {
     
 
+    /// @brief Presentation policy, trading latency against throughput.
+    enum class PresentPolicy : uint8_t {
+        // FIFO in release and immediate in debug builds, one image more than the minimum, two frames in flight
+        eDefault = 0,
+        // mailbox if available, otherwise FIFO, with as few images as possible and a single frame in flight
+        eLowLatency,
+        // FIFO with two images more than the minimum and three frames in flight, so the GPU never waits for the CPU
+        eThroughput
+    };
+
+
+    /// @brief Simulated present pacing of a virtual swapchain.
+    enum class VirtualPresentMode : uint8_t {
+        // images are available again as soon as the GPU is done with them
+        eUncapped = 0,
+        // images are shown one after another at a fixed rate, like FIFO presentation on a display
+        eFixedRate
+    };
+
+
+    /// @brief Settings of a virtual swapchain, backed by offscreen images instead of a surface.
+    struct VirtualSwapchainSettings {
+        uint32_t width = 1920;
+        uint32_t height = 1080;
+        uint32_t imageCount = 3;
+        vk::Format format = vk::Format::eB8G8R8A8Srgb;
+        VirtualPresentMode presentMode = VirtualPresentMode::eUncapped;
+        // presents per second for fixed rate pacing
+        double presentRate = 60.0;
+        // path prefix for presented images written to disk, as <prefix><present index>.ppm, empty to disable readback
+        std::string readbackPath;
+        // write every n-th presented image
+        uint32_t readbackInterval = 1;
+    };
+
+
+    struct VirtualSwapchainData;
+
+
     /// @brief Holds the Vulkan swapchain, images and image views, along with all the data used to (re-)create it. Also contains flag to indicate if swapcahin needs recreating.
     struct Swapchain {
         vk::SwapchainKHR swapchain;
@@ -20,6 +65,24 @@ namespace vktg
 		vk::PresentModeKHR presentMode;
 		vk::Extent2D extent;
 		bool isValid;
+		/// @brief Layout swapchain images have to be transitioned to before presenting.
+		vk::ImageLayout presentLayout;
+		PresentPolicy policy;
+		/// @brief Number of frames in flight the render loop should use for the present policy.
+		uint32_t framesInFlight;
+		/// @brief True if presents are tagged with ids and can be waited on, see ConfigSettings::presentWait.
+		bool presentWait;
+		/// @brief Id of the last present, counting from 1.
+		uint64_t presentId;
+		/// @brief Input to present latency of the last measured present in milliseconds.
+		///		   Measured once the present is done with present wait, otherwise when it is queued.
+		double inputLatency;
+		/// @brief Number of input latency measurements so far, increases whenever inputLatency is updated.
+		uint64_t inputLatencyCount;
+		/// @brief Input times of presents waiting to be done, by present id.
+		std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> pendingInputTimes;
+		/// @brief Offscreen images, fences and pacing state of a virtual swapchain, null for a surface swapchain.
+		std::shared_ptr<VirtualSwapchainData> virtualData;
 
 
 		/// @brief Access swapchain image width.
@@ -28,17 +91,32 @@ namespace vktg
 		/// @brief Access swapcahi mage height.
 		/// @return Image height.
 		uint32_t Height() const { return extent.height; }
+		/// @brief Check if the swapchain is virtual, i.e. backed by offscreen images.
+		/// @return True if virtual.
+		bool IsVirtual() const { return virtualData != nullptr; }
     };
 
 
     /// @brief Gathers all the data to create Vulkan swapchain and returns an uninitialized Swapchain object.
+	///		   The present policy picks present mode, image count and the recommended number of frames in flight.
+	/// @param policy Present policy.
     /// @return Swapchain object.
-    Swapchain PrepareSwapchain();
+    Swapchain PrepareSwapchain( PresentPolicy policy = PresentPolicy::eDefault);
+
+    /// @brief Returns an uninitialized virtual Swapchain object, which needs no surface and works with all the swapchain functions below.
+	///		   Its images are offscreen images that are optionally read back to disk on present, presents are paced as configured.
+	/// @param settings Virtual swapchain settings.
+    /// @return Swapchain object.
+    Swapchain PrepareVirtualSwapchain( const VirtualSwapchainSettings &settings = {});
 
     /// @brief Creates the Vulkan swapchain, stores its images and creates the image views.
-	//		   If given an already initialized swapchain, the old swapchain is destroyed and recreated with updated window size.
+	//		   If given an already initialized swapchain, it is recreated with updated window size, passing the old swapchain on to the new one.
+	//		   The old swapchain and its image views are destroyed right away, so the device has to be idle, unless a deferred deletion queue is given
+	//		   to retire them in until the frames still using them are done.
     /// @param swapchain Swapchain object created by PrepareSwapchain().
-    void CreateSwapchain( Swapchain &swapchain);
+    /// @param pRetired Optional deferred deletion queue to retire the old swapchain in.
+    /// @param frame Last frame using the old swapchain, if retired.
+    void CreateSwapchain( Swapchain &swapchain, DeferredDeletionQueue *pRetired = nullptr, uint64_t frame = 0);
 	
 	/// @brief Destroys given swapchain object along with its image views.
 	/// @param swapchain Swapcahin to estroy.
@@ -60,8 +138,17 @@ namespace vktg
 	/// @param swapchain Swapchain object holding Vulkan swapchain.
 	/// @param waitSemaphore Semaphores to wait on before presenting.
 	/// @param imageIndex Index of the swapchain image to present.
+	/// @param inputTime Optional time of the input this frame responds to, e.g. InputHandler::InputTime(), to measure input to present latency.
 	/// @return True is swapchain is still valid, false otherwise.
-	bool PresentImage( Swapchain &swapchain, const vk::Semaphore *waitSemaphore, uint32_t *imageIndex);
+	bool PresentImage( Swapchain &swapchain, const vk::Semaphore *waitSemaphore, uint32_t *imageIndex, std::chrono::steady_clock::time_point inputTime = {});
+
+	/// @brief Limits the presents in flight to the frames in flight of the swapchain, by waiting for older presents to be done.
+	///		   Call before sampling input for the next frame, so input is as fresh as possible when the frame is shown.
+	///		   Does nothing if present wait is not enabled and for virtual swapchains, which are paced on acquire.
+	/// @param swapchain Swapchain object holding Vulkan swapchain.
+	/// @param timeout Timeout in nanoseconds.
+	/// @return True if a present was waited for.
+	bool WaitForPresentPacing( Swapchain &swapchain, uint64_t timeout = 1e9);
 
 
 } // namespace vktg
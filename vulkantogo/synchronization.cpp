@@ -1,6 +1,8 @@
 
 #include "synchronization.h"
 
+#include <algorithm>
+
 
 namespace vktg
 {
@@ -126,4 +128,176 @@ namespace vktg
     }
 
 
+    /***    BARRIER BATCH    ***/
+
+    // Merges two ranges [base, base + count) if they overlap or touch, VK_REMAINING_* counts extend to the end.
+    static bool MergeRanges( uint64_t base1, uint64_t count1, uint64_t base2, uint64_t count2, uint64_t remaining, uint64_t &base, uint64_t &count) {
+
+        uint64_t end1 = count1 == remaining ? UINT64_MAX : base1 + count1;
+        uint64_t end2 = count2 == remaining ? UINT64_MAX : base2 + count2;
+        if (base1 > end2 || base2 > end1)
+        {
+            return false;
+        }
+
+        base = std::min( base1, base2);
+        uint64_t end = std::max( end1, end2);
+        count = end == UINT64_MAX ? remaining : end - base;
+
+        return true;
+    }
+
+
+    BarrierBatch& BarrierBatch::Add( const vk::MemoryBarrier2 &barrier) {
+
+        for (auto &other : mMemoryBarriers)
+        {
+            if (other.srcStageMask == barrier.srcStageMask && other.srcAccessMask == barrier.srcAccessMask)
+            {
+                other.dstStageMask |= barrier.dstStageMask;
+                other.dstAccessMask |= barrier.dstAccessMask;
+                return *this;
+            }
+            if (other.dstStageMask == barrier.dstStageMask && other.dstAccessMask == barrier.dstAccessMask)
+            {
+                other.srcStageMask |= barrier.srcStageMask;
+                other.srcAccessMask |= barrier.srcAccessMask;
+                return *this;
+            }
+        }
+        mMemoryBarriers.push_back( barrier);
+
+        return *this;
+    }
+
+
+    BarrierBatch& BarrierBatch::Add( const vk::BufferMemoryBarrier2 &barrier) {
+
+        for (auto &other : mBufferBarriers)
+        {
+            if (other.buffer != barrier.buffer
+                || other.srcQueueFamilyIndex != barrier.srcQueueFamilyIndex
+                || other.dstQueueFamilyIndex != barrier.dstQueueFamilyIndex)
+            {
+                continue;
+            }
+
+            // same range, combine scopes
+            if (other.offset == barrier.offset && other.size == barrier.size)
+            {
+                other.srcStageMask |= barrier.srcStageMask;
+                other.srcAccessMask |= barrier.srcAccessMask;
+                other.dstStageMask |= barrier.dstStageMask;
+                other.dstAccessMask |= barrier.dstAccessMask;
+                return *this;
+            }
+
+            // same scopes, combine ranges
+            uint64_t offset, size;
+            if (other.srcStageMask == barrier.srcStageMask && other.srcAccessMask == barrier.srcAccessMask
+                && other.dstStageMask == barrier.dstStageMask && other.dstAccessMask == barrier.dstAccessMask
+                && MergeRanges( other.offset, other.size, barrier.offset, barrier.size, VK_WHOLE_SIZE, offset, size))
+            {
+                other.offset = offset;
+                other.size = size;
+                return *this;
+            }
+        }
+        mBufferBarriers.push_back( barrier);
+
+        return *this;
+    }
+
+
+    BarrierBatch& BarrierBatch::Add( const vk::ImageMemoryBarrier2 &barrier) {
+
+        for (size_t i = 0; i < mImageBarriers.size(); i++)
+        {
+            auto &other = mImageBarriers[i];
+            auto &range = other.subresourceRange;
+            auto &newRange = barrier.subresourceRange;
+            if (other.image != barrier.image
+                || other.oldLayout != barrier.oldLayout || other.newLayout != barrier.newLayout
+                || other.srcQueueFamilyIndex != barrier.srcQueueFamilyIndex
+                || other.dstQueueFamilyIndex != barrier.dstQueueFamilyIndex
+                || range.aspectMask != newRange.aspectMask)
+            {
+                continue;
+            }
+
+            // same subresource, combine scopes
+            if (range == newRange)
+            {
+                other.srcStageMask |= barrier.srcStageMask;
+                other.srcAccessMask |= barrier.srcAccessMask;
+                other.dstStageMask |= barrier.dstStageMask;
+                other.dstAccessMask |= barrier.dstAccessMask;
+                return *this;
+            }
+
+            if (other.srcStageMask != barrier.srcStageMask || other.srcAccessMask != barrier.srcAccessMask
+                || other.dstStageMask != barrier.dstStageMask || other.dstAccessMask != barrier.dstAccessMask)
+            {
+                continue;
+            }
+
+            // same scopes, combine adjacent mip levels or array layers
+            uint64_t base, count;
+            auto merged = other;
+            if (range.baseArrayLayer == newRange.baseArrayLayer && range.layerCount == newRange.layerCount
+                && MergeRanges( range.baseMipLevel, range.levelCount, newRange.baseMipLevel, newRange.levelCount, VK_REMAINING_MIP_LEVELS, base, count))
+            {
+                merged.subresourceRange.baseMipLevel = (uint32_t)base;
+                merged.subresourceRange.levelCount = (uint32_t)count;
+            }
+            else if (range.baseMipLevel == newRange.baseMipLevel && range.levelCount == newRange.levelCount
+                && MergeRanges( range.baseArrayLayer, range.layerCount, newRange.baseArrayLayer, newRange.layerCount, VK_REMAINING_ARRAY_LAYERS, base, count))
+            {
+                merged.subresourceRange.baseArrayLayer = (uint32_t)base;
+                merged.subresourceRange.layerCount = (uint32_t)count;
+            }
+            else
+            {
+                continue;
+            }
+
+            // the grown range may now be adjacent to another barrier, e.g. a full mip chain of the next layer
+            mImageBarriers.erase( mImageBarriers.begin() + i);
+            return Add( merged);
+        }
+        mImageBarriers.push_back( barrier);
+
+        return *this;
+    }
+
+
+    void BarrierBatch::Flush( vk::CommandBuffer cmd) {
+
+        if (Empty())
+        {
+            return;
+        }
+
+        auto dependencyInfo = vk::DependencyInfo{}
+            .setMemoryBarrierCount( (uint32_t)mMemoryBarriers.size() )
+            .setPMemoryBarriers( mMemoryBarriers.data() )
+            .setBufferMemoryBarrierCount( (uint32_t)mBufferBarriers.size() )
+            .setPBufferMemoryBarriers( mBufferBarriers.data() )
+            .setImageMemoryBarrierCount( (uint32_t)mImageBarriers.size() )
+            .setPImageMemoryBarriers( mImageBarriers.data() );
+
+        cmd.pipelineBarrier2( &dependencyInfo);
+
+        Clear();
+    }
+
+
+    void BarrierBatch::Clear() {
+
+        mMemoryBarriers.clear();
+        mBufferBarriers.clear();
+        mImageBarriers.clear();
+    }
+
+
 } // namespace vktg
\ No newline at end of file
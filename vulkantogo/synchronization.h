@@ -4,6 +4,7 @@
 #include "vk_core.h"
 
 #include <span>
+#include <vector>
 
 
 namespace vktg
@@ -97,5 +98,54 @@ namespace vktg
         const vk::ImageSubresourceRange &subResource = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1} 
     );
 
+
+    /// @brief Collects memory, buffer and image barriers and records them with a single pipeline barrier.
+    ///        Compatible barriers are merged on insertion. Barriers in one batch are not ordered among each other,
+    ///        so do not add two layout transitions of the same image subresource before flushing.
+    class BarrierBatch {
+
+        public:
+
+            /// @brief Add a memory barrier. Merged with a barrier of equal source or destination scope.
+            /// @param barrier Memory barrier, e.g. created with CreateMemoryBarrier(...).
+            /// @return Reference to BarrierBatch for chaining.
+            BarrierBatch& Add( const vk::MemoryBarrier2 &barrier);
+            /// @brief Add a buffer memory barrier. Merged with a barrier of the same buffer and scopes covering an adjacent
+            ///        or overlapping range, or with a barrier of the same buffer range.
+            /// @param barrier Buffer memory barrier, e.g. created with CreateBufferMemoryBarrier(...).
+            /// @return Reference to BarrierBatch for chaining.
+            BarrierBatch& Add( const vk::BufferMemoryBarrier2 &barrier);
+            /// @brief Add an image memory barrier. Merged with a barrier of the same image, layouts and scopes covering adjacent
+            ///        mip levels or layers, or with a barrier of the same image subresource and layouts.
+            /// @param barrier Image memory barrier, e.g. created with CreateImageMemoryBarrier(...).
+            /// @return Reference to BarrierBatch for chaining.
+            BarrierBatch& Add( const vk::ImageMemoryBarrier2 &barrier);
+
+            /// @brief Records all collected barriers with one pipeline barrier and clears the batch. Does nothing if the batch is empty.
+            /// @param cmd Command buffer to record pipeline barrier.
+            void Flush( vk::CommandBuffer cmd);
+            /// @brief Removes all collected barriers without recording them.
+            void Clear();
+
+            /// @brief Check if the batch holds any barriers.
+            /// @return True if no barriers have been added since the last flush.
+            bool Empty() const { return mMemoryBarriers.empty() && mBufferBarriers.empty() && mImageBarriers.empty(); }
+            /// @brief Access collected memory barriers.
+            /// @return List of merged memory barriers.
+            std::span<const vk::MemoryBarrier2> MemoryBarriers() const { return mMemoryBarriers; }
+            /// @brief Access collected buffer memory barriers.
+            /// @return List of merged buffer memory barriers.
+            std::span<const vk::BufferMemoryBarrier2> BufferBarriers() const { return mBufferBarriers; }
+            /// @brief Access collected image memory barriers.
+            /// @return List of merged image memory barriers.
+            std::span<const vk::ImageMemoryBarrier2> ImageBarriers() const { return mImageBarriers; }
+
+        private:
+
+            std::vector<vk::MemoryBarrier2> mMemoryBarriers;
+            std::vector<vk::BufferMemoryBarrier2> mBufferBarriers;
+            std::vector<vk::ImageMemoryBarrier2> mImageBarriers;
+    };
+
     
 } // namespace vktg
@@ -0,0 +1,592 @@
+#include "texture_streamer.h"
+#include "formats.h"
+#include "transfer.h"
+#include "synchronization.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    TextureStreamer::TextureStreamer( uint8_t frameOverlap, vk::DeviceSize memoryBudget, const ResourceUsage &usage, uint32_t workerThreads) :
+        mFrameOverlap{ frameOverlap},
+        mUsage{ usage},
+        mTailSize{ 64},
+        mMaxPendingLoads{ 2 * workerThreads},
+        mMemoryBudget{ memoryBudget},
+        mMemoryUsage{ 0},
+        mFrame{ 0},
+        mThreadPool{ workerThreads}
+    {
+    }
+
+
+    uint32_t TextureStreamer::AddTexture( const StreamedTextureInfo &info) {
+
+        if (!info.loadLevel)
+        {
+            throw std::runtime_error( "Streamed texture needs a mip level loading function!");
+        }
+
+        Texture texture;
+        texture.info = info;
+        texture.info.mipLevels = std::max( info.mipLevels, 1u);
+
+        // mip tail of all levels not larger than the tail size
+        texture.tailMip = 0;
+        while (texture.tailMip + 1 < texture.info.mipLevels && std::max( info.width >> texture.tailMip, info.height >> texture.tailMip) > mTailSize)
+        {
+            texture.tailMip++;
+        }
+        texture.residentMip = texture.tailMip;
+
+        std::vector<uint8_t> tailData( LevelsSize( texture, texture.tailMip));
+        size_t offset = 0;
+        for (uint32_t mip = texture.tailMip; mip < texture.info.mipLevels; mip++)
+        {
+            auto levelSize = ImageDataSize( info.format, std::max( info.width >> mip, 1u), std::max( info.height >> mip, 1u), 1, info.layers);
+            info.loadLevel( mip, std::span<uint8_t>( tailData.data() + offset, levelSize));
+            offset += levelSize;
+        }
+
+        CreateImage(
+            texture.image,
+            std::max( info.width >> texture.tailMip, 1u), std::max( info.height >> texture.tailMip, 1u),
+            info.format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
+            vk::ImageAspectFlagBits::eColor, texture.info.mipLevels - texture.tailMip, info.layers
+        );
+        UploadImageData( tailData.data(), texture.image, mUsage);
+        mMemoryUsage += LevelsSize( texture, texture.residentMip);
+
+        mTextures.push_back( std::move( texture));
+
+        return (uint32_t)mTextures.size() - 1;
+    }
+
+
+    void TextureStreamer::RemoveTexture( uint32_t texture) {
+
+        // unknown or already removed textures hold no image anymore
+        if (texture >= mTextures.size() || mTextures[texture].removed)
+        {
+            return;
+        }
+
+        auto &tex = mTextures[texture];
+        tex.removed = true;
+
+        // pending textures are retired once their residency change is done
+        if (!tex.pending)
+        {
+            Retire( tex.image);
+            mMemoryUsage -= LevelsSize( tex, tex.residentMip);
+        }
+    }
+
+
+    void TextureStreamer::SetPriority( uint32_t texture, float priority) {
+
+        mTextures[texture].priority = priority;
+    }
+
+
+    void TextureStreamer::SetMemoryBudget( vk::DeviceSize memoryBudget) {
+
+        mMemoryBudget = memoryBudget;
+    }
+
+
+    std::vector<uint32_t> TextureStreamer::Update() {
+
+        ++mFrame;
+        std::vector<uint32_t> changedTextures;
+
+        // destroy images that no frame in flight can use anymore
+        std::erase_if( mRetiredImages, [this]( const RetiredImage &retired) {
+            if (mFrame - retired.frame <= mFrameOverlap)
+            {
+                return false;
+            }
+            DestroyImage( retired.image);
+            return true;
+        });
+
+        // swap in images of finished uploads
+        for (auto upload = mUploads.begin(); upload != mUploads.end(); )
+        {
+            if (Device().getFenceStatus( upload->context.fence) != vk::Result::eSuccess)
+            {
+                ++upload;
+                continue;
+            }
+
+            for (auto &swap : upload->swaps)
+            {
+                auto &tex = mTextures[swap.texture];
+                tex.pending = false;
+                Retire( tex.image);
+                mMemoryUsage -= LevelsSize( tex, tex.residentMip);
+                if (tex.removed)
+                {
+                    Retire( swap.image);
+                    continue;
+                }
+
+                tex.image = swap.image;
+                tex.residentMip = swap.residentMip;
+                mMemoryUsage += LevelsSize( tex, tex.residentMip);
+                changedTextures.push_back( swap.texture);
+            }
+            for (auto &staging : upload->stagingBuffers)
+            {
+                DestroyBuffer( staging);
+            }
+
+            mFreeContexts.push_back( upload->context);
+            upload = mUploads.erase( upload);
+        }
+
+        // residency changes of this update are recorded into one command buffer
+        Upload upload;
+        bool recording = false;
+        auto recordCmd = [&]() {
+            if (!recording)
+            {
+                if (mFreeContexts.empty())
+                {
+                    mFreeContexts.push_back( CreateSubmitContext( QueueType::eGraphics));
+                }
+                upload.context = mFreeContexts.back();
+                mFreeContexts.pop_back();
+                upload.context.Begin();
+                recording = true;
+            }
+            return upload.context.cmd;
+        };
+
+        // on errors the residency changes recorded so far are dropped, nothing of them has been submitted
+        try
+        {
+            // upload finished loads
+            for (auto load = mLoads.begin(); load != mLoads.end(); )
+            {
+                if (load->done.wait_for( std::chrono::seconds( 0)) != std::future_status::ready)
+                {
+                    ++load;
+                    continue;
+                }
+
+                auto &tex = mTextures[load->texture];
+                try
+                {
+                    load->done.get();
+                }
+                catch (...)
+                {
+                    // skipped so the other residency changes of this update still go through, the texture keeps its levels
+                    tex.pending = false;
+                    tex.loadError = std::current_exception();
+                    DestroyBuffer( load->staging);
+                    load = mLoads.erase( load);
+                    continue;
+                }
+
+                if (tex.removed)
+                {
+                    tex.pending = false;
+                    Retire( tex.image);
+                    mMemoryUsage -= LevelsSize( tex, tex.residentMip);
+                    DestroyBuffer( load->staging);
+                }
+                else
+                {
+                    RecordResidencyChange( recordCmd(), load->texture, load->residentMip, &*load, upload);
+                    upload.stagingBuffers.push_back( load->staging);
+                }
+                load = mLoads.erase( load);
+            }
+
+            // memory that textures with pending residency changes are going to need additionally
+            vk::DeviceSize pendingGrowth = 0;
+            for (auto &load : mLoads)
+            {
+                auto &tex = mTextures[load.texture];
+                pendingGrowth += LevelsSize( tex, load.residentMip) - LevelsSize( tex, tex.residentMip);
+            }
+            auto addSwapGrowth = [&]( const Upload &pendingUpload) {
+                for (auto &swap : pendingUpload.swaps)
+                {
+                    auto &tex = mTextures[swap.texture];
+                    if (swap.residentMip < tex.residentMip)
+                    {
+                        pendingGrowth += LevelsSize( tex, swap.residentMip) - LevelsSize( tex, tex.residentMip);
+                    }
+                }
+            };
+            for (auto &pendingUpload : mUploads)
+            {
+                addSwapGrowth( pendingUpload);
+            }
+            addSwapGrowth( upload);
+
+            std::vector<uint32_t> candidates;
+            candidates.reserve( mTextures.size());
+            vk::DeviceSize budget = MemoryBudget();
+
+            // evict top mip levels under memory pressure, levels that are no longer needed first, then least important textures
+            vk::DeviceSize usage = mMemoryUsage + pendingGrowth;
+            if (usage > budget)
+            {
+                for (uint32_t t = 0; t < mTextures.size(); t++)
+                {
+                    if (!mTextures[t].removed && !mTextures[t].pending && mTextures[t].residentMip < mTextures[t].tailMip)
+                    {
+                        candidates.push_back( t);
+                    }
+                }
+                std::sort( candidates.begin(), candidates.end(), [this]( uint32_t a, uint32_t b) {
+                    bool unneededA = mTextures[a].residentMip < DesiredMip( mTextures[a]);
+                    bool unneededB = mTextures[b].residentMip < DesiredMip( mTextures[b]);
+                    if (unneededA != unneededB)
+                    {
+                        return unneededA;
+                    }
+                    return mTextures[a].priority < mTextures[b].priority;
+                });
+
+                for (auto t : candidates)
+                {
+                    if (usage <= budget)
+                    {
+                        break;
+                    }
+
+                    auto &tex = mTextures[t];
+                    uint32_t residentMip = std::max( tex.residentMip + 1, DesiredMip( tex));
+                    usage -= std::min( usage, LevelsSize( tex, tex.residentMip) - LevelsSize( tex, residentMip));
+                    RecordResidencyChange( recordCmd(), t, residentMip, nullptr, upload);
+                }
+            }
+
+            // start loading missing mip levels of the most important textures that fit into the budget
+            candidates.clear();
+            for (uint32_t t = 0; t < mTextures.size(); t++)
+            {
+                if (!mTextures[t].removed && !mTextures[t].pending && !mTextures[t].loadError && DesiredMip( mTextures[t]) < mTextures[t].residentMip)
+                {
+                    candidates.push_back( t);
+                }
+            }
+            std::sort( candidates.begin(), candidates.end(), [this]( uint32_t a, uint32_t b) {
+                return mTextures[a].priority > mTextures[b].priority;
+            });
+
+            for (auto t : candidates)
+            {
+                if (mLoads.size() >= mMaxPendingLoads)
+                {
+                    break;
+                }
+
+                // load as many of the desired levels as fit into the budget
+                auto &tex = mTextures[t];
+                uint32_t residentMip = DesiredMip( tex);
+                while (residentMip < tex.residentMip && usage + LevelsSize( tex, residentMip) - LevelsSize( tex, tex.residentMip) > budget)
+                {
+                    residentMip++;
+                }
+                if (residentMip == tex.residentMip)
+                {
+                    continue;
+                }
+                usage += LevelsSize( tex, residentMip) - LevelsSize( tex, tex.residentMip);
+
+                // staging layout of the loaded levels, mip levels relative to the new image
+                Load load;
+                load.texture = t;
+                load.residentMip = residentMip;
+                vk::DeviceSize alignment = std::lcm( GetFormatInfo( tex.info.format).blockSize, 4u);
+                vk::DeviceSize offset = 0;
+                std::vector<vk::DeviceSize> levelSizes;
+                for (uint32_t mip = residentMip; mip < tex.residentMip; mip++)
+                {
+                    offset = (offset + alignment - 1) / alignment * alignment;
+                    uint32_t width = std::max( tex.info.width >> mip, 1u);
+                    uint32_t height = std::max( tex.info.height >> mip, 1u);
+                    load.regions.push_back( vk::BufferImageCopy2{}
+                        .setBufferOffset( offset )
+                        .setImageExtent( vk::Extent3D{width, height, 1} )
+                        .setImageSubresource( vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, mip - residentMip, 0, tex.info.layers} )
+                    );
+                    levelSizes.push_back( ImageDataSize( tex.info.format, width, height, 1, tex.info.layers));
+                    offset += levelSizes.back();
+                }
+                CreateStagingBuffer( load.staging, offset);
+
+                // load levels straight into mapped staging memory
+                auto loadLevel = tex.info.loadLevel;
+                auto stagingData = static_cast<uint8_t*>( load.staging.Data());
+                auto regions = load.regions;
+                load.done = mThreadPool.Submit( [loadLevel, stagingData, regions, levelSizes, residentMip](){
+                    for (size_t i = 0; i < regions.size(); i++)
+                    {
+                        loadLevel( residentMip + (uint32_t)i, std::span<uint8_t>( stagingData + regions[i].bufferOffset, levelSizes[i]));
+                    }
+                });
+
+                tex.pending = true;
+                mLoads.push_back( std::move( load));
+            }
+        }
+        catch (...)
+        {
+            if (recording)
+            {
+                AbortUpload( upload);
+            }
+            throw;
+        }
+
+        if (recording)
+        {
+            upload.context.End();
+            upload.context.Submit();
+            mUploads.push_back( std::move( upload));
+        }
+
+        return changedTextures;
+    }
+
+
+    void TextureStreamer::Destroy() {
+
+        mThreadPool.Wait();
+        for (auto &load : mLoads)
+        {
+            DestroyBuffer( load.staging);
+        }
+        mLoads.clear();
+
+        for (auto &upload : mUploads)
+        {
+            WaitForFence( upload.context.fence);
+            for (auto &swap : upload.swaps)
+            {
+                DestroyImage( swap.image);
+            }
+            for (auto &staging : upload.stagingBuffers)
+            {
+                DestroyBuffer( staging);
+            }
+            DestroySubmitContext( upload.context);
+        }
+        mUploads.clear();
+
+        for (auto &context : mFreeContexts)
+        {
+            DestroySubmitContext( context);
+        }
+        mFreeContexts.clear();
+
+        for (auto &tex : mTextures)
+        {
+            // removed textures that were not pending are already retired
+            if (!tex.removed || tex.pending)
+            {
+                DestroyImage( tex.image);
+            }
+        }
+        mTextures.clear();
+
+        for (auto &retired : mRetiredImages)
+        {
+            DestroyImage( retired.image);
+        }
+        mRetiredImages.clear();
+        mMemoryUsage = 0;
+    }
+
+
+    const Image& TextureStreamer::GetImage( uint32_t texture) const {
+
+        return mTextures[texture].image;
+    }
+
+
+    uint32_t TextureStreamer::ResidentMip( uint32_t texture) const {
+
+        return mTextures[texture].residentMip;
+    }
+
+
+    vk::DeviceSize TextureStreamer::MemoryUsage() const {
+
+        return mMemoryUsage;
+    }
+
+
+    uint32_t TextureStreamer::PendingCount() const {
+
+        uint32_t count = (uint32_t)mLoads.size();
+        for (auto &upload : mUploads)
+        {
+            count += (uint32_t)upload.swaps.size();
+        }
+
+        return count;
+    }
+
+
+    std::exception_ptr TextureStreamer::LoadError( uint32_t texture) const {
+
+        return mTextures[texture].loadError;
+    }
+
+
+    void TextureStreamer::ClearLoadError( uint32_t texture) {
+
+        mTextures[texture].loadError = nullptr;
+    }
+
+
+    uint32_t TextureStreamer::DesiredMip( const Texture &texture) const {
+
+        if (texture.priority <= 0.f)
+        {
+            return texture.tailMip;
+        }
+
+        float size = (float)std::max( texture.info.width, texture.info.height);
+        float mip = std::floor( std::log2( size / texture.priority));
+
+        return (uint32_t)std::clamp( mip, 0.f, (float)texture.tailMip);
+    }
+
+
+    vk::DeviceSize TextureStreamer::MemoryBudget() const {
+
+        if (mMemoryBudget > 0)
+        {
+            return mMemoryBudget;
+        }
+
+        // budget of the device local heaps minus memory used by other resources, with some headroom
+        auto budgets = Allocator().getBudget();
+        auto memoryProperties = Gpu().getMemoryProperties();
+        vk::DeviceSize heapBudget = 0;
+        vk::DeviceSize heapUsage = 0;
+        for (uint32_t heap = 0; heap < memoryProperties.memoryHeapCount; heap++)
+        {
+            if (memoryProperties.memoryHeaps[heap].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+            {
+                heapBudget += budgets[heap].budget;
+                heapUsage += budgets[heap].usage;
+            }
+        }
+        heapBudget = heapBudget / 10 * 9;
+        vk::DeviceSize otherUsage = heapUsage > mMemoryUsage ? heapUsage - mMemoryUsage : 0;
+
+        return heapBudget > otherUsage ? heapBudget - otherUsage : 0;
+    }
+
+
+    vk::DeviceSize TextureStreamer::LevelsSize( const Texture &texture, uint32_t firstMip) const {
+
+        return ImageDataSize(
+            texture.info.format,
+            std::max( texture.info.width >> firstMip, 1u), std::max( texture.info.height >> firstMip, 1u),
+            texture.info.mipLevels - firstMip, texture.info.layers
+        );
+    }
+
+
+    void TextureStreamer::RecordResidencyChange( vk::CommandBuffer cmd, uint32_t texture, uint32_t residentMip, Load *load, Upload &upload) {
+
+        auto &tex = mTextures[texture];
+
+        Image image;
+        CreateImage(
+            image,
+            std::max( tex.info.width >> residentMip, 1u), std::max( tex.info.height >> residentMip, 1u),
+            tex.info.format, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
+            vk::ImageAspectFlagBits::eColor, tex.info.mipLevels - residentMip, tex.info.layers
+        );
+        tex.pending = true;
+
+        // levels resident in both images are copied over
+        std::vector<vk::ImageCopy2> copyRegions;
+        for (uint32_t mip = std::max( residentMip, tex.residentMip); mip < tex.info.mipLevels; mip++)
+        {
+            copyRegions.push_back( vk::ImageCopy2{}
+                .setSrcSubresource( vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, mip - tex.residentMip, 0, tex.info.layers} )
+                .setDstSubresource( vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, mip - residentMip, 0, tex.info.layers} )
+                .setExtent( vk::Extent3D{std::max( tex.info.width >> mip, 1u), std::max( tex.info.height >> mip, 1u), 1} )
+            );
+        }
+
+        BarrierBatch barriers;
+        Transition( barriers, tex.image, ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal});
+        Transition( barriers, image, ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal});
+        barriers.Flush( cmd);
+
+        auto copyInfo = vk::CopyImageInfo2{}
+            .setSrcImage( tex.image.image )
+            .setSrcImageLayout( vk::ImageLayout::eTransferSrcOptimal )
+            .setDstImage( image.image )
+            .setDstImageLayout( vk::ImageLayout::eTransferDstOptimal )
+            .setRegionCount( (uint32_t)copyRegions.size() )
+            .setPRegions( copyRegions.data() );
+        cmd.copyImage2( &copyInfo);
+
+        if (load != nullptr)
+        {
+            CopyBufferToImage( cmd, load->staging.buffer, image.image, load->regions);
+        }
+
+        // the old image stays in use until the swap
+        Transition( barriers, tex.image, mUsage);
+        Transition( barriers, image, mUsage);
+        barriers.Flush( cmd);
+
+        upload.swaps.push_back( Swap{ texture, residentMip, image});
+    }
+
+
+    void TextureStreamer::AbortUpload( Upload &upload) {
+
+        upload.context.End();
+        mFreeContexts.push_back( upload.context);
+
+        // textures keep their current image, loaded levels are loaded again in a later update
+        for (auto &swap : upload.swaps)
+        {
+            auto &tex = mTextures[swap.texture];
+            tex.pending = false;
+            SetTrackedState( tex.image, mUsage);
+            DestroyImage( swap.image);
+            if (tex.removed)
+            {
+                Retire( tex.image);
+                mMemoryUsage -= LevelsSize( tex, tex.residentMip);
+            }
+        }
+        for (auto &staging : upload.stagingBuffers)
+        {
+            DestroyBuffer( staging);
+        }
+    }
+
+
+    void TextureStreamer::Retire( const Image &image) {
+
+        mRetiredImages.push_back( RetiredImage{ image, mFrame});
+    }
+
+
+} // namespace vktg
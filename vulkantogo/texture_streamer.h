@@ -0,0 +1,167 @@
+#pragma once
+
+
+#include "vk_core.h"
+#include "storage.h"
+#include "submit_context.h"
+#include "util/thread_pool.h"
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <span>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Describes a texture with a full mip chain whose mip levels are loaded on demand.
+    struct StreamedTextureInfo {
+
+        vk::Format format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipLevels;
+        uint32_t layers = 1;
+        /// @brief Writes the tightly packed data of all layers of a mip level to the destination, called on worker threads.
+        std::function<void( uint32_t mipLevel, std::span<uint8_t> dst)> loadLevel;
+    };
+
+
+    /// @brief Streams mip levels of textures in and out depending on their priority and a device memory budget.
+    ///        The smallest mip levels of each texture are always resident, higher levels are loaded on worker threads
+    ///        and uploaded on the graphics queue. Each texture image holds exactly its resident mip levels, so its image view
+    ///        clamps sampling to the resident levels and evicted levels free their memory.
+    class TextureStreamer {
+
+        public:
+
+            /// @brief Initialize texture streamer.
+            /// @param frameOverlap Number of frames in flight, replaced images are destroyed once no frame can use them anymore.
+            /// @param memoryBudget Device memory the streamed textures may use. If 0 the budget is derived from the vma heap budgets.
+            /// @param usage Usage the textures are sampled with, e.g. fragment shader reads in shader read only layout.
+            /// @param workerThreads Number of threads loading mip levels.
+            TextureStreamer(
+                uint8_t frameOverlap = 2, vk::DeviceSize memoryBudget = 0,
+                const ResourceUsage &usage = ResourceUsage{ vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal},
+                uint32_t workerThreads = 2
+            );
+
+            /// @brief Add a texture and upload its mip tail, i.e. all levels of at most tail size, before returning.
+            /// @param info Texture description and mip level loading function.
+            /// @return Texture handle.
+            uint32_t AddTexture( const StreamedTextureInfo &info);
+            /// @brief Remove a texture. Its image is destroyed once no frame in flight can use it anymore.
+            ///        Removing an unknown or already removed texture does nothing.
+            /// @param texture Texture handle.
+            void RemoveTexture( uint32_t texture);
+            /// @brief Set the priority of a texture as its size on screen in pixels along its larger axis, 0 if not visible.
+            ///        The mip level matching that size is streamed in, more important textures first.
+            /// @param texture Texture handle.
+            /// @param priority Size on screen in pixels.
+            void SetPriority( uint32_t texture, float priority);
+            /// @brief Set the device memory budget of all streamed textures.
+            /// @param memoryBudget Memory budget in bytes. If 0 the budget is derived from the vma heap budgets.
+            void SetMemoryBudget( vk::DeviceSize memoryBudget);
+
+            /// @brief Swaps in finished uploads, evicts mip levels if over budget and starts loading the most important missing levels.
+            ///        Call once per frame, after waiting for the oldest frame in flight.
+            /// @return Textures whose image and image view changed, descriptors referencing them need to be updated.
+            std::vector<uint32_t> Update();
+            /// @brief Waits for all loads and uploads, then destroys all textures and the submit contexts.
+            void Destroy();
+
+            /// @brief Current image of a texture holding its resident mip levels.
+            /// @param texture Texture handle.
+            /// @return Image object.
+            const Image& GetImage( uint32_t texture) const;
+            /// @brief Highest detail mip level of the full mip chain that is resident.
+            /// @param texture Texture handle.
+            /// @return Mip level index.
+            uint32_t ResidentMip( uint32_t texture) const;
+            /// @brief Memory of the resident mip levels of all textures, the same measure the budget is checked against.
+            /// @return Memory size in bytes.
+            vk::DeviceSize MemoryUsage() const;
+            /// @brief Number of mip level loads and uploads in progress.
+            /// @return Number of pending residency changes.
+            uint32_t PendingCount() const;
+            /// @brief Exception thrown by the last failed mip level load of a texture. A texture with a failed load keeps its resident
+            ///        levels and is not loaded again until the error is cleared, the other textures keep streaming.
+            /// @param texture Texture handle.
+            /// @return Exception pointer, null if no load failed.
+            std::exception_ptr LoadError( uint32_t texture) const;
+            /// @brief Clears the load error of a texture, so its missing levels are loaded again.
+            /// @param texture Texture handle.
+            void ClearLoadError( uint32_t texture);
+
+        private:
+
+            struct Texture {
+                StreamedTextureInfo info;
+                Image image;
+                uint32_t residentMip;
+                uint32_t tailMip;
+                float priority = 0.f;
+                bool pending = false;
+                bool removed = false;
+                std::exception_ptr loadError;
+            };
+
+            struct Load {
+                uint32_t texture;
+                uint32_t residentMip;
+                Buffer staging;
+                std::vector<vk::BufferImageCopy2> regions;
+                std::future<void> done;
+            };
+
+            struct Swap {
+                uint32_t texture;
+                uint32_t residentMip;
+                Image image;
+            };
+
+            struct Upload {
+                SubmitContext context;
+                std::vector<Swap> swaps;
+                std::vector<Buffer> stagingBuffers;
+            };
+
+            struct RetiredImage {
+                Image image;
+                uint64_t frame;
+            };
+
+            /// @brief Mip level matching the priority of a texture.
+            uint32_t DesiredMip( const Texture &texture) const;
+            /// @brief Memory budget of the streamed textures.
+            vk::DeviceSize MemoryBudget() const;
+            /// @brief Memory needed by the mip levels of a texture starting at given level.
+            vk::DeviceSize LevelsSize( const Texture &texture, uint32_t firstMip) const;
+            /// @brief Creates an image holding the new resident levels and records copies of the kept levels and loaded data.
+            void RecordResidencyChange( vk::CommandBuffer cmd, uint32_t texture, uint32_t residentMip, Load *load, Upload &upload);
+            /// @brief Ends an upload that is not going to be submitted and drops its residency changes.
+            void AbortUpload( Upload &upload);
+            void Retire( const Image &image);
+
+
+            const uint8_t mFrameOverlap;
+            const ResourceUsage mUsage;
+            const uint32_t mTailSize;
+            const uint32_t mMaxPendingLoads;
+            vk::DeviceSize mMemoryBudget;
+            vk::DeviceSize mMemoryUsage;
+            uint64_t mFrame;
+
+            std::vector<Texture> mTextures;
+            std::vector<Load> mLoads;
+            std::vector<Upload> mUploads;
+            std::vector<SubmitContext> mFreeContexts;
+            std::vector<RetiredImage> mRetiredImages;
+            ThreadPool mThreadPool;
+    };
+
+
+} // namespace vktg
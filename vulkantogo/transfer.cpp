@@ -1,8 +1,15 @@
 
 #include "transfer.h"
+#include "formats.h"
 #include "storage.h"
 #include "submit_context.h"
 #include "synchronization.h"
+#include "util/cpu_profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
 
 
 namespace vktg
@@ -78,12 +85,50 @@ namespace vktg
     }
 
 
-    void CopyImageToBuffer( vk::CommandBuffer cmd, vk::Image srcImage, vk::Buffer dstBuffer, size_t bufferOffset, uint32_t imgWidth, uint32_t imgHeight, vk::Offset3D imgOffset, const vk::ImageSubresourceLayers &imgSubresource) {
+    void CopyBufferToImage( vk::CommandBuffer cmd, vk::Buffer srcBuffer, vk::Image dstImage, std::span<vk::BufferImageCopy2> regions) {
+
+        auto copyInfo = vk::CopyBufferToImageInfo2{}
+            .setSrcBuffer( srcBuffer )
+            .setDstImage( dstImage )
+            .setDstImageLayout( vk::ImageLayout::eTransferDstOptimal )
+            .setRegionCount( (uint32_t)regions.size() )
+            .setPRegions( regions.data() );        
+
+        cmd.copyBufferToImage2( &copyInfo);
+    }
+
+
+    vk::DeviceSize PackedImageRegions( const Image &image, std::vector<vk::BufferImageCopy2> &regions, vk::DeviceSize bufferOffset) {
+
+        // buffer offsets must be a multiple of the texel block size and of 4 for depth stencil formats
+        vk::DeviceSize alignment = std::lcm( GetFormatInfo( image.Format()).blockSize, 4u);
+
+        vk::DeviceSize offset = bufferOffset;
+        for (uint32_t mip = 0; mip < image.MipLevels(); mip++)
+        {
+            offset = (offset + alignment - 1) / alignment * alignment;
+            uint32_t width = std::max( image.Width() >> mip, 1u);
+            uint32_t height = std::max( image.Height() >> mip, 1u);
+
+            regions.push_back( vk::BufferImageCopy2{}
+                .setBufferOffset( offset )
+                .setImageExtent( vk::Extent3D{width, height, 1} )
+                .setImageSubresource( vk::ImageSubresourceLayers{image.imageAspect, mip, 0, image.Layers()} )
+            );
+            offset += ImageDataSize( image.Format(), width, height, 1, image.Layers());
+        }
+
+        return offset - bufferOffset;
+    }
+
+
+    void CopyImageToBuffer( vk::CommandBuffer cmd, vk::Image srcImage, vk::Buffer dstBuffer, size_t bufferOffset, uint32_t imgWidth, uint32_t imgHeight, const vk::Offset3D &imgOffset, const vk::ImageSubresourceLayers &imgSubresource) {
 
         auto copyRegion = vk::BufferImageCopy2{}
             .setBufferOffset( bufferOffset)
             .setImageOffset( imgOffset )
-            .setImageExtent( vk::Extent3D{imgWidth, imgHeight, 1} );
+            .setImageExtent( vk::Extent3D{imgWidth, imgHeight, 1} )
+            .setImageSubresource( imgSubresource );
 
         auto copyInfo = vk::CopyImageToBufferInfo2{}
             .setSrcImage( srcImage )
@@ -96,8 +141,72 @@ namespace vktg
     }
 
 
+    uint32_t MipLevelCount( uint32_t width, uint32_t height) {
+
+        uint32_t levels = 1;
+        for (uint32_t size = std::max( width, height); size > 1; size /= 2)
+        {
+            levels++;
+        }
+
+        return levels;
+    }
+
+
+    void GenerateMipmaps( vk::CommandBuffer cmd, Image &image, const ResourceUsage &finalUsage) {
+
+        auto features = Gpu().getFormatProperties( image.Format()).optimalTilingFeatures;
+        if (!(features & vk::FormatFeatureFlagBits::eBlitSrc) || !(features & vk::FormatFeatureFlagBits::eBlitDst))
+        {
+            throw std::runtime_error( "Image format does not support blits, cannot generate mipmaps!");
+        }
+        auto filter = (features & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) ? vk::Filter::eLinear : vk::Filter::eNearest;
+
+        ResourceUsage blitRead{ vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal};
+        ResourceUsage blitWrite{ vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal};
+
+        BarrierBatch barriers;
+        int32_t width = (int32_t)image.Width();
+        int32_t height = (int32_t)image.Height();
+        for (uint32_t mip = 1; mip < image.MipLevels(); mip++)
+        {
+            // previous level becomes blit source, next level blit destination, both with one pipeline barrier
+            Transition( barriers, image, blitRead, vk::ImageSubresourceRange{ {}, mip - 1, 1, 0, VK_REMAINING_ARRAY_LAYERS});
+            Transition( barriers, image, blitWrite, vk::ImageSubresourceRange{ {}, mip, 1, 0, VK_REMAINING_ARRAY_LAYERS});
+            barriers.Flush( cmd);
+
+            int32_t nextWidth = std::max( width / 2, 1);
+            int32_t nextHeight = std::max( height / 2, 1);
+            auto blitRegion = vk::ImageBlit2{}
+                .setSrcOffsets( {vk::Offset3D{0, 0, 0}, vk::Offset3D{width, height, 1}} )
+                .setDstOffsets( {vk::Offset3D{0, 0, 0}, vk::Offset3D{nextWidth, nextHeight, 1}} )
+                .setSrcSubresource( vk::ImageSubresourceLayers{image.imageAspect, mip - 1, 0, image.Layers()} )
+                .setDstSubresource( vk::ImageSubresourceLayers{image.imageAspect, mip, 0, image.Layers()} );
+
+            auto blitInfo = vk::BlitImageInfo2{}
+                .setSrcImage( image.image )
+                .setSrcImageLayout( vk::ImageLayout::eTransferSrcOptimal )
+                .setDstImage( image.image )
+                .setDstImageLayout( vk::ImageLayout::eTransferDstOptimal )
+                .setFilter( filter )
+                .setRegionCount( 1 )
+                .setPRegions( &blitRegion );
+
+            cmd.blitImage2( &blitInfo);
+
+            width = nextWidth;
+            height = nextHeight;
+        }
+
+        Transition( barriers, image, finalUsage);
+        barriers.Flush( cmd);
+    }
+
+
     void UploadBufferData( const void *srcData, vk::Buffer dstBuffer, size_t size, size_t offset) {
 
+        VKTG_PROFILE_FUNCTION();
+
         Buffer stagingBuffer;
         CreateStagingBuffer( stagingBuffer, size, srcData);
 
@@ -119,6 +228,8 @@ namespace vktg
 
     void UploadImageData( const void *srcData, vk::Image dstImage, uint32_t width, uint32_t height, const vk::Offset3D &imgOffset, const vk::ImageSubresourceLayers &imgSubresource) {
 
+        VKTG_PROFILE_FUNCTION();
+
         Buffer stagingBuffer;
         CreateStagingBuffer( stagingBuffer, width * height * 4, srcData);
 
@@ -139,4 +250,50 @@ namespace vktg
     }
 
 
+    void UploadImageData( const void *srcData, Image &dstImage, const ResourceUsage &finalUsage, QueueType queueType) {
+
+        VKTG_PROFILE_FUNCTION();
+
+        if (dstImage.imageAspect & vk::ImageAspectFlagBits::eDepth && dstImage.imageAspect & vk::ImageAspectFlagBits::eStencil)
+        {
+            throw std::runtime_error( "Upload of combined depth stencil image data is not supported!");
+        }
+
+        std::vector<vk::BufferImageCopy2> regions;
+        regions.reserve( dstImage.MipLevels());
+        vk::DeviceSize stagingSize = PackedImageRegions( dstImage, regions);
+
+        Buffer stagingBuffer;
+        CreateStagingBuffer( stagingBuffer, stagingSize);
+
+        // source data is tightly packed, mip levels in the staging buffer start at aligned offsets
+        auto src = static_cast<const uint8_t*>( srcData);
+        auto dst = static_cast<uint8_t*>( stagingBuffer.Data());
+        for (auto &region : regions)
+        {
+            auto levelSize = ImageDataSize( dstImage.Format(), region.imageExtent.width, region.imageExtent.height, 1, dstImage.Layers());
+            std::memcpy( dst + region.bufferOffset, src, levelSize);
+            src += levelSize;
+        }
+
+        auto submitContext = CreateSubmitContext( queueType);
+        submitContext.Begin();
+            Transition( 
+                submitContext.cmd, dstImage, 
+                ResourceUsage{ vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal}
+            );
+            CopyBufferToImage( submitContext.cmd, stagingBuffer.buffer, dstImage.image, regions);
+            if (finalUsage.stage != vk::PipelineStageFlagBits2::eNone)
+            {
+                Transition( submitContext.cmd, dstImage, finalUsage);
+            }
+        submitContext.End();
+        submitContext.Submit();
+        WaitForFence( submitContext.fence);
+
+        DestroySubmitContext( submitContext);
+        DestroyBuffer( stagingBuffer);
+    }
+
+
 } // namespace vktg
@@ -2,8 +2,10 @@
 
 
 #include "vk_core.h"
+#include "storage.h"
 
 #include <span>
+#include <vector>
 
 
 namespace vktg
@@ -70,6 +72,26 @@ namespace vktg
     );
 
 
+    /// @brief Copies multiple regions from source buffer to destination image with a single copy command.
+    /// @param cmd Command buffer to record copy command.
+    /// @param srcBuffer Source buffer.
+    /// @param dstImage Destination image, must be in transfer destination layout.
+    /// @param regions List of buffer to image regions to copy, e.g. created with PackedImageRegions(...).
+    void CopyBufferToImage(
+        vk::CommandBuffer cmd,
+        vk::Buffer srcBuffer, vk::Image dstImage,
+        std::span<vk::BufferImageCopy2> regions
+    );
+
+    /// @brief Creates copy regions for the data of all mip levels and layers of an image packed into a buffer, one region per mip level.
+    ///        Each mip level starts at an offset aligned for the image format and holds the tightly packed texel blocks of all image layers.
+    /// @param image Image to create copy regions for.
+    /// @param regions List to append copy regions to.
+    /// @param bufferOffset Buffer offset of mip level 0.
+    /// @return Size of the packed image data in the buffer, starting at the buffer offset.
+    vk::DeviceSize PackedImageRegions( const Image &image, std::vector<vk::BufferImageCopy2> &regions, vk::DeviceSize bufferOffset = 0);
+
+
     /// @brief Copies image region from source image to destination buffer.
     /// @param cmd Command buffer to record copy command.
     /// @param srcImage Source image,
@@ -88,6 +110,24 @@ namespace vktg
     );
 
 
+    /// @brief Number of mip levels of a full mip chain down to 1x1.
+    /// @param width Width of mip level 0.
+    /// @param height Height of mip level 0.
+    /// @return Number of mip levels.
+    uint32_t MipLevelCount( uint32_t width, uint32_t height);
+
+    /// @brief Fills mip levels 1 and up of all image layers by blitting each level into the next, with all layers in one blit.
+    ///        Mip level 0 must hold the image data. Requires transfer source and destination usage and a graphics queue command buffer.
+    ///        sRGB images are filtered in linear space. Uses nearest filtering if the format does not support linear filtering.
+    /// @param cmd Command buffer to record blit commands.
+    /// @param image Image to generate mip levels for. Its tracked state is updated.
+    /// @param finalUsage Usage all mip levels are transitioned to afterwards.
+    void GenerateMipmaps( 
+        vk::CommandBuffer cmd, Image &image, 
+        const ResourceUsage &finalUsage = ResourceUsage{ vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal}
+    );
+
+
     /// @brief Uploads buffer data to GPU. Intended for use on separate thread, since it will wait for completion.
     /// @param srcData Pointer to source data location.
     /// @param dstBuffer Destination buffer.
@@ -95,7 +135,8 @@ namespace vktg
     /// @param offset Offset of buffer region to copy into.
     void UploadBufferData( const void* srcData, vk::Buffer dstBuffer, size_t size, size_t offset);
 
-    /// @brief Uploads image data to GPU. Intended for use on separate thread, since it will wait for completion.
+    /// @brief Uploads image data of a format with 4 bytes per texel to GPU. Intended for use on separate thread, since it will wait for completion.
+    ///        The destination image must already be in transfer destination layout.
     /// @param srcData Pointer to source data location.
     /// @param dstImage Destination image.
     /// @param width Width of destination image region.
@@ -103,10 +144,24 @@ namespace vktg
     /// @param imgOffset Offset of destination image region.
     /// @param imgSubresource Destination image subresource
     void UploadImageData( 
-        void* srcData, vk::Image dstImage, 
+        const void* srcData, vk::Image dstImage, 
         uint32_t width, uint32_t height, const vk::Offset3D &imgOffset = vk::Offset3D{0, 0, 0},
         const vk::ImageSubresourceLayers &imgSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, 0, 0, 1}
     );
 
+    /// @brief Uploads image data of all mip levels and layers to GPU, using a single staging buffer and copy command.
+    ///        Supports all formats known to GetFormatInfo(...), including block-compressed formats. 
+    ///        Intended for use on separate thread, since it will wait for completion.
+    /// @param srcData Pointer to image data, mip level after mip level, each holding the tightly packed texel blocks of all image layers, 
+    ///        as stored in KTX2 files. Use ImageDataSize(...) to get the expected data size.
+    /// @param dstImage Destination image. Its tracked state is used for the layout transitions and updated.
+    /// @param finalUsage Usage the image is transitioned to after the copy. Left in transfer destination layout if empty.
+    /// @param queueType Queue to submit the copy to, must support the final usage stage.
+    void UploadImageData( 
+        const void* srcData, Image &dstImage,
+        const ResourceUsage &finalUsage = ResourceUsage{ vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal},
+        QueueType queueType = QueueType::eGraphics
+    );
+
     
 } // namespace vktg
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "cpu_profiler.h"
+#include "json.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace vktg
+{
+
+
+    // written by its own thread only, read by the collecting thread
+    struct ThreadEvents {
+
+        struct OpenZone {
+            const char *name;
+            uint64_t start;
+        };
+
+        // sequence is the event index + 1 once the event is complete and 0 while it is written
+        struct Slot {
+            std::atomic<uint64_t> sequence{ 0};
+            CpuProfileEvent event;
+        };
+
+        std::array<Slot, CpuProfiler::ringSize> events;
+        std::atomic<uint64_t> written{ 0};
+        std::array<OpenZone, CpuProfiler::maxDepth> openZones;
+        uint32_t depth = 0;
+        uint32_t index;
+
+        // guarded by the registry mutex
+        uint64_t cleared = 0;
+        std::string name;
+    };
+
+
+    struct ThreadRegistry {
+
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+    };
+
+
+    static const auto sStartTime = std::chrono::steady_clock::now();
+    static std::atomic<bool> sEnabled{ true};
+
+
+    static ThreadRegistry& Registry() {
+
+        static ThreadRegistry registry;
+
+        return registry;
+    }
+
+
+    // buffers are kept after their thread exits so its events can still be exported
+    static ThreadEvents& ThisThread() {
+
+        thread_local ThreadEvents *pThread = nullptr;
+        if (!pThread)
+        {
+            auto &registry = Registry();
+            std::lock_guard<std::mutex> lock( registry.mutex);
+
+            auto thread = std::make_unique<ThreadEvents>();
+            thread->index = (uint32_t)registry.threads.size();
+            thread->name = "thread " + std::to_string( thread->index);
+            pThread = thread.get();
+            registry.threads.push_back( std::move( thread));
+        }
+
+        return *pThread;
+    }
+
+
+    // seqlock per slot, a reader copying the slot at the same time sees the sequence change and drops its copy
+    static void Push( ThreadEvents &thread, const CpuProfileEvent &event) {
+
+        uint64_t written = thread.written.load( std::memory_order_relaxed);
+        auto &slot = thread.events[written % CpuProfiler::ringSize];
+        slot.sequence.store( 0, std::memory_order_relaxed);
+        std::atomic_thread_fence( std::memory_order_release);
+        slot.event = event;
+        slot.event.thread = thread.index;
+        slot.sequence.store( written + 1, std::memory_order_release);
+        thread.written.store( written + 1, std::memory_order_release);
+    }
+
+
+    void CpuProfiler::Enable( bool enabled) {
+
+        sEnabled.store( enabled, std::memory_order_relaxed);
+    }
+
+
+    bool CpuProfiler::Enabled() {
+
+        return sEnabled.load( std::memory_order_relaxed);
+    }
+
+
+    void CpuProfiler::BeginZone( const char *name) {
+
+        auto &thread = ThisThread();
+        if (thread.depth < maxDepth)
+        {
+            // zones begun while disabled are still tracked, so enabling in between keeps begin and end paired
+            thread.openZones[thread.depth] = ThreadEvents::OpenZone{ Enabled() ? name : nullptr, Now()};
+        }
+        ++thread.depth;
+    }
+
+
+    void CpuProfiler::EndZone() {
+
+        auto &thread = ThisThread();
+        if (thread.depth == 0)
+        {
+            return;
+        }
+
+        --thread.depth;
+        if (thread.depth >= maxDepth || !thread.openZones[thread.depth].name)
+        {
+            return;
+        }
+
+        auto &zone = thread.openZones[thread.depth];
+        CpuProfileEvent event;
+        event.name = zone.name;
+        event.start = zone.start;
+        event.duration = Now() - zone.start;
+        event.value = 0;
+        event.depth = (uint16_t)thread.depth;
+        event.type = CpuProfileEvent::Type::eZone;
+        Push( thread, event);
+    }
+
+
+    void CpuProfiler::Marker( const char *name, uint64_t value) {
+
+        if (!Enabled())
+        {
+            return;
+        }
+
+        CpuProfileEvent event;
+        event.name = name;
+        event.start = Now();
+        event.duration = 0;
+        event.value = value;
+        event.depth = 0;
+        event.type = CpuProfileEvent::Type::eMarker;
+        Push( ThisThread(), event);
+    }
+
+
+    void CpuProfiler::SetThreadName( std::string_view name) {
+
+        auto &thread = ThisThread();
+        std::lock_guard<std::mutex> lock( Registry().mutex);
+        thread.name = name;
+    }
+
+
+    uint64_t CpuProfiler::Now() {
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - sStartTime).count();
+    }
+
+
+    std::vector<CpuProfileEvent> CpuProfiler::Events() {
+
+        std::vector<CpuProfileEvent> events;
+
+        auto &registry = Registry();
+        std::lock_guard<std::mutex> lock( registry.mutex);
+        for (auto &thread : registry.threads)
+        {
+            uint64_t written = thread->written.load( std::memory_order_acquire);
+            uint64_t first = std::max( thread->cleared, written > ringSize ? written - ringSize : 0);
+            for (uint64_t i = first; i < written; i++)
+            {
+                // skip events the recording thread overwrote before or while they were copied
+                auto &slot = thread->events[i % ringSize];
+                if (slot.sequence.load( std::memory_order_acquire) != i + 1)
+                {
+                    continue;
+                }
+                CpuProfileEvent event = slot.event;
+                std::atomic_thread_fence( std::memory_order_acquire);
+                if (slot.sequence.load( std::memory_order_relaxed) == i + 1)
+                {
+                    events.push_back( event);
+                }
+            }
+        }
+
+        std::stable_sort( events.begin(), events.end(), []( const CpuProfileEvent &a, const CpuProfileEvent &b){ return a.start < b.start; });
+
+        return events;
+    }
+
+
+    std::vector<std::string> CpuProfiler::ThreadNames() {
+
+        auto &registry = Registry();
+        std::lock_guard<std::mutex> lock( registry.mutex);
+
+        std::vector<std::string> names;
+        names.reserve( registry.threads.size());
+        for (auto &thread : registry.threads)
+        {
+            names.push_back( thread->name);
+        }
+
+        return names;
+    }
+
+
+    void CpuProfiler::Clear() {
+
+        auto &registry = Registry();
+        std::lock_guard<std::mutex> lock( registry.mutex);
+        for (auto &thread : registry.threads)
+        {
+            thread->cleared = thread->written.load( std::memory_order_acquire);
+        }
+    }
+
+
+    std::string CpuProfiler::ChromeTrace() {
+
+        auto threadNames = ThreadNames();
+        auto events = Events();
+
+        // chrome trace timestamps are in microseconds
+        std::ostringstream out;
+        out.setf( std::ios::fixed);
+        out.precision( 3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+        for (uint32_t i = 0; i < threadNames.size(); i++)
+        {
+            out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":";
+            AppendJsonString( out, threadNames[i]);
+            out << "}}";
+            first = false;
+        }
+
+        for (auto &event : events)
+        {
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            AppendJsonString( out, event.name);
+            if (event.type == CpuProfileEvent::Type::eZone)
+            {
+                out << ",\"ph\":\"X\",\"ts\":" << event.start * 1e-3 << ",\"dur\":" << event.duration * 1e-3;
+            }
+            else
+            {
+                out << ",\"ph\":\"i\",\"s\":\"g\",\"ts\":" << event.start * 1e-3 << ",\"args\":{\"value\":" << event.value << "}";
+            }
+            out << ",\"pid\":0,\"tid\":" << event.thread << "}";
+            first = false;
+        }
+        out << "\n]}\n";
+
+        return out.str();
+    }
+
+
+    void CpuProfiler::ExportChromeTrace( std::string_view path) {
+
+        std::ofstream file( std::string( path), std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error( "Failed to open file " + std::string( path) + " for writing!");
+        }
+
+        file << ChromeTrace();
+    }
+
+
+} // namespace vktg
@@ -0,0 +1,128 @@
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+#define VKTG_PROFILE_CONCAT_IMPL( a, b) a##b
+#define VKTG_PROFILE_CONCAT( a, b) VKTG_PROFILE_CONCAT_IMPL( a, b)
+
+// zone and marker names must outlive the profiler, e.g. string literals
+#ifdef VKTG_PROFILING
+    #define VKTG_PROFILE_ZONE( name) vktg::CpuProfileZone VKTG_PROFILE_CONCAT( vktgProfileZone, __LINE__)( name)
+    #define VKTG_PROFILE_FUNCTION() VKTG_PROFILE_ZONE( __func__)
+    #define VKTG_PROFILE_MARKER( name, value) vktg::CpuProfiler::Marker( name, value)
+    #define VKTG_PROFILE_THREAD( name) vktg::CpuProfiler::SetThreadName( name)
+#else
+    #define VKTG_PROFILE_ZONE( name)
+    #define VKTG_PROFILE_FUNCTION()
+    #define VKTG_PROFILE_MARKER( name, value)
+    #define VKTG_PROFILE_THREAD( name)
+#endif
+
+
+namespace vktg
+{
+
+
+    /// @brief Zone or marker recorded by the CPU profiler, times are in nanoseconds since profiler start.
+    struct CpuProfileEvent {
+
+        enum class Type : uint8_t {
+            eZone,
+            eMarker
+        };
+
+        const char *name;
+        uint64_t start;
+        /// @brief Zone duration, 0 for markers.
+        uint64_t duration;
+        /// @brief Marker value, e.g. the frame number of frame markers.
+        uint64_t value;
+        /// @brief Index of the recording thread in CpuProfiler::ThreadNames().
+        uint32_t thread;
+        /// @brief Nesting depth of zones, 0 for top level zones.
+        uint16_t depth;
+        Type type;
+    };
+
+
+    /// @brief Low overhead instrumentation of CPU zones. Each thread records into its own fixed size ring buffer without locking,
+    ///        once a ring is full the oldest events are overwritten. Events are collected by Events() or exported as Chrome trace JSON,
+    ///        which can be opened in chrome://tracing or Perfetto. Zones are usually recorded with the VKTG_PROFILE_* macros,
+    ///        which compile to nothing unless VKTG_PROFILING is defined.
+    class CpuProfiler {
+
+        public:
+
+            /// @brief Number of events kept per thread.
+            static constexpr uint32_t ringSize = 1 << 14;
+            /// @brief Maximum zone nesting depth per thread, deeper zones are ignored.
+            static constexpr uint32_t maxDepth = 64;
+
+            /// @brief Enables or disables recording, enabled by default.
+            /// @param enabled True to record events.
+            static void Enable( bool enabled);
+            /// @brief Whether events are recorded.
+            /// @return True if recording.
+            static bool Enabled();
+
+            /// @brief Starts a zone on the calling thread. Zones nest and must be ended in reverse order on the same thread.
+            /// @param name Zone name, must outlive the profiler.
+            static void BeginZone( const char *name);
+            /// @brief Ends the innermost zone of the calling thread.
+            static void EndZone();
+            /// @brief Records an instant event, shown as a vertical line across all threads in trace viewers.
+            /// @param name Marker name, must outlive the profiler.
+            /// @param value Value stored with the marker.
+            static void Marker( const char *name, uint64_t value = 0);
+            /// @brief Names the calling thread in exported traces.
+            /// @param name Thread name.
+            static void SetThreadName( std::string_view name);
+
+            /// @brief Nanoseconds since profiler start.
+            /// @return Current profiler time.
+            static uint64_t Now();
+
+            /// @brief Collects the events of all threads still held by their ring buffers and not cleared.
+            /// @return List of events, sorted by start time.
+            static std::vector<CpuProfileEvent> Events();
+            /// @brief Names of all threads that recorded events, indexed by CpuProfileEvent::thread.
+            /// @return List of thread names.
+            static std::vector<std::string> ThreadNames();
+            /// @brief Drops all events recorded so far.
+            static void Clear();
+
+            /// @brief Formats collected events as Chrome trace event JSON.
+            /// @return JSON string.
+            static std::string ChromeTrace();
+            /// @brief Writes collected events as Chrome trace event JSON to a file. Will throw if the file cannot be opened.
+            /// @param path Output file path.
+            static void ExportChromeTrace( std::string_view path);
+    };
+
+
+    /// @brief Profiles a CPU zone for the lifetime of the object.
+    class CpuProfileZone {
+
+        public:
+
+            /// @brief Begins a zone.
+            /// @param name Zone name, must outlive the profiler.
+            CpuProfileZone( const char *name) {
+                CpuProfiler::BeginZone( name);
+            }
+            /// @brief Ends the zone.
+            ~CpuProfileZone() {
+                CpuProfiler::EndZone();
+            }
+
+            CpuProfileZone( const CpuProfileZone&) = delete;
+            CpuProfileZone& operator=( const CpuProfileZone&) = delete;
+    };
+
+
+} // namespace vktg
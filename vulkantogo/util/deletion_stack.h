@@ -1,7 +1,11 @@
 #pragma once
 
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <utility>
 #include <vector>
 
 
@@ -36,5 +40,52 @@ namespace vktg
             std::vector<std::function<void()>> mDeletors;
     };    
 
+
+    /// @brief Defers deletion functions of objects still in use by frames in flight, each tagged with the last frame using the objects.
+    ///        Used to retire resources, like an old swapchain or resized render targets, without waiting for the device to be idle.
+    class DeferredDeletionQueue {
+
+        public:
+
+            /// @brief Adds deletion function to run once the given frame has retired. A frame older than the last pushed frame
+            ///        is raised to it, so the queue stays ordered and deletion functions are never called early.
+            /// @param frame Last frame using the objects, usually the current frame count.
+            /// @param func Deletion function.
+            void Push( uint64_t frame, std::function<void()> &&func) {
+
+                if (!mDeletors.empty())
+                {
+                    frame = std::max( frame, mDeletors.back().first);
+                }
+                mDeletors.emplace_back( frame, std::move(func));
+            }
+
+            /// @brief Calls the deletion functions of all frames up to the retired frame in order of submission.
+            ///        Call after waiting for the fence of a frame, e.g. with the frame count minus the frame overlap.
+            /// @param retiredFrame Last frame whose GPU work has completed.
+            void Flush( uint64_t retiredFrame) {
+
+                while (!mDeletors.empty() && mDeletors.front().first <= retiredFrame)
+                {
+                    mDeletors.front().second();
+                    mDeletors.pop_front();
+                }
+            }
+
+            /// @brief Calls all deletion functions, after the device is idle, e.g. on shut down.
+            void FlushAll() {
+
+                Flush( UINT64_MAX);
+            }
+
+            /// @brief Number of pending deletion functions.
+            /// @return Pending deletion count.
+            size_t Size() const { return mDeletors.size(); }
+
+        private:
+
+            std::deque<std::pair<uint64_t, std::function<void()>>> mDeletors;
+    };
+
     
 } // namespace vktg
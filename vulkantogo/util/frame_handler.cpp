@@ -1,12 +1,182 @@
 
 #include "frame_handler.h"
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
 
 
 namespace vktg
 {
 
 
-    FrameHandler::FrameHandler(const uint8_t frameOverlap) : mFrameOverlap{frameOverlap}, mFrameCount{0} {
+    void RollingStats::Add( double value) {
+
+        if (mCount == windowSize)
+        {
+            mSum -= mValues[mNext];
+        }
+        else
+        {
+            ++mCount;
+        }
+        mValues[mNext] = value;
+        mSum += value;
+        mNext = (mNext + 1) % windowSize;
+    }
+
+
+    double RollingStats::Last() const {
+
+        return mCount == 0 ? 0.0 : mValues[(mNext + windowSize - 1) % windowSize];
+    }
+
+
+    double RollingStats::Average() const {
+
+        return mCount == 0 ? 0.0 : mSum / mCount;
+    }
+
+
+    double RollingStats::Min() const {
+
+        return mCount == 0 ? 0.0 : *std::min_element( mValues.begin(), mValues.begin() + mCount);
+    }
+
+
+    double RollingStats::Max() const {
+
+        return mCount == 0 ? 0.0 : *std::max_element( mValues.begin(), mValues.begin() + mCount);
+    }
+
+
+    uint32_t RollingStats::Count() const {
+
+        return mCount;
+    }
+
+
+    static uint32_t FrameTimeBin( double milliseconds) {
+
+        return (uint32_t)std::min( std::max( milliseconds, 0.0) / FrameTimeStats::binWidth, FrameTimeStats::binCount - 1.0);
+    }
+
+
+    void FrameTimeStats::Add( double milliseconds) {
+
+        uint32_t index = mAdded % windowSize;
+        if (mAdded >= windowSize)
+        {
+            // the oldest value leaves the window
+            mSum -= mValues[index];
+            --mBins[FrameTimeBin( mValues[index])];
+            if (mMaxSize > 0 && mMaxQueue[mMaxFront] == index)
+            {
+                mMaxFront = (mMaxFront + 1) % windowSize;
+                --mMaxSize;
+            }
+        }
+
+        mValues[index] = milliseconds;
+        mSum += milliseconds;
+        ++mBins[FrameTimeBin( milliseconds)];
+
+        // older values not larger than the new one can never be the maximum again
+        while (mMaxSize > 0 && mValues[mMaxQueue[(mMaxFront + mMaxSize - 1) % windowSize]] <= milliseconds)
+        {
+            --mMaxSize;
+        }
+        mMaxQueue[(mMaxFront + mMaxSize) % windowSize] = index;
+        ++mMaxSize;
+        ++mAdded;
+    }
+
+
+    void FrameTimeStats::Reset() {
+
+        mBins.fill( 0);
+        mMaxFront = 0;
+        mMaxSize = 0;
+        mAdded = 0;
+        mSum = 0.0;
+    }
+
+
+    double FrameTimeStats::Last() const {
+
+        return mAdded == 0 ? 0.0 : mValues[(mAdded - 1) % windowSize];
+    }
+
+
+    double FrameTimeStats::Average() const {
+
+        return mAdded == 0 ? 0.0 : mSum / Count();
+    }
+
+
+    double FrameTimeStats::Percentile( double percent) const {
+
+        uint32_t count = Count();
+        if (count == 0)
+        {
+            return 0.0;
+        }
+
+        double target = std::clamp( percent, 0.0, 100.0) * 0.01 * count;
+        uint32_t cumulative = 0;
+        for (uint32_t bin = 0; bin + 1 < binCount; bin++)
+        {
+            if (mBins[bin] > 0 && cumulative + mBins[bin] >= target)
+            {
+                double fraction = (target - cumulative) / mBins[bin];
+                return std::min( (bin + fraction) * binWidth, Max());
+            }
+            cumulative += mBins[bin];
+        }
+
+        // the last bin also holds all longer frames, so hitches are ranked by their exact values from the window
+        std::array<double, windowSize> overflow;
+        uint32_t overflowCount = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (FrameTimeBin( mValues[i]) == binCount - 1)
+            {
+                overflow[overflowCount++] = mValues[i];
+            }
+        }
+        if (overflowCount == 0)
+        {
+            return Max();
+        }
+
+        uint32_t rank = (uint32_t)std::clamp( std::ceil( target) - cumulative, 1.0, (double)overflowCount) - 1;
+        std::nth_element( overflow.begin(), overflow.begin() + rank, overflow.begin() + overflowCount);
+
+        return overflow[rank];
+    }
+
+
+    double FrameTimeStats::Max() const {
+
+        return mMaxSize == 0 ? 0.0 : mValues[mMaxQueue[mMaxFront]];
+    }
+
+
+    uint32_t FrameTimeStats::Count() const {
+
+        return (uint32_t)std::min<uint64_t>( mAdded, windowSize);
+    }
+
+
+    std::span<const uint32_t> FrameTimeStats::Histogram() const {
+
+        return mBins;
+    }
+
+
+    FrameHandler::FrameHandler(const uint8_t frameOverlap) : mFrameOverlap{frameOverlap}, mFrameCount{0}, mDumpInterval{0}, mDumpFormat{FrameTimeFormat::eCsv} {
 
         mFrameTimer.Start();
     }
@@ -38,6 +208,8 @@ namespace vktg
 
     void FrameHandler::EarlyUpdate() {
 
+        VKTG_PROFILE_MARKER( "frame begin", mFrameCount);
+
         for (auto &[_, callback] : mEarlyFrameCallbacks)
         {
             callback();
@@ -47,8 +219,15 @@ namespace vktg
 
     void FrameHandler::LateUpdate() {
 
+        VKTG_PROFILE_MARKER( "frame end", mFrameCount);
+
         ++mFrameCount;
         mFrameTimer.Update();
+        mFrameTimes.Add( mFrameTimer.DeltaTime() * 1e3);
+        if (mDumpInterval > 0 && mFrameCount % mDumpInterval == 0)
+        {
+            DumpFrameTimes( mDumpPath, mDumpFormat);
+        }
 
         for (auto &[_, callback] : mLateFrameCallbacks)
         {
@@ -81,4 +260,73 @@ namespace vktg
     }
 
 
+    void FrameHandler::AddStat( std::string_view key, double value) {
+
+        mStats[std::string( key)].Add( value);
+    }
+
+
+    const RollingStats* FrameHandler::Stat( std::string_view key) const {
+
+        auto it = mStats.find( std::string( key));
+
+        return it == mStats.end() ? nullptr : &it->second;
+    }
+
+
+    const std::unordered_map<std::string, RollingStats>& FrameHandler::Stats() const {
+
+        return mStats;
+    }
+
+
+    const FrameTimeStats& FrameHandler::FrameTimes() const {
+
+        return mFrameTimes;
+    }
+
+
+    void FrameHandler::DumpFrameTimes( std::string_view path, FrameTimeFormat format) const {
+
+        auto mode = format == FrameTimeFormat::eCsv ? std::ios::out | std::ios::app | std::ios::ate : std::ios::out | std::ios::trunc;
+        std::ofstream file( std::string( path), mode);
+        if (!file.is_open())
+        {
+            throw std::runtime_error( "Failed to open file " + std::string( path) + " for writing!");
+        }
+
+        if (format == FrameTimeFormat::eCsv)
+        {
+            if (file.tellp() == 0)
+            {
+                file << "frame,count,average_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+            }
+            file << mFrameCount << ',' << mFrameTimes.Count() << ',' << mFrameTimes.Average() << ','
+                 << mFrameTimes.Percentile( 50.0) << ',' << mFrameTimes.Percentile( 95.0) << ',' << mFrameTimes.Percentile( 99.0) << ','
+                 << mFrameTimes.Max() << '\n';
+        }
+        else
+        {
+            file << "{\"frame\":" << mFrameCount << ",\"count\":" << mFrameTimes.Count() << ",\"average_ms\":" << mFrameTimes.Average()
+                 << ",\"p50_ms\":" << mFrameTimes.Percentile( 50.0) << ",\"p95_ms\":" << mFrameTimes.Percentile( 95.0)
+                 << ",\"p99_ms\":" << mFrameTimes.Percentile( 99.0) << ",\"max_ms\":" << mFrameTimes.Max()
+                 << ",\"histogram\":{\"bin_width_ms\":" << FrameTimeStats::binWidth << ",\"counts\":[";
+            auto bins = mFrameTimes.Histogram();
+            for (uint32_t bin = 0; bin < bins.size(); bin++)
+            {
+                file << (bin == 0 ? "" : ",") << bins[bin];
+            }
+            file << "]}}\n";
+        }
+    }
+
+
+    void FrameHandler::SetFrameTimeDump( std::string_view path, uint64_t interval, FrameTimeFormat format) {
+
+        mDumpPath = path;
+        mDumpInterval = interval;
+        mDumpFormat = format;
+    }
+
+
 } // namespace vktg
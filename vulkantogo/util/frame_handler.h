@@ -2,7 +2,9 @@
 
 #include "timer.h"
 
+#include <array>
 #include <functional>
+#include <span>
 #include <string>
 #include <unordered_map>
 
@@ -11,6 +13,70 @@ namespace vktg
 {
 
 
+    // statistics over the last windowSize values of a per frame measurement, e.g. a gpu zone time in ms
+    class RollingStats {
+
+        public:
+
+            static constexpr uint32_t windowSize = 128;
+
+            void Add( double value);
+
+            double Last() const;
+            double Average() const;
+            double Min() const;
+            double Max() const;
+            uint32_t Count() const;
+
+        private:
+
+            std::array<double, windowSize> mValues{};
+            uint32_t mNext = 0;
+            uint32_t mCount = 0;
+            double mSum = 0.0;
+    };
+
+
+    // frame times in ms over the last windowSize frames, updates and queries have (amortized) constant cost and never allocate
+    // percentiles are interpolated within the histogram bins, the last bin also counts all longer frames,
+    // percentiles falling into it are taken from the exact frame times of the window
+    class FrameTimeStats {
+
+        public:
+
+            static constexpr uint32_t windowSize = 512;
+            static constexpr uint32_t binCount = 256;
+            static constexpr double binWidth = 0.25;
+
+            void Add( double milliseconds);
+            void Reset();
+
+            double Last() const;
+            double Average() const;
+            double Percentile( double percent) const;
+            double Max() const;
+            uint32_t Count() const;
+            std::span<const uint32_t> Histogram() const;
+
+        private:
+
+            std::array<double, windowSize> mValues{};
+            std::array<uint32_t, binCount> mBins{};
+            // ring of window indices with decreasing values, the front holds the maximum
+            std::array<uint32_t, windowSize> mMaxQueue{};
+            uint32_t mMaxFront = 0;
+            uint32_t mMaxSize = 0;
+            uint64_t mAdded = 0;
+            double mSum = 0.0;
+    };
+
+
+    enum class FrameTimeFormat {
+        eCsv,
+        eJson
+    };
+
+
     class FrameHandler {
 
         public:
@@ -30,6 +96,16 @@ namespace vktg
             void UnregisterEarlyCallback( std::string_view key);
             void UnregisterLateCallback( std::string_view key);
 
+            void AddStat( std::string_view key, double value);
+            const RollingStats* Stat( std::string_view key) const;
+            const std::unordered_map<std::string, RollingStats>& Stats() const;
+
+            const FrameTimeStats& FrameTimes() const;
+            // csv appends one row per dump, json overwrites the file with the latest window including its histogram
+            void DumpFrameTimes( std::string_view path, FrameTimeFormat format) const;
+            // dumps every interval frames from LateUpdate(), an interval of 0 disables periodic dumps
+            void SetFrameTimeDump( std::string_view path, uint64_t interval, FrameTimeFormat format = FrameTimeFormat::eCsv);
+
         private:
 
             vktg::Timer mFrameTimer;
@@ -38,6 +114,12 @@ namespace vktg
 
             std::unordered_map<std::string, std::function<void()>> mEarlyFrameCallbacks;
             std::unordered_map<std::string, std::function<void()>> mLateFrameCallbacks;
+            std::unordered_map<std::string, RollingStats> mStats;
+
+            FrameTimeStats mFrameTimes;
+            std::string mDumpPath;
+            uint64_t mDumpInterval;
+            FrameTimeFormat mDumpFormat;
     };
 
     
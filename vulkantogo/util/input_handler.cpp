@@ -18,6 +18,7 @@ namespace vktg
 
         auto inputHandler = (InputHandler*)glfwGetWindowUserPointer( window);
         inputHandler->mKeyPress[key] = action != GLFW_RELEASE;
+        inputHandler->StampInput();
     }
 
     
@@ -25,6 +26,7 @@ namespace vktg
 
         auto inputHandler = (InputHandler*)glfwGetWindowUserPointer( window);
         inputHandler->mMouseButtonPress[button] = action != GLFW_RELEASE;
+        inputHandler->StampInput();
     }
 
     
@@ -36,6 +38,7 @@ namespace vktg
         inputHandler->mDeltaY = ypos - inputHandler->mMouseY;
         inputHandler->mMouseX = xpos;
         inputHandler->mMouseY = ypos;
+        inputHandler->StampInput();
     }
 
 
@@ -89,6 +92,22 @@ namespace vktg
     }
 
 
+    std::chrono::steady_clock::time_point InputHandler::InputTime() const {
+
+        return mInputTime;
+    }
+
+
+    void InputHandler::StampInput() {
+
+        // GLFW events carry no timestamps, so the time of polling is the closest estimate
+        if (mInputTime == std::chrono::steady_clock::time_point{})
+        {
+            mInputTime = std::chrono::steady_clock::now();
+        }
+    }
+
+
     void InputHandler::PushLayer(InputLayer *pNewLayer)
     {
 
@@ -112,6 +131,7 @@ namespace vktg
 
         mDeltaX = 0.0;
         mDeltaY = 0.0;
+        mInputTime = std::chrono::steady_clock::time_point{};
         
         glfwPollEvents();
         if (pTopLayer != nullptr)
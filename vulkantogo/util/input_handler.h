@@ -3,6 +3,7 @@
 
 #include <GLFW/glfw3.h>
 
+#include <chrono>
 #include <functional>
 #include <variant>
 
@@ -36,6 +37,9 @@ namespace vktg
             bool MouseButtonPressed(int button) const;
             std::pair<double, double> CursorPos() const;
             std::pair<double, double> CursorDelta() const;
+            // time the earliest input event of the last Update() was polled at, default constructed if there was none,
+            // pass it on to PresentImage(...) to measure input to present latency
+            std::chrono::steady_clock::time_point InputTime() const;
 
             void PushLayer( InputLayer *pLayer);
             void PopLayer();
@@ -47,6 +51,7 @@ namespace vktg
             static void KeyListener(GLFWwindow *window, int key, int scancode, int action, int mods);
             static void MouseListener(GLFWwindow *window, int button, int action, int mods);
             static void CursorPosListener(GLFWwindow *window, double xpos, double ypos);
+            void StampInput();
 
 
             GLFWwindow* pWindow;
@@ -56,6 +61,7 @@ namespace vktg
             bool mMouseButtonPress[GLFW_MOUSE_BUTTON_LAST] = {0};
             double mMouseX, mMouseY;
             double mDeltaX = 0, mDeltaY = 0;
+            std::chrono::steady_clock::time_point mInputTime;
     };
 
     
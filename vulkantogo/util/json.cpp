@@ -0,0 +1,40 @@
+#include "json.h"
+
+
+namespace vktg
+{
+
+
+    void AppendJsonString( std::ostream &out, std::string_view str) {
+
+        static const char hexDigits[] = "0123456789abcdef";
+
+        out << '"';
+        for (char c : str)
+        {
+            switch (c)
+            {
+                case '"': out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\b': out << "\\b"; break;
+                case '\f': out << "\\f"; break;
+                case '\n': out << "\\n"; break;
+                case '\r': out << "\\r"; break;
+                case '\t': out << "\\t"; break;
+                default:
+                    if ((unsigned char)c < 0x20)
+                    {
+                        out << "\\u00" << hexDigits[(unsigned char)c >> 4] << hexDigits[c & 0xF];
+                    }
+                    else
+                    {
+                        out << c;
+                    }
+                    break;
+            }
+        }
+        out << '"';
+    }
+
+
+} // namespace vktg
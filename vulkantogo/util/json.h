@@ -0,0 +1,19 @@
+#pragma once
+
+
+#include <ostream>
+#include <string_view>
+
+
+namespace vktg
+{
+
+
+    /// @brief Appends a string as JSON string literal, escaping quotes, backslashes and control characters.
+    ///        Used for names in the JSON outputs, like the Chrome trace of the CPU profiler.
+    /// @param out Output stream.
+    /// @param str String to append.
+    void AppendJsonString( std::ostream &out, std::string_view str);
+
+
+} // namespace vktg
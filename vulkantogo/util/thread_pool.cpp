@@ -0,0 +1,84 @@
+#include "thread_pool.h"
+#include "cpu_profiler.h"
+
+#include <algorithm>
+
+
+namespace vktg
+{
+
+
+    ThreadPool::ThreadPool( uint32_t threadCount) : mActiveJobs{0}, mStop{false} {
+
+        threadCount = std::max( threadCount, 1u);
+        mThreads.reserve( threadCount);
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            mThreads.emplace_back( &ThreadPool::Run, this);
+        }
+    }
+
+
+    ThreadPool::~ThreadPool() {
+
+        {
+            std::lock_guard<std::mutex> lock( mMutex);
+            mStop = true;
+        }
+        mJobCondition.notify_all();
+
+        for (auto &thread : mThreads)
+        {
+            thread.join();
+        }
+    }
+
+
+    void ThreadPool::Wait() {
+
+        std::unique_lock<std::mutex> lock( mMutex);
+        mIdleCondition.wait( lock, [this](){ return mJobs.empty() && mActiveJobs == 0; });
+    }
+
+
+    uint32_t ThreadPool::ThreadCount() const {
+
+        return (uint32_t)mThreads.size();
+    }
+
+
+    void ThreadPool::Run() {
+
+        VKTG_PROFILE_THREAD( "thread pool worker");
+
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock( mMutex);
+                mJobCondition.wait( lock, [this](){ return mStop || !mJobs.empty(); });
+                // remaining jobs are still executed on shutdown
+                if (mJobs.empty())
+                {
+                    return;
+                }
+                job = std::move( mJobs.front());
+                mJobs.pop_front();
+                ++mActiveJobs;
+            }
+
+            {
+                VKTG_PROFILE_ZONE( "ThreadPool job");
+                job();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock( mMutex);
+                --mActiveJobs;
+            }
+            mIdleCondition.notify_all();
+        }
+    }
+
+
+} // namespace vktg
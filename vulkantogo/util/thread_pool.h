@@ -0,0 +1,71 @@
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace vktg
+{
+
+
+    /// @brief Fixed number of worker threads executing submitted jobs in submission order.
+    class ThreadPool {
+
+        public:
+
+            /// @brief Starts worker threads.
+            /// @param threadCount Number of worker threads, at least one.
+            ThreadPool( uint32_t threadCount = std::thread::hardware_concurrency());
+            /// @brief Finishes all submitted jobs and joins worker threads.
+            ~ThreadPool();
+
+            ThreadPool( const ThreadPool&) = delete;
+            ThreadPool& operator=( const ThreadPool&) = delete;
+
+            /// @brief Queues a job for execution on a worker thread.
+            /// @param func Job function.
+            /// @return Future holding the return value of the job or the exception it threw.
+            template<typename Func>
+            std::future<std::invoke_result_t<Func>> Submit( Func &&func) {
+
+                using Result = std::invoke_result_t<Func>;
+                auto task = std::make_shared<std::packaged_task<Result()>>( std::forward<Func>( func));
+                auto future = task->get_future();
+                {
+                    std::lock_guard<std::mutex> lock( mMutex);
+                    mJobs.push_back( [task](){ (*task)(); });
+                }
+                mJobCondition.notify_one();
+
+                return future;
+            }
+
+            /// @brief Blocks until all submitted jobs have been executed.
+            void Wait();
+            /// @brief Number of worker threads.
+            /// @return Number of worker threads.
+            uint32_t ThreadCount() const;
+
+        private:
+
+            void Run();
+
+            std::vector<std::thread> mThreads;
+            std::deque<std::function<void()>> mJobs;
+            std::mutex mMutex;
+            std::condition_variable mJobCondition;
+            std::condition_variable mIdleCondition;
+            uint32_t mActiveJobs;
+            bool mStop;
+    };
+
+
+} // namespace vktg
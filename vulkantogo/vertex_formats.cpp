@@ -0,0 +1,192 @@
+#include "vertex_formats.h"
+
+#include <cmath>
+#include <cstring>
+
+
+namespace vktg
+{
+
+
+    static int16_t FloatToSnorm16( float value) {
+
+        return (int16_t)std::round( std::clamp( value, -1.f, 1.f) * 32767.f);
+    }
+
+
+    static uint16_t FloatToUnorm16( float value) {
+
+        return (uint16_t)std::round( std::clamp( value, 0.f, 1.f) * 65535.f);
+    }
+
+
+    uint16_t FloatToHalf( float value) {
+
+        uint32_t bits;
+        memcpy( &bits, &value, sizeof(bits));
+
+        uint16_t sign = (bits >> 16) & 0x8000;
+        uint32_t exponent = (bits >> 23) & 0xFF;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        // inf and nan
+        if (exponent == 0xFF)
+        {
+            return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+        }
+
+        int32_t halfExponent = (int32_t)exponent - 127 + 15;
+        // overflow to inf
+        if (halfExponent >= 31)
+        {
+            return sign | 0x7C00;
+        }
+        // subnormal or zero
+        if (halfExponent <= 0)
+        {
+            if (halfExponent < -10)
+            {
+                return sign;
+            }
+            mantissa |= 0x800000;
+            uint32_t shift = 14 - halfExponent;
+            uint32_t halfMantissa = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (halfMantissa & 1)))
+            {
+                halfMantissa++;
+            }
+            return sign | (uint16_t)halfMantissa;
+        }
+
+        uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFF;
+        // rounding may carry into the exponent, which correctly rounds up to the next power of two or inf
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        {
+            half++;
+        }
+
+        return sign | (uint16_t)half;
+    }
+
+
+    float HalfToFloat( uint16_t value) {
+
+        uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1F;
+        uint32_t mantissa = value & 0x3FF;
+
+        uint32_t bits;
+        if (exponent == 0x1F)
+        {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        }
+        else if (exponent != 0)
+        {
+            bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+        }
+        else if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // normalize subnormal half
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400))
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+
+        float result;
+        memcpy( &result, &bits, sizeof(result));
+
+        return result;
+    }
+
+
+    Half2 PackHalf2( float x, float y) {
+
+        return Half2{ FloatToHalf( x), FloatToHalf( y)};
+    }
+
+
+    Snorm16x2 PackOctahedral( const Float3 &direction) {
+
+        float length = std::abs( direction.x) + std::abs( direction.y) + std::abs( direction.z);
+        if (length == 0.f)
+        {
+            return Snorm16x2{ 0, 0};
+        }
+
+        float x = direction.x / length;
+        float y = direction.y / length;
+        // fold lower hemisphere over the diagonals
+        if (direction.z < 0.f)
+        {
+            float foldedX = (1.f - std::abs( y)) * (x >= 0.f ? 1.f : -1.f);
+            float foldedY = (1.f - std::abs( x)) * (y >= 0.f ? 1.f : -1.f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        return Snorm16x2{ FloatToSnorm16( x), FloatToSnorm16( y)};
+    }
+
+
+    Float3 UnpackOctahedral( const Snorm16x2 &encoded) {
+
+        float x = std::max( encoded.x / 32767.f, -1.f);
+        float y = std::max( encoded.y / 32767.f, -1.f);
+        float z = 1.f - std::abs( x) - std::abs( y);
+        if (z < 0.f)
+        {
+            float unfoldedX = (1.f - std::abs( y)) * (x >= 0.f ? 1.f : -1.f);
+            float unfoldedY = (1.f - std::abs( x)) * (y >= 0.f ? 1.f : -1.f);
+            x = unfoldedX;
+            y = unfoldedY;
+        }
+
+        float length = std::sqrt( x * x + y * y + z * z);
+
+        return Float3{ x / length, y / length, z / length};
+    }
+
+
+    Unorm8x4 PackUnorm8x4( float r, float g, float b, float a) {
+
+        auto toUnorm8 = []( float value){ return (uint8_t)std::round( std::clamp( value, 0.f, 1.f) * 255.f); };
+
+        return Unorm8x4{ toUnorm8( r), toUnorm8( g), toUnorm8( b), toUnorm8( a)};
+    }
+
+
+    Unorm16x4 QuantizePosition( const Float3 &position, const Float3 &boundsMin, const Float3 &boundsMax) {
+
+        auto normalize = []( float value, float min, float max){ return max > min ? (value - min) / (max - min) : 0.f; };
+
+        return Unorm16x4{
+            FloatToUnorm16( normalize( position.x, boundsMin.x, boundsMax.x)),
+            FloatToUnorm16( normalize( position.y, boundsMin.y, boundsMax.y)),
+            FloatToUnorm16( normalize( position.z, boundsMin.z, boundsMax.z)),
+            65535
+        };
+    }
+
+
+    Float3 DequantizePosition( const Unorm16x4 &quantized, const Float3 &boundsMin, const Float3 &boundsMax) {
+
+        return Float3{
+            boundsMin.x + quantized.x / 65535.f * (boundsMax.x - boundsMin.x),
+            boundsMin.y + quantized.y / 65535.f * (boundsMax.y - boundsMin.y),
+            boundsMin.z + quantized.z / 65535.f * (boundsMax.z - boundsMin.z)
+        };
+    }
+
+
+} // namespace vktg
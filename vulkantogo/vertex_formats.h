@@ -0,0 +1,147 @@
+#pragma once
+
+
+#include "vk_core.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+
+namespace vktg
+{
+
+
+    /// @brief Vertex attribute storage types, each maps to a single vk::Format.
+    struct Float2 { float x, y; };
+    struct Float3 { float x, y, z; };
+    struct Float4 { float x, y, z, w; };
+    /// @brief Two half floats, e.g. texture coordinates.
+    struct Half2 { uint16_t x, y; };
+    /// @brief Four half floats, e.g. positions with limited precision.
+    struct Half4 { uint16_t x, y, z, w; };
+    /// @brief Two 16-bit signed normalized values, e.g. octahedral encoded normals and tangents.
+    struct Snorm16x2 { int16_t x, y; };
+    /// @brief Four 16-bit unsigned normalized values, e.g. positions quantized to the mesh bounds.
+    struct Unorm16x4 { uint16_t x, y, z, w; };
+    /// @brief Four 8-bit unsigned normalized values, e.g. vertex colors.
+    struct Unorm8x4 { uint8_t r, g, b, a; };
+
+
+    /// @brief Vertex input format of an attribute storage type. Specialize for custom types, e.g. glm vectors.
+    template<typename T>
+    struct VertexAttributeFormat;
+
+    template<> struct VertexAttributeFormat<float>     { static constexpr vk::Format format = vk::Format::eR32Sfloat; };
+    template<> struct VertexAttributeFormat<Float2>    { static constexpr vk::Format format = vk::Format::eR32G32Sfloat; };
+    template<> struct VertexAttributeFormat<Float3>    { static constexpr vk::Format format = vk::Format::eR32G32B32Sfloat; };
+    template<> struct VertexAttributeFormat<Float4>    { static constexpr vk::Format format = vk::Format::eR32G32B32A32Sfloat; };
+    template<> struct VertexAttributeFormat<Half2>     { static constexpr vk::Format format = vk::Format::eR16G16Sfloat; };
+    template<> struct VertexAttributeFormat<Half4>     { static constexpr vk::Format format = vk::Format::eR16G16B16A16Sfloat; };
+    template<> struct VertexAttributeFormat<Snorm16x2> { static constexpr vk::Format format = vk::Format::eR16G16Snorm; };
+    template<> struct VertexAttributeFormat<Unorm16x4> { static constexpr vk::Format format = vk::Format::eR16G16B16A16Unorm; };
+    template<> struct VertexAttributeFormat<Unorm8x4>  { static constexpr vk::Format format = vk::Format::eR8G8B8A8Unorm; };
+
+
+    /// @brief Compile time vertex layout of a struct whose members have the given attribute types in declaration order.
+    ///        Offsets follow the C++ struct layout rules, so static_assert( sizeof(MyVertex) == Layout::stride) guards against mismatches.
+    template<typename... Types>
+    struct VertexLayout {
+
+        static constexpr uint32_t attributeCount = sizeof...(Types);
+
+        /// @brief Attribute offsets within the vertex.
+        static constexpr std::array<uint32_t, attributeCount> offsets = [](){
+            std::array<uint32_t, attributeCount> result{};
+            uint32_t offset = 0;
+            size_t i = 0;
+            ((offset = (offset + alignof(Types) - 1) / alignof(Types) * alignof(Types), result[i++] = offset, offset += sizeof(Types)), ...);
+            return result;
+        }();
+
+        /// @brief Vertex size including trailing padding.
+        static constexpr uint32_t stride = [](){
+            uint32_t offset = 0;
+            uint32_t alignment = 1;
+            ((offset = (offset + alignof(Types) - 1) / alignof(Types) * alignof(Types) + sizeof(Types), alignment = std::max<uint32_t>( alignment, alignof(Types))), ...);
+            return (offset + alignment - 1) / alignment * alignment;
+        }();
+
+        /// @brief Vertex input binding description of the layout.
+        /// @param binding Binding index.
+        /// @param inputRate Per vertex or per instance data.
+        /// @return Binding description.
+        static constexpr vk::VertexInputBindingDescription Binding( uint32_t binding = 0, vk::VertexInputRate inputRate = vk::VertexInputRate::eVertex) {
+
+            return vk::VertexInputBindingDescription{ binding, stride, inputRate};
+        }
+
+        /// @brief Vertex input attribute descriptions of the layout at consecutive locations.
+        /// @param binding Binding index.
+        /// @param firstLocation Shader location of the first attribute.
+        /// @return Attribute descriptions.
+        static constexpr std::array<vk::VertexInputAttributeDescription, attributeCount> Attributes( uint32_t binding = 0, uint32_t firstLocation = 0) {
+
+            constexpr std::array<vk::Format, attributeCount> formats{ VertexAttributeFormat<Types>::format...};
+            std::array<vk::VertexInputAttributeDescription, attributeCount> result{};
+            for (uint32_t i = 0; i < attributeCount; i++)
+            {
+                result[i] = vk::VertexInputAttributeDescription{ firstLocation + i, binding, formats[i], offsets[i]};
+            }
+            return result;
+        }
+    };
+
+
+    /// @brief Convert float to half float, rounding to nearest even.
+    /// @param value Float value.
+    /// @return Half float bits.
+    uint16_t FloatToHalf( float value);
+
+    /// @brief Convert half float to float.
+    /// @param value Half float bits.
+    /// @return Float value.
+    float HalfToFloat( uint16_t value);
+
+    /// @brief Pack two floats as half floats.
+    /// @param x First value.
+    /// @param y Second value.
+    /// @return Packed values.
+    Half2 PackHalf2( float x, float y);
+
+    /// @brief Encode a unit vector with an octahedral mapping into two snorm16 values.
+    ///        Decode in shaders with: v = vec3(e, 1 - abs(e.x) - abs(e.y)); if (v.z < 0) v.xy = (1 - abs(v.yx)) * sign(v.xy); v = normalize(v);
+    /// @param direction Direction, does not need to be normalized.
+    /// @return Encoded direction.
+    Snorm16x2 PackOctahedral( const Float3 &direction);
+
+    /// @brief Decode an octahedral encoded unit vector.
+    /// @param encoded Encoded direction.
+    /// @return Normalized direction.
+    Float3 UnpackOctahedral( const Snorm16x2 &encoded);
+
+    /// @brief Pack four values in [0, 1] as unorm8.
+    /// @param r Red.
+    /// @param g Green.
+    /// @param b Blue.
+    /// @param a Alpha.
+    /// @return Packed color.
+    Unorm8x4 PackUnorm8x4( float r, float g, float b, float a);
+
+    /// @brief Quantize a position to unorm16 relative to the mesh bounds, w is set to one.
+    ///        Dequantize in shaders with: position = boundsMin + q.xyz * (boundsMax - boundsMin).
+    /// @param position Position inside the bounds.
+    /// @param boundsMin Minimum corner of the mesh bounds.
+    /// @param boundsMax Maximum corner of the mesh bounds.
+    /// @return Quantized position.
+    Unorm16x4 QuantizePosition( const Float3 &position, const Float3 &boundsMin, const Float3 &boundsMax);
+
+    /// @brief Reconstruct a quantized position.
+    /// @param quantized Quantized position.
+    /// @param boundsMin Minimum corner of the mesh bounds.
+    /// @param boundsMax Maximum corner of the mesh bounds.
+    /// @return Position.
+    Float3 DequantizePosition( const Unorm16x4 &quantized, const Float3 &boundsMin, const Float3 &boundsMax);
+
+
+} // namespace vktg
@@ -2,6 +2,8 @@
 #define VMA_IMPLEMENTATION
 #include "vk_core.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <functional>
 #include <string>
@@ -20,7 +22,10 @@ namespace vktg
 
     static void SetRequiredExtensionsDefault( std::vector<const char*>& extensions ) {
 
-        extensions.push_back( VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        if (!Config()->headless)
+        {
+            extensions.push_back( VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
         extensions.push_back( VK_EXT_SAMPLER_FILTER_MINMAX_EXTENSION_NAME );
         extensions.push_back( VK_KHR_SAMPLER_MIRROR_CLAMP_TO_EDGE_EXTENSION_NAME );
     }
@@ -53,6 +58,7 @@ namespace vktg
             .setLargePoints( VK_TRUE )
             .setWideLines( VK_TRUE )
             .setSamplerAnisotropy( VK_TRUE )
+            .setPipelineStatisticsQuery( VK_TRUE )
             .setShaderFloat64( VK_TRUE);
     }
 
@@ -67,7 +73,8 @@ namespace vktg
             .setDrawIndirectCount( VK_TRUE )
             .setSamplerFilterMinmax( VK_TRUE )
             .setBufferDeviceAddress( VK_TRUE )
-            .setTimelineSemaphore( VK_TRUE );
+            .setTimelineSemaphore( VK_TRUE )
+            .setHostQueryReset( VK_TRUE );
     }
 
     static void SetVulkan13DeviceFeaturesDefault( vk::PhysicalDeviceVulkan13Features& features) {
@@ -103,6 +110,8 @@ namespace vktg
             pConfig->windowWidth = 1920;
             pConfig->windowHeight = 1080;
             pConfig->fullScreen = false;
+            pConfig->headless = false;
+            pConfig->presentWait = false;
             pConfig->debugCallback = [](
                 VkDebugUtilsMessageSeverityFlagBitsEXT      messageSeverity,
                 VkDebugUtilsMessageTypeFlagsEXT             messageType,
@@ -121,7 +130,7 @@ namespace vktg
 
         static GLFWwindow* window;
 
-        if (!window)
+        if (!window && !Config()->headless)
         {
             // init glfw
             if (!glfwInit())
@@ -175,9 +184,13 @@ namespace vktg
                 .setEngineVersion(  VK_MAKE_VERSION(1, 0, 0) )
                 .setApiVersion( VK_API_VERSION_1_3 );
 
-            uint32_t glfwExtensionCount = 0;
-            auto glfwExtensions = glfwGetRequiredInstanceExtensions( &glfwExtensionCount);
-            std::vector<const char*> glfwExtensionsVector( glfwExtensions, glfwExtensions + glfwExtensionCount);
+            std::vector<const char*> glfwExtensionsVector;
+            if (!Config()->headless)
+            {
+                uint32_t glfwExtensionCount = 0;
+                auto glfwExtensions = glfwGetRequiredInstanceExtensions( &glfwExtensionCount);
+                glfwExtensionsVector.assign( glfwExtensions, glfwExtensions + glfwExtensionCount);
+            }
             std::vector<const char*> layers;
 
 #ifndef NDEBUG
@@ -232,7 +245,7 @@ namespace vktg
 
         static vk::SurfaceKHR surface;
 
-        if (!surface)
+        if (!surface && !Config()->headless)
         {
             VkSurfaceKHR tempSurface;
             VK_CHECK( (vk::Result)glfwCreateWindowSurface( Instance(), Window(), nullptr, &tempSurface) );
@@ -265,6 +278,12 @@ namespace vktg
                 }
             }
 
+            // e.g. CPU implementations like lavapipe
+            if (!chosenGpu && !gpus.empty())
+            {
+                chosenGpu = gpus.front();
+            }
+
             if (!chosenGpu)
             {
                 throw std::runtime_error("Failed to find suitable GPU!");
@@ -275,6 +294,10 @@ namespace vktg
     }
 
     
+    static bool presentWaitEnabled = false;
+    static bool meshShaderEnabled = false;
+
+
     vk::Device Device() {
 
         static vk::Device device;
@@ -356,6 +379,52 @@ namespace vktg
             enabledFeatures.pNext = &enabledFeatures11;
             enabledFeatures11.pNext = &enabledFeatures12;
             enabledFeatures12.pNext = &enabledFeatures13;
+            auto meshShaderFeatures = vk::PhysicalDeviceMeshShaderFeaturesEXT{};
+            if (Config()->setMeshShaderFeatures)
+            {
+                Config()->setMeshShaderFeatures( meshShaderFeatures);
+                // only if supported, check with MeshShaderEnabled()
+                auto extensions = Gpu().enumerateDeviceExtensionProperties();
+                bool hasExtension = std::any_of( extensions.begin(), extensions.end(), []( const vk::ExtensionProperties &extension){ 
+                    return std::strcmp( extension.extensionName, VK_EXT_MESH_SHADER_EXTENSION_NAME) == 0; 
+                });
+                auto supported = hasExtension
+                    ? Gpu().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceMeshShaderFeaturesEXT>().get<vk::PhysicalDeviceMeshShaderFeaturesEXT>()
+                    : vk::PhysicalDeviceMeshShaderFeaturesEXT{};
+                if (meshShaderFeatures.meshShader && supported.meshShader && (!meshShaderFeatures.taskShader || supported.taskShader))
+                {
+                    requiredExtensions.push_back( VK_EXT_MESH_SHADER_EXTENSION_NAME);
+                    meshShaderFeatures.pNext = nullptr;
+                    enabledFeatures13.pNext = &meshShaderFeatures;
+                    meshShaderEnabled = true;
+                }
+            }
+
+            // present id and present wait, only if supported since few drivers expose them
+            auto presentIdFeatures = vk::PhysicalDevicePresentIdFeaturesKHR{};
+            auto presentWaitFeatures = vk::PhysicalDevicePresentWaitFeaturesKHR{};
+            if (Config()->presentWait && !Config()->headless)
+            {
+                auto extensions = Gpu().enumerateDeviceExtensionProperties();
+                auto hasExtension = [&extensions]( const char *name){
+                    return std::any_of( extensions.begin(), extensions.end(), [name]( const vk::ExtensionProperties &extension){ 
+                        return std::strcmp( extension.extensionName, name) == 0; 
+                    });
+                };
+                auto supported = Gpu().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>();
+                if (hasExtension( VK_KHR_PRESENT_ID_EXTENSION_NAME) && hasExtension( VK_KHR_PRESENT_WAIT_EXTENSION_NAME)
+                    && supported.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId && supported.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait)
+                {
+                    requiredExtensions.push_back( VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                    requiredExtensions.push_back( VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                    presentIdFeatures.setPresentId( VK_TRUE );
+                    presentWaitFeatures.setPresentWait( VK_TRUE );
+                    presentWaitFeatures.pNext = enabledFeatures.pNext;
+                    presentIdFeatures.pNext = &presentWaitFeatures;
+                    enabledFeatures.pNext = &presentIdFeatures;
+                    presentWaitEnabled = true;
+                }
+            }
 
             // create device
             auto deviceInfo = vk::DeviceCreateInfo{}
@@ -400,6 +469,22 @@ namespace vktg
     }
 
 
+    bool PresentWaitEnabled() {
+
+        Device();
+
+        return presentWaitEnabled;
+    }
+
+
+    bool MeshShaderEnabled() {
+
+        Device();
+
+        return meshShaderEnabled;
+    }
+
+
     uint32_t QueueIndex( QueueType type, int queueIdx) {
 
         static int32_t graphicsQueueIdx = -1;
@@ -522,7 +607,10 @@ namespace vktg
         Device().destroy();
 
         // surface
-        Instance().destroySurfaceKHR( Surface());
+        if (!Config()->headless)
+        {
+            Instance().destroySurfaceKHR( Surface());
+        }
 
         // debug messenger
 #ifndef NDEBUG
@@ -533,8 +621,11 @@ namespace vktg
         Instance().destroy();
 
         // window
-        glfwDestroyWindow( Window());
-        glfwTerminate();
+        if (!Config()->headless)
+        {
+            glfwDestroyWindow( Window());
+            glfwTerminate();
+        }
     }
 
     
@@ -31,6 +31,8 @@ namespace vktg
         bool fullScreen;
         std::function<void()> configureGlfw;
         std::function<void(GLFWwindow*)> configureGlfwWindow;
+        // no window, surface and swapchain extension, e.g. for benchmarks on a CPU Vulkan implementation
+        bool headless;
 
         // vulkan required device extentions
         std::function<void(std::vector<const char*>&)> setRequiredExtensions;
@@ -40,6 +42,10 @@ namespace vktg
         std::function<void(vk::PhysicalDeviceVulkan11Features&)> setVulkan11DeviceFeatures;
         std::function<void(vk::PhysicalDeviceVulkan12Features&)> setVulkan12DeviceFeatures;
         std::function<void(vk::PhysicalDeviceVulkan13Features&)> setVulkan13DeviceFeatures;
+        // mesh shader features, VK_EXT_mesh_shader is enabled if meshShader is set and the requested features are supported
+        std::function<void(vk::PhysicalDeviceMeshShaderFeaturesEXT&)> setMeshShaderFeatures;
+        // enables VK_KHR_present_id and VK_KHR_present_wait if supported, for present pacing with WaitForPresentPacing(...)
+        bool presentWait;
 
         // vulkan debug callback
         std::function<void(
@@ -58,7 +64,7 @@ namespace vktg
     
 
     /// @brief Access GLFW window. Creates window with specified configuration upon first call.
-    /// @return Pointer to the created glfw window.
+    /// @return Pointer to the created glfw window, nullptr if headless.
     GLFWwindow* Window();
     /// @brief Access Vulkan instance. Creates instance upon first call.
     /// @return Vulkan instance.
@@ -67,14 +73,21 @@ namespace vktg
     /// @return Vulkan debug messenger.
     vk::DebugUtilsMessengerEXT DebugMessenger();
     /// @brief Access Vulkan surface, Creates surface upon first call.
-    /// @return Vulkan surface.
+    /// @return Vulkan surface, null handle if headless.
     vk::SurfaceKHR Surface();
-    /// @brief Access Vulkan physical device. Selects suitable physical device upon first call.
+    /// @brief Access Vulkan physical device. Selects suitable physical device upon first call, preferring discrete over integrated GPUs
+    ///        and falling back to any other device, e.g. a CPU implementation.
     /// @return Vulkan physical device.
     vk::PhysicalDevice Gpu();
     /// @brief Access Vulkan device. Creates device with specified configuration upon frst call.
     /// @return Vulkan device. 
     vk::Device Device();
+    /// @brief Check if present id and present wait are enabled, see ConfigSettings::presentWait.
+    /// @return True if enabled.
+    bool PresentWaitEnabled();
+    /// @brief Check if VK_EXT_mesh_shader is enabled, see ConfigSettings::setMeshShaderFeatures.
+    /// @return True if enabled.
+    bool MeshShaderEnabled();
     /// @brief Access Vulkan queue family index for specified queue type. The first call providing a queueIdx will assign this index to queues of that type.
     ///        Intended for internal use only. Access specific queue indices with the dedicated *QueueIndex() functions for graphics, compute and transfer.
     /// @param type Type of queue.
@@ -114,7 +127,7 @@ namespace vktg
     ///        Any customization must happen before call to StartUp().
     /// @return Pointer to static ConfigSettings object.
     ConfigSettings* Config();
-    /// @brief Start up VulkanToGo. Creates glfw window, vulkan instance and surface. Selects gpu to use and creates Vulkan device, queues and memory allocator.
+    /// @brief Start up VulkanToGo. Creates glfw window, vulkan instance and surface, unless headless. Selects gpu to use and creates Vulkan device, queues and memory allocator.
     ///        This is the first function you call before using the API and after setting user configuration.
     void StartUp();
     /// @brief Shut down VulkanToGo. Destroys Vulkan instance, device, surface, memory allocator and GLFW window.
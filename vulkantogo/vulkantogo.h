@@ -9,16 +9,30 @@
 #include "vk_core.h"
 #include "commands.h"
 #include "descriptors.h"
+#include "formats.h"
+#include "geometry_pool.h"
+#include "gpu_profiler.h"
+#include "indirect_draw.h"
+#include "mesh_optimizer.h"
+#include "meshlets.h"
 #include "pipelines.h"
+#include "queries.h"
+#include "readback.h"
+#include "render_graph.h"
 #include "rendering.h" 
 #include "samplers.h"
 #include "storage.h"
 #include "submit_context.h"
 #include "swapchain.h"
 #include "synchronization.h"
+#include "texture_streamer.h"
 #include "transfer.h"
+#include "vertex_formats.h"
 
 #include "util/deletion_stack.h"
 #include "util/timer.h" 
 #include "util/frame_handler.h"
-#include "util/input_handler.h"
\ No newline at end of file
+#include "util/input_handler.h"
+#include "util/thread_pool.h"
+#include "util/cpu_profiler.h"
+#include "util/json.h"
\ No newline at end of file